@@ -5,8 +5,17 @@ in vec2 uv;
 layout (location = 0) out vec4 fragColor;
 
 uniform sampler2D inputTexture; // Explicit binding.
-uniform float near;
-uniform float far;
+
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
 
 float remap(float depth) {
     return (2.0 * near) / (far + near - depth * (far - near));
@@ -6,6 +6,12 @@ layout (location = 0) out vec4 fragColor;
 in vec2 uv;
 uniform sampler2D inputTexture; // Explicit binding.
 
+// First moment of the optimized moment quantization in shadow.frag, which is the depth.
+float DequantizeDepth(vec4 quantized) {
+    quantized[0] -= 0.035955884801f;
+    return dot(vec4(0.2227744146f, 0.0771972861f, 0.7926986636f, 0.0319417555f), quantized);
+}
+
 void main() {
-    fragColor = vec4(vec3(texture(inputTexture, uv).r), 1.0f);
+    fragColor = vec4(vec3(DequantizeDepth(texture(inputTexture, uv))), 1.0f);
 }
\ No newline at end of file
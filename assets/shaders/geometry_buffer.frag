@@ -10,10 +10,19 @@ layout (location = 4) out vec4 specular;
 in vec4 worldPosition;
 in vec4 worldNormal;
 
-uniform vec3 ambientCoefficient;
-uniform vec3 diffuseCoefficient;
-uniform vec3 specularCoefficient;
-uniform float specularExponent;
+// Layout is reflected by MaterialBuffer, members are filled from the material uniforms of the same name.
+struct Material {
+    vec3 ambientCoefficient;
+    vec3 diffuseCoefficient;
+    vec3 specularCoefficient;
+    float specularExponent;
+};
+
+layout (std430, binding = 9) readonly buffer Materials {
+    Material materials[];
+};
+
+flat in int materialID;
 
 uniform float normalBlend; // Blend factor between vertex and face normals.
 
@@ -24,6 +33,8 @@ vec3 GetFaceNormal(vec3 worldPosition) {
 }
 
 void main() {
+    Material material = materials[materialID];
+
     // Store fragment position in the first texture buffer.
     position = vec4(worldPosition.xyz, 1.0f);
 
@@ -33,11 +44,11 @@ void main() {
     normal = vec4(mix(faceNormal, vertexNormal, normalBlend), 1.0f); // Color, not traditional normal value.
 
     // Store ambient color in the third texture buffer.
-    ambient = vec4(ambientCoefficient, 1.0f);
+    ambient = vec4(material.ambientCoefficient, 1.0f);
 
     // Store diffuse color in the fourth texture buffer.
-    diffuse = vec4(diffuseCoefficient, 1.0f);
+    diffuse = vec4(material.diffuseCoefficient, 1.0f);
 
     // Store specular color in the RBG channels and exponent in the A channel of the fifth texture buffer.
-    specular = vec4(specularCoefficient, specularExponent);
+    specular = vec4(material.specularCoefficient, material.specularExponent);
 }
\ No newline at end of file
@@ -5,21 +5,45 @@ layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec3 vertexNormal;
 layout (location = 2) in vec2 vertexUV;
 
-uniform mat4 cameraTransform;
-uniform mat4 modelTransform;
-uniform mat4 normalTransform;
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
+
+// Per-draw data streamed by the render queue (matches RenderQueue::DrawData).
+struct Draw {
+    mat4 modelTransform;
+    mat4 normalTransform;
+    int materialID; // Record in the material buffer.
+};
+
+layout (std430, binding = 10) readonly buffer Draws {
+    Draw draws[];
+};
+
+uniform int drawID;
 
 out vec4 worldPosition;
 out vec4 worldNormal;
 out vec3 shadowPosition;
+flat out int materialID;
 
 void main() {
     // Transform to screen coordinates (NDC).
 //    viewNormal = transpose(inverse(viewTransform * modelTransform)) * vec4(vertexNormal, 0.0f);
 //    viewPosition = viewTransform * modelTransform * vec4(vertexPosition, 1.0);
 
-    worldNormal = normalTransform * vec4(vertexNormal, 0.0f);
-    worldPosition = modelTransform * vec4(vertexPosition, 1.0);
+    Draw draw = draws[drawID];
+    materialID = draw.materialID;
+
+    worldNormal = draw.normalTransform * vec4(vertexNormal, 0.0f);
+    worldPosition = draw.modelTransform * vec4(vertexPosition, 1.0);
 
-    gl_Position = cameraTransform * modelTransform * vec4(vertexPosition, 1.0);
+    gl_Position = cameraTransform * worldPosition;
 }
\ No newline at end of file
@@ -0,0 +1,72 @@
+#version 460 core
+
+// Compact geometry buffer, matches geometry_buffer_compact.frag.
+layout (location = 0) out vec2 normal;   // Octahedral encoding.
+layout (location = 1) out vec4 ambient;  // sRGB.
+layout (location = 2) out vec4 diffuse;  // sRGB.
+layout (location = 3) out vec4 specular; // sRGB, specular exponent packed in the A channel.
+
+in vec4 worldPosition;
+in vec4 worldNormal;
+flat in int objectIndex;
+
+// Per-object data (matches IndirectRenderer::ObjectData).
+struct Object {
+    mat4 modelTransform;
+    mat4 normalTransform;
+    vec4 center; // World space bounds.
+    vec4 extent;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint passMask;
+    int materialID; // Record in the material buffer.
+};
+
+layout (std430, binding = 6) readonly buffer Objects {
+    Object objects[];
+};
+
+// Layout is reflected by MaterialBuffer, matches geometry_buffer_compact.frag.
+struct Material {
+    vec3 ambientCoefficient;
+    vec3 diffuseCoefficient;
+    vec3 specularCoefficient;
+    float specularExponent;
+};
+
+layout (std430, binding = 9) readonly buffer Materials {
+    Material materials[];
+};
+
+uniform float normalBlend; // Blend factor between vertex and face normals.
+
+vec3 GetFaceNormal(vec3 worldPosition) {
+    vec3 dx = dFdx(worldPosition);
+    vec3 dy = dFdy(worldPosition);
+    return normalize(cross(dx, dy));
+}
+
+// Maps a unit vector onto the octahedron and unfolds it into [0, 1]^2.
+vec2 EncodeNormal(vec3 n) {
+    n /= abs(n.x) + abs(n.y) + abs(n.z);
+    vec2 e = n.z >= 0.0f ? n.xy : (1.0f - abs(n.yx)) * vec2(n.x >= 0.0f ? 1.0f : -1.0f, n.y >= 0.0f ? 1.0f : -1.0f);
+    return e * 0.5f + 0.5f;
+}
+
+// Exponents in [0, infinity] are stored as sqrt(2 / (exponent + 2)) in [0, 1], which spends the 8 bits on visually distinct values.
+float PackSpecularExponent(float exponent) {
+    return sqrt(2.0f / (max(exponent, 0.0f) + 2.0f));
+}
+
+void main() {
+    vec3 vertexNormal = normalize(worldNormal.xyz);
+    vec3 faceNormal = GetFaceNormal(worldPosition.xyz);
+    normal = EncodeNormal(normalize(mix(faceNormal, vertexNormal, normalBlend)));
+
+    Material material = materials[objects[objectIndex].materialID];
+
+    ambient = vec4(material.ambientCoefficient, 1.0f);
+    diffuse = vec4(material.diffuseCoefficient, 1.0f);
+    specular = vec4(material.specularCoefficient, PackSpecularExponent(material.specularExponent));
+}
@@ -0,0 +1,49 @@
+
+#version 460 core
+
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+layout (location = 2) in vec2 vertexUV;
+
+// Per-object data (matches IndirectRenderer::ObjectData).
+struct Object {
+    mat4 modelTransform;
+    mat4 normalTransform;
+    vec4 center; // World space bounds.
+    vec4 extent;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint passMask;
+    int materialID; // Record in the material buffer.
+};
+
+layout (std430, binding = 6) readonly buffer Objects {
+    Object objects[];
+};
+
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
+
+out vec4 worldPosition;
+out vec4 worldNormal;
+flat out int objectIndex;
+
+void main() {
+    // Base instance of each indirect draw command is the index of the object being drawn.
+    objectIndex = gl_BaseInstance;
+    Object object = objects[objectIndex];
+
+    worldNormal = object.normalTransform * vec4(vertexNormal, 0.0f);
+    worldPosition = object.modelTransform * vec4(vertexPosition, 1.0);
+
+    gl_Position = cameraTransform * worldPosition;
+}
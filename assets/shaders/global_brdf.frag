@@ -8,7 +8,7 @@ in vec2 uvCoord;
 out vec4 fragColor;
 
 // Samplers from geometry pass.
-uniform sampler2D position;
+uniform sampler2D depthBuffer;
 uniform sampler2D normal;
 uniform sampler2D ambient;
 uniform sampler2D diffuse;
@@ -24,16 +24,22 @@ uniform int model; // 0 for Phong, 1 for GGX, 2 for Beckman.
 #define PHONG   0
 #define GGX     1
 #define BECKMAN 2
-uniform float exposure;
-uniform float contrast;
 
-uniform vec3 cameraPosition;
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
+
 uniform vec3 lightDirection;
 uniform vec3 lightColor;
 uniform float lightBrightness;
 uniform mat4 shadowTransform;
-uniform float near;
-uniform float far;
 
 layout (std140, binding = 4) uniform HammersleyDistribution {
     int count;
@@ -42,6 +48,38 @@ layout (std140, binding = 4) uniform HammersleyDistribution {
 
 float epsilon = 0.0001f;
 
+// Surface attributes of the current fragment, read once in main.
+vec3 surfaceNormal;
+vec3 surfaceSpecular;
+float surfaceExponent;
+
+vec3 DecodeNormal(vec2 e) {
+    e = e * 2.0f - 1.0f;
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+    return normalize(n);
+}
+
+float UnpackSpecularExponent(float packed) {
+    return 2.0f / max(packed * packed, 0.0001f) - 2.0f;
+}
+
+// World position from the depth buffer and the inverse of the camera (view-projection) transform.
+vec3 ReconstructPosition(vec2 uv) {
+    vec4 ndc = vec4(uv * 2.0f - 1.0f, texture(depthBuffer, uv).r * 2.0f - 1.0f, 1.0f);
+    vec4 world = inverseCameraTransform * ndc;
+    return world.xyz / world.w;
+}
+
+void ReadSurface(vec2 uv) {
+    surfaceNormal = DecodeNormal(texture(normal, uv).rg);
+
+    vec4 specularSample = texture(specular, uv);
+    surfaceSpecular = specularSample.rgb;
+    surfaceExponent = UnpackSpecularExponent(specularSample.a);
+}
+
 bool InRange(float value, float low, float high) {
     return value >= low && value <= high;
 }
@@ -82,6 +120,16 @@ vec3 CholeskyDecomposition(float m11, float m12, float m13, float m22, float m23
     return vec3(x, y, z);
 }
 
+// Inverse of the optimized moment quantization in shadow.frag.
+vec4 DequantizeMoments(vec4 quantized) {
+    quantized[0] -= 0.035955884801f;
+
+    return mat4(0.2227744146f,  0.1549679261f,  0.1451988946f,  0.163127443f,
+                0.0771972861f,  0.1394629426f,  0.2120202157f,  0.2591432266f,
+                0.7926986636f,  0.7963415838f,  0.7258694464f,  0.6539092497f,
+                0.0319417555f, -0.1722823173f, -0.2758014811f, -0.3376131734f) * quantized;
+}
+
 float remap(float depth) {
     return (2.0 * near) / (far + near - depth * (far - near));
 }
@@ -98,7 +146,7 @@ float Shadow(vec4 p) {
         if (InRange(shadowCoordinate.x, 0.0f, 1.0f) && InRange(shadowCoordinate.y, 0.0f, 1.0f)) {
             float zf = remap(shadowCoordinate.z);
 
-            vec4 b = texture(shadowMap, shadowCoordinate.xy);
+            vec4 b = DequantizeMoments(texture(shadowMap, shadowCoordinate.xy));
 
             float alpha = 0.001f;
             vec4 bp = (1.0f - alpha) * b + alpha * vec4(0.8f);
@@ -115,7 +163,7 @@ float Shadow(vec4 p) {
             // Adjust shadow bias based on the steepness of the surface angle to the light direction.
             float shadowBiasMin = 0.001f;
             float shadowBiasMax = 0.005f;
-            float shadowBias = max(shadowBiasMax * (1.0f - dot(normalize(texture(normal, uvCoord)).rgb, normalize(-lightDirection))), shadowBiasMin);
+            float shadowBias = max(shadowBiasMax * (1.0f - dot(surfaceNormal, normalize(-lightDirection))), shadowBiasMin);
 
             if (zf + shadowBias <= z2) {
                 return 0.0f;
@@ -153,8 +201,8 @@ float ToPhong(float alpha) {
 // In the Phong BRDF model, 'alpha' is valid in the range [0.0, infinity], with higher values representing a smoother surface.
 // In both the GGX and Beckman models, 'alpha' is valid in the range [0.0, 1.0], with higher values representing a rougher surface.
 float D(vec3 H) {
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
-    float alpha = texture(specular, uvCoord).a;
+    vec3 N = surfaceNormal;
+    float alpha = surfaceExponent;
     float error = 1.0f; // TODO: what is the error term?
 
     float hn = dot(H, N);
@@ -186,7 +234,7 @@ float D(vec3 H) {
 
 // F - Fresnel (reflection).
 vec3 F(vec3 L, vec3 H) {
-    vec3 Ks = texture(specular, uvCoord).xyz;
+    vec3 Ks = surfaceSpecular;
     return Ks + (1.0f - Ks) * pow(1.0f - max(dot(L, H), 0.0f), 5.0f);
 }
 
@@ -196,8 +244,8 @@ float G(vec3 v, vec3 H) {
     // Realtime approximation:
     // return 1.0f / (dot(L, H) * dot(L, H));
 
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
-    float alpha = texture(specular, uvCoord).a;
+    vec3 N = surfaceNormal;
+    float alpha = surfaceExponent;
     float error = 0.0f;
 
     float vn = dot(v, N);
@@ -239,7 +287,7 @@ float G(vec3 v, vec3 H) {
 }
 
 float T(float xi) {
-    float alpha = texture(specular, uvCoord).a;
+    float alpha = surfaceExponent;
 
     switch (model) {
         case PHONG: {
@@ -322,9 +370,10 @@ vec3 EnvironmentSpecular(vec3 N, vec3 V) {
 }
 
 void main(void) {
-    vec4 p = texture(position, uvCoord);
+    ReadSurface(uvCoord);
+    vec4 p = vec4(ReconstructPosition(uvCoord), 1.0f);
 
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
+    vec3 N = surfaceNormal;
     vec3 V = normalize(cameraPosition - p.xyz);
 
     // Ambient.
@@ -336,7 +385,7 @@ void main(void) {
     vec3 diffuseComponent = (Kd / PI) * texture(irradianceMap, NormalToSphereMapUV(N)).rgb;
 
     // Specular.
-    vec3 Ks = texture(specular, uvCoord).xyz;
+    vec3 Ks = surfaceSpecular;
     vec3 specularComponent = Ks * EnvironmentSpecular(N, V);
 
     vec3 L = normalize(-lightDirection); // Directional light.
@@ -65,6 +65,16 @@ vec3 CholeskyDecomposition(float m11, float m12, float m13, float m22, float m23
     return vec3(x, y, z);
 }
 
+// Inverse of the optimized moment quantization in shadow.frag.
+vec4 DequantizeMoments(vec4 quantized) {
+    quantized[0] -= 0.035955884801f;
+
+    return mat4(0.2227744146f,  0.1549679261f,  0.1451988946f,  0.163127443f,
+                0.0771972861f,  0.1394629426f,  0.2120202157f,  0.2591432266f,
+                0.7926986636f,  0.7963415838f,  0.7258694464f,  0.6539092497f,
+                0.0319417555f, -0.1722823173f, -0.2758014811f, -0.3376131734f) * quantized;
+}
+
 float remap(float depth) {
     return (2.0 * near) / (far + near - depth * (far - near));
 }
@@ -81,7 +91,7 @@ float G(vec4 p) {
         if (InRange(shadowCoordinate.x, 0.0f, 1.0f) && InRange(shadowCoordinate.y, 0.0f, 1.0f)) {
             float zf = remap(shadowCoordinate.z);
 
-            vec4 b = texture(shadowMap, shadowCoordinate.xy);
+            vec4 b = DequantizeMoments(texture(shadowMap, shadowCoordinate.xy));
 
             float alpha = 0.001f;
             vec4 bp = (1.0f - alpha) * b + alpha * vec4(0.8f);
@@ -6,7 +6,7 @@
 out vec4 fragColor;
 
 // Texture samplers for various geometry buffers.
-uniform sampler2D position;
+uniform sampler2D depthBuffer;
 uniform sampler2D normal;
 uniform sampler2D ambient;
 uniform sampler2D diffuse;
@@ -14,32 +14,82 @@ uniform sampler2D specular;
 
 uniform vec2 resolution;
 
-// Camera information (in world space).
-uniform vec3 cameraPosition;
-
-// Local light information (per light).
-uniform vec3 lightPosition;
-uniform float lightRadius;
-uniform vec3 lightColor;
-uniform float lightBrightness;
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
+
+// Local light information (per instance).
+struct LocalLight {
+    mat4 modelTransform;
+    vec4 position; // xyz: world position, w: radius.
+    vec4 color;    // rgb: color, a: brightness.
+};
+
+layout (std430, binding = 5) readonly buffer LocalLights {
+    LocalLight lights[];
+};
+
+flat in int lightIndex;
+
+vec3 lightPosition;
+float lightRadius;
+vec3 lightColor;
+float lightBrightness;
 
 // BRDF.
 uniform int model; // 0 for Phong, 1 for GGX, 2 for Beckman.
 #define PHONG   0
 #define GGX     1
 #define BECKMAN 2
-uniform float exposure;
-uniform float contrast;
 
 vec2 uvCoord;
 float epsilon = 0.0001f;
 
+// Surface attributes of the current fragment, read once in main.
+vec3 surfaceNormal;
+vec3 surfaceSpecular;
+float surfaceExponent;
+
+vec3 DecodeNormal(vec2 e) {
+    e = e * 2.0f - 1.0f;
+    vec3 n = vec3(e, 1.0f - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0f);
+    n.xy += vec2(n.x >= 0.0f ? -t : t, n.y >= 0.0f ? -t : t);
+    return normalize(n);
+}
+
+float UnpackSpecularExponent(float packed) {
+    return 2.0f / max(packed * packed, 0.0001f) - 2.0f;
+}
+
+// World position from the depth buffer and the inverse of the camera (view-projection) transform.
+vec3 ReconstructPosition(vec2 uv) {
+    vec4 ndc = vec4(uv * 2.0f - 1.0f, texture(depthBuffer, uv).r * 2.0f - 1.0f, 1.0f);
+    vec4 world = inverseCameraTransform * ndc;
+    return world.xyz / world.w;
+}
+
+void ReadSurface(vec2 uv) {
+    surfaceNormal = DecodeNormal(texture(normal, uv).rg);
+
+    vec4 specularSample = texture(specular, uv);
+    surfaceSpecular = specularSample.rgb;
+    surfaceExponent = UnpackSpecularExponent(specularSample.a);
+}
+
 // D - microfacet distribution.
 // In the Phong BRDF model, 'alpha' is valid in the range [0.0, infinity], with higher values representing a smoother surface.
 // In both the GGX and Beckman models, 'alpha' is valid in the range [0.0, 1.0], with higher values representing a rougher surface.
 float D(vec3 H) {
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
-    float alpha = texture(specular, uvCoord).a;
+    vec3 N = surfaceNormal;
+    float alpha = surfaceExponent;
     float error = 0.0f; // TODO: what is the error term?
 
     float hn = dot(H, N);
@@ -71,7 +121,7 @@ float D(vec3 H) {
 
 // F - Fresnel (reflection).
 vec3 F(vec3 L, vec3 H) {
-    vec3 Ks = texture(specular, uvCoord).xyz;
+    vec3 Ks = surfaceSpecular;
     return Ks + (1.0f - Ks) * pow(1.0f - max(dot(L, H), 0.0f), 5.0f);
 }
 
@@ -81,8 +131,8 @@ float G(vec3 v, vec3 H) {
     // Realtime approximation:
     // return 1.0f / (dot(L, H) * dot(L, H));
 
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
-    float alpha = texture(specular, uvCoord).a;
+    vec3 N = surfaceNormal;
+    float alpha = surfaceExponent;
     float error = 0.0f;
 
     float vn = dot(v, N);
@@ -124,10 +174,16 @@ float G(vec3 v, vec3 H) {
 }
 
 void main(void) {
+    lightPosition = lights[lightIndex].position.xyz;
+    lightRadius = lights[lightIndex].position.w;
+    lightColor = lights[lightIndex].color.rgb;
+    lightBrightness = lights[lightIndex].color.a;
+
     uvCoord = gl_FragCoord.xy / resolution;
-    vec4 p = texture(position, uvCoord);
+    ReadSurface(uvCoord);
+    vec4 p = vec4(ReconstructPosition(uvCoord), 1.0f);
 
-    vec3 N = normalize(texture(normal, uvCoord).xyz);
+    vec3 N = surfaceNormal;
     vec3 V = normalize(cameraPosition - p.xyz);
     vec3 L = normalize(lightPosition - p.xyz);
     vec3 H = normalize(L + V);
@@ -145,7 +201,7 @@ void main(void) {
         vec3 diffuseComponent = Kd;
 
         // Specular.
-        vec3 Ks = texture(specular, uvCoord).rgb;
+        vec3 Ks = surfaceSpecular;
         vec3 specularComponent = vec3(0.0f);
         float NdotL = dot(N, L);
 
@@ -4,9 +4,32 @@
 layout (location = 0) in vec3 vertexPosition;
 layout (location = 1) in vec3 vertexNormal;
 
-uniform mat4 cameraTransform;
-uniform mat4 modelTransform;
+// Local light information (per instance).
+struct LocalLight {
+    mat4 modelTransform;
+    vec4 position; // xyz: world position, w: radius.
+    vec4 color;    // rgb: color, a: brightness.
+};
+
+layout (std430, binding = 5) readonly buffer LocalLights {
+    LocalLight lights[];
+};
+
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
+uniform int instanceOffset; // Index of the first light in the current draw call.
+
+flat out int lightIndex;
 
 void main() {
-    gl_Position = cameraTransform * modelTransform * vec4(vertexPosition, 1.0f);
-}
\ No newline at end of file
+    lightIndex = instanceOffset + gl_InstanceID;
+    gl_Position = cameraTransform * lights[lightIndex].modelTransform * vec4(vertexPosition, 1.0f);
+}
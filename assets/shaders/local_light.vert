@@ -0,0 +1,26 @@
+
+#version 450 core
+
+layout (location = 0) in vec3 vertexPosition;
+layout (location = 1) in vec3 vertexNormal;
+
+// Local light information (per instance).
+struct LocalLight {
+    mat4 modelTransform;
+    vec4 position; // xyz: world position, w: radius.
+    vec4 color;    // rgb: color, a: brightness.
+};
+
+layout (std430, binding = 5) readonly buffer LocalLights {
+    LocalLight lights[];
+};
+
+uniform mat4 cameraTransform;
+uniform int instanceOffset; // Index of the first light in the current draw call.
+
+flat out int lightIndex;
+
+void main() {
+    lightIndex = instanceOffset + gl_InstanceID;
+    gl_Position = cameraTransform * lights[lightIndex].modelTransform * vec4(vertexPosition, 1.0f);
+}
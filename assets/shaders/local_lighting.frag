@@ -13,16 +13,33 @@ uniform vec2 resolution;
 // Camera information (in world space).
 uniform vec3 cameraPosition;
 
-// Local light information (per light).
-uniform vec3 lightPosition;
-uniform float lightRadius;
-uniform vec3 lightColor;
-uniform float lightBrightness;
+// Local light information (per instance).
+struct LocalLight {
+    mat4 modelTransform;
+    vec4 position; // xyz: world position, w: radius.
+    vec4 color;    // rgb: color, a: brightness.
+};
+
+layout (std430, binding = 5) readonly buffer LocalLights {
+    LocalLight lights[];
+};
+
+flat in int lightIndex;
+
+vec3 lightPosition;
+float lightRadius;
+vec3 lightColor;
+float lightBrightness;
 
 // Shader outputs.
 layout (location = 0) out vec4 fragColor;
 
 void main(void) {
+    lightPosition = lights[lightIndex].position.xyz;
+    lightRadius = lights[lightIndex].position.w;
+    lightColor = lights[lightIndex].color.rgb;
+    lightBrightness = lights[lightIndex].color.a;
+
     vec2 uv = gl_FragCoord.xy / resolution;
 
     vec4 worldPosition = vec4(texture(position, uv).rgb, 1.0f);
@@ -4,16 +4,40 @@
 layout(location = 0) out vec4 fragColor;
 
 in vec2 uv;
-uniform float near;
-uniform float far;
+
+// Camera and tone mapping constants of the frame (matches FrameConstants).
+layout (std140, binding = 5) uniform FrameConstants {
+    mat4 cameraTransform;
+    mat4 inverseCameraTransform;
+    vec3 cameraPosition;
+    float near;
+    float far;
+    float exposure;
+    float contrast;
+};
 
 float remap(float depth) {
      return (2.0 * near) / (far + near - depth * (far - near));
 }
 
+// Optimized moment quantization (Peters and Klein, Moment Shadow Mapping). The affine transform spreads the moments of
+// depths in [0, 1] over the unit cube, so they keep enough precision to be stored in 16-bit UNORM channels.
+// It is linear, so quantized moments can be filtered directly.
+vec4 QuantizeMoments(float depth) {
+     vec4 moments = vec4(depth, depth * depth, depth * depth * depth, depth * depth * depth * depth);
+
+     vec4 quantized = mat4(-2.07224649f,   13.7948857237f,  0.105877704f,   9.7924062118f,
+                            32.23703778f,  -59.4683975703f, -1.9077466311f, -33.7652110555f,
+                           -68.571074599f,  82.0359750338f,  9.3496555107f,  47.9456096605f,
+                            39.3703274134f, -35.364903257f, -6.6543490743f, -23.9728048165f) * moments;
+     quantized[0] += 0.035955884801f;
+
+     return quantized;
+}
+
 void main() {
      float depth = remap(gl_FragCoord.z);
 
      // Four-channel shadow map.
-     fragColor = vec4(depth, depth * depth, depth * depth * depth, depth * depth * depth * depth);
+     fragColor = QuantizeMoments(depth);
 }
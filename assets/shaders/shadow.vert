@@ -4,8 +4,20 @@
 layout (location = 0) in vec3 vertexPosition;
 
 uniform mat4 shadowTransform;
-uniform mat4 modelTransform;
+
+// Per-draw data streamed by the render queue (matches RenderQueue::DrawData).
+struct Draw {
+    mat4 modelTransform;
+    mat4 normalTransform;
+    int materialID; // Record in the material buffer.
+};
+
+layout (std430, binding = 10) readonly buffer Draws {
+    Draw draws[];
+};
+
+uniform int drawID;
 
 void main() {
-    gl_Position = shadowTransform * modelTransform * vec4(vertexPosition, 1.0f); // NDC.
+    gl_Position = shadowTransform * draws[drawID].modelTransform * vec4(vertexPosition, 1.0f); // NDC.
 }
\ No newline at end of file
@@ -0,0 +1,27 @@
+#version 460 core
+
+layout (location = 0) in vec3 vertexPosition;
+
+// Per-object data (matches IndirectRenderer::ObjectData).
+struct Object {
+    mat4 modelTransform;
+    mat4 normalTransform;
+    vec4 center; // World space bounds.
+    vec4 extent;
+    uint indexCount;
+    uint firstIndex;
+    int baseVertex;
+    uint passMask;
+    int materialID; // Record in the material buffer.
+};
+
+layout (std430, binding = 6) readonly buffer Objects {
+    Object objects[];
+};
+
+uniform mat4 shadowTransform;
+
+void main() {
+    // Base instance of each indirect draw command is the index of the object being drawn.
+    gl_Position = shadowTransform * objects[gl_BaseInstance].modelTransform * vec4(vertexPosition, 1.0f); // NDC.
+}
@@ -26,9 +26,71 @@ namespace Sandbox {
             void ClearFlag(GLuint flags);
         }
 
+        // Cache of the OpenGL state set through the backend. Requests that match the cached state do not reach the driver.
+        // Unbinding (binding 0) programs, vertex arrays and textures is elided entirely: the previous object stays bound until a
+        // different one is bound, which makes Bind / Unbind pairs around draws free. Code that modifies state captured by a bound
+        // object (such as the element buffer binding of a vertex array) must bind the object it means to modify first.
+        // All binds of the tracked state must go through these functions (or invalidate the cache) to keep it in sync.
+        namespace State {
+            struct Statistics {
+                int issued;  // State changes forwarded to OpenGL.
+                int avoided; // Redundant state changes that were skipped.
+            };
+
+            // Called at the start of every frame, forgets all cached state as code outside of the backend (ImGui) sets state directly.
+            void BeginFrame();
+            void Invalidate();
+
+            // Statistics of the previous frame.
+            [[nodiscard]] const Statistics& GetStatistics();
+
+            // Statistics of the frame in progress.
+            [[nodiscard]] const Statistics& GetCurrentStatistics();
+
+            void UseProgram(GLuint program);
+            void BindVertexArray(GLuint vertexArray);
+
+            void ActiveTexture(int unit);
+            void BindTexture(GLenum target, GLuint texture); // Binds to the active texture unit.
+
+            // GL_FRAMEBUFFER binds both the read and the draw framebuffer.
+            void BindFramebuffer(GLenum target, GLuint framebuffer);
+            [[nodiscard]] GLuint GetFramebuffer(GLenum target);
+
+            void SetEnabled(GLenum flag, bool enabled);
+            void DepthMask(bool mask);
+
+            void Viewport(int x, int y, int width, int height);
+            [[nodiscard]] glm::ivec4 GetViewport();
+
+            // Deleting an object resets the bindings that refer to it.
+            void OnProgramDeleted(GLuint program);
+            void OnVertexArrayDeleted(GLuint vertexArray);
+            void OnTextureDeleted(GLuint texture);
+            void OnFramebufferDeleted(GLuint framebuffer);
+        }
+
         namespace Rendering {
+            // Counts of draws issued through the backend, reset by State::BeginFrame.
+            struct Statistics {
+                int drawCalls;         // Multi-draw indirect calls count once.
+                long long triangles;   // Triangles of indirect draws are not known on the CPU and are not counted.
+                int indirectDrawCalls; // 'triangles' is incomplete if any indirect draws were issued.
+            };
+
+            // Statistics of the previous frame.
+            [[nodiscard]] const Statistics& GetStatistics();
+
+            // Statistics of the frame in progress.
+            [[nodiscard]] const Statistics& GetCurrentStatistics();
+
             void DrawFSQ();
-            void DrawIndexed(GLuint renderingPrimitive, int indexCount);
+            // Indices are read starting at 'firstIndex' in the bound element buffer and offset by 'baseVertex'.
+            void DrawIndexed(GLuint renderingPrimitive, int indexCount, unsigned firstIndex = 0u, int baseVertex = 0);
+            void DrawIndexedInstanced(GLuint renderingPrimitive, int indexCount, int instanceCount, unsigned firstIndex = 0u, int baseVertex = 0);
+
+            // Issues 'drawCount' indexed draws with parameters sourced from the bound GL_DRAW_INDIRECT_BUFFER.
+            void DrawIndexedIndirect(GLuint renderingPrimitive, int drawCount);
 
             void ActivateTextureSampler(int samplerID);
             void BindTextureWithSampler(Shader* shader, Texture* texture, int samplerID);
@@ -36,6 +36,7 @@ namespace Sandbox {
 
             [[nodiscard]] Texture* GetNamedRenderTarget(const std::string& textureBufferName) const;
             [[nodiscard]] RenderBufferObject* GetDepthBuffer() const;
+            [[nodiscard]] const std::vector<Texture*>& GetRenderTargets() const; // In order of attachment.
 
             [[nodiscard]] bool CheckStatus() const;
 
@@ -0,0 +1,95 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/utility/free_list_allocator.h"
+#include "common/utility/singleton.h"
+
+namespace Sandbox {
+
+    // Vertex and index data of all meshes lives in one large vertex buffer and one large index buffer, suballocated with free lists.
+    // All meshes share a single vertex array object and are drawn with base vertex offsets, so switching meshes does not
+    // require binding different buffers. Indices are stored relative to the first vertex of their mesh.
+    class GeometryArena : public ISingleton<GeometryArena> {
+        public:
+            REGISTER_SINGLETON(GeometryArena);
+
+            // Interleaved vertex format: position (location 0), normal (location 1), uv (location 2).
+            struct Vertex {
+                glm::vec3 position;
+                glm::vec3 normal;
+                glm::vec2 uv;
+            };
+
+            // Location of a mesh in the shared buffers.
+            // Ranges are updated in place when the arena is defragmented and must not be cached across frames.
+            struct Allocation {
+                int baseVertex;
+                unsigned vertexCount;
+                unsigned firstIndex;
+                unsigned indexCount;
+            };
+
+            void Init();
+            void Update(); // Releases unused allocations and defragments under the per-frame budget, called once per frame.
+            void Shutdown();
+
+            // Allocation is returned to the arena once the last reference to it is dropped.
+            [[nodiscard]] std::shared_ptr<const Allocation> Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices);
+
+            void Bind() const;
+            void Unbind() const;
+
+            // Moves allocations towards the start of the buffers to merge free space, copying at most 'budget' bytes.
+            // Allocations larger than the remaining budget stay in place and holes behind them are filled first.
+            // Returns the number of bytes moved.
+            std::size_t Defragment(std::size_t budget);
+
+            void SetDefragmentationBudget(std::size_t bytes);
+            [[nodiscard]] std::size_t GetDefragmentationBudget() const;
+
+            [[nodiscard]] int GetAllocationCount() const;
+            [[nodiscard]] const FreeListAllocator& GetVertexAllocator() const;
+            [[nodiscard]] const FreeListAllocator& GetIndexAllocator() const;
+
+        private:
+            struct Block {
+                std::weak_ptr<Allocation> owner;
+                Allocation range; // Kept to release the block after the owner has expired.
+            };
+
+            GeometryArena();
+            ~GeometryArena() override;
+
+            void ReleaseExpired();
+            void Release(int blockID);
+
+            // Grows buffer storage to hold at least the requested number of elements, preserving contents.
+            void ReserveVertices(unsigned count);
+            void ReserveIndices(unsigned count);
+            void Resize(GLuint& buffer, std::size_t size, std::size_t capacity);
+
+            // Moves one allocation of at most 'budget' bytes into the lowest hole of the vertex / index buffer it can fill.
+            // Returns the number of bytes copied, 0 if no allocation could be moved.
+            std::size_t CompactVertices(std::size_t budget);
+            std::size_t CompactIndices(std::size_t budget);
+            void Copy(GLuint buffer, std::size_t source, std::size_t destination, std::size_t size);
+
+            GLuint vao_;
+            GLuint vbo_;
+            GLuint ebo_;
+            GLuint scratch_; // Staging for copies between overlapping ranges.
+            std::size_t scratchSize_;
+
+            FreeListAllocator vertexAllocator_;
+            FreeListAllocator indexAllocator_;
+
+            int nextBlockID_;
+            std::unordered_map<int, Block> blocks_;
+            std::map<unsigned, int> vertexBlocks_; // Base vertex -> block.
+            std::map<unsigned, int> indexBlocks_;  // First index -> block.
+
+            std::size_t defragmentationBudget_; // Bytes per frame.
+    };
+
+}
@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    // Pixel buffer object used for asynchronous transfers between client memory and textures.
+    // Unpack buffers stage texture uploads, pack buffers receive texture readbacks.
+    class PixelBufferObject {
+        public:
+            enum Direction {
+                UNPACK, // Client memory -> texture.
+                PACK    // Texture -> client memory.
+            };
+
+            explicit PixelBufferObject(Direction direction);
+            ~PixelBufferObject();
+
+            void Bind() const;
+            void Unbind() const;
+
+            // Allocates fresh storage for the buffer. Previous storage is orphaned, so transfers still in flight are not stalled on.
+            void Reserve(std::size_t size);
+
+            // Buffer must be bound.
+            [[nodiscard]] void* Map();
+            void Unmap() const;
+
+            [[nodiscard]] std::size_t GetSize() const;
+            [[nodiscard]] GLuint ID() const;
+
+        private:
+            GLenum GetTarget() const;
+
+            GLuint _bufferID;
+            Direction _direction;
+            std::size_t _size;
+    };
+
+}
@@ -0,0 +1,37 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    // Shader storage buffer object bound to a fixed indexed binding point.
+    // Storage grows to fit the largest data set uploaded so far and is otherwise reused.
+    class ShaderStorageBufferObject {
+        public:
+            explicit ShaderStorageBufferObject(unsigned bindingPoint);
+            ~ShaderStorageBufferObject();
+
+            void Bind() const;
+            void Unbind() const;
+
+            // Binds the buffer to its indexed binding point, so shaders declaring 'layout (binding = ...)' can read it.
+            void BindBase() const;
+
+            // Replaces the buffer contents. Passing no data only ensures the buffer can hold 'size' bytes.
+            void SetData(std::size_t size, const void* data);
+            void SetSubData(std::size_t offset, std::size_t size, const void* data) const;
+
+            [[nodiscard]] unsigned GetBindingPoint() const;
+            [[nodiscard]] std::size_t GetSize() const;     // Size of the data last uploaded.
+            [[nodiscard]] std::size_t GetCapacity() const;
+            [[nodiscard]] GLuint ID() const;
+
+        private:
+            GLuint _bufferID;
+            unsigned _bindingPoint;
+            std::size_t _size;
+            std::size_t _capacity;
+    };
+
+}
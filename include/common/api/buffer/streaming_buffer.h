@@ -0,0 +1,63 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/utility/singleton.h"
+
+namespace Sandbox {
+
+    // Persistently mapped ring buffer for uniform and shader storage data that is rewritten every frame.
+    // The buffer is split into one segment per frame in flight. Allocations are linear within the segment of the current frame
+    // and are written with plain memcpy, a segment is only reused once the fence of the frame that last used it has been signaled.
+    // Allocations are only valid until the end of the frame they were made in.
+    class StreamingBuffer : public ISingleton<StreamingBuffer> {
+        public:
+            REGISTER_SINGLETON(StreamingBuffer);
+
+            static constexpr int FRAMES_IN_FLIGHT = 3;
+
+            struct Allocation {
+                void* data;  // Mapped, write only.
+                GLintptr offset;
+                GLsizeiptr size;
+            };
+
+            void Init(std::size_t segmentSize = 4u * 1024u * 1024u);
+            void Shutdown();
+
+            // Waits until the GPU is done with the segment of this frame. Called once per frame, before anything is allocated.
+            void BeginFrame();
+
+            // Fences the segment of this frame. Called once per frame, after the last draw reading from it.
+            void EndFrame();
+
+            // Offset is aligned for binding the allocation as a range of the given buffer target.
+            [[nodiscard]] Allocation Allocate(std::size_t size, GLenum target);
+
+            // Allocates and copies 'size' bytes of data.
+            [[nodiscard]] Allocation Write(const void* data, std::size_t size, GLenum target);
+
+            // Binds an allocation to an indexed binding point of the given target.
+            void BindRange(GLenum target, unsigned bindingPoint, const Allocation& allocation) const;
+
+            [[nodiscard]] GLuint ID() const;
+            [[nodiscard]] std::size_t GetSegmentSize() const;
+            [[nodiscard]] std::size_t GetFrameUsage() const; // Bytes allocated so far this frame, including alignment.
+
+        private:
+            StreamingBuffer();
+            ~StreamingBuffer() override;
+
+            GLuint buffer_;
+            char* mapped_;
+
+            std::size_t segmentSize_;
+            std::size_t head_; // Offset into the segment of the current frame.
+            int segment_;
+            GLsync fences_[FRAMES_IN_FLIGHT];
+
+            GLint uniformAlignment_;
+            GLint storageAlignment_;
+    };
+
+}
@@ -4,6 +4,7 @@
 
 #include "common/utility/reloadable.h"
 #include "common/api/shader/shader_component.h"
+#include "common/api/shader/uniform.h"
 
 namespace Sandbox {
 
@@ -14,11 +15,25 @@ namespace Sandbox {
 
             [[nodiscard]] const std::string& GetName() const;
 
+            // Locations of all active uniforms are reflected once per link, setting a uniform does not query OpenGL.
+            // Uniforms that are not active in the program are ignored.
             template <typename DataType>
             void SetUniform(const std::string& uniformName, DataType value);
 
+            template <typename DataType>
+            void SetUniform(const char* uniformName, DataType value);
+
+            template <typename DataType>
+            void SetUniform(const UniformName& uniformName, DataType value);
+
+            // Returns -1 for uniforms that are not active in the program.
+            [[nodiscard]] GLint GetUniformLocation(const UniformName& uniformName) const;
+
             [[nodiscard]] GLuint GetID() const;
 
+            // Unique for every successful link of any shader, so cached layouts notice recompilation.
+            [[nodiscard]] unsigned GetLinkID() const;
+
         private:
             friend class ShaderLibrary;
             // Shader needs to know component paths (even if binary is cached) to support shader hot loading.
@@ -27,15 +42,17 @@ namespace Sandbox {
 
             void Recompile() override;
             void CompileFromSource();
+            void ReflectUniforms();
 
             template<typename DataType>
             void SetUniformData(GLuint uniformLocation, DataType value);
 
             std::string name_;
             GLuint ID_;
+            unsigned linkID_;
 
             std::unordered_map<std::string, ShaderComponent> shaderComponents_;
-            std::unordered_map<std::string, GLint> uniformLocations_;
+            std::unordered_map<std::uint64_t, GLint> uniformLocations_; // Keyed by name hash.
     };
 
 }
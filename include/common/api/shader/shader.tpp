@@ -6,21 +6,26 @@
 
 namespace Sandbox {
 
+    // Declared again for translation units that include backend.h first, in which case it is not complete yet at this point.
+    namespace Backend {
+        namespace State {
+            void ActiveTexture(int unit);
+        }
+    }
+
     template <typename DataType>
     void Shader::SetUniform(const std::string& uniformName, DataType value) {
-        auto uniformLocation = uniformLocations_.find(uniformName);
+        SetUniformData(GetUniformLocation(UniformName(uniformName)), value);
+    }
 
-        // Location not found.
-        if (uniformLocation == uniformLocations_.end()) {
-            // Find location first.
-            GLint location = glGetUniformLocation(ID_, uniformName.c_str());
-            uniformLocations_.emplace(uniformName, location);
+    template <typename DataType>
+    void Shader::SetUniform(const char* uniformName, DataType value) {
+        SetUniformData(GetUniformLocation(UniformName(uniformName)), value);
+    }
 
-            SetUniformData(location, value);
-        }
-        else {
-            SetUniformData(uniformLocation->second, value);
-        }
+    template <typename DataType>
+    void Shader::SetUniform(const UniformName& uniformName, DataType value) {
+        SetUniformData(GetUniformLocation(uniformName), value);
     }
 
     template <typename DataType>
@@ -59,7 +64,7 @@ namespace Sandbox {
             Texture* texture = data.first;
             int textureSamplerID = data.second;
 
-            glActiveTexture(GL_TEXTURE0 + textureSamplerID);
+            Backend::State::ActiveTexture(textureSamplerID);
             glUniform1i(uniformLocation, textureSamplerID);
             texture->Bind();
         }
@@ -17,7 +17,8 @@ namespace Sandbox {
             ShaderUniform(std::string uniformName, UniformEntry uniformData);
             ShaderUniform(const ShaderUniform& other);
 
-            void OnImGui();
+            // Returns true if the value was edited.
+            bool OnImGui();
 
             void Bind(Shader* shaderProgram) const;
             void Unbind() const;
@@ -28,6 +29,7 @@ namespace Sandbox {
             [[nodiscard]] const std::string& GetName() const;
 
             [[nodiscard]] UniformEntry& GetData();
+            [[nodiscard]] const UniformEntry& GetData() const;
 
             template <typename T>
             void SetData(const T& data);
@@ -49,13 +51,13 @@ namespace Sandbox {
             void BindHelper(Shader* shaderProgram) const;
 
             template <typename T1, typename T2, typename ...T3>
-            void OnImGuiHelper();
+            bool OnImGuiHelper();
 
             template <typename T>
-            void OnImGuiHelper();
+            bool OnImGuiHelper();
 
             template <typename Type>
-            void OnImGuiForType(Type uniformData);
+            bool OnImGuiForType(Type uniformData);
 
             std::string _uniformName;
             std::string _uniformImGuiLabel;
@@ -63,51 +63,57 @@ namespace Sandbox {
 
     // bool, int, float, glm::vec2, glm::vec3, glm::vec4, glm::mat3, glm::mat4
     template<typename T1, typename T2, typename... T3>
-    void ShaderUniform::OnImGuiHelper() {
+    bool ShaderUniform::OnImGuiHelper() {
         try {
-            OnImGuiForType(std::get<T1>(_uniformData));
+            return OnImGuiForType(std::get<T1>(_uniformData));
         }
         catch (std::bad_variant_access&) {
-            OnImGuiHelper<T2, T3...>();
+            return OnImGuiHelper<T2, T3...>();
         }
     }
 
     template <typename T>
-    void ShaderUniform::OnImGuiHelper() {
+    bool ShaderUniform::OnImGuiHelper() {
         try {
-            OnImGuiForType(std::get<T>(_uniformData));
+            return OnImGuiForType(std::get<T>(_uniformData));
         }
         catch (std::bad_variant_access&) {
             // Do nothing.
+            return false;
         }
     }
 
     template <typename Type>
-    void ShaderUniform::OnImGuiForType(Type uniformData) {
+    bool ShaderUniform::OnImGuiForType(Type uniformData) {
         ImGui::Text(std::string(_uniformName + ':').c_str());
+        bool changed = false;
 
         // Type of uniform is bool.
         if constexpr (std::is_same_v<Type, bool>) {
             if (ImGui::Checkbox(_uniformImGuiLabel.c_str(), &uniformData)) {
                 _uniformData = uniformData;
+                changed = true;
             }
         }
         // Type of uniform is int.
         else if constexpr (std::is_same_v<Type, int>) {
             if (ImGui::DragInt(_uniformImGuiLabel.c_str(), &uniformData)) {
                 _uniformData = uniformData;
+                changed = true;
             }
         }
         // Type of uniform is float.
         else if constexpr (std::is_same_v<Type, float>) {
             if (ImGui::DragFloat(_uniformImGuiLabel.c_str(), &uniformData)) {
                 _uniformData = uniformData;
+                changed = true;
             }
         }
         // Type of uniform is vec2.
         else if constexpr (std::is_same_v<Type, glm::vec2>) {
             if (ImGui::DragFloat2(_uniformImGuiLabel.c_str(), &uniformData[0], 0.1f, _minSliderRange, _maxSliderRange)) {
                 _uniformData = uniformData;
+                changed = true;
             }
         }
         // Type of uniform is vec3.
@@ -115,11 +121,13 @@ namespace Sandbox {
             if (_useColorPicker) {
                 if (ImGui::ColorEdit3(_uniformImGuiLabel.c_str(), &uniformData[0])) {
                     _uniformData = uniformData;
+                    changed = true;
                 }
             }
             else {
                 if (ImGui::DragFloat3(_uniformImGuiLabel.c_str(), &uniformData[0], 0.1f, _minSliderRange, _maxSliderRange)) {
                     _uniformData = uniformData;
+                    changed = true;
                 }
             }
         }
@@ -128,15 +136,19 @@ namespace Sandbox {
             if (_useColorPicker) {
                 if (ImGui::ColorEdit4(_uniformImGuiLabel.c_str(), &uniformData[0])) {
                     _uniformData = uniformData;
+                    changed = true;
                 }
             }
             else {
                 if (ImGui::DragFloat4(_uniformImGuiLabel.c_str(), &uniformData[0], 0.1f, _minSliderRange, _maxSliderRange)) {
                     _uniformData = uniformData;
+                    changed = true;
                 }
             }
         }
         // Unsupported: mat3, mat4, TextureSampler
+
+        return changed;
     }
 
 }
@@ -0,0 +1,47 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    // 64-bit FNV-1a.
+    [[nodiscard]] constexpr std::uint64_t HashUniformName(std::string_view name) {
+        std::uint64_t hash = 0xcbf29ce484222325ull;
+
+        for (char character : name) {
+            hash ^= static_cast<std::uint8_t>(character);
+            hash *= 0x100000001b3ull;
+        }
+
+        return hash;
+    }
+
+    // Uniform name identified by its hash. Names declared 'constexpr' are hashed at compile time.
+    class UniformName {
+        public:
+            constexpr explicit UniformName(const char* name) : name_(name),
+                                                               hash_(HashUniformName(name))
+                                                               {
+            }
+
+            explicit UniformName(const std::string& name) : name_(name),
+                                                            hash_(HashUniformName(name))
+                                                            {
+            }
+
+            // Not null terminated when constructed from a std::string, and only valid as long as that string is.
+            [[nodiscard]] constexpr std::string_view GetName() const {
+                return name_;
+            }
+
+            [[nodiscard]] constexpr std::uint64_t GetHash() const {
+                return hash_;
+            }
+
+        private:
+            std::string_view name_;
+            std::uint64_t hash_;
+    };
+
+}
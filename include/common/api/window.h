@@ -19,6 +19,18 @@ namespace Sandbox {
             void PollEvents();
             void SwapBuffers();
 
+            // Headless windows create an offscreen EGL context (surfaceless where supported, pbuffer otherwise) without a
+            // visible window, input, or ImGui backends. Scenes render into their own framebuffers as usual.
+            // Must be set before Init.
+            void SetHeadless(bool headless);
+            [[nodiscard]] bool IsHeadless() const;
+
+            // Headless windows stay active until closed.
+            void Close();
+
+            // Seconds since the window was initialized.
+            [[nodiscard]] double GetTime() const;
+
             // Calls to GetWidth / GetHeight will always return most up-to-date window size.
             [[nodiscard]] bool CheckForResize();
 
@@ -37,9 +49,22 @@ namespace Sandbox {
             Window();
             ~Window() override;
 
+            void InitGLFW();
+            void InitEGL();
+            void InitImGui();
+
             // Window data.
             GLFWwindow* window_;
             glm::ivec2 dimensions_;
+
+            bool headless_;
+            bool closed_;
+            std::chrono::steady_clock::time_point start_;
+
+            // EGL handles of headless windows, kept opaque so EGL headers stay out of the precompiled header.
+            void* eglDisplay_;
+            void* eglContext_;
+            void* eglSurface_; // EGL_NO_SURFACE for surfaceless contexts.
     };
 
 }
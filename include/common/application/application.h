@@ -4,6 +4,10 @@
 
 #include "common/api/window.h"
 #include "common/application/scene_manager.h"
+#include "common/application/benchmark.h"
+#include "common/application/render_test.h"
+#include "common/application/frame_capture.h"
+#include "common/camera/camera_path.h"
 #include "common/utility/singleton.h"
 
 namespace Sandbox {
@@ -12,17 +16,57 @@ namespace Sandbox {
         public:
             REGISTER_SINGLETON(Application);
 
-            void Init(int width, int height);
+            // Headless applications render offscreen and skip ImGui, see Window::SetHeadless.
+            void Init(int width, int height, bool headless = false);
             void Run();
             void Shutdown();
 
+            // Run returns after this many frames, -1 runs until the window is closed.
+            void SetFrameLimit(int frames);
+
+            // Run returns once the benchmark has finished and written its results. Disables input.
+            void SetBenchmark(const Benchmark::Settings& settings);
+
+            // Run returns once all scenes of the test have been captured. Disables input.
+            void SetRenderTest(const RenderTest::Settings& settings);
+
+            // Captures a render target of the active scene every frame, time advances in fixed steps.
+            void SetFrameCapture(const FrameCapture::Settings& settings);
+
+            // Non-zero if a render test failed.
+            [[nodiscard]] int GetExitCode() const;
+
+            // Records the camera of the active scene every frame, the path is written to 'filepath' on shutdown.
+            void RecordCameraPath(const std::string& filepath);
+
+            // Overrides the camera of the active scene with a recorded path, evaluated at fixed time steps scaled by 'speed'.
+            // Disables input. Run returns once the path has ended, unless a benchmark is running.
+            void PlayCameraPath(const std::string& filepath, float speed, CameraPath::Interpolation interpolation);
+
             [[nodiscard]] SceneManager& GetSceneManager();
 
         private:
             Application();
             ~Application() override;
 
+            // Called after the active scene has updated.
+            void UpdateCameraPaths(IScene* scene);
+
             SceneManager sceneManager_;
+            int frameLimit_;
+            std::unique_ptr<Benchmark> benchmark_;
+            std::unique_ptr<RenderTest> renderTest_;
+            std::unique_ptr<FrameCapture> frameCapture_;
+            int exitCode_;
+
+            std::string cameraRecordingFile_;
+            std::unique_ptr<CameraPath> cameraRecording_;
+            float cameraRecordingTime_;
+
+            std::unique_ptr<CameraPath> cameraPlayback_;
+            float cameraPlaybackTime_;
+            float cameraPlaybackSpeed_;
+            CameraPath::Interpolation cameraPlaybackInterpolation_;
     };
 
 }
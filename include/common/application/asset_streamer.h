@@ -0,0 +1,68 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/buffer/pbo.h"
+#include "common/texture/texture.h"
+#include "common/utility/thread_pool.h"
+#include "common/utility/singleton.h"
+
+namespace Sandbox {
+
+    // Streams assets in the background so that scene loads do not block the render thread.
+    // File IO and decoding run on worker threads, and the resulting OpenGL uploads are drained from a queue on the render thread
+    // under a per-frame time budget. Requested assets are backed by placeholder data until their upload completes.
+    class AssetStreamer : public ISingleton<AssetStreamer> {
+        public:
+            REGISTER_SINGLETON(AssetStreamer);
+
+            void Init();
+            void Update(); // Uploads decoded assets, called once per frame on the render thread.
+            void Shutdown();
+
+            // Drops all outstanding requests, called when switching scenes.
+            // Blocks until requests that are already being processed on worker threads finish.
+            void Reset();
+
+            // Texture receives a 1x1 placeholder until the image at 'filepath' is uploaded.
+            // 'prepare' (optional) runs on the worker thread before decoding, to generate the file if necessary.
+            std::shared_future<void> LoadTexture(Texture* texture, const std::string& filepath, std::function<void()> prepare = nullptr);
+
+            // Entity receives a placeholder mesh (if it does not have one already) until the OBJ file at 'filepath' is loaded.
+            std::shared_future<void> LoadMesh(int entityID, const std::string& filepath);
+
+            // Entities share a single mesh, the file is parsed once.
+            std::shared_future<void> LoadMesh(const std::vector<int>& entityIDs, const std::string& filepath);
+
+            void SetFrameBudget(float milliseconds);
+            [[nodiscard]] float GetFrameBudget() const;
+
+            // Number of requests that have not finished uploading.
+            [[nodiscard]] int GetPendingRequestCount() const;
+
+        private:
+            struct Upload {
+                int generation;
+                std::function<void()> upload; // Executed on the render thread.
+                std::exception_ptr error;     // Set if the worker thread failed to prepare the asset.
+                std::shared_ptr<std::promise<void>> promise;
+                std::string filepath;
+            };
+
+            AssetStreamer();
+            ~AssetStreamer() override;
+
+            void Submit(const std::string& filepath, std::function<std::function<void()>()> work, const std::shared_ptr<std::promise<void>>& promise);
+
+            std::unique_ptr<ThreadPool> workers_;
+            std::unique_ptr<PixelBufferObject> stagingBuffer_;
+
+            mutable std::mutex mutex_;
+            std::deque<Upload> uploads_;
+
+            std::atomic<int> generation_; // Incremented on reset, uploads from previous generations get discarded.
+            std::atomic<int> numPendingRequests_;
+            float frameBudget_; // Milliseconds.
+    };
+
+}
@@ -0,0 +1,75 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/application/scene.h"
+
+namespace Sandbox {
+
+    // Scripted, input-free run of a single scene that records frame statistics and writes them to disk when it finishes.
+    // Frames advance with a fixed time step and the scene camera orbits its starting view once over the measured frames,
+    // so consecutive runs render the same sequence of frames.
+    // Warmup lasts at least the requested number of frames, and until all streamed assets of the scene have been uploaded.
+    class Benchmark {
+        public:
+            struct Settings {
+                std::string scene;
+                int frames;
+                int warmup;
+                std::string outputDirectory;
+            };
+
+            explicit Benchmark(Settings settings);
+            ~Benchmark();
+
+            // Called by the application around every frame.
+            void BeginFrame();
+            void EndFrame();
+
+            // Called after the scene has updated, overrides its camera. Not called while a camera path is played back.
+            void DriveCamera(IScene* scene);
+
+            [[nodiscard]] bool IsFinished() const;
+
+            // Writes a JSON summary and per-frame CSV samples to the output directory.
+            void WriteResults();
+
+        private:
+            struct Sample {
+                double frameTime; // Milliseconds.
+                int drawCalls;
+                long long triangles; // -1 if indirect draws were issued, their triangles are culled on the GPU.
+                int stateChanges;
+            };
+
+            struct PassTimes {
+                double cpu; // Milliseconds summed over all measured frames.
+                double gpu;
+                int cpuCount;
+                int gpuCount;
+            };
+
+            [[nodiscard]] bool IsMeasuring() const;
+            void CollectProfilerFrames();
+            void SampleMemory();
+
+            Settings settings_;
+
+            int frame_;
+            int warmupFrames_;   // Frames spent warming up, -1 while warmup is still in progress.
+            unsigned firstProfilerFrame_;
+            unsigned nextProfilerFrame_;
+
+            std::chrono::steady_clock::time_point frameStart_;
+            std::vector<Sample> samples_;
+            std::map<std::string, PassTimes> passes_; // Sorted by name for stable output.
+
+            bool cameraCaptured_;
+            glm::vec3 cameraStart_;
+            glm::vec3 cameraPivot_;
+
+            long long peakVideoMemory_; // Kilobytes, -1 if the driver does not report it.
+            int videoMemoryQuery_;      // -1 until checked, 1 if GL_NVX_gpu_memory_info is supported.
+    };
+
+}
@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/camera/camera_path.h"
+#include "common/application/frame_capture.h"
+
+namespace Sandbox {
+
+    struct CommandLineOptions {
+        CommandLineOptions();
+
+        bool help;
+        bool headless;  // Offscreen EGL context, see Window::SetHeadless.
+        int width;
+        int height;
+        int frames;     // Frames to render before exiting, -1 runs until the window is closed. Measured frames when benchmarking.
+        std::string scene; // Registered name of the scene to start with, empty for the default scene.
+
+        bool benchmark; // Runs 'scene' without input and writes frame statistics to out/benchmark, see Benchmark.
+        int warmup;     // Frames rendered before a benchmark starts measuring.
+        int blurRadius; // Radius of all box blurs instead of the one set by scenes, -1 to not override. See BoxBlur.
+
+        std::string recordCamera; // Camera path file written on exit, empty to not record.
+        std::string playCamera;   // Camera path file played back instead of reading input, empty to not play back.
+        float playbackSpeed;
+        CameraPath::Interpolation playbackInterpolation;
+
+        bool renderTest;        // Compares render targets of every registered scene (or only 'scene') against reference images.
+        bool updateReferences;  // Render test overwrites reference images instead.
+        std::string references; // Reference image directory, empty for the default.
+
+        std::string capture;    // Frame capture directory (or encoder command), empty to not capture.
+        std::string captureTarget;
+        FrameCapture::Format captureFormat;
+    };
+
+    // Throws on unknown options and malformed values.
+    [[nodiscard]] CommandLineOptions ParseCommandLine(int argc, char* argv[]);
+    [[nodiscard]] std::string GetCommandLineUsage(const std::string& program);
+
+}
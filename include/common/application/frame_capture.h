@@ -0,0 +1,88 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/buffer/pbo.h"
+#include "common/application/scene.h"
+#include "common/texture/texture.h"
+#include "common/utility/thread_pool.h"
+
+namespace Sandbox {
+
+    // Records a render target of the active scene every frame, as a numbered image sequence or into the standard input
+    // of an encoder process.
+    // Readbacks go into a ring of pixel buffer objects and are collected once their fences signal. Encoding runs on worker
+    // threads. Both the ring and the queue of frames waiting to be encoded are bounded: when either is full, the render
+    // thread waits, so a slow encoder lowers the frame rate instead of growing memory without limit.
+    class FrameCapture {
+        public:
+            enum class Format {
+                PNG,
+                QOI,  // Lossless, encodes several times faster than PNG at a similar size.
+                RAW,  // Tightly packed RGBA8, top row first.
+                PIPE  // Raw frames written in order to the standard input of 'output', a shell command.
+            };
+
+            struct Settings {
+                Settings();
+
+                std::string target; // Name of a render target of the scene, see IScene::GetRenderTargets.
+                Format format;
+                std::string output; // Directory for image sequences, command for PIPE. {width} and {height} get replaced in commands.
+                int ringSize;       // Readbacks in flight.
+                int queueSize;      // Frames read back and waiting to be encoded.
+            };
+
+            explicit FrameCapture(Settings settings);
+            ~FrameCapture();
+
+            // Called by the application after the active scene has rendered.
+            void Capture(IScene* scene);
+
+            // Blocks until all captured frames have been encoded. Frames captured afterwards are dropped.
+            void Finish();
+
+            [[nodiscard]] int GetCapturedFrames() const;
+
+            // Frames the render thread had to wait for the ring or the encoder.
+            [[nodiscard]] int GetStalls() const;
+
+        private:
+            struct Readback {
+                std::unique_ptr<PixelBufferObject> buffer;
+                GLsync fence;
+                int frame;
+                int width;
+                int height;
+                int channels; // Depth targets are read back with one channel.
+            };
+
+            // Collects readbacks in order. Waits for the oldest one if 'wait' is set.
+            void Collect(bool wait);
+            void Encode(int frame, std::shared_ptr<Texture::ImageData> image);
+            void Write(int frame, Texture::ImageData& image);
+
+            [[nodiscard]] std::string GetFilepath(int frame) const;
+
+            Settings settings_;
+            std::unique_ptr<ThreadPool> workers_;
+
+            std::deque<Readback> readbacks_;                       // In flight, oldest first.
+            std::vector<std::unique_ptr<PixelBufferObject>> pool_; // Free buffers of the ring.
+            int numBuffers_;
+
+            // Frames waiting to be encoded.
+            std::mutex mutex_;
+            std::condition_variable encoded_;
+            int numQueued_;
+
+            FILE* pipe_; // Opened with the first frame, as the command needs the frame size.
+            int pipeWidth_;
+            int pipeHeight_;
+
+            int frame_;
+            int stalls_;
+            bool finished_;
+    };
+
+}
@@ -19,9 +19,15 @@ namespace Sandbox {
 
             [[nodiscard]] glm::vec2 GetMouseCursorPosition() const;
 
+            // Disabled input reads all keys and buttons as released, for runs that must not depend on the user.
+            void SetEnabled(bool enabled);
+            [[nodiscard]] bool IsEnabled() const;
+
         private:
             Input();
             ~Input() override;
+
+            bool enabled_;
     };
 
 }
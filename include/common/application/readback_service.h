@@ -0,0 +1,66 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/buffer/pbo.h"
+#include "common/texture/texture.h"
+#include "common/utility/thread_pool.h"
+#include "common/utility/singleton.h"
+
+namespace Sandbox {
+
+    // Reads textures and the default framebuffer back to disk without stalling the render thread.
+    // Readbacks are issued into pixel buffer objects and fenced. Once the fence signals (usually a couple of frames later),
+    // the buffer is mapped and copied out, and the image is encoded and written on a worker thread.
+    // The image format follows from the file extension: .png writes 8 bits per channel, .hdr writes Radiance RGBE.
+    class ReadbackService : public ISingleton<ReadbackService> {
+        public:
+            REGISTER_SINGLETON(ReadbackService);
+
+            void Init();
+            void Update(); // Collects finished readbacks, called once per frame on the render thread.
+            void Shutdown();
+
+            // Future is ready once the file has been written, and holds the error if writing failed.
+            std::shared_future<void> Capture(const Texture* texture, const std::string& filepath);
+
+            // Back buffer of the default framebuffer, as presented.
+            std::shared_future<void> CaptureFramebuffer(const std::string& filepath);
+
+            // Blocks until all issued readbacks have been written to disk.
+            void Flush();
+
+            // Readbacks that have not been written to disk yet.
+            [[nodiscard]] int GetPendingCount() const;
+
+        private:
+            struct Readback {
+                std::unique_ptr<PixelBufferObject> buffer;
+                GLsync fence;
+
+                std::string filepath;
+                int width;
+                int height;
+                int channels;
+                bool hdr;
+
+                std::shared_ptr<std::promise<void>> promise;
+            };
+
+            ReadbackService();
+            ~ReadbackService() override;
+
+            // Pack buffer is bound when the transfer is issued. Returns the future of the readback.
+            std::shared_future<void> Issue(const std::function<void()>& transfer, const std::string& filepath, int width, int height, int channels, bool hdr);
+
+            // Buffer of a readback whose fence has signaled.
+            void Complete(Readback& readback);
+
+            std::unique_ptr<ThreadPool> workers_;
+
+            std::deque<Readback> readbacks_;                       // In order of issue.
+            std::vector<std::unique_ptr<PixelBufferObject>> pool_; // Buffers of completed readbacks.
+            std::atomic<int> numPendingWrites_;
+    };
+
+}
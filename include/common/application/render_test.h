@@ -0,0 +1,67 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/application/scene_manager.h"
+#include "common/texture/texture.h"
+
+namespace Sandbox {
+
+    // Golden-image regression test. Renders each scene with its starting camera and a fixed time step, reads back the
+    // render targets the scene exposes at a fixed frame and compares them against reference images.
+    // Every compared target is written to the output directory together with a difference image. Targets fail when too
+    // many pixels differ by more than the per-channel tolerance, or when their structural similarity (SSIM) drops below
+    // the threshold.
+    class RenderTest {
+        public:
+            struct Settings {
+                Settings();
+
+                std::vector<std::string> scenes;
+                int frame;                      // Frame of each scene to capture, after streamed assets have been uploaded.
+                std::string referenceDirectory; // Reference images, as <directory>/<scene>/<target>.png.
+                std::string outputDirectory;
+                bool update;                    // Overwrite reference images instead of comparing against them.
+
+                int tolerance;          // Per-channel difference in [0, 255] a pixel may have before it counts as failed.
+                float failedPixels;     // Fraction of failed pixels a target may have.
+                float similarity;       // Minimum SSIM of a target.
+            };
+
+            explicit RenderTest(Settings settings);
+            ~RenderTest();
+
+            // Called by the application after the active scene has rendered. Moves on to the next scene once the current
+            // one has been captured.
+            void Update(SceneManager& sceneManager);
+
+            [[nodiscard]] bool IsFinished() const;
+            [[nodiscard]] bool Passed() const;
+
+            // Writes a JSON report of all compared targets to the output directory.
+            void WriteReport() const;
+
+        private:
+            struct Result {
+                std::string scene;
+                std::string target;
+                std::string error; // Empty if the target could be compared.
+
+                float failedPixels;
+                float maximumDifference; // In [0, 1].
+                float meanDifference;
+                float similarity;
+                bool passed;
+            };
+
+            void Capture(IScene* scene);
+            [[nodiscard]] Result Compare(const std::string& scene, const std::string& target, const Texture::ImageData& image) const;
+
+            Settings settings_;
+
+            std::size_t current_; // Index of the scene being captured.
+            int frame_;           // Frames rendered since the current scene was loaded.
+            std::vector<Result> results_;
+    };
+
+}
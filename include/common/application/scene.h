@@ -3,6 +3,8 @@
 #define SANDBOX_SCENE_H
 
 #include "pch.h"
+#include "common/camera/camera.h"
+#include "common/texture/texture.h"
 
 namespace Sandbox {
 
@@ -27,6 +29,12 @@ namespace Sandbox {
             // Resize custom frame buffers + render attachments, configure cameras, etc.
             virtual void OnWindowResize(int width, int height);
 
+            // Main camera of the scene, driven externally by benchmarks. nullptr if the scene has none.
+            [[nodiscard]] virtual ICamera* GetCamera();
+
+            // Render targets compared against reference images by render tests, see RenderTest.
+            [[nodiscard]] virtual std::vector<Texture*> GetRenderTargets();
+
             // Provide a public-facing name for the scene.
             // If not specified, data directory gets created from scene name.
             void SetName(const std::string& name);
@@ -15,6 +15,9 @@ namespace Sandbox {
             void Update();
             void Shutdown();
 
+            // Scene selection menu, changes take effect on the next update.
+            void OnImGui();
+
             // Takes name by which the scene will be referenced in the editor.
             // Scenes will appear in the order they are added.
             template <typename T>
@@ -25,7 +28,12 @@ namespace Sandbox {
 
             void SwitchScenes();
 
+            // Changes take effect on the next update.
             void SetActiveScene(const std::string& name);
+            [[nodiscard]] bool HasScene(const std::string& name) const;
+
+            // In order of registration.
+            [[nodiscard]] std::vector<std::string> GetSceneNames() const;
 
         private:
             // Interface for capturing scene type into a class to be able to destroy/create scenes on load.
@@ -54,6 +62,7 @@ namespace Sandbox {
             [[nodiscard]] bool ValidateSceneName(const std::string& name) const;
 
             [[nodiscard]] ISceneType* GetActiveSceneType() const;
+            [[nodiscard]] ISceneType* GetLoadedSceneType() const; // Differs from the active scene type until scenes are switched.
             void UnloadSceneData() const;
             void LoadSceneData() const;
 
@@ -11,6 +11,9 @@ namespace Sandbox {
         public:
             REGISTER_SINGLETON(Time);
 
+            // Time step of benchmarks and camera path playback, which need to be reproducible.
+            static constexpr float FIXED_TIME_STEP = 1.0f / 60.0f;
+
             // Public fields.
             float dt;
 
@@ -0,0 +1,49 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/camera/camera.h"
+
+namespace Sandbox {
+
+    // Camera poses sampled once per frame, saved to and loaded from a compact binary file.
+    // Playing a path back evaluates it at fixed time steps instead of reading input, so runs with different rendering
+    // changes see identical view sequences.
+    class CameraPath {
+        public:
+            struct Keyframe {
+                float time; // Seconds since the start of the path.
+                glm::vec3 position;
+                glm::vec3 forward;
+                float fov;  // Degrees.
+            };
+
+            enum class Interpolation {
+                Linear,
+                CatmullRom
+            };
+
+            CameraPath();
+            ~CameraPath();
+
+            // Keyframes need to be added in order of increasing time.
+            void AddKeyframe(const ICamera& camera, float time);
+            void Clear();
+
+            // Throws if the file cannot be opened or is not a camera path.
+            void Load(const std::string& filepath);
+            void Save(const std::string& filepath) const;
+
+            // Pose at 'time', clamped to the first and last keyframes.
+            [[nodiscard]] Keyframe Evaluate(float time, Interpolation interpolation) const;
+            void Apply(ICamera& camera, float time, Interpolation interpolation) const;
+
+            [[nodiscard]] bool IsEmpty() const;
+            [[nodiscard]] float GetDuration() const;
+            [[nodiscard]] const std::vector<Keyframe>& GetKeyframes() const;
+
+        private:
+            std::vector<Keyframe> keyframes_;
+    };
+
+}
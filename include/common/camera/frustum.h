@@ -0,0 +1,38 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/bounds.h"
+
+namespace Sandbox {
+
+    // View volume described by six planes extracted from a view-projection matrix.
+    // Plane normals point inwards: points inside the frustum have a non-negative signed distance to every plane.
+    class Frustum {
+        public:
+            static constexpr int NUM_PLANES = 6;
+
+            Frustum();
+            explicit Frustum(const glm::mat4& viewProjection);
+            ~Frustum();
+
+            // Planes are stored in order: left, right, bottom, top, near, far.
+            void SetViewProjection(const glm::mat4& viewProjection);
+            [[nodiscard]] const glm::vec4& GetPlane(int index) const;
+
+            [[nodiscard]] bool Contains(const glm::vec3& point) const;
+            [[nodiscard]] bool Intersects(const glm::vec3& center, float radius) const;
+            [[nodiscard]] bool Intersects(const Bounds& bounds) const;
+
+            // Tests a batch of axis-aligned boxes stored as separate center / half-extent arrays.
+            // Writes the indices of the boxes that intersect the frustum and returns how many were written.
+            // Conservative: boxes near frustum corners may be reported as visible.
+            int Intersects(const float* centerX, const float* centerY, const float* centerZ,
+                           const float* extentX, const float* extentY, const float* extentZ,
+                           int count, int* visible) const;
+
+        private:
+            glm::vec4 planes_[NUM_PLANES];
+    };
+
+}
@@ -95,6 +95,15 @@ namespace Sandbox {
             template <typename ...T, typename Fn>
             inline void IterateOver(Fn&& callback);
 
+            // Calls the callback function for each entity in the given list, given it has the required set of components.
+            // Returns the number of entities the callback was called for.
+            template <typename ...T, typename Fn>
+            inline int IterateOver(const std::vector<int>& entityIDs, Fn&& callback);
+
+            // Returns the IDs of all entities that have the required set of components.
+            template <typename ...T>
+            [[nodiscard]] const std::unordered_set<int>& GetEntityIDs();
+
 
         private:
             ECS();
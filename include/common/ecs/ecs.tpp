@@ -117,6 +117,28 @@ namespace Sandbox {
         }
     }
 
+    template <typename ...T, typename Fn>
+    int ECS::IterateOver(const std::vector<int>& entityIDs, Fn&& callback) {
+        const std::unordered_set<int>& validEntityList = GetIterator<T...>()->GetValidEntityList();
+        int count = 0;
+
+        for (int entityID : entityIDs) {
+            if (validEntityList.find(entityID) == validEntityList.end()) {
+                continue;
+            }
+
+            callback(*GetComponent<T>(entityID)...);
+            ++count;
+        }
+
+        return count;
+    }
+
+    template <typename ...T>
+    const std::unordered_set<int>& ECS::GetEntityIDs() {
+        return GetIterator<T...>()->GetValidEntityList();
+    }
+
     template <typename T>
     ComponentManager<T>* ECS::AddComponentManager() {
         static_assert(std::is_base_of_v<IComponent, T>, "Template type T provided to AddComponentManager must derive from IComponent.");
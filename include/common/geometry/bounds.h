@@ -25,10 +25,16 @@ namespace Sandbox {
 
             [[nodiscard]] bool Inside(const glm::vec3& point) const;
 
+            // Bounds are valid once they contain at least one point.
+            [[nodiscard]] bool IsValid() const;
+
             [[nodiscard]] static Bounds GetUnion(const Bounds& first, const Bounds& second);
             [[nodiscard]] static Bounds GetIntersection(const Bounds& first, const Bounds& second);
             [[nodiscard]] static bool Overlap(const Bounds& first, const Bounds& second);
 
+            // Axis-aligned bounds enclosing the given bounds after transformation.
+            [[nodiscard]] static Bounds GetTransformed(const Bounds& bounds, const glm::mat4& transform);
+
         private:
             bool initialized_; // Default-constructed bounds should not include glm::vec3(0.0f) in the bounds (unless explicitly specified).
             glm::vec3 minimum_;
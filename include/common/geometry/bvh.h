@@ -0,0 +1,106 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/bounds.h"
+#include "common/geometry/ray.h"
+
+namespace Sandbox {
+
+    // Bounding volume hierarchy over a set of primitive bounds.
+    // Built top-down with the binned surface area heuristic, then collapsed into wide nodes that store the bounds of their
+    // children in SIMD-friendly layout, so that a ray is tested against all children of a node at once.
+    // Primitive intersection is left to the caller, the hierarchy only deals with primitive indices.
+    class BVH {
+        public:
+#if defined(__AVX__)
+            static constexpr int WIDTH = 8;
+#else
+            static constexpr int WIDTH = 4;
+#endif
+            static constexpr int NUM_BINS = 16;
+            static constexpr int MAX_LEAF_SIZE = 8;
+            static constexpr int MAX_DEPTH = 64;
+
+            BVH();
+            ~BVH();
+
+            // Subtrees over more than 'parallelThreshold' primitives are built on separate threads, in the top log2(hardware threads)
+            // levels of the tree only, so there is about one build thread per hardware thread.
+            void Build(const std::vector<Bounds>& primitiveBounds, int parallelThreshold = 4096);
+            void Clear();
+
+            // Intersection function signature: bool(int primitive, const Ray& ray, RayHit& hit).
+            // Function should return true (and update 'hit') only for intersections closer than the current 'hit.t_'.
+            template <typename Fn>
+            bool ClosestHit(const Ray& ray, Fn&& intersect, RayHit& hit) const;
+
+            // Terminates on the first intersection reported by the intersection function.
+            template <typename Fn>
+            bool AnyHit(const Ray& ray, Fn&& intersect) const;
+
+            // Calls the callback function for every primitive whose bounds overlap the given bounds.
+            // Callback function signature: void(int primitive).
+            template <typename Fn>
+            void QueryOverlap(const Bounds& bounds, Fn&& callback) const;
+
+            [[nodiscard]] bool IsEmpty() const;
+            [[nodiscard]] const Bounds& GetBounds() const;
+            [[nodiscard]] int GetNodeCount() const;
+            [[nodiscard]] int GetPrimitiveCount() const;
+
+        private:
+            struct BuildNode;
+
+            // Wide node, child bounds are stored as structure of arrays.
+            struct alignas(32) Node {
+                float minimumX[WIDTH];
+                float minimumY[WIDTH];
+                float minimumZ[WIDTH];
+                float maximumX[WIDTH];
+                float maximumY[WIDTH];
+                float maximumZ[WIDTH];
+
+                int children[WIDTH]; // Node index for internal children, offset into the primitive arrays for leaves.
+                int counts[WIDTH];   // Number of primitives for leaves, 0 for internal children.
+                int numChildren;
+            };
+
+            // Ray data computed once per traversal.
+            struct RayData {
+                glm::vec3 origin;
+                glm::vec3 inverseDirection;
+                float tMinimum;
+            };
+
+            struct StackEntry {
+                int node;
+                float distance;
+            };
+
+            // Upper bound of traversal stack entries, given the limit on build depth.
+            static constexpr int STACK_SIZE = MAX_DEPTH * (WIDTH - 1) + 1;
+
+            [[nodiscard]] std::unique_ptr<BuildNode> BuildRecursive(const std::vector<glm::vec3>& centroids, std::vector<int>& indices, int begin, int end, int depth, int parallelThreshold, int parallelDepth) const;
+            int Flatten(const BuildNode* buildNode);
+
+            [[nodiscard]] static RayData GetRayData(const Ray& ray);
+
+            // Returns a bitmask of the children hit by the ray. Entry distances of all children are written to 'distances'.
+            [[nodiscard]] static int IntersectNode(const Node& node, const RayData& ray, float tMaximum, float* distances);
+
+            // Returns a bitmask of the children overlapping the given bounds.
+            [[nodiscard]] static int OverlapNode(const Node& node, const Bounds& bounds);
+
+            std::vector<Node> nodes_;
+
+            // Reordered during the build so that every leaf references a contiguous range.
+            std::vector<int> primitiveIndices_;
+            std::vector<Bounds> primitiveBounds_;
+
+            Bounds bounds_;
+    };
+
+}
+
+#include "common/geometry/bvh.tpp"
@@ -0,0 +1,145 @@
+
+namespace Sandbox {
+
+    template <typename Fn>
+    bool BVH::ClosestHit(const Ray& ray, Fn&& intersect, RayHit& hit) const {
+        if (nodes_.empty()) {
+            return false;
+        }
+
+        RayData data = GetRayData(ray);
+        hit.t_ = std::min(hit.t_, ray.tMaximum_);
+
+        bool found = false;
+
+        StackEntry stack[STACK_SIZE];
+        int stackSize = 0;
+        stack[stackSize++] = { 0, ray.tMinimum_ };
+
+        float distances[WIDTH];
+        int order[WIDTH];
+
+        while (stackSize > 0) {
+            StackEntry entry = stack[--stackSize];
+            if (entry.distance > hit.t_) {
+                // Closer intersection was found after this node was pushed.
+                continue;
+            }
+
+            const Node& node = nodes_[entry.node];
+            int mask = IntersectNode(node, data, hit.t_, distances);
+
+            // Visit children front to back.
+            int numHit = 0;
+            for (int i = 0; i < node.numChildren; ++i) {
+                if (mask & (1 << i)) {
+                    int j = numHit++;
+                    while (j > 0 && distances[order[j - 1]] > distances[i]) {
+                        order[j] = order[j - 1];
+                        --j;
+                    }
+                    order[j] = i;
+                }
+            }
+
+            // Leaves get intersected immediately, internal nodes are pushed back to front so that the closest is processed first.
+            for (int k = 0; k < numHit; ++k) {
+                int i = order[k];
+                if (node.counts[i] == 0 || distances[i] > hit.t_) {
+                    continue;
+                }
+
+                for (int p = node.children[i]; p < node.children[i] + node.counts[i]; ++p) {
+                    if (intersect(primitiveIndices_[p], ray, hit)) {
+                        found = true;
+                    }
+                }
+            }
+
+            for (int k = numHit - 1; k >= 0; --k) {
+                int i = order[k];
+                if (node.counts[i] == 0 && distances[i] <= hit.t_) {
+                    stack[stackSize++] = { node.children[i], distances[i] };
+                }
+            }
+        }
+
+        return found;
+    }
+
+    template <typename Fn>
+    bool BVH::AnyHit(const Ray& ray, Fn&& intersect) const {
+        if (nodes_.empty()) {
+            return false;
+        }
+
+        RayData data = GetRayData(ray);
+
+        RayHit hit { };
+        hit.t_ = ray.tMaximum_;
+
+        StackEntry stack[STACK_SIZE];
+        int stackSize = 0;
+        stack[stackSize++] = { 0, ray.tMinimum_ };
+
+        float distances[WIDTH];
+
+        while (stackSize > 0) {
+            const Node& node = nodes_[stack[--stackSize].node];
+            int mask = IntersectNode(node, data, ray.tMaximum_, distances);
+
+            for (int i = 0; i < node.numChildren; ++i) {
+                if (!(mask & (1 << i))) {
+                    continue;
+                }
+
+                if (node.counts[i] == 0) {
+                    stack[stackSize++] = { node.children[i], distances[i] };
+                    continue;
+                }
+
+                for (int p = node.children[i]; p < node.children[i] + node.counts[i]; ++p) {
+                    if (intersect(primitiveIndices_[p], ray, hit)) {
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    template <typename Fn>
+    void BVH::QueryOverlap(const Bounds& bounds, Fn&& callback) const {
+        if (nodes_.empty() || !bounds.IsValid()) {
+            return;
+        }
+
+        int stack[STACK_SIZE];
+        int stackSize = 0;
+        stack[stackSize++] = 0;
+
+        while (stackSize > 0) {
+            const Node& node = nodes_[stack[--stackSize]];
+            int mask = OverlapNode(node, bounds);
+
+            for (int i = 0; i < node.numChildren; ++i) {
+                if (!(mask & (1 << i))) {
+                    continue;
+                }
+
+                if (node.counts[i] == 0) {
+                    stack[stackSize++] = node.children[i];
+                    continue;
+                }
+
+                for (int p = node.children[i]; p < node.children[i] + node.counts[i]; ++p) {
+                    if (Bounds::Overlap(primitiveBounds_[p], bounds)) {
+                        callback(primitiveIndices_[p]);
+                    }
+                }
+            }
+        }
+    }
+
+}
@@ -0,0 +1,92 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/bounds.h"
+
+namespace Sandbox {
+
+    // Incrementally updated bounding volume hierarchy for moving objects.
+    // Leaves store enlarged ('fat') bounds, so objects that move by a small amount do not need to be re-inserted.
+    // Insertions pick the sibling that minimizes surface area, and tree rotations keep the hierarchy height-balanced.
+    // Proxies (leaf node indices) remain valid until the object is removed.
+    class DynamicAABBTree {
+        public:
+            static constexpr int NULL_NODE = -1;
+
+            // Leaf bounds are enlarged by 'margin' plus 'relativeMargin' times the object extent along each axis.
+            explicit DynamicAABBTree(float margin = 0.1f, float relativeMargin = 0.1f);
+            ~DynamicAABBTree();
+
+            // Returns the proxy of the new leaf.
+            int Insert(const Bounds& bounds, int userData);
+            void Remove(int proxy);
+
+            // Re-inserts the leaf only if the new bounds are no longer contained by its fat bounds.
+            // Returns true if the leaf was re-inserted.
+            bool Move(int proxy, const Bounds& bounds);
+
+            void Clear();
+
+            // Traverses all nodes whose bounds pass the predicate.
+            // Predicate signature: bool(const Bounds& fatBounds).
+            // Callback signature: bool(int proxy), returning false terminates the query early.
+            template <typename Predicate, typename Fn>
+            void Query(Predicate&& predicate, Fn&& callback) const;
+
+            // Best-first search for the 'k' leaves closest to the point, ordered from closest to farthest.
+            // Distance function signature: float(int proxy), returning the squared distance from the point to the object.
+            // It must never be less than the squared distance to the fat bounds of the leaf.
+            template <typename Fn>
+            void QueryNearest(const glm::vec3& point, int k, Fn&& distance, std::vector<int>& proxies) const;
+
+            [[nodiscard]] int GetUserData(int proxy) const;
+            [[nodiscard]] const Bounds& GetFatBounds(int proxy) const;
+
+            [[nodiscard]] int GetProxyCount() const;
+            [[nodiscard]] int GetHeight() const;
+            [[nodiscard]] bool IsEmpty() const;
+
+            [[nodiscard]] static float GetSquaredDistance(const Bounds& bounds, const glm::vec3& point);
+
+        private:
+            struct Node {
+                [[nodiscard]] bool IsLeaf() const {
+                    return child1 == NULL_NODE;
+                }
+
+                Bounds bounds;
+                int parent; // Next node in the free list for unused nodes.
+                int child1;
+                int child2;
+                int height; // 0 for leaves, -1 for unused nodes.
+                int userData;
+            };
+
+            [[nodiscard]] int AllocateNode();
+            void FreeNode(int index);
+
+            void InsertLeaf(int leaf);
+            void RemoveLeaf(int leaf);
+
+            // Performs a left or right rotation if the subtree rooted at the given node is unbalanced.
+            // Returns the index of the new subtree root.
+            int Balance(int index);
+
+            // Recomputes bounds and heights from the given node up to the root.
+            void Refit(int index);
+
+            [[nodiscard]] Bounds Fatten(const Bounds& bounds) const;
+
+            std::vector<Node> nodes_;
+            int root_;
+            int freeList_;
+            int proxyCount_;
+
+            float margin_;
+            float relativeMargin_;
+    };
+
+}
+
+#include "common/geometry/dynamic_aabb_tree.tpp"
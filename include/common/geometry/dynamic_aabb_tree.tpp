@@ -0,0 +1,80 @@
+
+namespace Sandbox {
+
+    template <typename Predicate, typename Fn>
+    void DynamicAABBTree::Query(Predicate&& predicate, Fn&& callback) const {
+        if (root_ == NULL_NODE) {
+            return;
+        }
+
+        // The tree is height-balanced, so the stack rarely grows past its initial capacity.
+        std::vector<int> stack;
+        stack.reserve(64);
+        stack.emplace_back(root_);
+
+        while (!stack.empty()) {
+            int index = stack.back();
+            stack.pop_back();
+
+            const Node& node = nodes_[index];
+            if (!predicate(node.bounds)) {
+                continue;
+            }
+
+            if (node.IsLeaf()) {
+                if (!callback(index)) {
+                    return;
+                }
+            }
+            else {
+                stack.emplace_back(node.child1);
+                stack.emplace_back(node.child2);
+            }
+        }
+    }
+
+    template <typename Fn>
+    void DynamicAABBTree::QueryNearest(const glm::vec3& point, int k, Fn&& distance, std::vector<int>& proxies) const {
+        if (root_ == NULL_NODE || k <= 0) {
+            return;
+        }
+
+        struct Entry {
+            bool operator>(const Entry& other) const {
+                return distance > other.distance;
+            }
+
+            float distance;
+            int index;
+            bool exact; // Distance to the object itself, rather than a lower bound from node bounds.
+        };
+
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+        queue.push({ GetSquaredDistance(nodes_[root_].bounds, point), root_, false });
+
+        int found = 0;
+
+        // Entries are visited in order of distance, so an exact entry reaching the top is closer than anything left to visit.
+        while (!queue.empty() && found < k) {
+            Entry entry = queue.top();
+            queue.pop();
+
+            if (entry.exact) {
+                proxies.emplace_back(entry.index);
+                ++found;
+                continue;
+            }
+
+            const Node& node = nodes_[entry.index];
+
+            if (node.IsLeaf()) {
+                queue.push({ distance(entry.index), entry.index, true });
+            }
+            else {
+                queue.push({ GetSquaredDistance(nodes_[node.child1].bounds, point), node.child1, false });
+                queue.push({ GetSquaredDistance(nodes_[node.child2].bounds, point), node.child2, false });
+            }
+        }
+    }
+
+}
@@ -3,7 +3,7 @@
 #define SANDBOX_MESH_H
 
 #include "pch.h"
-#include "common/api/buffer/vao.h"
+#include "common/api/buffer/geometry_arena.h"
 #include "common/ecs/component/component.h"
 #include "common/geometry/bounds.h"
 
@@ -29,7 +29,7 @@ namespace Sandbox {
     class Mesh : public IComponent {
         public:
             // Default mesh topology is Triangles.
-            Mesh(VertexArrayObject* vao);
+            Mesh();
             ~Mesh() override;
 
             Mesh(const Mesh& other);
@@ -39,10 +39,24 @@ namespace Sandbox {
             void Unbind() const;
 
             // Assumes mesh is already bound.
+            // All meshes share the vertex array object of the geometry arena, so binding once is enough to render any number of meshes.
             void Render();
+
+            // Draws the mesh 'instanceCount' times with a single draw call. Shaders distinguish instances with gl_InstanceID.
+            // Assumes mesh is already bound.
+            void RenderInstanced(int instanceCount);
+
+            // Uploads pending changes to the geometry arena.
             virtual void Complete();
 
             [[nodiscard]] const Bounds& GetBounds() const;
+            [[nodiscard]] MeshTopology GetTopology() const;
+
+            // Changes every time the mesh data is modified. Copies share the version of the mesh they were copied from.
+            [[nodiscard]] unsigned GetVersion() const;
+
+            // Copies of a mesh share geometry until either of them is modified. Uploads pending changes.
+            [[nodiscard]] std::shared_ptr<const GeometryArena::Allocation> GetGeometry();
 
             // Allows for manual construction of meshes.
             // Mesh is always rendered using indexed rendering.
@@ -67,9 +81,16 @@ namespace Sandbox {
             // Recalculates vertex normals.
             void RecalculateNormals();
 
+            // Computes vertex normals by averaging the unique face normals around each vertex.
+            // Does not touch any OpenGL state and is safe to call off of the render thread.
+            [[nodiscard]] static std::vector<glm::vec3> CalculateNormals(const std::vector<glm::vec3>& vertices, const std::vector<unsigned>& indices);
+
         private:
-            VertexArrayObject* vao_;
+            void Modify();
+
+            std::shared_ptr<const GeometryArena::Allocation> geometry_;
             bool isDirty_;
+            unsigned version_;
 
             MeshTopology topology_;
 
@@ -0,0 +1,39 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/bvh.h"
+#include "common/geometry/mesh.h"
+
+namespace Sandbox {
+
+    // Triangle-level acceleration structure for a single mesh, in object space.
+    class MeshBVH {
+        public:
+            MeshBVH();
+            explicit MeshBVH(const Mesh& mesh);
+            ~MeshBVH();
+
+            // Only triangle meshes are supported.
+            void Build(const Mesh& mesh);
+
+            // Hit primitive is the index of the triangle.
+            bool ClosestHit(const Ray& ray, RayHit& hit) const;
+            [[nodiscard]] bool AnyHit(const Ray& ray) const;
+
+            // Appends the indices of triangles whose bounds overlap the given bounds.
+            void QueryOverlap(const Bounds& bounds, std::vector<int>& triangles) const;
+
+            [[nodiscard]] const BVH& GetBVH() const;
+            [[nodiscard]] int GetTriangleCount() const;
+
+        private:
+            // Moller-Trumbore ray-triangle intersection.
+            bool IntersectTriangle(int triangle, const Ray& ray, RayHit& hit) const;
+
+            BVH bvh_;
+            std::vector<glm::vec3> vertices_;
+            std::vector<unsigned> indices_;
+    };
+
+}
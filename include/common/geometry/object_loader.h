@@ -19,8 +19,23 @@ namespace Sandbox {
                 std::string filepath_;
             };
 
+            // Parsed and normalized mesh data.
+            struct MeshData {
+                std::vector<glm::vec3> vertices;
+                std::vector<glm::vec3> normals;
+                std::vector<unsigned> indices;
+                std::vector<glm::vec2> uv;
+            };
+
             Mesh LoadFromFile(const Request& request);
 
+            // Loading split into a parsing step that does not touch any OpenGL state or the mesh cache (safe to call off of the render
+            // thread), and a construction step that creates the mesh and caches it for future use (render thread only).
+            [[nodiscard]] MeshData Parse(const Request& request) const;
+            Mesh Create(const Request& request, const MeshData& data);
+
+            [[nodiscard]] bool IsLoaded(const Request& request) const;
+
             // Loads UV sphere.
             Mesh LoadSphere(); // TODO: Abstract.
 
@@ -0,0 +1,31 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    struct Ray {
+        Ray(const glm::vec3& origin, const glm::vec3& direction, float tMinimum = 0.0f, float tMaximum = std::numeric_limits<float>::max());
+        ~Ray();
+
+        [[nodiscard]] glm::vec3 At(float t) const;
+
+        glm::vec3 origin_;
+        glm::vec3 direction_; // Does not need to be normalized.
+        float tMinimum_;
+        float tMaximum_;
+    };
+
+    struct RayHit {
+        RayHit();
+        ~RayHit();
+
+        [[nodiscard]] bool IsValid() const;
+
+        int primitive_; // -1 if nothing was hit.
+        float t_;
+        glm::vec2 barycentrics_; // Only set for triangle intersections.
+    };
+
+}
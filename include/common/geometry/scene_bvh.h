@@ -0,0 +1,60 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/bvh.h"
+#include "common/geometry/mesh_bvh.h"
+
+namespace Sandbox {
+
+    // Entity-level acceleration structure over the world-space bounds of all entities with a Transform and a Mesh.
+    // Ray queries are refined against mesh triangles, using one MeshBVH per unique geometry (built on demand).
+    class SceneBVH {
+        public:
+            struct Hit {
+                Hit();
+                ~Hit();
+
+                [[nodiscard]] bool IsValid() const;
+
+                int entityID_; // -1 if nothing was hit.
+                int triangle_;
+                float t_;
+                glm::vec3 position_; // World space.
+            };
+
+            SceneBVH();
+            ~SceneBVH();
+
+            // Rebuilds the hierarchy from the current state of the ECS.
+            void Build();
+            void Clear();
+
+            // Rays are in world space.
+            bool ClosestHit(const Ray& ray, Hit& hit) const;
+            [[nodiscard]] bool AnyHit(const Ray& ray) const;
+
+            // Appends the IDs of entities whose world-space bounds overlap the given bounds.
+            void QueryOverlap(const Bounds& bounds, std::vector<int>& entityIDs) const;
+
+        private:
+            struct Entry {
+                int entityID;
+                glm::mat4 inverseTransform;
+                const MeshBVH* mesh;
+            };
+
+            // Rays are transformed into object space without normalizing the direction, so ray distances carry over.
+            [[nodiscard]] static Ray ToObjectSpace(const Ray& ray, const glm::mat4& inverseTransform);
+
+            BVH bvh_;
+            std::vector<Entry> entities_;
+            struct MeshEntry {
+                std::shared_ptr<const GeometryArena::Allocation> geometry; // Keeps the key alive while the hierarchy is in use.
+                std::unique_ptr<MeshBVH> hierarchy;
+            };
+
+            std::unordered_map<const GeometryArena::Allocation*, MeshEntry> meshes_;
+    };
+
+}
@@ -0,0 +1,45 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/geometry/dynamic_aabb_tree.h"
+#include "common/camera/frustum.h"
+
+namespace Sandbox {
+
+    class FrustumCuller;
+
+    // Dynamic spatial index over the world-space bounds of all entities with a Transform and a Mesh.
+    // Kept in sync with the bounds cached by a FrustumCuller: only entities that were added, moved or removed since the
+    // last update are touched, and moving entities are only re-inserted once they leave their enlarged tree bounds.
+    // Queries test the exact (not enlarged) entity bounds.
+    class SpatialIndex {
+        public:
+            SpatialIndex();
+            ~SpatialIndex();
+
+            // Must be called after FrustumCuller::Update() every frame, as only the entities modified by the last update are applied.
+            void Update(const FrustumCuller& culler);
+            void Clear();
+
+            // Query functions append the IDs of matching entities to the given list.
+            void QueryRadius(const glm::vec3& center, float radius, std::vector<int>& entityIDs) const;
+            void QueryBox(const Bounds& bounds, std::vector<int>& entityIDs) const;
+            void QueryFrustum(const Frustum& frustum, std::vector<int>& entityIDs) const;
+
+            // Entities are ordered by distance from the point to their bounds (closest first).
+            void QueryNearest(const glm::vec3& point, int k, std::vector<int>& entityIDs) const;
+
+            [[nodiscard]] int GetEntityCount() const;
+            [[nodiscard]] const DynamicAABBTree& GetTree() const;
+
+        private:
+            void Insert(int entityID, const Bounds& bounds);
+            void Remove(int entityID);
+
+            DynamicAABBTree tree_;
+            std::unordered_map<int, int> proxies_; // Entity ID to tree proxy.
+            std::vector<Bounds> bounds_;           // Exact entity bounds, indexed by proxy.
+    };
+
+}
@@ -27,10 +27,15 @@ namespace Sandbox {
 
             [[nodiscard]] bool IsDirty() const;
 
+            // Changes every time the transform is modified. Unlike the dirty flag, it is not reset by GetMatrix().
+            [[nodiscard]] unsigned GetVersion() const;
+
         private:
             void CalculateMatrix();
+            void Modify();
 
             bool _isDirty;
+            unsigned _version;
             glm::mat4 _matrix;
 
             glm::vec3 _rotation;
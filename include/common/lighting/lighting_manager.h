@@ -15,6 +15,7 @@ namespace Sandbox {
 
             void OnImGui();
 
+            // Streams the light block for this frame, only lights that changed are written to the staging copy.
             void Update();
             void AddLight(const Light& light);
 
@@ -22,9 +23,9 @@ namespace Sandbox {
             void ConstructUniformBlock();
 
             unsigned _numActiveLights;
-            bool _isDirty;
 
-            UniformBufferObject _lightingUBO;
+            UniformBlockLayout _blockLayout;
+            std::vector<char> _blockData; // std140 staging copy of the whole light block.
             std::list<Light> _lights;
     };
 
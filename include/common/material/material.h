@@ -27,10 +27,19 @@ namespace Sandbox {
 
             void SetUniform(const std::string& uniformName, ShaderUniform::UniformEntry uniformData);
             ShaderUniform* GetUniform(const std::string& uniformName) const;
+            [[nodiscard]] const std::unordered_map<std::string, ShaderUniform*>& GetUniforms() const;
+
+            // Material buffers rewrite the records of dirty materials. Edits through ImGui and SetUniform mark the material
+            // automatically, edits made directly through GetUniform must mark it themselves.
+            void MarkDirty();
+            [[nodiscard]] bool IsDirty() const;
 
         private:
+            friend class MaterialBuffer;
+
             std::string _name;
             std::unordered_map<std::string, ShaderUniform*> _uniforms;
+            bool _dirty;
     };
 
     class MaterialCollection : public IComponent {
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/material/material.h"
+#include "common/api/shader/shader.h"
+#include "common/api/buffer/ssbo.h"
+
+namespace Sandbox {
+
+    // Materials compiled into fixed size records of a single shader storage buffer, so draws only select a record by index.
+    // The record layout is reflected from an std430 storage block of a shader, declared as an unsized array of structs:
+    //     layout (std430, binding = 9) readonly buffer Materials { Material materials[]; };
+    // Struct members are filled from the material uniforms of the same name. Only records of dirty materials are rewritten,
+    // and only the range between the first and last rewritten record is uploaded.
+    class MaterialBuffer {
+        public:
+            static constexpr unsigned BINDING_POINT = 9;
+
+            explicit MaterialBuffer(std::string blockName = "Materials");
+            ~MaterialBuffer();
+
+            // Layout is reflected again whenever the shader is recompiled.
+            void SetLayout(Shader* shader);
+
+            // Index of the record of the material, a record is added the first time a material is seen. Material must not be null.
+            [[nodiscard]] int GetMaterialID(Material* material);
+
+            // Rewrites records of dirty materials and uploads them. Must be called before drawing with the buffer.
+            void Update();
+
+            void Bind() const;
+
+            void Clear();
+
+            [[nodiscard]] int GetMaterialCount() const;
+            [[nodiscard]] std::size_t GetRecordSize() const;
+            [[nodiscard]] std::size_t GetUploadedBytes() const; // Uploaded by the last update.
+
+        private:
+            struct Member {
+                std::size_t offset;
+                GLenum type;
+                std::size_t matrixStride;
+            };
+
+            void Reflect();
+            void WriteRecord(int materialID);
+
+            std::string blockName_;
+            Shader* shader_;
+            unsigned linkID_;
+
+            std::unordered_map<std::string, Member> members_; // By struct member name.
+            std::size_t stride_;
+
+            std::vector<Material*> materials_;
+            std::unordered_map<const Material*, int> materialIDs_;
+
+            std::vector<char> data_;
+            std::size_t dirtyBegin_;
+            std::size_t dirtyEnd_;
+            bool reallocate_;
+            std::size_t uploadedBytes_;
+
+            ShaderStorageBufferObject buffer_;
+    };
+
+}
@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/shader/shader.h"
+#include "common/texture/texture.h"
+
+namespace Sandbox {
+
+    // Separable blur approximating a Gaussian with repeated box filters (Kovesi, Fast Almost-Gaussian Filtering).
+    // Box filters keep a running sum along each row and column, so wide blurs cost as much as narrow ones.
+    // Images of any size are supported, pixels past the edges repeat the edge pixels.
+    class BoxBlur {
+        public:
+            static constexpr int PASSES = 3; // Box filters per axis.
+            static constexpr int WORK_GROUP_SIZE = 64; // Must match 'local_size_x' in the box blur compute shader.
+            static constexpr int SEGMENT_LENGTH = 32;  // Pixels filtered per invocation, raised to the box width for wide boxes.
+
+            BoxBlur();
+            ~BoxBlur();
+
+            // Box sizes approximating a Gaussian with a standard deviation of half the radius.
+            void SetRadius(int radius);
+            [[nodiscard]] int GetRadius() const;
+
+            // Radius used by every blur instead of the one passed to SetRadius, so benchmarks can compare radii. Negative
+            // radii disable the override. Applies to radii set after the call.
+            static void SetRadiusOverride(int radius);
+
+            // Blurs 'source' into 'destination', which is used as an intermediate target together with 'scratch'.
+            // All textures must have the same size and format. 'source' is not modified.
+            void Blur(Shader* blurShader, const Texture* source, const Texture* destination, const Texture* scratch) const;
+
+        private:
+            static int radiusOverride_;
+
+            int radius_;
+            int boxRadii_[PASSES];
+    };
+
+}
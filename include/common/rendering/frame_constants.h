@@ -0,0 +1,30 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/camera/camera.h"
+
+namespace Sandbox {
+
+    // Camera and tone mapping constants shared by all passes of a frame, streamed once per frame instead of being set as
+    // uniforms on every shader. Matches the 'FrameConstants' uniform block (std140) of the shaders:
+    //     layout (std140, binding = 5) uniform FrameConstants { ... };
+    struct FrameConstants {
+        static constexpr unsigned BINDING_POINT = 5;
+
+        FrameConstants(ICamera& camera, float exposure = 1.0f, float contrast = 1.0f);
+
+        // Writes the constants to the streaming buffer and binds them for the rest of the frame.
+        void Bind() const;
+
+        glm::mat4 cameraTransform_;
+        glm::mat4 inverseCameraTransform_;
+        glm::vec3 cameraPosition_;
+        float nearPlane_;
+        float farPlane_;
+        float exposure_;
+        float contrast_;
+        float padding_;
+    };
+
+}
@@ -0,0 +1,162 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/texture/texture.h"
+
+namespace Sandbox {
+
+    // Describes a render pipeline as a list of passes and the render targets they read and write.
+    // The graph is rebuilt every frame: passes that do not contribute to an output are culled, and transient render targets are
+    // taken from a shared pool only for the span of passes that use them, so targets with disjoint lifetimes alias the same texture.
+    // Passes execute in the order they are added.
+    class FrameGraph {
+        public:
+            struct TextureDescription {
+                GLenum format; // Sized internal format.
+
+                // Size is relative to the graph size when 'scale' is greater than zero, absolute otherwise.
+                float scale;
+                int width;
+                int height;
+
+                [[nodiscard]] static TextureDescription Relative(GLenum format, float scale = 1.0f);
+                [[nodiscard]] static TextureDescription Absolute(GLenum format, int width, int height);
+            };
+
+            struct Statistics {
+                int passes;
+                int culledPasses;
+                int resources;       // Transient render targets declared this frame.
+                int textures;        // Pooled textures backing them.
+                std::size_t bytes;   // Memory of all pooled textures.
+                std::size_t unaliasedBytes; // Memory the transient render targets of this frame would take without aliasing.
+            };
+
+            class PassBuilder {
+                public:
+                    // Declares a new transient render target. The pass still declares how it writes it.
+                    void Create(const std::string& name, const TextureDescription& description);
+
+                    // Render target is sampled by this pass.
+                    void Read(const std::string& name);
+
+                    // Render target is attached to the framebuffer of this pass, color targets in the order they are declared.
+                    void Write(const std::string& name);
+
+                    // Render target is written through image load / store and is not attached.
+                    void WriteStorage(const std::string& name);
+
+                    // Pass is never culled, even if nothing reads what it writes.
+                    void SetSideEffect();
+
+                private:
+                    friend class FrameGraph;
+                    PassBuilder(FrameGraph& graph, int passID);
+
+                    FrameGraph& graph_;
+                    int passID_;
+            };
+
+            FrameGraph();
+            ~FrameGraph();
+
+            // Size that relative render targets are scaled against.
+            // Only pooled textures of relative size are released, absolute ones are kept as they are.
+            // Must be called between frames, as the current graph is reset.
+            void SetSize(int width, int height);
+
+            // Render target owned outside of the graph. It is never aliased.
+            void Import(const std::string& name, Texture* texture);
+
+            // Render target is kept alive until the end of the frame, so it can be displayed after the graph has executed.
+            void MarkOutput(const std::string& name);
+
+            void AddPass(const std::string& name, const std::function<void(PassBuilder& builder)>& setup, const std::function<void()>& execute);
+
+            // Culls passes and assigns pooled textures to transient render targets.
+            void Compile();
+
+            // Binds the framebuffer of each remaining pass before running it, the previous viewport is restored afterwards.
+            void Execute();
+
+            // Removes all passes and resources, pooled textures are kept for the next frame.
+            void Reset();
+
+            // Releases all pooled textures and framebuffers.
+            void Clear();
+
+            // Valid while the declaring pass executes, and for outputs until the graph is reset.
+            // Returns nullptr for render targets of culled passes.
+            [[nodiscard]] Texture* GetTexture(const std::string& name) const;
+
+            [[nodiscard]] int GetWidth() const;
+            [[nodiscard]] int GetHeight() const;
+            [[nodiscard]] const Statistics& GetStatistics() const;
+
+        private:
+            struct Resource {
+                std::string name;
+                TextureDescription description;
+                bool imported;
+                bool output;
+
+                std::vector<int> writers;
+                int readers;     // Remaining readers during culling.
+                int firstPass;   // First and last live pass using the resource.
+                int lastPass;
+                int pooled;      // Index into the pool, -1 for imported render targets.
+                Texture* texture;
+            };
+
+            struct Pass {
+                std::string name;
+                std::function<void()> execute;
+
+                std::vector<int> reads;
+                std::vector<int> writes;      // Attachments.
+                std::vector<int> storage;     // Image load / store.
+                bool sideEffect;
+                int references;  // Resources written by the pass that are still used.
+                bool culled;
+            };
+
+            struct PooledTexture {
+                std::unique_ptr<Texture> texture;
+                GLenum format;
+                int width;
+                int height;
+                bool relative;
+                int lastUsedFrame;
+            };
+
+            [[nodiscard]] int GetResourceID(const std::string& name) const;
+            [[nodiscard]] glm::ivec2 GetSize(const TextureDescription& description) const;
+
+            void Cull();
+            void ComputeLifetimes();
+            void AssignTextures();
+
+            // Returns the index of a pooled texture matching the description that is not in use by another render target.
+            [[nodiscard]] int Acquire(const Resource& resource, std::vector<bool>& busy);
+            void ReleaseUnused();
+
+            // Framebuffers are cached by their attachments, which stay the same between frames as long as the graph does.
+            GLuint GetFramebuffer(const Pass& pass);
+            void DestroyFramebuffers(GLuint texture);
+
+            int width_;
+            int height_;
+            int frame_;
+
+            std::vector<Pass> passes_;
+            std::vector<Resource> resources_;
+            std::unordered_map<std::string, int> resourceIDs_;
+
+            std::vector<PooledTexture> pool_;
+            std::map<std::vector<GLuint>, GLuint> framebuffers_;
+
+            Statistics statistics_;
+    };
+
+}
@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/camera/frustum.h"
+#include "common/geometry/bounds.h"
+
+namespace Sandbox {
+
+    // Caches world-space bounds for every entity with a Transform and a Mesh, and tests them against view frustums.
+    // Bounds are only recomputed for entities that were added, or whose transform or mesh changed since the last update.
+    class FrustumCuller {
+        public:
+            FrustumCuller();
+            ~FrustumCuller();
+
+            // Refreshes cached bounds from the ECS.
+            // Changes are detected by comparing transform and mesh versions, so this may be called at any point in a frame.
+            void Update();
+            void Clear();
+
+            // Fills the list with the IDs of all cached entities whose bounds intersect the frustum.
+            void Cull(const Frustum& frustum, std::vector<int>& visibleEntityIDs) const;
+
+            [[nodiscard]] bool HasEntity(int entityID) const;
+
+            // Returns invalid bounds for entities that are not tracked.
+            [[nodiscard]] Bounds GetBounds(int entityID) const;
+            [[nodiscard]] int GetEntityCount() const;
+
+            // Entities that were added or whose bounds changed / entities that were removed during the last update.
+            [[nodiscard]] const std::vector<int>& GetModifiedEntities() const;
+            [[nodiscard]] const std::vector<int>& GetRemovedEntities() const;
+
+            // Per-pass counts, displayed in OnImGui.
+            // 'total' is the number of entities the pass would have drawn without culling.
+            void RecordPass(const std::string& pass, int drawn, int total);
+            void OnImGui() const;
+
+        private:
+            struct PassStatistics {
+                std::string name;
+                int drawn;
+                int culled;
+            };
+
+            void Insert(int entityID);
+            void Remove(int index);
+            void SetBounds(int index, const Bounds& localBounds, const glm::mat4& transform);
+
+            std::unordered_map<int, int> indices_; // Entity ID to index into the arrays below.
+            std::vector<int> entityIDs_;
+            std::vector<Bounds> localBounds_;      // Mesh bounds the cached world bounds were computed from.
+            std::vector<unsigned> transformVersions_;
+            std::vector<unsigned> meshVersions_;
+            std::vector<unsigned> lastUpdated_;
+
+            // Bounds in structure of arrays layout for batched frustum tests.
+            std::vector<float> centerX_;
+            std::vector<float> centerY_;
+            std::vector<float> centerZ_;
+            std::vector<float> extentX_;
+            std::vector<float> extentY_;
+            std::vector<float> extentZ_;
+
+            unsigned frame_;
+            std::vector<int> modified_;
+            std::vector<int> removed_;
+
+            std::vector<PassStatistics> passes_;
+    };
+
+}
@@ -0,0 +1,90 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/buffer/ssbo.h"
+#include "common/api/shader/shader.h"
+#include "common/camera/frustum.h"
+#include "common/geometry/mesh.h"
+#include "common/rendering/frustum_culler.h"
+
+namespace Sandbox {
+
+    // GPU-driven submission path.
+    // Geometry of all meshes lives in the shared buffers of the geometry arena, and per-object transforms, bounds and material
+    // record indices live in a shader storage buffer. A compute shader frustum culls the objects of a pass and writes one indirect
+    // draw command per object, so the whole pass is submitted with a single glMultiDrawElementsIndirect call.
+    // Shaders read the data of the object being drawn with 'objects[gl_BaseInstance]'.
+    // Objects are only rewritten when their entity was modified, and only the range of rewritten objects is uploaded.
+    class IndirectRenderer {
+        public:
+            static constexpr unsigned OBJECT_BINDING_POINT = 6;
+            static constexpr unsigned COMMAND_BINDING_POINT = 7;
+            static constexpr int WORK_GROUP_SIZE = 64; // Must match 'local_size_x' in the culling compute shader.
+
+            IndirectRenderer();
+            ~IndirectRenderer();
+
+            // Rewrites the objects of entities with a Transform and a (triangle) Mesh that were added, modified or removed according
+            // to the culler, which must have been updated this frame. Must be called every frame the culler is updated, or be
+            // followed by Invalidate() when frames were skipped.
+            // The pass mask function returns the bitmask of passes an entity takes part in (0 to skip the entity), the material
+            // function the index of its record in the material buffer. Both are only queried when the object is rewritten.
+            void Update(const FrustumCuller& culler, const std::function<unsigned(int entityID)>& getPassMask, const std::function<int(int entityID)>& getMaterialID);
+
+            // Objects of all entities are rewritten on the next update.
+            void Invalidate();
+            void Clear();
+
+            // Writes the indirect draw commands for the objects that are part of the given pass and inside the frustum.
+            void Cull(Shader* cullShader, const Frustum& frustum, unsigned pass);
+
+            // Draws the objects of a pass culled by the last call to Cull. Shader must be bound.
+            void Render(unsigned pass) const;
+
+            [[nodiscard]] int GetObjectCount() const;
+            [[nodiscard]] int GetGeometryCount() const;
+
+        private:
+            // Matches the 'Object' struct (std430) in the indirect shaders.
+            struct ObjectData {
+                glm::mat4 modelTransform;
+                glm::mat4 normalTransform;
+                glm::vec4 center; // World space bounds.
+                glm::vec4 extent;
+                unsigned indexCount;
+                unsigned firstIndex;
+                int baseVertex;
+                unsigned passMask;
+                int materialID;
+                int padding[3]; // Pads the struct to its std430 array stride.
+            };
+
+            void Write(const FrustumCuller& culler, int entityID, const std::function<unsigned(int)>& getPassMask, const std::function<int(int)>& getMaterialID);
+            void Remove(int entityID);
+            void MarkDirty(int index);
+            void Upload();
+
+            void AddGeometry(const std::shared_ptr<const GeometryArena::Allocation>& geometry);
+            void ReleaseGeometry(const std::shared_ptr<const GeometryArena::Allocation>& geometry);
+
+            [[nodiscard]] ShaderStorageBufferObject* GetCommandBuffer(unsigned pass);
+            [[nodiscard]] const ShaderStorageBufferObject* GetCommandBuffer(unsigned pass) const;
+
+            std::unordered_map<const GeometryArena::Allocation*, int> geometry_; // Unique meshes referenced by the objects, with their reference counts.
+
+            std::unordered_map<int, int> indices_; // Entity ID to index into the arrays below.
+            std::vector<int> entityIDs_;
+            std::vector<ObjectData> objects_;
+            std::vector<std::shared_ptr<const GeometryArena::Allocation>> objectGeometry_;
+
+            // Objects rewritten since the last upload.
+            int dirtyBegin_;
+            int dirtyEnd_;
+            bool rebuild_;
+
+            ShaderStorageBufferObject objectBuffer_;
+            std::map<unsigned, std::unique_ptr<ShaderStorageBufferObject>> commandBuffers_;
+    };
+
+}
@@ -0,0 +1,97 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/shader/shader.h"
+#include "common/geometry/mesh.h"
+#include "common/material/material.h"
+
+namespace Sandbox {
+
+    // Everything needed to issue a draw without going back to the ECS.
+    struct DrawPacket {
+        Shader* shader;
+        const Material* material; // Optional, bound whenever it changes between consecutive draws.
+        Mesh* mesh;
+        glm::mat4 modelTransform;
+        int materialID;           // Record in a material buffer, for shaders that read materials from storage instead.
+    };
+
+    // Collects draw packets and executes them ordered by a 64-bit sort key, so that draws sharing a shader, material and mesh
+    // end up next to each other and state changes between them are minimal.
+    // Key layout, from the most significant bits: shader (12) | material (16) | mesh (16) | depth (20).
+    // A queue holds the packets of a single pass, passes are recorded one after another by clearing the queue in between.
+    // Model transforms and material records of all packets are streamed in one block when the queue is executed. Shaders read
+    // the data of the packet being drawn with 'draws[drawID]' from the storage block at DRAW_BINDING_POINT.
+    class RenderQueue {
+        private:
+            struct Entry {
+                float depth;
+                DrawPacket packet;
+            };
+
+            // Matches the 'Draw' struct (std430) in the shaders.
+            struct DrawData {
+                glm::mat4 modelTransform;
+                glm::mat4 normalTransform;
+                int materialID;
+                int padding[3]; // Pads the struct to its std430 array stride.
+            };
+
+        public:
+            static constexpr unsigned DRAW_BINDING_POINT = 10;
+
+            // Packets of one list are only ever submitted from one thread.
+            // Separate lists allow draw preparation to be spread over worker threads without any synchronization per packet.
+            class DrawList {
+                public:
+                    // 'depth' in [0, 1] orders draws within the same shader, material and mesh front to back.
+                    void Submit(float depth, const DrawPacket& packet);
+
+                private:
+                    friend class RenderQueue;
+                    std::vector<Entry> entries_;
+            };
+
+            RenderQueue();
+            ~RenderQueue();
+
+            // Thread safe, the returned list stays valid until the queue is cleared.
+            [[nodiscard]] DrawList& CreateList();
+
+            // Submits to the list of the render thread.
+            void Submit(float depth, const DrawPacket& packet);
+
+            // Merges all lists and orders packets by their keys. Must be called on the render thread, after all lists are filled.
+            void Sort();
+
+            // Streams the per-draw data of all packets and executes them in sorted order. Additional per-draw uniforms are set by
+            // the given callback, after the shader and material are bound. Returns the number of draws issued.
+            int Execute(const std::function<void(Shader& shader, const DrawPacket& packet)>& setDrawUniforms = nullptr);
+
+            void Clear();
+
+            [[nodiscard]] int GetPacketCount() const;
+
+        private:
+            [[nodiscard]] static std::uint64_t MakeKey(unsigned shader, unsigned material, unsigned mesh, float depth);
+
+            // Least significant digit radix sort of (key, packet index) pairs, digits shared by all keys are skipped.
+            void RadixSort();
+
+            DrawList renderThreadList_;
+
+            std::mutex mutex_;
+            std::deque<DrawList> lists_;
+
+            std::vector<DrawPacket> packets_;
+            std::vector<std::pair<std::uint64_t, unsigned>> keys_; // Sorted (key, packet index) pairs.
+            std::vector<std::pair<std::uint64_t, unsigned>> scratch_;
+            std::vector<DrawData> draws_; // Staging for the streamed per-draw data, in sorted order.
+
+            // Small per-frame IDs for the key.
+            std::unordered_map<const Material*, unsigned> materialIDs_;
+            std::unordered_map<const void*, unsigned> meshIDs_;
+    };
+
+}
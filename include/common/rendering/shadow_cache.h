@@ -0,0 +1,89 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/texture/texture.h"
+
+namespace Sandbox {
+
+    // Keeps the shadow map of a directional light between frames.
+    // Casters are split into a static and a dynamic layer. The static layer is only re-rendered when the light transform changes,
+    // or when a static caster was added, removed, or had its transform or mesh change. Dynamic casters are drawn over a
+    // copy of the static layer every frame. The filtered shadow map is only rebuilt when one of its layers changed.
+    class ShadowCache {
+        public:
+            enum class Layer {
+                NONE,
+                STATIC,
+                DYNAMIC
+            };
+
+            ShadowCache();
+            ~ShadowCache();
+
+            // Allocates the cached render targets. Moments are stored in 'format', depth in 32-bit floats.
+            void Initialize(GLenum format, int size);
+            void Clear();
+
+            // Refreshes the dirty flags, called once per frame before the shadow map is rendered.
+            // The layer function returns the layer an entity with a Transform and a Mesh casts shadows into.
+            void Update(const glm::mat4& lightTransform, const std::function<Layer(int entityID)>& getLayer);
+
+            // Static layer is re-rendered on the next frame.
+            void Invalidate();
+
+            // Filtered shadow map is rebuilt from the layers on the next frame, for example after the filter changed.
+            void InvalidateFilter();
+
+            // Called once the shadow map of this frame has been rendered, clears the dirty flags.
+            void Validate();
+
+            [[nodiscard]] bool IsStaticLayerDirty() const;
+
+            // Static layer changed, the filter was invalidated, or there are dynamic casters.
+            [[nodiscard]] bool IsShadowMapDirty() const;
+            [[nodiscard]] bool HasDynamicCasters() const;
+
+            [[nodiscard]] Texture* GetStaticMoments() const;
+            [[nodiscard]] Texture* GetStaticDepth() const;
+            [[nodiscard]] Texture* GetShadowMap() const;
+
+            [[nodiscard]] int GetStaticCasterCount() const;
+            [[nodiscard]] int GetDynamicCasterCount() const;
+
+            void OnImGui() const;
+
+        private:
+            // Static layer was rendered with these versions of the caster transform and mesh.
+            struct Caster {
+                int entityID;
+                unsigned transformVersion;
+                unsigned meshVersion;
+
+                bool operator==(const Caster& other) const {
+                    return entityID == other.entityID && transformVersion == other.transformVersion && meshVersion == other.meshVersion;
+                }
+
+                bool operator!=(const Caster& other) const {
+                    return !(*this == other);
+                }
+            };
+
+            std::unique_ptr<Texture> staticMoments_;
+            std::unique_ptr<Texture> staticDepth_;
+            std::unique_ptr<Texture> shadowMap_;
+
+            glm::mat4 lightTransform_;
+            std::vector<Caster> staticCasters_; // Sorted by entity ID.
+            int dynamicCasterCount_;
+
+            bool staticDirty_;
+            bool filterDirty_;
+
+            // Displayed in OnImGui.
+            int frames_;
+            int staticUpdates_;
+            int filterUpdates_;
+    };
+
+}
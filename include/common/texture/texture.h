@@ -3,6 +3,7 @@
 #define SANDBOX_TEXTURE_H
 
 #include "pch.h"
+#include "common/api/buffer/pbo.h"
 
 namespace Sandbox {
 
@@ -14,6 +15,25 @@ namespace Sandbox {
                 UNKNOWN
             };
 
+            // Decoded image contents.
+            // Decoding does not touch any OpenGL state and is safe to do off of the render thread.
+            struct ImageData {
+                ImageData();
+
+                [[nodiscard]] std::size_t GetSize() const;
+
+                // Swaps the order of rows, OpenGL stores images bottom row first.
+                void FlipVertically();
+
+                int width;
+                int height;
+                int channels;
+                bool hdr; // Pixel data holds floats instead of bytes.
+                std::vector<unsigned char> pixels;
+            };
+
+            [[nodiscard]] static ImageData Decode(const std::string& filepath);
+
             explicit Texture(std::string name);
             ~Texture();
 
@@ -21,25 +41,43 @@ namespace Sandbox {
             void Unbind() const;
 
             [[nodiscard]] const std::string& GetName() const;
+            void SetName(const std::string& name);
             [[nodiscard]] GLuint ID() const;
             [[nodiscard]] int GetWidth() const;
             [[nodiscard]] int GetHeight() const;
 
+            // COLOR reserves GL_RGBA32F storage, DEPTH reserves GL_DEPTH_COMPONENT32F storage.
             void ReserveData(AttachmentType attachmentType, int contentWidth, int contentHeight);
+
+            // Reserves storage of a sized internal format, the attachment type follows from the format.
+            void ReserveData(GLenum internalFormat, int contentWidth, int contentHeight);
             void ReserveData(const std::string& textureName);
 
             void SetData(int contentWidth, int contentHeight, const std::vector<unsigned char>& data);
             void SetData(int contentWidth, int contentHeight, const std::vector<float>& data);
 
+            void SetData(const ImageData& image);
+
+            // Copies the image data into the staging buffer and sources the texture upload from it.
+            void SetData(const ImageData& image, PixelBufferObject& stagingBuffer);
 
             void WriteDataToDirectory(const std::string& directory) const;
 
+            // Contents as four channel bytes with the first row at the top, same as decoded images.
+            // Depth is replicated into the color channels.
+            [[nodiscard]] ImageData ReadData() const;
+
             void SetAttachmentLocation(GLuint attachmentLocation);
             [[nodiscard]] GLuint GetAttachmentLocation() const;
             [[nodiscard]] AttachmentType GetAttachmentType() const;
+            [[nodiscard]] GLenum GetInternalFormat() const;
+
+            // Size of a pixel of a render target format, in bytes.
+            [[nodiscard]] static std::size_t GetPixelSize(GLenum internalFormat);
 
         private:
-            void WriteData(const std::string& filepath, GLenum format, GLenum type, int channels) const;
+            // 'data' is an offset into the bound GL_PIXEL_UNPACK_BUFFER, if there is one.
+            void UploadImage(const ImageData& image, const void* data);
 
             int _contentWidth;
             int _contentHeight;
@@ -48,6 +86,7 @@ namespace Sandbox {
             bool _stbLoaded;
             GLuint _textureID;
             AttachmentType _attachmentType;
+            GLenum _internalFormat;
             GLuint _attachmentLocation;
     };
 
@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    // Hands out ranges of a linear address space (offsets / sizes in arbitrary units, e.g. vertices).
+    // Free blocks are tracked both by offset, to coalesce neighbours on release, and by size, for best fit allocation.
+    // Only bookkeeping, the allocator does not own any memory.
+    class FreeListAllocator {
+        public:
+            explicit FreeListAllocator(unsigned capacity = 0u);
+            ~FreeListAllocator();
+
+            // Returns false if there is no free block large enough to hold 'size' units.
+            [[nodiscard]] bool Allocate(unsigned size, unsigned& offset);
+
+            // Allocates the given range, which must be free. Used to move allocations to a known location.
+            void AllocateAt(unsigned offset, unsigned size);
+            void Free(unsigned offset, unsigned size);
+
+            // Extends the address space, new space is appended to the end as a free block.
+            void Grow(unsigned capacity);
+            void Reset(unsigned capacity);
+
+            // Returns the lowest free block starting at or after 'start' that is followed by allocated space (false if there is none).
+            [[nodiscard]] bool GetNextHole(unsigned start, unsigned& offset, unsigned& size) const;
+
+            [[nodiscard]] unsigned GetCapacity() const;
+            [[nodiscard]] unsigned GetAllocatedSize() const;
+            [[nodiscard]] unsigned GetLargestFreeBlock() const;
+            [[nodiscard]] int GetFreeBlockCount() const;
+
+        private:
+            void InsertFreeBlock(unsigned offset, unsigned size);
+            void EraseFreeBlock(std::map<unsigned, unsigned>::iterator block);
+
+            unsigned capacity_;
+            unsigned allocated_;
+
+            std::map<unsigned, unsigned> blocksByOffset_;      // Offset -> size.
+            std::multimap<unsigned, unsigned> blocksBySize_;   // Size -> offset.
+    };
+
+}
@@ -43,6 +43,9 @@ namespace Sandbox {
             void PrintWarningMessage(const std::string& message) const;
             void PrintErrorMessage(const std::string& message) const;
 
+            // Messages may be logged from worker threads.
+            std::recursive_mutex mutex_;
+
             std::ofstream writer_;
 
             int _processingBufferSize;
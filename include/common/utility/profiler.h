@@ -0,0 +1,154 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/utility/singleton.h"
+
+namespace Sandbox {
+
+    // Hierarchical frame profiler for CPU and GPU zones.
+    // CPU zones can be opened on any thread and nest per thread. GPU zones are bracketed by timestamp queries (timestamps nest,
+    // GL_TIME_ELAPSED queries do not) and can only be opened on the thread owning the context. Query results are read back
+    // BUFFERED_FRAMES frames later, so resolving them never stalls the pipeline.
+    // Completed frames are kept in a short history, displayed as a timeline in OnImGui and exported as Chrome trace events
+    // (chrome://tracing, Perfetto).
+    class Profiler : public ISingleton<Profiler> {
+        public:
+            REGISTER_SINGLETON(Profiler);
+
+            static constexpr int BUFFERED_FRAMES = 3;
+            static constexpr int HISTORY_FRAMES = 240;
+
+            struct Zone {
+                const char* name; // Zone names must outlive the profiler, usually string literals.
+                int thread;       // 0 is the main thread, -1 for GPU zones.
+                int depth;
+
+                // Milliseconds since profiler initialization.
+                double start;
+                double duration;
+            };
+
+            struct Frame {
+                unsigned index;
+                double start;
+                double duration;
+                bool resolved;          // All GPU zones of the frame have been read back.
+                std::vector<Zone> zones;
+            };
+
+            void Init();
+            void Shutdown();
+
+            // Called once per frame by the application, on the main thread.
+            void BeginFrame();
+            void EndFrame();
+
+            void BeginZone(const char* name);
+            void EndZone();
+            void BeginGPUZone(const char* name);
+            void EndGPUZone();
+
+            // Disabled profilers record nothing. Takes effect at the start of the next frame.
+            // Zones opened before the profiler is initialized are not recorded either.
+            void SetEnabled(bool enabled);
+            [[nodiscard]] bool IsEnabled() const;
+
+            // Stable copy of a zone name that is built at runtime, valid until the profiler is destroyed.
+            [[nodiscard]] const char* Intern(const std::string& name);
+
+            // Names the calling thread in the timeline and in exported traces.
+            void SetThreadName(const std::string& name);
+
+            // Writes all resolved frames in the history to 'filepath' in Chrome trace event format.
+            void ExportChromeTrace(const std::string& filepath) const;
+
+            // Blocks until the GPU zones of all finished frames have been read back.
+            void Flush();
+
+            // Latest resolved frame, nullptr if there is none yet.
+            [[nodiscard]] const Frame* GetLatestFrame() const;
+
+            // Oldest frame first. Frames resolve in order, once their GPU zones have been read back.
+            [[nodiscard]] const std::deque<Frame>& GetHistory() const;
+
+            // Index of the frame in progress.
+            [[nodiscard]] unsigned GetFrameIndex() const;
+
+            void OnImGui();
+
+        private:
+            struct GPUZone {
+                const char* name;
+                int depth;
+                GLuint queries[2]; // Begin and end timestamps.
+            };
+
+            struct GPUFrame {
+                unsigned index;
+                std::vector<GPUZone> zones;
+                std::size_t used;  // Zones issued this frame, the rest are kept around for their queries.
+                bool pending;      // Results are not read back yet.
+            };
+
+            Profiler();
+            ~Profiler() override;
+
+            [[nodiscard]] double Now() const;
+            [[nodiscard]] int GetThreadIndex();
+
+            void ResolveGPUFrame(GPUFrame& gpuFrame, bool wait);
+            [[nodiscard]] Frame* FindFrame(unsigned index);
+
+            std::atomic<bool> enabled_; // Read by worker threads opening zones.
+            bool requestedEnabled_;
+            bool initialized_;
+
+            std::chrono::steady_clock::time_point epoch_;
+            double gpuOffset_; // Maps GPU timestamps onto the CPU timeline, in milliseconds.
+
+            unsigned frameIndex_;
+            Frame current_;
+            std::deque<Frame> history_;
+
+            // Zones may be closed from worker threads while the main thread is in the middle of a frame.
+            mutable std::mutex mutex_;
+            std::unordered_map<std::thread::id, int> threadIndices_;
+            std::vector<std::string> threadNames_;
+            std::unordered_set<std::string> names_; // Interned zone names.
+
+            GPUFrame gpuFrames_[BUFFERED_FRAMES];
+            int gpuDepth_;
+            std::vector<std::size_t> gpuStack_; // Open GPU zones of the current frame.
+
+            bool paused_; // Timeline shows the same frame while paused.
+            Frame displayed_;
+    };
+
+    // Opens a zone for the lifetime of the object.
+    class ProfileZone {
+        public:
+            ProfileZone(const char* name, bool gpu);
+            ~ProfileZone();
+
+            ProfileZone(const ProfileZone& other) = delete;
+            ProfileZone& operator=(const ProfileZone& other) = delete;
+
+        private:
+            bool gpu_;
+            bool active_;
+    };
+
+}
+
+#define PROFILER_CONCATENATE_IMPL(A, B) A##B
+#define PROFILER_CONCATENATE(A, B) PROFILER_CONCATENATE_IMPL(A, B)
+
+// CPU zone for the rest of the enclosing scope.
+#define PROFILE_SCOPE(NAME)     ::Sandbox::ProfileZone PROFILER_CONCATENATE(_profileZone, __LINE__)(NAME, false)
+
+// CPU zone and GPU zone for the rest of the enclosing scope. Main thread only.
+#define PROFILE_GPU_SCOPE(NAME) ::Sandbox::ProfileZone PROFILER_CONCATENATE(_profileZone, __LINE__)(NAME, true)
+
+// CPU zone named after the enclosing function.
+#define PROFILE_FUNCTION()      PROFILE_SCOPE(__func__)
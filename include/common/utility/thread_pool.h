@@ -0,0 +1,48 @@
+
+#pragma once
+
+#include "pch.h"
+
+namespace Sandbox {
+
+    // Fixed-size pool of worker threads executing tasks in submission order.
+    // Tasks must not touch OpenGL state, as there is no context current on worker threads.
+    class ThreadPool {
+        public:
+            // Defaults to one worker per hardware thread, leaving one for the render thread.
+            explicit ThreadPool(unsigned numThreads = 0u);
+            ~ThreadPool();
+
+            ThreadPool(const ThreadPool& other) = delete;
+            ThreadPool& operator=(const ThreadPool& other) = delete;
+
+            template <typename Fn>
+            std::future<std::invoke_result_t<Fn>> Submit(Fn&& task);
+
+            // Blocks until all submitted tasks have finished executing.
+            void Wait();
+
+            // Drops all tasks that have not started executing and blocks until the running ones finish.
+            // Futures of dropped tasks report a broken promise.
+            void Clear();
+
+            [[nodiscard]] unsigned GetThreadCount() const;
+
+        private:
+            void Enqueue(std::function<void()> task);
+            void ProcessTasks();
+
+            std::vector<std::thread> workers_;
+            std::deque<std::function<void()>> tasks_;
+
+            std::mutex mutex_;
+            std::condition_variable taskAvailable_;
+            std::condition_variable tasksFinished_;
+
+            unsigned numActiveTasks_;
+            bool running_;
+    };
+
+}
+
+#include "common/utility/thread_pool.tpp"
@@ -0,0 +1,19 @@
+
+namespace Sandbox {
+
+    template <typename Fn>
+    std::future<std::invoke_result_t<Fn>> ThreadPool::Submit(Fn&& task) {
+        typedef std::invoke_result_t<Fn> ReturnType;
+
+        // std::function requires copyable targets, packaged tasks are move-only.
+        std::shared_ptr<std::packaged_task<ReturnType()>> packagedTask = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Fn>(task));
+        std::future<ReturnType> future = packagedTask->get_future();
+
+        Enqueue([packagedTask]() {
+            (*packagedTask)();
+        });
+
+        return future;
+    }
+
+}
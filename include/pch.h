@@ -4,6 +4,7 @@
 
 // Standard includes
 #include <unordered_map>
+#include <map>
 #include <vector>
 #include <set>
 #include <unordered_set>
@@ -11,7 +12,9 @@
 #include <array>
 #include <bitset>
 #include <string>
+#include <string_view>
 #include <queue>
+#include <deque>
 #include <list>
 #include <stdexcept>
 #include <utility>
@@ -19,13 +22,19 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
+#include <iomanip>
 #include <filesystem>
 #include <functional>
 #include <memory>
 #include <algorithm>
 #include <mutex>
 #include <thread>
+#include <condition_variable>
+#include <future>
+#include <chrono>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
 #include <variant>
 #include <typeindex>
 
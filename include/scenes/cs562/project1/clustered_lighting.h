@@ -0,0 +1,45 @@
+
+#pragma once
+
+#include "pch.h"
+#include "common/api/buffer/streaming_buffer.h"
+#include "common/api/shader/shader.h"
+#include "common/texture/texture.h"
+#include "common/camera/camera.h"
+
+namespace Sandbox {
+
+    // Shades local lights with a single compute pass instead of rasterizing a light volume per light.
+    // The screen is split into tiles, and the depth range covered by each tile into slices. Every tile reduces its depth bounds,
+    // bins the lights overlapping it into the slices they touch and then shades each pixel with the lights of its own slice only.
+    class ClusteredLighting {
+        public:
+            static constexpr unsigned BINDING_POINT = 8;
+            static constexpr int TILE_SIZE = 16;    // Must match the work group size of the lighting shader.
+            static constexpr int DEPTH_SLICES = 32; // Depth slices per tile.
+
+            ClusteredLighting();
+            ~ClusteredLighting();
+
+            // Gathers light data for the given entities that have a Transform and LocalLight.
+            // Returns the number of lights gathered.
+            int Build(const std::vector<int>& entityIDs);
+
+            // Adds the contribution of all gathered lights to 'output', which must have an RGBA32F format.
+            // Shader must be bound, with the geometry buffer textures and depth buffer already set.
+            void Render(Shader* shader, Texture* output, ICamera& camera) const;
+
+            [[nodiscard]] int GetLightCount() const;
+
+        private:
+            // Laid out to match the 'ClusteredLights' std430 storage block in the lighting shader.
+            struct LightData {
+                glm::vec4 position; // xyz: world position, w: radius.
+                glm::vec4 color;    // rgb: color, a: brightness.
+            };
+
+            std::vector<LightData> lights_;
+            StreamingBuffer::Allocation lightData_; // Valid for the frame the lights were gathered in.
+    };
+
+}
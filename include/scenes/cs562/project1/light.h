@@ -3,6 +3,9 @@
 
 #include "pch.h"
 #include "common/ecs/component/component.h"
+#include "common/api/buffer/streaming_buffer.h"
+#include "common/api/shader/shader.h"
+#include "common/geometry/mesh.h"
 
 namespace Sandbox {
 
@@ -24,4 +27,47 @@ namespace Sandbox {
         float brightness_;
     };
 
+    // Per-instance light volume data, laid out to match the 'LocalLights' std430 storage block in the lighting shaders.
+    struct LocalLightInstance {
+        glm::mat4 modelTransform_;
+        glm::vec4 position_; // xyz: world position, w: radius.
+        glm::vec4 color_;    // rgb: color, a: brightness.
+    };
+
+    // Draws local light volumes with one instanced draw call per unique light volume mesh.
+    // Per-instance data of all lights is streamed into a single shader storage range each frame.
+    class LocalLightBatch {
+        public:
+            static constexpr unsigned BINDING_POINT = 5;
+
+            LocalLightBatch();
+            ~LocalLightBatch();
+
+            // Gathers instance data for the given entities that have a Transform, Mesh and LocalLight.
+            // Returns the number of lights gathered.
+            int Build(const std::vector<int>& entityIDs);
+
+            // Shader must be bound and index the storage block with 'instanceOffset + gl_InstanceID'.
+            void Render(Shader* shader) const;
+
+        private:
+            struct Batch {
+                const GeometryArena::Allocation* geometry;
+                Mesh* mesh;
+                int offset;
+                int count;
+            };
+
+            struct Entry {
+                const GeometryArena::Allocation* geometry;
+                Mesh* mesh;
+                LocalLightInstance instance;
+            };
+
+            std::vector<Entry> entries_;
+            std::vector<LocalLightInstance> instances_;
+            std::vector<Batch> batches_;
+            StreamingBuffer::Allocation instanceData_; // Valid for the frame the batch was built in.
+    };
+
 }
@@ -6,10 +6,15 @@
 #include "common/api/buffer/fbo.h"
 #include "common/api/shader/shader.h"
 #include "common/material/material_library.h"
+#include "common/material/material_buffer.h"
 #include "common/api/shader/shader_library.h"
 #include "common/camera/fps_camera.h"
+#include "common/rendering/frustum_culler.h"
+#include "common/rendering/render_queue.h"
+#include "common/geometry/spatial_index.h"
 
 #include "scenes/cs562/project1/light.h"
+#include "scenes/cs562/project1/clustered_lighting.h"
 
 namespace Sandbox {
 
@@ -33,6 +38,9 @@ namespace Sandbox {
 
             void OnWindowResize(int width, int height) override;
 
+            [[nodiscard]] ICamera* GetCamera() override;
+            [[nodiscard]] std::vector<Texture*> GetRenderTargets() override;
+
         private:
             void InitializeShaders();
             void InitializeMaterials();
@@ -45,15 +53,28 @@ namespace Sandbox {
             // Lighting pass for global lights.
             void GlobalLightingPass();
 
-            // Lighting pass for local lights.
+            // Lighting pass for local lights, one light volume per light.
             void LocalLightingPass();
 
+            // Lighting pass for local lights, binned into screen tiles and depth slices and shaded by a single compute pass.
+            void ClusteredLightingPass();
+
             void RenderDepthBuffer();
 
             FrameBufferObject fbo_;
             FPSCamera camera_;
 
+            FrustumCuller culler_;
+            SpatialIndex spatialIndex_;
+            std::vector<int> visibleEntities_; // Entities inside the camera frustum this frame.
+            std::vector<int> visibleLights_;   // Light volumes inside the camera frustum this frame.
+            LocalLightBatch lightBatch_;
+            ClusteredLighting clusteredLighting_;
+            bool clusteredLightingEnabled_;
+            RenderQueue renderQueue_;
+
             MaterialLibrary materialLibrary_;
+            MaterialBuffer materialBuffer_;
 
             DirectionalLight directionalLight_;
     };
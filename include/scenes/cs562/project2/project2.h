@@ -5,8 +5,13 @@
 #include "common/api/buffer/fbo.h"
 #include "common/api/shader/shader.h"
 #include "common/material/material_library.h"
+#include "common/material/material_buffer.h"
 #include "common/api/shader/shader_library.h"
 #include "common/camera/fps_camera.h"
+#include "common/rendering/frustum_culler.h"
+#include "common/rendering/render_queue.h"
+#include "common/rendering/box_blur.h"
+#include "common/geometry/spatial_index.h"
 #include "common/api/buffer/ubo.h"
 #include "common/geometry/bounds.h"
 
@@ -34,6 +39,9 @@ namespace Sandbox {
 
             void OnWindowResize(int width, int height) override;
 
+            [[nodiscard]] ICamera* GetCamera() override;
+            [[nodiscard]] std::vector<Texture*> GetRenderTargets() override;
+
         private:
             void InitializeShaders();
             void InitializeMaterials();
@@ -62,10 +70,19 @@ namespace Sandbox {
             FrameBufferObject fbo_;
             FPSCamera camera_;
             MaterialLibrary materialLibrary_;
+            MaterialBuffer materialBuffer_;
+
+            FrustumCuller culler_;
+            SpatialIndex spatialIndex_;
+            std::vector<int> visibleEntities_; // Entities inside the camera frustum this frame.
+            std::vector<int> visibleLights_;   // Light volumes inside the camera frustum this frame.
+            LocalLightBatch lightBatch_;
+            RenderQueue renderQueue_;
+            std::vector<int> shadowCasters_;   // Entities inside the light frustum this frame.
             DirectionalLight directionalLight_;
 
             FrameBufferObject shadowMap_;
-            UniformBufferObject blurKernel_;
+            BoxBlur shadowBlur_;
             int blurKernelRadius_;
     };
 
@@ -2,11 +2,19 @@
 #pragma once
 
 #include "common/application/scene.h"
-#include "common/api/buffer/fbo.h"
 #include "common/api/shader/shader.h"
 #include "common/material/material_library.h"
+#include "common/material/material_buffer.h"
 #include "common/api/shader/shader_library.h"
 #include "common/camera/fps_camera.h"
+#include "common/rendering/frustum_culler.h"
+#include "common/rendering/render_queue.h"
+#include "common/geometry/spatial_index.h"
+#include "common/geometry/scene_bvh.h"
+#include "common/rendering/indirect_renderer.h"
+#include "common/rendering/frame_graph.h"
+#include "common/rendering/shadow_cache.h"
+#include "common/rendering/box_blur.h"
 #include "common/api/buffer/ubo.h"
 #include "common/geometry/bounds.h"
 
@@ -34,16 +42,21 @@ namespace Sandbox {
 
             void OnWindowResize(int width, int height) override;
 
+            [[nodiscard]] ICamera* GetCamera() override;
+            [[nodiscard]] std::vector<Texture*> GetRenderTargets() override;
+
         private:
             void InitializeShaders();
             void InitializeMaterials();
             void InitializeTextures();
             void ConfigureModels();
             void ConfigureLights();
-            void ConstructFBO();
-            void ConstructShadowMap();
+
+            // Declares the passes of this frame and the render targets they use.
+            void BuildFrameGraph();
 
             void GeometryPass();
+            void RenderSceneDepth();
 
             [[nodiscard]] glm::mat4 CalculateShadowMatrix();
 
@@ -51,16 +64,23 @@ namespace Sandbox {
             void InitializeBlurKernel();
 
             // Lighting pass for global lights.
-            void GlobalLightingPass();
+            void GlobalLightingPass(const std::string& shadowMap);
 
             // Lighting pass for local lights.
             void LocalLightingPass();
 
+            // Static casters are rendered into the cached layer, dynamic casters over a copy of it.
             void GenerateShadowMap();
-            void BlurShadowMap();
+            void CompositeShadowMap();
+            void RenderShadowCasters(unsigned pass);
+            void BlurShadowMap(const std::string& source);
+            void RenderDepth(const std::string& source, const std::string& samplerName);
 
             void GenerateRandomPoints();
 
+            // Selects the entity under a point of the framebuffer image, given in [0, 1] with the origin in the top left corner.
+            void PickEntity(const glm::vec2& position);
+
 //            struct HDRImageData {
 //                int width;
 //                int height;
@@ -74,13 +94,34 @@ namespace Sandbox {
 
             Bounds bounds_;
 
-            FrameBufferObject fbo_;
+            FrameGraph frameGraph_;
+            bool debugTexturesVisible_; // Debug render targets are only kept while they are displayed.
+            int normalFormat_; // Selected geometry buffer formats.
+            int colorFormat_;
             FPSCamera camera_;
             MaterialLibrary materialLibrary_;
+            MaterialBuffer materialBuffer_;
+
+            FrustumCuller culler_;
+            SpatialIndex spatialIndex_;
+            std::vector<int> visibleEntities_; // Entities inside the camera frustum this frame.
+            std::vector<int> visibleLights_;   // Light volumes inside the camera frustum this frame.
+
+            // Mouse picking against mesh triangles, the hierarchy is rebuilt on the first pick after the scene changed.
+            SceneBVH sceneBVH_;
+            bool sceneBVHDirty_;
+            SceneBVH::Hit selection_;
+            LocalLightBatch lightBatch_;
+            RenderQueue renderQueue_;
+
+            // GPU-driven path for the geometry and shadow passes.
+            IndirectRenderer indirectRenderer_;
+            bool gpuDriven_;
+            std::vector<int> shadowCasters_;   // Entities inside the light frustum this frame.
+            ShadowCache shadowCache_;
             DirectionalLight directionalLight_;
 
-            FrameBufferObject shadowMap_;
-            UniformBufferObject blurKernel_;
+            BoxBlur shadowBlur_;
             int blurKernelRadius_;
 
             int brdfModel_;
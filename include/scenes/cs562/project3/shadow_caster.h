@@ -5,7 +5,15 @@
 
 namespace Sandbox {
 
+    // Static casters are rendered into the cached shadow map layer, dynamic ones are redrawn over it every frame.
     struct ShadowCaster : public IComponent {
+        ShadowCaster() : dynamic_(false) {
+        }
+
+        explicit ShadowCaster(bool dynamic) : dynamic_(dynamic) {
+        }
+
+        bool dynamic_;
     };
 
 }
\ No newline at end of file
@@ -1,18 +1,22 @@
 
 #include "common/api/backend.h"
 #include "common/geometry/mesh.h"
-#include "common/api/buffer/vao_manager.h"
 
 namespace Sandbox {
     namespace Backend {
 
+        namespace Rendering {
+            static Statistics current { };
+            static Statistics previous { };
+        }
+
         namespace Core {
             void EnableFlag(GLuint flag) {
-                glEnable(flag);
+                State::SetEnabled(flag, true);
             }
 
             void DisableFlag(GLuint flag) {
-                glDisable(flag);
+                State::SetEnabled(flag, false);
             }
 
             void CullFace(GLuint face) {
@@ -20,7 +24,7 @@ namespace Sandbox {
             }
 
             void WriteDepth(bool mask) {
-                mask ? glDepthMask(GL_TRUE) : glDepthMask(GL_FALSE);
+                State::DepthMask(mask);
             }
 
             void ClearColor(float r, float g, float b, float a) {
@@ -32,20 +36,255 @@ namespace Sandbox {
             }
 
             void SetViewport(unsigned int x, unsigned int y, unsigned int width, unsigned int height) {
-                glViewport(x, y, width, height);
+                State::Viewport(static_cast<int>(x), static_cast<int>(y), static_cast<int>(width), static_cast<int>(height));
             }
 
             glm::vec4 GetViewport() {
-                glm::vec4 data;
-                glGetFloatv(GL_VIEWPORT, &data[0]);
-                return data;
+                return glm::vec4(State::GetViewport());
+            }
+        }
+
+        namespace State {
+            static const GLuint UNKNOWN = std::numeric_limits<GLuint>::max();
+
+            // Texture bindings are cached for the first units and the common targets, others are always forwarded.
+            static const int MAX_TEXTURE_UNITS = 32;
+            static const int NUM_TEXTURE_TARGETS = 4;
+
+            static struct Cache {
+                // Nothing is known about the state of a new context.
+                Cache() {
+                    Reset();
+                }
+
+                void Reset() {
+                    program = UNKNOWN;
+                    vertexArray = UNKNOWN;
+
+                    activeTexture = -1;
+                    for (auto& unit : textures) {
+                        for (GLuint& texture : unit) {
+                            texture = UNKNOWN;
+                        }
+                    }
+
+                    readFramebuffer = UNKNOWN;
+                    drawFramebuffer = UNKNOWN;
+
+                    flags.clear();
+                    depthMask = -1;
+
+                    hasViewport = false;
+                }
+
+                GLuint program;
+                GLuint vertexArray;
+
+                int activeTexture; // -1 if unknown.
+                GLuint textures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+
+                GLuint readFramebuffer;
+                GLuint drawFramebuffer;
+
+                std::unordered_map<GLenum, bool> flags;
+                int depthMask; // -1 if unknown.
+
+                bool hasViewport;
+                glm::ivec4 viewport;
+            } cache;
+
+            static Statistics current { };
+            static Statistics previous { };
+
+            static int GetTextureTargetIndex(GLenum target) {
+                switch (target) {
+                    case GL_TEXTURE_2D:
+                        return 0;
+                    case GL_TEXTURE_CUBE_MAP:
+                        return 1;
+                    case GL_TEXTURE_2D_ARRAY:
+                        return 2;
+                    case GL_TEXTURE_3D:
+                        return 3;
+                    default:
+                        return -1;
+                }
+            }
+
+            // Returns true if the state change needs to be forwarded to OpenGL.
+            static bool Record(bool redundant) {
+                if (redundant) {
+                    ++current.avoided;
+                    return false;
+                }
+
+                ++current.issued;
+                return true;
+            }
+
+            void BeginFrame() {
+                previous = current;
+                current = { };
+
+                Rendering::previous = Rendering::current;
+                Rendering::current = { };
+
+                Invalidate();
+            }
+
+            void Invalidate() {
+                cache.Reset();
+            }
+
+            const Statistics& GetStatistics() {
+                return previous;
+            }
+
+            const Statistics& GetCurrentStatistics() {
+                return current;
+            }
+
+            void UseProgram(GLuint program) {
+                // Leaving the previous program installed is harmless, as nothing is drawn without binding a program first.
+                if (Record(program == 0 || program == cache.program)) {
+                    glUseProgram(program);
+                    cache.program = program;
+                }
+            }
+
+            void BindVertexArray(GLuint vertexArray) {
+                if (Record(vertexArray == 0 || vertexArray == cache.vertexArray)) {
+                    glBindVertexArray(vertexArray);
+                    cache.vertexArray = vertexArray;
+                }
+            }
+
+            void ActiveTexture(int unit) {
+                if (Record(unit == cache.activeTexture)) {
+                    glActiveTexture(GL_TEXTURE0 + unit);
+                    cache.activeTexture = unit;
+                }
+            }
+
+            void BindTexture(GLenum target, GLuint texture) {
+                int unit = cache.activeTexture;
+                int index = GetTextureTargetIndex(target);
+
+                if (unit < 0 || unit >= MAX_TEXTURE_UNITS || index < 0) {
+                    // Binding is not tracked.
+                    Record(false);
+                    glBindTexture(target, texture);
+                    return;
+                }
+
+                GLuint& bound = cache.textures[unit][index];
+                if (Record(texture == 0 || texture == bound)) {
+                    glBindTexture(target, texture);
+                    bound = texture;
+                }
+            }
+
+            void BindFramebuffer(GLenum target, GLuint framebuffer) {
+                // Framebuffer bindings are never elided when unbinding, as binding 0 selects the default framebuffer.
+                bool read = target == GL_FRAMEBUFFER || target == GL_READ_FRAMEBUFFER;
+                bool draw = target == GL_FRAMEBUFFER || target == GL_DRAW_FRAMEBUFFER;
+
+                bool redundant = (!read || cache.readFramebuffer == framebuffer) && (!draw || cache.drawFramebuffer == framebuffer);
+                if (Record(redundant)) {
+                    glBindFramebuffer(target, framebuffer);
+
+                    if (read) {
+                        cache.readFramebuffer = framebuffer;
+                    }
+                    if (draw) {
+                        cache.drawFramebuffer = framebuffer;
+                    }
+                }
+            }
+
+            GLuint GetFramebuffer(GLenum target) {
+                GLuint& framebuffer = target == GL_READ_FRAMEBUFFER ? cache.readFramebuffer : cache.drawFramebuffer;
+
+                if (framebuffer == UNKNOWN) {
+                    GLint binding = 0;
+                    glGetIntegerv(target == GL_READ_FRAMEBUFFER ? GL_READ_FRAMEBUFFER_BINDING : GL_DRAW_FRAMEBUFFER_BINDING, &binding);
+                    framebuffer = static_cast<GLuint>(binding);
+                }
+
+                return framebuffer;
+            }
+
+            void SetEnabled(GLenum flag, bool enabled) {
+                auto iterator = cache.flags.find(flag);
+                if (Record(iterator != cache.flags.end() && iterator->second == enabled)) {
+                    enabled ? glEnable(flag) : glDisable(flag);
+                    cache.flags[flag] = enabled;
+                }
+            }
+
+            void DepthMask(bool mask) {
+                if (Record(cache.depthMask == static_cast<int>(mask))) {
+                    glDepthMask(mask ? GL_TRUE : GL_FALSE);
+                    cache.depthMask = static_cast<int>(mask);
+                }
+            }
+
+            void Viewport(int x, int y, int width, int height) {
+                glm::ivec4 viewport(x, y, width, height);
+
+                if (Record(cache.hasViewport && cache.viewport == viewport)) {
+                    glViewport(x, y, width, height);
+                    cache.viewport = viewport;
+                    cache.hasViewport = true;
+                }
+            }
+
+            glm::ivec4 GetViewport() {
+                if (!cache.hasViewport) {
+                    glGetIntegerv(GL_VIEWPORT, &cache.viewport[0]);
+                    cache.hasViewport = true;
+                }
+
+                return cache.viewport;
+            }
+
+            void OnProgramDeleted(GLuint program) {
+                // Deleting the current program does not uninstall it, the program is only flagged for deletion.
+                if (cache.program == program) {
+                    cache.program = UNKNOWN;
+                }
+            }
+
+            void OnVertexArrayDeleted(GLuint vertexArray) {
+                if (cache.vertexArray == vertexArray) {
+                    cache.vertexArray = 0;
+                }
+            }
+
+            void OnTextureDeleted(GLuint texture) {
+                for (auto& unit : cache.textures) {
+                    for (GLuint& bound : unit) {
+                        if (bound == texture) {
+                            bound = 0;
+                        }
+                    }
+                }
+            }
+
+            void OnFramebufferDeleted(GLuint framebuffer) {
+                if (cache.readFramebuffer == framebuffer) {
+                    cache.readFramebuffer = 0;
+                }
+                if (cache.drawFramebuffer == framebuffer) {
+                    cache.drawFramebuffer = 0;
+                }
             }
         }
 
         namespace Rendering {
             void DrawFSQ() {
                 static bool initialized = false;
-                static Mesh quad { VAOManager::Instance().GetVAO("assets/models/quad.obj") };
+                static Mesh quad { };
                 if (!initialized) {
                     std::vector<glm::vec3> vertices;
                     std::vector<unsigned> indices;
@@ -83,12 +322,50 @@ namespace Sandbox {
                 quad.Unbind();
             }
 
-            void DrawIndexed(GLuint renderingPrimitive, int indexCount) {
-                glDrawElements(renderingPrimitive, indexCount, GL_UNSIGNED_INT, nullptr);
+            static long long GetTriangleCount(GLuint renderingPrimitive, int indexCount) {
+                switch (renderingPrimitive) {
+                    case GL_TRIANGLES:
+                        return indexCount / 3;
+                    case GL_TRIANGLE_STRIP:
+                    case GL_TRIANGLE_FAN:
+                        return std::max(indexCount - 2, 0);
+                    default:
+                        return 0;
+                }
+            }
+
+            const Statistics& GetStatistics() {
+                return previous;
+            }
+
+            const Statistics& GetCurrentStatistics() {
+                return current;
+            }
+
+            void DrawIndexed(GLuint renderingPrimitive, int indexCount, unsigned firstIndex, int baseVertex) {
+                ++current.drawCalls;
+                current.triangles += GetTriangleCount(renderingPrimitive, indexCount);
+
+                const void* offset = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(firstIndex) * sizeof(unsigned));
+                glDrawElementsBaseVertex(renderingPrimitive, indexCount, GL_UNSIGNED_INT, offset, baseVertex);
+            }
+
+            void DrawIndexedInstanced(GLuint renderingPrimitive, int indexCount, int instanceCount, unsigned firstIndex, int baseVertex) {
+                ++current.drawCalls;
+                current.triangles += GetTriangleCount(renderingPrimitive, indexCount) * instanceCount;
+
+                const void* offset = reinterpret_cast<const void*>(static_cast<std::uintptr_t>(firstIndex) * sizeof(unsigned));
+                glDrawElementsInstancedBaseVertex(renderingPrimitive, indexCount, GL_UNSIGNED_INT, offset, instanceCount, baseVertex);
+            }
+
+            void DrawIndexedIndirect(GLuint renderingPrimitive, int drawCount) {
+                ++current.drawCalls;
+                ++current.indirectDrawCalls;
+                glMultiDrawElementsIndirect(renderingPrimitive, GL_UNSIGNED_INT, nullptr, drawCount, 0);
             }
 
             void ActivateTextureSampler(int samplerID) {
-                glActiveTexture(GL_TEXTURE0 + samplerID);
+                State::ActiveTexture(samplerID);
             }
 
             void BindTextureWithSampler(Shader* shader, Texture* renderTarget, int samplerID) {
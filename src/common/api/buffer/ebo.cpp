@@ -23,8 +23,10 @@ namespace Sandbox {
 
     void ElementBufferObject::SetData(unsigned dataSize, const void *dataBase) {
         _indexCount = dataSize / sizeof(unsigned);
-        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, _bufferID);
-        glBufferData(GL_ELEMENT_ARRAY_BUFFER, dataSize, dataBase, GL_STATIC_DRAW);
+        // Upload through a generic target, binding GL_ELEMENT_ARRAY_BUFFER would modify whichever vertex array is bound.
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _bufferID);
+        glBufferData(GL_COPY_WRITE_BUFFER, dataSize, dataBase, GL_STATIC_DRAW);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
     }
 
     unsigned ElementBufferObject::GetIndexCount() const {
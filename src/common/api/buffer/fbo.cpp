@@ -1,6 +1,7 @@
 
 #include "common/api/buffer/fbo.h"
 #include "common/utility/directory.h"
+#include "common/api/backend.h"
 
 namespace Sandbox {
 
@@ -23,22 +24,23 @@ namespace Sandbox {
         delete _depthBuffer;
 
         glDeleteFramebuffers(1, &_bufferID);
+        Backend::State::OnFramebufferDeleted(_bufferID);
     }
 
     void FrameBufferObject::BindForReadWrite() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, _bufferID);
+        Backend::State::BindFramebuffer(GL_FRAMEBUFFER, _bufferID);
     }
 
     void FrameBufferObject::BindForRead() const {
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, _bufferID);
+        Backend::State::BindFramebuffer(GL_READ_FRAMEBUFFER, _bufferID);
     }
 
     void FrameBufferObject::BindForWrite() const {
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, _bufferID);
+        Backend::State::BindFramebuffer(GL_DRAW_FRAMEBUFFER, _bufferID);
     }
 
     void FrameBufferObject::Unbind() const {
-        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        Backend::State::BindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
     void FrameBufferObject::DrawBuffers(int startingRenderTargetID, int numRenderTargets) const {
@@ -55,8 +57,8 @@ namespace Sandbox {
 
     void FrameBufferObject::CopyDepthBufferTo(FrameBufferObject* other) const {
         // Reading from this FBO.
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, _bufferID);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, other->_bufferID);
+        Backend::State::BindFramebuffer(GL_READ_FRAMEBUFFER, _bufferID);
+        Backend::State::BindFramebuffer(GL_DRAW_FRAMEBUFFER, other->_bufferID);
 
         // Copy over depth information.
         glBlitFramebuffer(0, 0, _contentWidth, _contentHeight, 0, 0, other->_contentWidth, other->_contentHeight, GL_DEPTH_BUFFER_BIT, GL_NEAREST);
@@ -121,6 +123,10 @@ namespace Sandbox {
         return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
     }
 
+    const std::vector<Texture*>& FrameBufferObject::GetRenderTargets() const {
+        return _renderTargetsList;
+    }
+
     unsigned FrameBufferObject::GetWidth() const {
         return _contentWidth;
     }
@@ -155,7 +161,7 @@ namespace Sandbox {
         // Reallocate all textures.
         for (Texture* renderTarget : renderTargets) {
             renderTarget->Bind();
-            renderTarget->ReserveData(renderTarget->GetAttachmentType(), _contentWidth, _contentHeight);
+            renderTarget->ReserveData(renderTarget->GetInternalFormat(), _contentWidth, _contentHeight); // Keeps the format of each attachment.
         }
 
         _hasDepthRenderTarget = false;
@@ -192,20 +198,20 @@ namespace Sandbox {
 
     void FrameBufferObject::RegenerateBufferID() {
         glDeleteFramebuffers(1, &_bufferID);
+        Backend::State::OnFramebufferDeleted(_bufferID);
         glGenFramebuffers(1, &_bufferID);
     }
 
     void CopyDepthBuffer(FrameBufferObject* source, FrameBufferObject* destination) {
         // Keep track of the current bound framebuffer(s).
-        GLint currentBoundReadFBO, currentBoundDrawFBO;
-        glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &currentBoundReadFBO);
-        glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &currentBoundDrawFBO);
+        GLuint currentBoundReadFBO = Backend::State::GetFramebuffer(GL_READ_FRAMEBUFFER);
+        GLuint currentBoundDrawFBO = Backend::State::GetFramebuffer(GL_DRAW_FRAMEBUFFER);
 
         source->CopyDepthBufferTo(destination);
 
         // Restore state.
-        glBindFramebuffer(GL_READ_FRAMEBUFFER, currentBoundReadFBO);
-        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, currentBoundDrawFBO);
+        Backend::State::BindFramebuffer(GL_READ_FRAMEBUFFER, currentBoundReadFBO);
+        Backend::State::BindFramebuffer(GL_DRAW_FRAMEBUFFER, currentBoundDrawFBO);
     }
 
 }
@@ -0,0 +1,370 @@
+
+#include "common/api/buffer/geometry_arena.h"
+#include "common/api/backend.h"
+
+namespace Sandbox {
+
+    static const unsigned INITIAL_VERTEX_CAPACITY = 1u << 16u;
+    static const unsigned INITIAL_INDEX_CAPACITY = 1u << 18u;
+
+    void GeometryArena::Init() {
+        glGenVertexArrays(1, &vao_);
+
+        // Attribute formats are separate from the buffer binding, so buffers can be reallocated without redefining the layout.
+        Backend::State::BindVertexArray(vao_);
+
+        glEnableVertexAttribArray(0);
+        glVertexAttribFormat(0, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, position));
+        glVertexAttribBinding(0, 0);
+
+        glEnableVertexAttribArray(1);
+        glVertexAttribFormat(1, 3, GL_FLOAT, GL_FALSE, offsetof(Vertex, normal));
+        glVertexAttribBinding(1, 0);
+
+        glEnableVertexAttribArray(2);
+        glVertexAttribFormat(2, 2, GL_FLOAT, GL_FALSE, offsetof(Vertex, uv));
+        glVertexAttribBinding(2, 0);
+
+        Backend::State::BindVertexArray(0);
+
+        ReserveVertices(INITIAL_VERTEX_CAPACITY);
+        ReserveIndices(INITIAL_INDEX_CAPACITY);
+    }
+
+    void GeometryArena::Update() {
+        ReleaseExpired();
+        Defragment(defragmentationBudget_);
+    }
+
+    void GeometryArena::Shutdown() {
+        glDeleteBuffers(1, &scratch_);
+        glDeleteBuffers(1, &ebo_);
+        glDeleteBuffers(1, &vbo_);
+        glDeleteVertexArrays(1, &vao_);
+        Backend::State::OnVertexArrayDeleted(vao_);
+
+        vao_ = 0;
+        vbo_ = 0;
+        ebo_ = 0;
+        scratch_ = 0;
+        scratchSize_ = 0;
+
+        // Outstanding allocations stay valid memory-wise, but no longer refer to any storage.
+        blocks_.clear();
+        vertexBlocks_.clear();
+        indexBlocks_.clear();
+        vertexAllocator_.Reset(0u);
+        indexAllocator_.Reset(0u);
+    }
+
+    std::shared_ptr<const GeometryArena::Allocation> GeometryArena::Allocate(const std::vector<Vertex>& vertices, const std::vector<unsigned>& indices) {
+        if (vertices.empty() || indices.empty()) {
+            throw std::runtime_error("GeometryArena::Allocate requires non-empty vertex and index data.");
+        }
+
+        // Reuse space from meshes that are no longer referenced.
+        ReleaseExpired();
+
+        unsigned vertexCount = static_cast<unsigned>(vertices.size());
+        unsigned indexCount = static_cast<unsigned>(indices.size());
+
+        unsigned baseVertex = 0u;
+        if (!vertexAllocator_.Allocate(vertexCount, baseVertex)) {
+            ReserveVertices(vertexAllocator_.GetCapacity() + vertexCount);
+            bool allocated = vertexAllocator_.Allocate(vertexCount, baseVertex);
+            assert(allocated);
+        }
+
+        unsigned firstIndex = 0u;
+        if (!indexAllocator_.Allocate(indexCount, firstIndex)) {
+            ReserveIndices(indexAllocator_.GetCapacity() + indexCount);
+            bool allocated = indexAllocator_.Allocate(indexCount, firstIndex);
+            assert(allocated);
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(baseVertex * sizeof(Vertex)), static_cast<GLsizeiptr>(vertexCount * sizeof(Vertex)), vertices.data());
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, ebo_);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(firstIndex * sizeof(unsigned)), static_cast<GLsizeiptr>(indexCount * sizeof(unsigned)), indices.data());
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        std::shared_ptr<Allocation> allocation = std::make_shared<Allocation>();
+        allocation->baseVertex = static_cast<int>(baseVertex);
+        allocation->vertexCount = vertexCount;
+        allocation->firstIndex = firstIndex;
+        allocation->indexCount = indexCount;
+
+        int blockID = nextBlockID_++;
+        blocks_.emplace(blockID, Block { allocation, *allocation });
+        vertexBlocks_.emplace(baseVertex, blockID);
+        indexBlocks_.emplace(firstIndex, blockID);
+
+        return allocation;
+    }
+
+    void GeometryArena::Bind() const {
+        Backend::State::BindVertexArray(vao_);
+    }
+
+    void GeometryArena::Unbind() const {
+        Backend::State::BindVertexArray(0);
+    }
+
+    std::size_t GeometryArena::Defragment(std::size_t budget) {
+        // Expired blocks would otherwise be moved around.
+        ReleaseExpired();
+
+        std::size_t moved = 0;
+
+        while (moved < budget) {
+            std::size_t copied = CompactVertices(budget - moved);
+            if (copied == 0) {
+                break;
+            }
+
+            moved += copied;
+        }
+
+        while (moved < budget) {
+            std::size_t copied = CompactIndices(budget - moved);
+            if (copied == 0) {
+                break;
+            }
+
+            moved += copied;
+        }
+
+        return moved;
+    }
+
+    void GeometryArena::SetDefragmentationBudget(std::size_t bytes) {
+        defragmentationBudget_ = bytes;
+    }
+
+    std::size_t GeometryArena::GetDefragmentationBudget() const {
+        return defragmentationBudget_;
+    }
+
+    int GeometryArena::GetAllocationCount() const {
+        return static_cast<int>(blocks_.size());
+    }
+
+    const FreeListAllocator& GeometryArena::GetVertexAllocator() const {
+        return vertexAllocator_;
+    }
+
+    const FreeListAllocator& GeometryArena::GetIndexAllocator() const {
+        return indexAllocator_;
+    }
+
+    GeometryArena::GeometryArena() : vao_(0),
+                                     vbo_(0),
+                                     ebo_(0),
+                                     scratch_(0),
+                                     scratchSize_(0),
+                                     nextBlockID_(0),
+                                     defragmentationBudget_(1u << 20u) // 1 MB.
+                                     {
+    }
+
+    GeometryArena::~GeometryArena() {
+    }
+
+    void GeometryArena::ReleaseExpired() {
+        for (auto iterator = blocks_.begin(); iterator != blocks_.end();) {
+            int blockID = iterator->first;
+            bool expired = iterator->second.owner.expired();
+            ++iterator;
+
+            if (expired) {
+                Release(blockID);
+            }
+        }
+    }
+
+    void GeometryArena::Release(int blockID) {
+        auto iterator = blocks_.find(blockID);
+        assert(iterator != blocks_.end());
+
+        const Allocation& range = iterator->second.range;
+        vertexAllocator_.Free(static_cast<unsigned>(range.baseVertex), range.vertexCount);
+        indexAllocator_.Free(range.firstIndex, range.indexCount);
+
+        vertexBlocks_.erase(static_cast<unsigned>(range.baseVertex));
+        indexBlocks_.erase(range.firstIndex);
+        blocks_.erase(iterator);
+    }
+
+    void GeometryArena::ReserveVertices(unsigned count) {
+        unsigned capacity = vertexAllocator_.GetCapacity();
+        if (count <= capacity && vbo_) {
+            return;
+        }
+
+        // Grow geometrically to amortize the cost of copying existing data.
+        unsigned grown = std::max(count, capacity * 2u);
+        Resize(vbo_, capacity * sizeof(Vertex), grown * sizeof(Vertex));
+        vertexAllocator_.Grow(grown);
+
+        Backend::State::BindVertexArray(vao_);
+        glBindVertexBuffer(0, vbo_, 0, sizeof(Vertex));
+        Backend::State::BindVertexArray(0);
+    }
+
+    void GeometryArena::ReserveIndices(unsigned count) {
+        unsigned capacity = indexAllocator_.GetCapacity();
+        if (count <= capacity && ebo_) {
+            return;
+        }
+
+        unsigned grown = std::max(count, capacity * 2u);
+        Resize(ebo_, capacity * sizeof(unsigned), grown * sizeof(unsigned));
+        indexAllocator_.Grow(grown);
+
+        // Element buffer binding is part of the vertex array object state.
+        Backend::State::BindVertexArray(vao_);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+        Backend::State::BindVertexArray(0);
+    }
+
+    void GeometryArena::Resize(GLuint& buffer, std::size_t size, std::size_t capacity) {
+        GLuint replacement = 0;
+        glGenBuffers(1, &replacement);
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, replacement);
+        glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(capacity), nullptr, GL_STATIC_DRAW);
+
+        if (buffer && size > 0) {
+            // Existing data is copied on the GPU.
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, static_cast<GLsizeiptr>(size));
+            glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        glDeleteBuffers(1, &buffer);
+        buffer = replacement;
+    }
+
+    std::size_t GeometryArena::CompactVertices(std::size_t budget) {
+        unsigned start = 0u;
+        unsigned holeOffset = 0u;
+        unsigned holeSize = 0u;
+
+        // Hole is always followed by an allocation, which slides down to the start of the hole.
+        // Allocations that do not fit the budget are skipped, so a large mesh does not stall compaction behind it.
+        auto iterator = vertexBlocks_.end();
+        while (vertexAllocator_.GetNextHole(start, holeOffset, holeSize)) {
+            iterator = vertexBlocks_.find(holeOffset + holeSize);
+            assert(iterator != vertexBlocks_.end());
+
+            unsigned vertexCount = blocks_.at(iterator->second).range.vertexCount;
+            if (vertexCount * sizeof(Vertex) <= budget) {
+                break;
+            }
+
+            start = holeOffset + holeSize + vertexCount;
+            iterator = vertexBlocks_.end();
+        }
+
+        if (iterator == vertexBlocks_.end()) {
+            return 0;
+        }
+
+        int blockID = iterator->second;
+        Block& block = blocks_.at(blockID);
+        unsigned count = block.range.vertexCount;
+        unsigned offset = static_cast<unsigned>(block.range.baseVertex);
+
+        Copy(vbo_, offset * sizeof(Vertex), holeOffset * sizeof(Vertex), count * sizeof(Vertex));
+
+        vertexAllocator_.Free(offset, count);
+        vertexAllocator_.AllocateAt(holeOffset, count);
+
+        vertexBlocks_.erase(iterator);
+        vertexBlocks_.emplace(holeOffset, blockID);
+
+        block.range.baseVertex = static_cast<int>(holeOffset);
+        block.owner.lock()->baseVertex = static_cast<int>(holeOffset);
+
+        return count * sizeof(Vertex);
+    }
+
+    std::size_t GeometryArena::CompactIndices(std::size_t budget) {
+        unsigned start = 0u;
+        unsigned holeOffset = 0u;
+        unsigned holeSize = 0u;
+
+        auto iterator = indexBlocks_.end();
+        while (indexAllocator_.GetNextHole(start, holeOffset, holeSize)) {
+            iterator = indexBlocks_.find(holeOffset + holeSize);
+            assert(iterator != indexBlocks_.end());
+
+            unsigned indexCount = blocks_.at(iterator->second).range.indexCount;
+            if (indexCount * sizeof(unsigned) <= budget) {
+                break;
+            }
+
+            start = holeOffset + holeSize + indexCount;
+            iterator = indexBlocks_.end();
+        }
+
+        if (iterator == indexBlocks_.end()) {
+            return 0;
+        }
+
+        int blockID = iterator->second;
+        Block& block = blocks_.at(blockID);
+        unsigned count = block.range.indexCount;
+        unsigned offset = block.range.firstIndex;
+
+        // Indices are relative to the base vertex of the mesh and do not need to be rewritten.
+        Copy(ebo_, offset * sizeof(unsigned), holeOffset * sizeof(unsigned), count * sizeof(unsigned));
+
+        indexAllocator_.Free(offset, count);
+        indexAllocator_.AllocateAt(holeOffset, count);
+
+        indexBlocks_.erase(iterator);
+        indexBlocks_.emplace(holeOffset, blockID);
+
+        block.range.firstIndex = holeOffset;
+        block.owner.lock()->firstIndex = holeOffset;
+
+        return count * sizeof(unsigned);
+    }
+
+    void GeometryArena::Copy(GLuint buffer, std::size_t source, std::size_t destination, std::size_t size) {
+        glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+
+        if (source - destination >= size) {
+            // Ranges do not overlap (allocations only ever move towards the start of the buffer).
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(source), static_cast<GLintptr>(destination), static_cast<GLsizeiptr>(size));
+        }
+        else {
+            // Copying between overlapping ranges of the same buffer is not allowed, go through the scratch buffer.
+            if (scratchSize_ < size) {
+                glDeleteBuffers(1, &scratch_);
+                glGenBuffers(1, &scratch_);
+
+                glBindBuffer(GL_COPY_WRITE_BUFFER, scratch_);
+                glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STREAM_COPY);
+                scratchSize_ = size;
+            }
+
+            glBindBuffer(GL_COPY_WRITE_BUFFER, scratch_);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(source), 0, static_cast<GLsizeiptr>(size));
+
+            glBindBuffer(GL_COPY_READ_BUFFER, scratch_);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, static_cast<GLintptr>(destination), static_cast<GLsizeiptr>(size));
+        }
+
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+}
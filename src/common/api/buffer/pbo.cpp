@@ -0,0 +1,58 @@
+
+#include "common/api/buffer/pbo.h"
+
+namespace Sandbox {
+
+    PixelBufferObject::PixelBufferObject(Direction direction) : _direction(direction),
+                                                                _size(0u)
+                                                                {
+        glGenBuffers(1, &_bufferID);
+    }
+
+    PixelBufferObject::~PixelBufferObject() {
+        glDeleteBuffers(1, &_bufferID);
+    }
+
+    void PixelBufferObject::Bind() const {
+        glBindBuffer(GetTarget(), _bufferID);
+    }
+
+    void PixelBufferObject::Unbind() const {
+        glBindBuffer(GetTarget(), 0);
+    }
+
+    void PixelBufferObject::Reserve(std::size_t size) {
+        GLenum target = GetTarget();
+
+        glBindBuffer(target, _bufferID);
+        glBufferData(target, static_cast<GLsizeiptr>(size), nullptr, _direction == UNPACK ? GL_STREAM_DRAW : GL_STREAM_READ);
+
+        _size = size;
+    }
+
+    void* PixelBufferObject::Map() {
+        if (_direction == UNPACK) {
+            // Storage was just orphaned, no need to synchronize with previous contents.
+            return glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(_size), GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        }
+
+        return glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, static_cast<GLsizeiptr>(_size), GL_MAP_READ_BIT);
+    }
+
+    void PixelBufferObject::Unmap() const {
+        glUnmapBuffer(GetTarget());
+    }
+
+    std::size_t PixelBufferObject::GetSize() const {
+        return _size;
+    }
+
+    GLuint PixelBufferObject::ID() const {
+        return _bufferID;
+    }
+
+    GLenum PixelBufferObject::GetTarget() const {
+        return _direction == UNPACK ? GL_PIXEL_UNPACK_BUFFER : GL_PIXEL_PACK_BUFFER;
+    }
+
+}
@@ -0,0 +1,71 @@
+
+#include "common/api/buffer/ssbo.h"
+
+namespace Sandbox {
+
+    ShaderStorageBufferObject::ShaderStorageBufferObject(unsigned bindingPoint) : _bindingPoint(bindingPoint),
+                                                                                  _size(0u),
+                                                                                  _capacity(0u)
+                                                                                  {
+        glGenBuffers(1, &_bufferID);
+    }
+
+    ShaderStorageBufferObject::~ShaderStorageBufferObject() {
+        glDeleteBuffers(1, &_bufferID);
+    }
+
+    void ShaderStorageBufferObject::Bind() const {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferID);
+    }
+
+    void ShaderStorageBufferObject::Unbind() const {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    void ShaderStorageBufferObject::BindBase() const {
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, _bindingPoint, _bufferID);
+    }
+
+    void ShaderStorageBufferObject::SetData(std::size_t size, const void* data) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferID);
+
+        if (size > _capacity) {
+            // Grow geometrically to avoid reallocating every time the data set grows by a little.
+            _capacity = std::max(size, _capacity * 2u);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, static_cast<GLsizeiptr>(_capacity), nullptr, GL_DYNAMIC_DRAW);
+        }
+
+        // Data may be omitted to only reserve storage that is written on the GPU.
+        if (size > 0u && data) {
+            glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, static_cast<GLsizeiptr>(size), data);
+        }
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        _size = size;
+    }
+
+    void ShaderStorageBufferObject::SetSubData(std::size_t offset, std::size_t size, const void* data) const {
+        assert(offset + size <= _capacity);
+
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _bufferID);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), data);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    }
+
+    unsigned ShaderStorageBufferObject::GetBindingPoint() const {
+        return _bindingPoint;
+    }
+
+    std::size_t ShaderStorageBufferObject::GetSize() const {
+        return _size;
+    }
+
+    std::size_t ShaderStorageBufferObject::GetCapacity() const {
+        return _capacity;
+    }
+
+    GLuint ShaderStorageBufferObject::ID() const {
+        return _bufferID;
+    }
+
+}
@@ -0,0 +1,135 @@
+
+#include "common/api/buffer/streaming_buffer.h"
+
+namespace Sandbox {
+
+    void StreamingBuffer::Init(std::size_t segmentSize) {
+        segmentSize_ = segmentSize;
+
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniformAlignment_);
+        glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storageAlignment_);
+
+        // Segments start on an alignment valid for both targets.
+        std::size_t alignment = static_cast<std::size_t>(std::max(uniformAlignment_, storageAlignment_));
+        segmentSize_ = (segmentSize_ + alignment - 1) / alignment * alignment;
+
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        GLsizeiptr size = static_cast<GLsizeiptr>(segmentSize_ * FRAMES_IN_FLIGHT);
+
+        glGenBuffers(1, &buffer_);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        mapped_ = static_cast<char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+        if (!mapped_) {
+            throw std::runtime_error("Failed to persistently map streaming buffer.");
+        }
+    }
+
+    void StreamingBuffer::Shutdown() {
+        for (GLsync& fence : fences_) {
+            if (fence) {
+                glDeleteSync(fence);
+                fence = nullptr;
+            }
+        }
+
+        if (buffer_) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, buffer_);
+            glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+            glDeleteBuffers(1, &buffer_);
+            buffer_ = 0;
+            mapped_ = nullptr;
+        }
+    }
+
+    void StreamingBuffer::BeginFrame() {
+        head_ = 0;
+
+        GLsync& fence = fences_[segment_];
+        if (!fence) {
+            return;
+        }
+
+        // Usually signaled long ago, only blocks if the CPU is more than FRAMES_IN_FLIGHT frames ahead.
+        GLenum result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while (result == GL_TIMEOUT_EXPIRED) {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000); // 1 ms.
+        }
+
+        if (result == GL_WAIT_FAILED) {
+            throw std::runtime_error("Failed to wait for streaming buffer segment.");
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamingBuffer::EndFrame() {
+        fences_[segment_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        segment_ = (segment_ + 1) % FRAMES_IN_FLIGHT;
+    }
+
+    StreamingBuffer::Allocation StreamingBuffer::Allocate(std::size_t size, GLenum target) {
+        std::size_t alignment = static_cast<std::size_t>(target == GL_SHADER_STORAGE_BUFFER ? storageAlignment_ : uniformAlignment_);
+        std::size_t offset = (head_ + alignment - 1) / alignment * alignment;
+
+        if (offset + size > segmentSize_) {
+            throw std::runtime_error("Streaming buffer segment of " + std::to_string(segmentSize_) + " bytes is full, requested " + std::to_string(size) + " more bytes.");
+        }
+
+        head_ = offset + size;
+
+        std::size_t bufferOffset = segmentSize_ * segment_ + offset;
+        return { mapped_ + bufferOffset, static_cast<GLintptr>(bufferOffset), static_cast<GLsizeiptr>(size) };
+    }
+
+    StreamingBuffer::Allocation StreamingBuffer::Write(const void* data, std::size_t size, GLenum target) {
+        Allocation allocation = Allocate(size, target);
+        if (size > 0) {
+            std::memcpy(allocation.data, data, size);
+        }
+
+        return allocation;
+    }
+
+    void StreamingBuffer::BindRange(GLenum target, unsigned bindingPoint, const Allocation& allocation) const {
+        // Empty ranges cannot be bound.
+        if (allocation.size == 0) {
+            glBindBufferBase(target, bindingPoint, 0);
+            return;
+        }
+
+        glBindBufferRange(target, bindingPoint, buffer_, allocation.offset, allocation.size);
+    }
+
+    GLuint StreamingBuffer::ID() const {
+        return buffer_;
+    }
+
+    std::size_t StreamingBuffer::GetSegmentSize() const {
+        return segmentSize_;
+    }
+
+    std::size_t StreamingBuffer::GetFrameUsage() const {
+        return head_;
+    }
+
+    StreamingBuffer::StreamingBuffer() : buffer_(0),
+                                         mapped_(nullptr),
+                                         segmentSize_(0),
+                                         head_(0),
+                                         segment_(0),
+                                         fences_ { },
+                                         uniformAlignment_(256),
+                                         storageAlignment_(256)
+                                         {
+    }
+
+    StreamingBuffer::~StreamingBuffer() {
+    }
+
+}
@@ -1,5 +1,6 @@
 
 #include "common/api/buffer/vao.h"
+#include "common/api/backend.h"
 
 namespace Sandbox {
 
@@ -15,6 +16,7 @@ namespace Sandbox {
 
     VertexArrayObject::~VertexArrayObject() {
         glDeleteVertexArrays(1, &bufferID_);
+        Backend::State::OnVertexArrayDeleted(bufferID_);
     }
 
     VertexArrayObject::VertexArrayObject(const VertexArrayObject& other) : bufferID_(0),
@@ -69,11 +71,11 @@ namespace Sandbox {
 
     void VertexArrayObject::Bind() const {
         // VBOs/EBO get bound on initialization.
-        glBindVertexArray(bufferID_);
+        Backend::State::BindVertexArray(bufferID_);
     }
 
     void VertexArrayObject::Unbind() const {
-        glBindVertexArray(0);
+        Backend::State::BindVertexArray(0);
     }
 
     void VertexArrayObject::AddVBO(const std::string& name, const BufferLayout& bufferLayout) {
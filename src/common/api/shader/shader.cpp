@@ -3,17 +3,21 @@
 #include "common/utility/log.h"
 #include "common/application/application.h"
 #include "common/api/shader/shader_preprocessor.h"
+#include "common/api/backend.h"
 
 #define INVALID (-1)
 
 namespace Sandbox {
 
+    // Link IDs start at 1, 0 marks uniform handles that were never resolved.
+    static unsigned linkCount = 0u;
+
     void Shader::Bind() const {
-        glUseProgram(ID_);
+        Backend::State::UseProgram(ID_);
     }
 
     void Shader::Unbind() const {
-        glUseProgram(0);
+        Backend::State::UseProgram(0);
     }
 
     const std::string &Shader::GetName() const {
@@ -22,7 +26,8 @@ namespace Sandbox {
 
     Shader::Shader(const std::string& name, const std::initializer_list<std::string>& shaderComponentPaths) : IReloadable(shaderComponentPaths),
                                                                                                               name_(name),
-                                                                                                              ID_(INVALID)
+                                                                                                              ID_(INVALID),
+                                                                                                              linkID_(0u)
                                                                                                               {
         for (const std::string& filepath : shaderComponentPaths) {
             shaderComponents_.emplace(filepath, ShaderComponent(filepath));
@@ -32,6 +37,7 @@ namespace Sandbox {
 
     Shader::~Shader() {
         glDeleteProgram(ID_);
+        Backend::State::OnProgramDeleted(ID_);
     }
 
     void Shader::Recompile() {
@@ -121,9 +127,12 @@ namespace Sandbox {
         // Shader has already been initialized, do cleanup first.
         if (ID_ != INVALID) {
             glDeleteProgram(ID_);
-            uniformLocations_.clear();
+            Backend::State::OnProgramDeleted(ID_);
         }
         ID_ = shaderProgram;
+        linkID_ = ++linkCount;
+
+        ReflectUniforms();
 
         // Shader types are no longer necessary.
         for (int i = 0; i < numShaderComponents; ++i) {
@@ -133,8 +142,76 @@ namespace Sandbox {
         }
     }
 
+    void Shader::ReflectUniforms() {
+        uniformLocations_.clear();
+
+        // Names are only kept to report hash collisions.
+        std::unordered_map<std::uint64_t, std::string> names;
+
+        auto add = [this, &names](const std::string& name, GLint location) {
+            std::uint64_t hash = HashUniformName(name);
+
+            auto iterator = names.find(hash);
+            if (iterator != names.end() && iterator->second != name) {
+                throw std::runtime_error("Uniforms '" + iterator->second + "' and '" + name + "' of shader '" + name_ + "' have the same name hash.");
+            }
+
+            names.emplace(hash, name);
+            uniformLocations_.emplace(hash, location);
+        };
+
+        GLint uniformCount = 0;
+        glGetProgramiv(ID_, GL_ACTIVE_UNIFORMS, &uniformCount);
+
+        GLint maxNameLength = 0;
+        glGetProgramiv(ID_, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+        std::vector<GLchar> buffer(maxNameLength + 1);
+
+        for (GLint i = 0; i < uniformCount; ++i) {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(ID_, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type, buffer.data());
+
+            std::string name(buffer.data(), length);
+            GLint location = glGetUniformLocation(ID_, name.c_str());
+
+            // Members of uniform blocks have no location.
+            if (location == INVALID) {
+                continue;
+            }
+
+            add(name, location);
+
+            // Arrays are reported once as 'name[0]', elements are addressable by index and the array by its plain name.
+            std::size_t subscript = name.size() > 3 ? name.rfind("[0]") : std::string::npos;
+            if (subscript != std::string::npos && subscript == name.size() - 3) {
+                std::string base = name.substr(0, subscript);
+                add(base, location);
+
+                for (GLint element = 1; element < size; ++element) {
+                    std::string elementName = base + "[" + std::to_string(element) + "]";
+                    add(elementName, glGetUniformLocation(ID_, elementName.c_str()));
+                }
+            }
+        }
+    }
+
+    GLint Shader::GetUniformLocation(const UniformName& uniformName) const {
+        auto iterator = uniformLocations_.find(uniformName.GetHash());
+        if (iterator == uniformLocations_.end()) {
+            return INVALID;
+        }
+
+        return iterator->second;
+    }
+
     GLuint Shader::GetID() const {
         return ID_;
     }
 
+    unsigned Shader::GetLinkID() const {
+        return linkID_;
+    }
+
 }
\ No newline at end of file
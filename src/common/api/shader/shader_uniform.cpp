@@ -22,8 +22,8 @@ namespace Sandbox {
         _maxSliderRange = other._maxSliderRange;
     }
 
-    void ShaderUniform::OnImGui() {
-        OnImGuiHelper<SUPPORTED_UNIFORM_TYPES>();
+    bool ShaderUniform::OnImGui() {
+        return OnImGuiHelper<SUPPORTED_UNIFORM_TYPES>();
     }
 
     void ShaderUniform::Bind(Shader *shaderProgram) const {
@@ -51,4 +51,8 @@ namespace Sandbox {
         return _uniformData;
     }
 
+    const ShaderUniform::UniformEntry& ShaderUniform::GetData() const {
+        return _uniformData;
+    }
+
 }
@@ -3,10 +3,22 @@
 #include "common/api/backend.h"
 #include "common/utility/log.h"
 
+#if defined(SANDBOX_EGL)
+    // EGL would otherwise pull in X11 headers, which define macros clashing with names used throughout the project.
+    #define EGL_NO_X11
+    #include <EGL/egl.h>
+    #include <EGL/eglext.h>
+#endif
+
 namespace Sandbox {
 
     Window::Window() : window_(nullptr),
-                       dimensions_(glm::ivec2(1280, 720))
+                       dimensions_(glm::ivec2(1280, 720)),
+                       headless_(false),
+                       closed_(false),
+                       eglDisplay_(nullptr),
+                       eglContext_(nullptr),
+                       eglSurface_(nullptr)
                        {
     }
 
@@ -14,28 +26,13 @@ namespace Sandbox {
     }
 
     void Window::Init() {
-        // Initialize GLFW.
-        int initializationCode = glfwInit();
-        if (!initializationCode) {
-            throw std::runtime_error("Failed to initialize GLFW.");
-        }
+        start_ = std::chrono::steady_clock::now();
 
-        // Setting up OpenGL properties
-        glfwWindowHint(GLFW_SAMPLES, 1); // change for anti-aliasing
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-        // Create window.
-        window_ = glfwCreateWindow(dimensions_.x, dimensions_.y, "OpenGL Sandbox", nullptr, nullptr);
-        if (!window_) {
-            throw std::runtime_error("Failed to create GLFW window.");
+        if (headless_) {
+            InitEGL();
         }
-
-        // Initialize OpenGL.
-        glfwMakeContextCurrent(window_);
-        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
-            throw std::runtime_error("Failed to initialize Glad (OpenGL).");
+        else {
+            InitGLFW();
         }
 
         ImGuiLog& log = ImGuiLog::Instance();
@@ -43,42 +40,80 @@ namespace Sandbox {
         log.LogTrace("Renderer: %s", (const char*)glGetString(GL_RENDERER));
         log.LogTrace("OpenGL Version: %s", (const char*)glGetString(GL_VERSION));
 
-        // Setup Dear ImGui context
-        IMGUI_CHECKVERSION();
-        ImGui::CreateContext();
-        ImGuiIO& io = ImGui::GetIO();
+        InitImGui();
+    }
 
-        std::string fontFilepath = ConvertToNativeSeparators(GetWorkingDirectory() + "/assets/fonts/inconsolata/Inconsolata-Regular.ttf");
-        io.FontDefault = io.Fonts->AddFontFromFileTTF(fontFilepath.c_str(), 17.0f);
-        ImGui::StyleColorsDark();
+    void Window::Shutdown() {
+        if (!headless_) {
+            glfwDestroyWindow(window_);
+            glfwTerminate();
+            return;
+        }
 
-        // Initialize ImGui Flags.
-        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
-        io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+#if defined(SANDBOX_EGL)
+        EGLDisplay display = static_cast<EGLDisplay>(eglDisplay_);
+        eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
 
-        // Setup Platform/Renderer backend.
-        ImGui_ImplGlfw_InitForOpenGL(window_, true);
-        ImGui_ImplOpenGL3_Init("#version 130");
-    }
+        if (eglSurface_ != EGL_NO_SURFACE) {
+            eglDestroySurface(display, static_cast<EGLSurface>(eglSurface_));
+        }
 
-    void Window::Shutdown() {
-        glfwDestroyWindow(window_);
-        glfwTerminate();
+        eglDestroyContext(display, static_cast<EGLContext>(eglContext_));
+        eglTerminate(display);
+#endif
+
+        eglDisplay_ = nullptr;
+        eglContext_ = nullptr;
+        eglSurface_ = nullptr;
     }
 
     bool Window::IsActive() {
-        return (glfwGetKey(window_, GLFW_KEY_ESCAPE) != GLFW_PRESS) && (glfwWindowShouldClose(window_) == 0);
+        if (headless_) {
+            return !closed_;
+        }
+
+        return !closed_ && (glfwGetKey(window_, GLFW_KEY_ESCAPE) != GLFW_PRESS) && (glfwWindowShouldClose(window_) == 0);
     }
 
     void Window::PollEvents() {
+        if (headless_) {
+            return;
+        }
+
         glfwPollEvents();
     }
 
     void Window::SwapBuffers() {
+        // Nothing is presented, scenes render into their own framebuffers.
+        if (headless_) {
+            return;
+        }
+
         glfwSwapBuffers(window_);
     }
 
+    void Window::SetHeadless(bool headless) {
+        headless_ = headless;
+    }
+
+    bool Window::IsHeadless() const {
+        return headless_;
+    }
+
+    void Window::Close() {
+        closed_ = true;
+    }
+
+    double Window::GetTime() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
     bool Window::CheckForResize() {
+        // Headless windows keep the dimensions they were created with.
+        if (headless_) {
+            return false;
+        }
+
         int width;
         int height;
         glfwGetFramebufferSize(window_, &width, &height);
@@ -110,6 +145,10 @@ namespace Sandbox {
     }
 
     void Window::SetName(const std::string& name) {
+        if (headless_) {
+            return;
+        }
+
         glfwSetWindowTitle(window_, name.c_str());
     }
 
@@ -125,4 +164,146 @@ namespace Sandbox {
         dimensions_ = dimensions;
     }
 
-}
\ No newline at end of file
+    void Window::InitGLFW() {
+        // Initialize GLFW.
+        int initializationCode = glfwInit();
+        if (!initializationCode) {
+            throw std::runtime_error("Failed to initialize GLFW.");
+        }
+
+        // Setting up OpenGL properties
+        glfwWindowHint(GLFW_SAMPLES, 1); // change for anti-aliasing
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+        // Create window.
+        window_ = glfwCreateWindow(dimensions_.x, dimensions_.y, "OpenGL Sandbox", nullptr, nullptr);
+        if (!window_) {
+            throw std::runtime_error("Failed to create GLFW window.");
+        }
+
+        // Initialize OpenGL.
+        glfwMakeContextCurrent(window_);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress)) {
+            throw std::runtime_error("Failed to initialize Glad (OpenGL).");
+        }
+    }
+
+    void Window::InitEGL() {
+#if defined(SANDBOX_EGL)
+        // Surfaceless platform needs no display server at all (Mesa), fall back to the default display otherwise.
+        EGLDisplay display = EGL_NO_DISPLAY;
+
+        const char* clientExtensions = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+        if (clientExtensions && std::strstr(clientExtensions, "EGL_MESA_platform_surfaceless")) {
+            auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(eglGetProcAddress("eglGetPlatformDisplayEXT"));
+            if (getPlatformDisplay) {
+                display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+            }
+        }
+
+        if (display == EGL_NO_DISPLAY) {
+            display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+
+        EGLint major = 0;
+        EGLint minor = 0;
+        if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+            throw std::runtime_error("Failed to initialize EGL display.");
+        }
+
+        const EGLint configAttributes[] = {
+            EGL_SURFACE_TYPE, EGL_PBUFFER_BIT,
+            EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+            EGL_RED_SIZE, 8,
+            EGL_GREEN_SIZE, 8,
+            EGL_BLUE_SIZE, 8,
+            EGL_ALPHA_SIZE, 8,
+            EGL_DEPTH_SIZE, 24,
+            EGL_NONE
+        };
+
+        EGLConfig config = nullptr;
+        EGLint configCount = 0;
+        if (!eglChooseConfig(display, configAttributes, &config, 1, &configCount) || configCount == 0) {
+            throw std::runtime_error("Failed to find an EGL config for offscreen rendering.");
+        }
+
+        if (!eglBindAPI(EGL_OPENGL_API)) {
+            throw std::runtime_error("Failed to bind the desktop OpenGL API through EGL.");
+        }
+
+        const EGLint contextAttributes[] = {
+            EGL_CONTEXT_MAJOR_VERSION, 4,
+            EGL_CONTEXT_MINOR_VERSION, 6,
+            EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+            EGL_NONE
+        };
+
+        EGLContext context = eglCreateContext(display, config, EGL_NO_CONTEXT, contextAttributes);
+        if (context == EGL_NO_CONTEXT) {
+            throw std::runtime_error("Failed to create OpenGL 4.6 context through EGL.");
+        }
+
+        // Without a surface there is no default framebuffer, scenes only ever render into their own.
+        EGLSurface surface = EGL_NO_SURFACE;
+
+        const char* displayExtensions = eglQueryString(display, EGL_EXTENSIONS);
+        if (!displayExtensions || !std::strstr(displayExtensions, "EGL_KHR_surfaceless_context")) {
+            const EGLint surfaceAttributes[] = {
+                EGL_WIDTH, dimensions_.x,
+                EGL_HEIGHT, dimensions_.y,
+                EGL_NONE
+            };
+
+            surface = eglCreatePbufferSurface(display, config, surfaceAttributes);
+            if (surface == EGL_NO_SURFACE) {
+                throw std::runtime_error("Failed to create EGL pbuffer surface.");
+            }
+        }
+
+        if (!eglMakeCurrent(display, surface, surface, context)) {
+            throw std::runtime_error("Failed to make EGL context current.");
+        }
+
+        eglDisplay_ = display;
+        eglContext_ = context;
+        eglSurface_ = surface;
+
+        if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+            throw std::runtime_error("Failed to initialize Glad (OpenGL).");
+        }
+
+        ImGuiLog::Instance().LogTrace("Headless EGL %i.%i context (%s).", major, minor, surface == EGL_NO_SURFACE ? "surfaceless" : "pbuffer");
+#else
+        throw std::runtime_error("Headless rendering requires EGL, which was not found when the project was configured.");
+#endif
+    }
+
+    void Window::InitImGui() {
+        // Setup Dear ImGui context
+        IMGUI_CHECKVERSION();
+        ImGui::CreateContext();
+        ImGuiIO& io = ImGui::GetIO();
+
+        // Headless windows keep a context for settings and layout files, but never start an ImGui frame.
+        if (headless_) {
+            io.DisplaySize = ImVec2(static_cast<float>(dimensions_.x), static_cast<float>(dimensions_.y));
+            return;
+        }
+
+        std::string fontFilepath = ConvertToNativeSeparators(GetWorkingDirectory() + "/assets/fonts/inconsolata/Inconsolata-Regular.ttf");
+        io.FontDefault = io.Fonts->AddFontFromFileTTF(fontFilepath.c_str(), 17.0f);
+        ImGui::StyleColorsDark();
+
+        // Initialize ImGui Flags.
+        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+        io.ConfigFlags |= ImGuiConfigFlags_DockingEnable;
+
+        // Setup Platform/Renderer backend.
+        ImGui_ImplGlfw_InitForOpenGL(window_, true);
+        ImGui_ImplOpenGL3_Init("#version 130");
+    }
+
+}
@@ -2,22 +2,41 @@
 #include "common/application/application.h"
 #include "common/api/backend.h"
 #include "common/application/time.h"
+#include "common/application/input.h"
+#include "common/application/asset_streamer.h"
+#include "common/application/readback_service.h"
+#include "common/api/buffer/geometry_arena.h"
+#include "common/api/buffer/streaming_buffer.h"
+#include "common/utility/profiler.h"
+#include "common/utility/log.h"
 #include "common/ecs/ecs.h"
 
 namespace Sandbox {
 
-    Application::Application() {
+    Application::Application() : frameLimit_(-1),
+                                 exitCode_(0),
+                                 cameraRecordingTime_(0.0f),
+                                 cameraPlaybackTime_(0.0f),
+                                 cameraPlaybackSpeed_(1.0f),
+                                 cameraPlaybackInterpolation_(CameraPath::Interpolation::CatmullRom)
+                                 {
     }
 
     Application::~Application() {
     }
 
-    void Application::Init(int width, int height) {
+    void Application::Init(int width, int height, bool headless) {
         Window& window = Window::Instance();
         window.SetDimensions(glm::ivec2(width, height));
+        window.SetHeadless(headless);
         window.Init();
 
+        Profiler::Instance().Init();
         ECS::Instance().Init();
+        GeometryArena::Instance().Init();
+        StreamingBuffer::Instance().Init();
+        AssetStreamer::Instance().Init();
+        ReadbackService::Instance().Init();
         sceneManager_.Init();
     }
 
@@ -26,14 +45,39 @@ namespace Sandbox {
         static float previous = 0.0f;
 
         Window& window = Window::Instance();
+        bool headless = window.IsHeadless();
+        int frame = 0;
 
         while (window.IsActive()) {
+            if (frameLimit_ >= 0 && frame >= frameLimit_) {
+                break;
+            }
+            ++frame;
+
             // Prepare for a new frame.
             // dt calculations.
-            current = static_cast<float>(glfwGetTime());
+            current = static_cast<float>(window.GetTime());
             Time::Instance().dt = current - previous;
             previous = current;
 
+            if (benchmark_ || renderTest_ || frameCapture_ || cameraPlayback_) {
+                // Fixed time step keeps frames identical between runs.
+                Time::Instance().dt = Time::FIXED_TIME_STEP;
+            }
+
+            // ImGui changes OpenGL state outside of the backend.
+            Backend::State::BeginFrame();
+
+            // Per-frame uniform and storage data is written from here on.
+            StreamingBuffer::Instance().BeginFrame();
+
+            Profiler& profiler = Profiler::Instance();
+            profiler.BeginFrame();
+
+            if (benchmark_) {
+                benchmark_->BeginFrame();
+            }
+
             // Clear canvas.
             Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
             Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -41,9 +85,13 @@ namespace Sandbox {
             window.PollEvents(); // Needs to be called before ImGui::NewFrame().
 
             // ImGui.
-            ImGui_ImplOpenGL3_NewFrame();
-            ImGui_ImplGlfw_NewFrame();
-            ImGui::NewFrame();
+            if (!headless) {
+                ImGui_ImplOpenGL3_NewFrame();
+                ImGui_ImplGlfw_NewFrame();
+                ImGui::NewFrame();
+
+                sceneManager_.OnImGui();
+            }
 
             ECS& ecs = ECS::Instance();
 
@@ -53,7 +101,19 @@ namespace Sandbox {
                 sceneManager_.SwitchScenes();
             }
 
-            ecs.Update();
+            {
+                PROFILE_SCOPE("Update");
+                ecs.Update();
+
+                // Upload assets that finished loading in the background.
+                AssetStreamer::Instance().Update();
+
+                // Write out screenshots and render target dumps whose readbacks have finished.
+                ReadbackService::Instance().Update();
+
+                // Release geometry of destroyed meshes and compact the shared geometry buffers.
+                GeometryArena::Instance().Update();
+            }
 
             // Scene processing.
             IScene* scene = sceneManager_.GetActiveScene();
@@ -64,30 +124,165 @@ namespace Sandbox {
                 }
 
                 // Run currently active scene.
-                scene->OnUpdate();
+                {
+                    PROFILE_SCOPE("OnUpdate");
+                    scene->OnUpdate();
+                }
+
+                UpdateCameraPaths(scene);
 
-                scene->OnPreRender();
-                scene->OnRender();
-                scene->OnPostRender();
+                {
+                    PROFILE_GPU_SCOPE("OnRender");
+                    scene->OnPreRender();
+                    scene->OnRender();
+                    scene->OnPostRender();
+                }
+
+                if (renderTest_) {
+                    renderTest_->Update(sceneManager_);
+                }
+
+                if (frameCapture_) {
+                    frameCapture_->Capture(scene);
+                }
 
-                scene->OnImGui();
+                if (!headless) {
+                    PROFILE_SCOPE("OnImGui");
+                    scene->OnImGui();
+                }
             }
 
 
             // Scene rendering.
-            ImGui::Render();
-            ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            if (!headless) {
+                PROFILE_GPU_SCOPE("ImGui");
+                ImGui::Render();
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+            }
+
+            StreamingBuffer::Instance().EndFrame();
+            profiler.EndFrame();
 
             window.SwapBuffers();
+
+            if (renderTest_ && renderTest_->IsFinished()) {
+                renderTest_->WriteReport();
+                exitCode_ = renderTest_->Passed() ? 0 : 1;
+                break;
+            }
+
+            if (cameraPlayback_) {
+                cameraPlaybackTime_ += Time::FIXED_TIME_STEP * cameraPlaybackSpeed_;
+
+                if (!benchmark_ && cameraPlaybackTime_ > cameraPlayback_->GetKeyframes().back().time) {
+                    break;
+                }
+            }
+
+            if (benchmark_) {
+                benchmark_->EndFrame();
+
+                if (benchmark_->IsFinished()) {
+                    benchmark_->WriteResults();
+                    break;
+                }
+            }
         }
     }
 
     void Application::Shutdown() {
+        if (frameCapture_) {
+            frameCapture_->Finish();
+            frameCapture_.reset();
+        }
+
+        if (cameraRecording_ && !cameraRecording_->IsEmpty()) {
+            cameraRecording_->Save(cameraRecordingFile_);
+            ImGuiLog::Instance().LogTrace("Camera path of %.2f seconds written to: %s", cameraRecording_->GetDuration(), cameraRecordingFile_.c_str());
+        }
+
         sceneManager_.Shutdown();
+        AssetStreamer::Instance().Shutdown();
+        ReadbackService::Instance().Shutdown();
         ECS::Instance().Shutdown();
+        GeometryArena::Instance().Shutdown();
+        StreamingBuffer::Instance().Shutdown();
+        Profiler::Instance().Shutdown();
         Window::Instance().Shutdown();
     }
 
+    void Application::SetFrameLimit(int frames) {
+        frameLimit_ = frames;
+    }
+
+    void Application::SetBenchmark(const Benchmark::Settings& settings) {
+        benchmark_ = std::make_unique<Benchmark>(settings);
+
+        // Benchmarks are measured over a fixed number of frames, not a frame limit.
+        frameLimit_ = -1;
+
+        // Profiler provides per-pass timings.
+        Profiler::Instance().SetEnabled(true);
+        Input::Instance().SetEnabled(false);
+    }
+
+    void Application::SetRenderTest(const RenderTest::Settings& settings) {
+        renderTest_ = std::make_unique<RenderTest>(settings);
+        frameLimit_ = -1;
+
+        Input::Instance().SetEnabled(false);
+    }
+
+    void Application::SetFrameCapture(const FrameCapture::Settings& settings) {
+        frameCapture_ = std::make_unique<FrameCapture>(settings);
+    }
+
+    int Application::GetExitCode() const {
+        return exitCode_;
+    }
+
+    void Application::RecordCameraPath(const std::string& filepath) {
+        cameraRecordingFile_ = filepath;
+        cameraRecording_ = std::make_unique<CameraPath>();
+        cameraRecordingTime_ = 0.0f;
+    }
+
+    void Application::PlayCameraPath(const std::string& filepath, float speed, CameraPath::Interpolation interpolation) {
+        std::unique_ptr<CameraPath> path = std::make_unique<CameraPath>();
+        path->Load(filepath);
+
+        if (path->IsEmpty()) {
+            throw std::runtime_error("Camera path file '" + filepath + "' has no keyframes.");
+        }
+
+        cameraPlaybackTime_ = path->GetKeyframes().front().time;
+        cameraPlaybackSpeed_ = speed;
+        cameraPlaybackInterpolation_ = interpolation;
+        cameraPlayback_ = std::move(path);
+
+        Input::Instance().SetEnabled(false);
+    }
+
+    void Application::UpdateCameraPaths(IScene* scene) {
+        ICamera* camera = scene->GetCamera();
+        if (!camera) {
+            return;
+        }
+
+        if (cameraPlayback_) {
+            cameraPlayback_->Apply(*camera, cameraPlaybackTime_, cameraPlaybackInterpolation_);
+        }
+        else if (benchmark_) {
+            benchmark_->DriveCamera(scene);
+        }
+
+        // Records what is rendered, including played back paths.
+        if (cameraRecording_) {
+            cameraRecording_->AddKeyframe(*camera, cameraRecordingTime_);
+            cameraRecordingTime_ += Time::Instance().dt;
+        }
+    }
+
     SceneManager& Application::GetSceneManager() {
         return sceneManager_;
     }
@@ -0,0 +1,240 @@
+
+#include "common/application/asset_streamer.h"
+#include "common/geometry/object_loader.h"
+#include "common/ecs/ecs.h"
+#include "common/utility/log.h"
+#include "common/utility/profiler.h"
+
+namespace Sandbox {
+
+    AssetStreamer::AssetStreamer() : generation_(0),
+                                     numPendingRequests_(0),
+                                     frameBudget_(2.0f)
+                                     {
+    }
+
+    AssetStreamer::~AssetStreamer() {
+    }
+
+    void AssetStreamer::Init() {
+        workers_ = std::make_unique<ThreadPool>();
+        stagingBuffer_ = std::make_unique<PixelBufferObject>(PixelBufferObject::UNPACK);
+    }
+
+    void AssetStreamer::Update() {
+        PROFILE_SCOPE("AssetStreamer::Update");
+
+        typedef std::chrono::high_resolution_clock Clock;
+        Clock::time_point start = Clock::now();
+
+        // Always process at least one upload per frame to guarantee progress.
+        bool processed = false;
+
+        while (true) {
+            if (processed) {
+                std::chrono::duration<float, std::milli> elapsed = Clock::now() - start;
+                if (elapsed.count() >= frameBudget_) {
+                    break;
+                }
+            }
+
+            Upload upload;
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (uploads_.empty()) {
+                    break;
+                }
+
+                upload = std::move(uploads_.front());
+                uploads_.pop_front();
+            }
+
+            if (upload.generation != generation_) {
+                // Request was issued by a scene that has since been unloaded.
+                continue;
+            }
+
+            processed = true;
+            --numPendingRequests_;
+
+            if (upload.error) {
+                try {
+                    std::rethrow_exception(upload.error);
+                }
+                catch (const std::exception& exception) {
+                    ImGuiLog::Instance().LogError("Failed to stream asset '%s': %s", upload.filepath.c_str(), exception.what());
+                }
+
+                // Asset keeps its placeholder data.
+                upload.promise->set_exception(upload.error);
+                continue;
+            }
+
+            {
+                PROFILE_SCOPE("Upload asset");
+                upload.upload();
+            }
+
+            upload.promise->set_value();
+        }
+    }
+
+    void AssetStreamer::Shutdown() {
+        Reset();
+
+        workers_.reset();
+        stagingBuffer_.reset();
+    }
+
+    void AssetStreamer::Reset() {
+        ++generation_;
+
+        if (workers_) {
+            workers_->Clear();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        uploads_.clear();
+        numPendingRequests_ = 0;
+    }
+
+    std::shared_future<void> AssetStreamer::LoadTexture(Texture* texture, const std::string& filepath, std::function<void()> prepare) {
+        assert(texture);
+
+        // Neutral gray placeholder.
+        texture->SetData(1, 1, std::vector<unsigned char> { 128, 128, 128, 255 });
+
+        std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+        std::shared_future<void> future = promise->get_future().share();
+
+        Submit(filepath, [this, texture, filepath, prepare]() -> std::function<void()> {
+            if (prepare) {
+                prepare();
+            }
+
+            std::shared_ptr<Texture::ImageData> image = std::make_shared<Texture::ImageData>(Texture::Decode(filepath));
+
+            return [this, texture, image]() {
+                texture->SetData(*image, *stagingBuffer_);
+            };
+        }, promise);
+
+        return future;
+    }
+
+    std::shared_future<void> AssetStreamer::LoadMesh(int entityID, const std::string& filepath) {
+        return LoadMesh(std::vector<int> { entityID }, filepath);
+    }
+
+    std::shared_future<void> AssetStreamer::LoadMesh(const std::vector<int>& entityIDs, const std::string& filepath) {
+        ECS& ecs = ECS::Instance();
+        OBJLoader& loader = OBJLoader::Instance();
+        OBJLoader::Request request(filepath);
+
+        std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+        std::shared_future<void> future = promise->get_future().share();
+
+        auto assign = [](int entityID, const Mesh& mesh) {
+            ECS& ecs = ECS::Instance();
+
+            if (ecs.HasComponent<Mesh>(entityID)) {
+                ecs.GetComponent<Mesh>(entityID).Configure([&mesh](Mesh& component) {
+                    component = mesh;
+                    component.Complete();
+                });
+            }
+            else {
+                ecs.AddComponent<Mesh>(entityID, mesh).Configure([](Mesh& component) {
+                    component.Complete();
+                });
+            }
+        };
+
+        if (loader.IsLoaded(request)) {
+            // Mesh data is already available, no streaming necessary.
+            Mesh mesh = loader.LoadFromFile(request);
+
+            for (int entityID : entityIDs) {
+                assign(entityID, mesh);
+            }
+
+            promise->set_value();
+            return future;
+        }
+
+        Mesh placeholder = loader.LoadSphere();
+
+        for (int entityID : entityIDs) {
+            if (!ecs.HasComponent<Mesh>(entityID)) {
+                assign(entityID, placeholder);
+            }
+        }
+
+        Submit(filepath, [entityIDs, filepath]() -> std::function<void()> {
+            std::shared_ptr<OBJLoader::MeshData> data = std::make_shared<OBJLoader::MeshData>(OBJLoader::Instance().Parse(OBJLoader::Request(filepath)));
+
+            return [entityIDs, filepath, data]() {
+                ECS& ecs = ECS::Instance();
+                Mesh mesh = OBJLoader::Instance().Create(OBJLoader::Request(filepath), *data);
+
+                for (int entityID : entityIDs) {
+                    // Entity was destroyed (or its mesh removed) while loading.
+                    if (!ecs.HasComponent<Mesh>(entityID)) {
+                        continue;
+                    }
+
+                    ecs.GetComponent<Mesh>(entityID).Configure([&mesh](Mesh& component) {
+                        component = mesh;
+                        component.Complete();
+                    });
+                }
+            };
+        }, promise);
+
+        return future;
+    }
+
+    void AssetStreamer::SetFrameBudget(float milliseconds) {
+        frameBudget_ = std::max(milliseconds, 0.0f);
+    }
+
+    float AssetStreamer::GetFrameBudget() const {
+        return frameBudget_;
+    }
+
+    int AssetStreamer::GetPendingRequestCount() const {
+        return numPendingRequests_;
+    }
+
+    void AssetStreamer::Submit(const std::string& filepath, std::function<std::function<void()>()> work, const std::shared_ptr<std::promise<void>>& promise) {
+        if (!workers_) {
+            throw std::runtime_error("AssetStreamer::Submit called before AssetStreamer::Init.");
+        }
+
+        int generation = generation_;
+        ++numPendingRequests_;
+
+        // Future returned by the thread pool is not needed, results are communicated through the upload queue.
+        (void) workers_->Submit([this, filepath, work = std::move(work), promise, generation]() {
+            Upload upload { };
+            upload.generation = generation;
+            upload.promise = promise;
+            upload.filepath = filepath;
+
+            try {
+                PROFILE_SCOPE("Load asset");
+                upload.upload = work();
+            }
+            catch (...) {
+                upload.error = std::current_exception();
+            }
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            uploads_.emplace_back(std::move(upload));
+        });
+
+        ImGuiLog::Instance().LogTrace("Streaming asset: '%s'", filepath.c_str());
+    }
+
+}
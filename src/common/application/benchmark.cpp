@@ -0,0 +1,353 @@
+
+#include "common/application/benchmark.h"
+#include "common/application/asset_streamer.h"
+#include "common/api/backend.h"
+#include "common/api/window.h"
+#include "common/utility/profiler.h"
+#include "common/utility/directory.h"
+#include "common/utility/log.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+namespace Sandbox {
+
+    // GL_NVX_gpu_memory_info, values are in kilobytes.
+    static const GLenum GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX = 0x9047;
+    static const GLenum GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX = 0x9049;
+
+    static bool HasExtension(const char* name) {
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &count);
+
+        for (GLint i = 0; i < count; ++i) {
+            const char* extension = reinterpret_cast<const char*>(glGetStringi(GL_EXTENSIONS, static_cast<GLuint>(i)));
+            if (extension && std::strcmp(extension, name) == 0) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // Kilobytes, -1 if not available on this platform.
+    static long long GetPeakResidentMemory() {
+#if defined(__APPLE__)
+        rusage usage { };
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<long long>(usage.ru_maxrss) / 1024; // Bytes.
+#elif defined(__unix__)
+        rusage usage { };
+        getrusage(RUSAGE_SELF, &usage);
+        return static_cast<long long>(usage.ru_maxrss);
+#else
+        return -1;
+#endif
+    }
+
+    // Contents of a JSON string literal.
+    static std::string EscapeJSON(const std::string& value) {
+        std::stringstream escaped;
+
+        for (char character : value) {
+            switch (character) {
+                case '"':
+                    escaped << "\\\"";
+                    break;
+                case '\\':
+                    escaped << "\\\\";
+                    break;
+                case '\n':
+                    escaped << "\\n";
+                    break;
+                case '\r':
+                    escaped << "\\r";
+                    break;
+                case '\t':
+                    escaped << "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(character) < 0x20u) {
+                        escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(character) << std::dec;
+                    }
+                    else {
+                        escaped << character;
+                    }
+                    break;
+            }
+        }
+
+        return escaped.str();
+    }
+
+    // Nearest rank, 'values' must be sorted.
+    static double GetPercentile(const std::vector<double>& values, double percentile) {
+        std::size_t rank = static_cast<std::size_t>(std::ceil(percentile / 100.0 * static_cast<double>(values.size())));
+        return values[std::clamp<std::size_t>(rank, 1, values.size()) - 1];
+    }
+
+    Benchmark::Benchmark(Settings settings) : settings_(std::move(settings)),
+                                              frame_(0),
+                                              warmupFrames_(-1),
+                                              firstProfilerFrame_(0u),
+                                              nextProfilerFrame_(0u),
+                                              cameraCaptured_(false),
+                                              cameraStart_(0.0f),
+                                              cameraPivot_(0.0f),
+                                              peakVideoMemory_(-1),
+                                              videoMemoryQuery_(-1)
+                                              {
+        if (settings_.frames <= 0) {
+            throw std::runtime_error("Benchmark needs to measure at least one frame.");
+        }
+
+        samples_.reserve(settings_.frames);
+    }
+
+    Benchmark::~Benchmark() {
+    }
+
+    void Benchmark::BeginFrame() {
+        frameStart_ = std::chrono::steady_clock::now();
+
+        if (warmupFrames_ < 0 && frame_ >= settings_.warmup && AssetStreamer::Instance().GetPendingRequestCount() == 0) {
+            warmupFrames_ = frame_;
+
+            // Profiler has begun this frame already.
+            firstProfilerFrame_ = Profiler::Instance().GetFrameIndex();
+            nextProfilerFrame_ = firstProfilerFrame_;
+
+            ImGuiLog::Instance().LogTrace("Benchmark '%s' warmed up after %i frames, measuring %i frames.", settings_.scene.c_str(), warmupFrames_, settings_.frames);
+        }
+    }
+
+    void Benchmark::EndFrame() {
+        ++frame_;
+
+        if (!IsMeasuring()) {
+            return;
+        }
+
+        std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - frameStart_;
+
+        // Counters of the frame that just ended, they are reset when the next frame begins.
+        const Backend::Rendering::Statistics& rendering = Backend::Rendering::GetCurrentStatistics();
+        const Backend::State::Statistics& state = Backend::State::GetCurrentStatistics();
+        long long triangles = rendering.indirectDrawCalls > 0 ? -1 : rendering.triangles;
+        samples_.push_back({ frameTime.count(), rendering.drawCalls, triangles, state.issued });
+
+        SampleMemory();
+        CollectProfilerFrames();
+    }
+
+    void Benchmark::DriveCamera(IScene* scene) {
+        ICamera* camera = scene->GetCamera();
+        if (!camera) {
+            return;
+        }
+
+        if (!cameraCaptured_) {
+            // Orbit around the point the camera initially looks at, at the distance the camera has from the origin.
+            cameraStart_ = camera->GetPosition();
+            cameraPivot_ = cameraStart_ + camera->GetForwardVector() * std::max(glm::length(cameraStart_), 1.0f);
+            cameraCaptured_ = true;
+        }
+
+        // Camera holds its starting view during warmup.
+        float progress = IsMeasuring() ? static_cast<float>(samples_.size()) / static_cast<float>(settings_.frames) : 0.0f;
+        glm::mat4 rotation = glm::rotate(glm::mat4(1.0f), glm::radians(360.0f * progress), glm::vec3(0.0f, 1.0f, 0.0f));
+
+        camera->SetPosition(cameraPivot_ + glm::vec3(rotation * glm::vec4(cameraStart_ - cameraPivot_, 0.0f)));
+        camera->SetTargetPosition(cameraPivot_);
+    }
+
+    bool Benchmark::IsFinished() const {
+        return warmupFrames_ >= 0 && static_cast<int>(samples_.size()) >= settings_.frames;
+    }
+
+    void Benchmark::WriteResults() {
+        if (samples_.empty()) {
+            throw std::runtime_error("Benchmark '" + settings_.scene + "' finished without measuring any frames.");
+        }
+
+        // GPU times of the last frames are still in flight.
+        Profiler::Instance().Flush();
+        CollectProfilerFrames();
+
+        double frames = static_cast<double>(samples_.size());
+
+        std::vector<double> frameTimes;
+        double frameTimeSum = 0.0;
+        double drawCallSum = 0.0;
+        double triangleSum = 0.0;
+        double stateChangeSum = 0.0;
+        bool trianglesKnown = true;
+        Sample maximum { 0.0, 0, 0, 0 };
+
+        for (const Sample& sample : samples_) {
+            frameTimes.push_back(sample.frameTime);
+            frameTimeSum += sample.frameTime;
+
+            drawCallSum += sample.drawCalls;
+            triangleSum += static_cast<double>(sample.triangles);
+            trianglesKnown = trianglesKnown && sample.triangles >= 0;
+            stateChangeSum += sample.stateChanges;
+
+            maximum.drawCalls = std::max(maximum.drawCalls, sample.drawCalls);
+            maximum.triangles = std::max(maximum.triangles, sample.triangles);
+            maximum.stateChanges = std::max(maximum.stateChanges, sample.stateChanges);
+        }
+
+        std::sort(frameTimes.begin(), frameTimes.end());
+
+        std::string filepath = settings_.outputDirectory + "/" + ProcessName(settings_.scene);
+        CreateDirectory(settings_.outputDirectory);
+
+        // Summary.
+        {
+            std::ofstream file(filepath + ".json");
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open benchmark results file '" + filepath + ".json'.");
+            }
+
+            Window& window = Window::Instance();
+
+            file << std::fixed << std::setprecision(4);
+            file << "{\n";
+            file << "  \"scene\": \"" << EscapeJSON(settings_.scene) << "\",\n";
+            file << "  \"renderer\": \"" << EscapeJSON(reinterpret_cast<const char*>(glGetString(GL_RENDERER))) << "\",\n";
+            file << "  \"resolution\": [" << window.GetWidth() << ", " << window.GetHeight() << "],\n";
+            file << "  \"headless\": " << (window.IsHeadless() ? "true" : "false") << ",\n";
+            file << "  \"warmupFrames\": " << warmupFrames_ << ",\n";
+            file << "  \"frames\": " << samples_.size() << ",\n";
+
+            file << "  \"frameTime\": {";
+            file << " \"min\": " << frameTimes.front() << ", \"mean\": " << frameTimeSum / frames;
+            file << ", \"p50\": " << GetPercentile(frameTimes, 50.0) << ", \"p95\": " << GetPercentile(frameTimes, 95.0) << ", \"p99\": " << GetPercentile(frameTimes, 99.0);
+            file << ", \"max\": " << frameTimes.back() << " },\n";
+
+            file << "  \"drawCalls\": { \"mean\": " << drawCallSum / frames << ", \"max\": " << maximum.drawCalls << " },\n";
+            // Frames with indirect draws have no triangle count.
+            if (trianglesKnown) {
+                file << "  \"triangles\": { \"mean\": " << triangleSum / frames << ", \"max\": " << maximum.triangles << " },\n";
+            }
+            else {
+                file << "  \"triangles\": null,\n";
+            }
+            file << "  \"stateChanges\": { \"mean\": " << stateChangeSum / frames << ", \"max\": " << maximum.stateChanges << " },\n";
+
+            // Mean milliseconds per measured frame, nested zones are included in their parents as well.
+            file << "  \"passes\": [";
+            bool first = true;
+            for (const std::pair<const std::string, PassTimes>& pass : passes_) {
+                file << (first ? "\n" : ",\n");
+                file << "    { \"name\": \"" << EscapeJSON(pass.first) << "\", \"cpu\": " << pass.second.cpu / frames << ", \"gpu\": ";
+                if (pass.second.gpuCount > 0) {
+                    file << pass.second.gpu / frames;
+                }
+                else {
+                    file << "null";
+                }
+                file << " }";
+                first = false;
+            }
+            file << "\n  ],\n";
+
+            // Unavailable values are written as null.
+            auto writeMemory = [&file](long long kilobytes) {
+                if (kilobytes >= 0) {
+                    file << kilobytes;
+                }
+                else {
+                    file << "null";
+                }
+            };
+
+            file << "  \"memory\": { \"peakResidentKB\": ";
+            writeMemory(GetPeakResidentMemory());
+            file << ", \"peakVideoKB\": ";
+            writeMemory(peakVideoMemory_);
+            file << " }\n";
+            file << "}\n";
+        }
+
+        // Per-frame samples.
+        {
+            std::ofstream file(filepath + "_frames.csv");
+            if (!file.is_open()) {
+                throw std::runtime_error("Failed to open benchmark results file '" + filepath + "_frames.csv'.");
+            }
+
+            file << std::fixed << std::setprecision(4);
+            file << "frame,frame_time_ms,draw_calls,triangles,state_changes\n";
+
+            for (std::size_t i = 0; i < samples_.size(); ++i) {
+                const Sample& sample = samples_[i];
+                file << i << "," << sample.frameTime << "," << sample.drawCalls << ",";
+
+                // Left empty for frames with indirect draws.
+                if (sample.triangles >= 0) {
+                    file << sample.triangles;
+                }
+
+                file << "," << sample.stateChanges << "\n";
+            }
+        }
+
+        ImGuiLog::Instance().LogTrace("Benchmark '%s': %.3f ms mean, %.3f ms p99 frame time. Results written to: %s.json", settings_.scene.c_str(), frameTimeSum / frames, GetPercentile(frameTimes, 99.0), filepath.c_str());
+    }
+
+    bool Benchmark::IsMeasuring() const {
+        return warmupFrames_ >= 0 && static_cast<int>(samples_.size()) < settings_.frames;
+    }
+
+    void Benchmark::CollectProfilerFrames() {
+        unsigned lastProfilerFrame = firstProfilerFrame_ + static_cast<unsigned>(samples_.size());
+
+        for (const Profiler::Frame& frame : Profiler::Instance().GetHistory()) {
+            if (frame.index < nextProfilerFrame_) {
+                continue;
+            }
+
+            // Frames resolve in order, later ones are picked up by the next call.
+            if (frame.index >= lastProfilerFrame || !frame.resolved) {
+                break;
+            }
+
+            for (const Profiler::Zone& zone : frame.zones) {
+                PassTimes& pass = passes_[zone.name];
+
+                if (zone.thread < 0) {
+                    pass.gpu += zone.duration;
+                    ++pass.gpuCount;
+                }
+                else {
+                    pass.cpu += zone.duration;
+                    ++pass.cpuCount;
+                }
+            }
+
+            nextProfilerFrame_ = frame.index + 1;
+        }
+    }
+
+    void Benchmark::SampleMemory() {
+        if (videoMemoryQuery_ < 0) {
+            videoMemoryQuery_ = HasExtension("GL_NVX_gpu_memory_info") ? 1 : 0;
+        }
+
+        if (videoMemoryQuery_ == 0) {
+            return;
+        }
+
+        // Estimate, includes memory used by other processes.
+        GLint total = 0;
+        GLint available = 0;
+        glGetIntegerv(GPU_MEMORY_INFO_DEDICATED_VIDMEM_NVX, &total);
+        glGetIntegerv(GPU_MEMORY_INFO_CURRENT_AVAILABLE_VIDMEM_NVX, &available);
+
+        peakVideoMemory_ = std::max(peakVideoMemory_, static_cast<long long>(total - available));
+    }
+
+}
@@ -0,0 +1,217 @@
+
+#include "common/application/command_line.h"
+
+namespace Sandbox {
+
+    CommandLineOptions::CommandLineOptions() : help(false),
+                                               headless(false),
+                                               width(1920),
+                                               height(1080),
+                                               frames(-1),
+                                               benchmark(false),
+                                               warmup(60),
+                                               blurRadius(-1),
+                                               playbackSpeed(1.0f),
+                                               playbackInterpolation(CameraPath::Interpolation::CatmullRom),
+                                               renderTest(false),
+                                               updateReferences(false),
+                                               captureTarget("output"),
+                                               captureFormat(FrameCapture::Format::PNG)
+                                               {
+    }
+
+    static int ParseInteger(const std::string& option, const std::string& value, int minimum) {
+        std::size_t processed = 0;
+        int result = 0;
+
+        try {
+            result = std::stoi(value, &processed);
+        }
+        catch (const std::exception&) {
+            processed = 0;
+        }
+
+        if (processed != value.size() || result < minimum) {
+            throw std::runtime_error("Invalid value '" + value + "' for option '" + option + "', expected an integer of at least " + std::to_string(minimum) + ".");
+        }
+
+        return result;
+    }
+
+    static float ParsePositiveFloat(const std::string& option, const std::string& value) {
+        std::size_t processed = 0;
+        float result = 0.0f;
+
+        try {
+            result = std::stof(value, &processed);
+        }
+        catch (const std::exception&) {
+            processed = 0;
+        }
+
+        if (processed != value.size() || !(result > 0.0f)) {
+            throw std::runtime_error("Invalid value '" + value + "' for option '" + option + "', expected a positive number.");
+        }
+
+        return result;
+    }
+
+    static CameraPath::Interpolation ParseInterpolation(const std::string& option, const std::string& value) {
+        if (value == "linear") {
+            return CameraPath::Interpolation::Linear;
+        }
+        else if (value == "spline") {
+            return CameraPath::Interpolation::CatmullRom;
+        }
+
+        throw std::runtime_error("Invalid value '" + value + "' for option '" + option + "', expected 'linear' or 'spline'.");
+    }
+
+    static FrameCapture::Format ParseCaptureFormat(const std::string& option, const std::string& value) {
+        if (value == "png") {
+            return FrameCapture::Format::PNG;
+        }
+        else if (value == "qoi") {
+            return FrameCapture::Format::QOI;
+        }
+        else if (value == "raw") {
+            return FrameCapture::Format::RAW;
+        }
+        else if (value == "pipe") {
+            return FrameCapture::Format::PIPE;
+        }
+
+        throw std::runtime_error("Invalid value '" + value + "' for option '" + option + "', expected 'png', 'qoi', 'raw' or 'pipe'.");
+    }
+
+    // Formatted as <width>x<height>.
+    static void ParseResolution(const std::string& option, const std::string& value, int& width, int& height) {
+        std::size_t separator = value.find('x');
+        if (separator == std::string::npos) {
+            throw std::runtime_error("Invalid value '" + value + "' for option '" + option + "', expected <width>x<height>.");
+        }
+
+        width = ParseInteger(option, value.substr(0, separator), 1);
+        height = ParseInteger(option, value.substr(separator + 1), 1);
+    }
+
+    CommandLineOptions ParseCommandLine(int argc, char* argv[]) {
+        CommandLineOptions options;
+        bool frames = false;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string option = argv[i];
+
+            // Options taking a value consume the next argument.
+            auto value = [&]() -> std::string {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("Option '" + option + "' expects a value.");
+                }
+
+                return argv[++i];
+            };
+
+            if (option == "--help" || option == "-h") {
+                options.help = true;
+            }
+            else if (option == "--headless") {
+                options.headless = true;
+            }
+            else if (option == "--width") {
+                options.width = ParseInteger(option, value(), 1);
+            }
+            else if (option == "--height") {
+                options.height = ParseInteger(option, value(), 1);
+            }
+            else if (option == "--frames") {
+                options.frames = ParseInteger(option, value(), 1);
+                frames = true;
+            }
+            else if (option == "--resolution") {
+                ParseResolution(option, value(), options.width, options.height);
+            }
+            else if (option == "--scene") {
+                options.scene = value();
+            }
+            else if (option == "--benchmark") {
+                options.benchmark = true;
+                options.scene = value();
+            }
+            else if (option == "--warmup") {
+                options.warmup = ParseInteger(option, value(), 0);
+            }
+            else if (option == "--blur-radius") {
+                options.blurRadius = ParseInteger(option, value(), 0);
+            }
+            else if (option == "--record-camera") {
+                options.recordCamera = value();
+            }
+            else if (option == "--play-camera") {
+                options.playCamera = value();
+            }
+            else if (option == "--playback-speed") {
+                options.playbackSpeed = ParsePositiveFloat(option, value());
+            }
+            else if (option == "--interpolation") {
+                options.playbackInterpolation = ParseInterpolation(option, value());
+            }
+            else if (option == "--render-test") {
+                options.renderTest = true;
+            }
+            else if (option == "--update-references") {
+                options.renderTest = true;
+                options.updateReferences = true;
+            }
+            else if (option == "--references") {
+                options.references = value();
+            }
+            else if (option == "--capture") {
+                options.capture = value();
+            }
+            else if (option == "--capture-target") {
+                options.captureTarget = value();
+            }
+            else if (option == "--capture-format") {
+                options.captureFormat = ParseCaptureFormat(option, value());
+            }
+            else {
+                throw std::runtime_error("Unknown option '" + option + "'.");
+            }
+        }
+
+        if (options.benchmark && !frames) {
+            options.frames = 600;
+        }
+
+        return options;
+    }
+
+    std::string GetCommandLineUsage(const std::string& program) {
+        std::stringstream usage;
+        usage << "Usage: " << program << " [options]\n"
+              << "  --headless              Render offscreen through EGL, without a window or ImGui.\n"
+              << "  --width <pixels>        Window (or offscreen) width, 1920 by default.\n"
+              << "  --height <pixels>       Window (or offscreen) height, 1080 by default.\n"
+              << "  --resolution <WxH>      Width and height at once, e.g. 1280x720.\n"
+              << "  --frames <count>        Exit after rendering this many frames (measured frames when benchmarking, 600 by default).\n"
+              << "  --scene <name>          Start with the scene registered under this name.\n"
+              << "  --benchmark <name>      Run the scene registered under this name without input, then write frame statistics to out/benchmark.\n"
+              << "  --warmup <count>        Frames rendered before a benchmark starts measuring, 60 by default.\n"
+              << "  --blur-radius <pixels>  Radius of all shadow map blurs, overriding the radius set by the scene.\n"
+              << "  --record-camera <file>  Record the camera of the active scene every frame, written to this file on exit.\n"
+              << "  --play-camera <file>    Play back a recorded camera path at a fixed time step, without input. Exits when the path ends unless benchmarking.\n"
+              << "  --playback-speed <x>    Camera path playback speed, 1 by default.\n"
+              << "  --interpolation <mode>  Camera path interpolation between recorded frames, 'linear' or 'spline' (default).\n"
+              << "  --render-test           Compare render targets of every registered scene (or --scene) against reference images,\n"
+              << "                          writing results to out/golden. Exits with an error if any target differs.\n"
+              << "  --update-references     Run the render test, overwriting the reference images.\n"
+              << "  --references <dir>      Reference image directory, data/golden by default.\n"
+              << "  --capture <output>      Capture a render target every frame into this directory, or the encoder command for\n"
+              << "                          'pipe', e.g. \"ffmpeg -f rawvideo -pix_fmt rgba -s {width}x{height} -r 60 -i - out.mp4\".\n"
+              << "  --capture-target <name> Render target to capture, 'output' by default.\n"
+              << "  --capture-format <fmt>  'png' (default), 'qoi', 'raw' or 'pipe'.\n"
+              << "  --help                  Print this message.\n";
+        return usage.str();
+    }
+
+}
@@ -0,0 +1,395 @@
+
+#include "common/application/frame_capture.h"
+#include "common/utility/directory.h"
+#include "common/utility/log.h"
+#include "common/utility/profiler.h"
+
+#if defined(_WIN32)
+    #define popen _popen
+    #define pclose _pclose
+#endif
+
+namespace Sandbox {
+
+    static void Replace(std::string& string, const std::string& pattern, const std::string& replacement) {
+        for (std::size_t position = string.find(pattern); position != std::string::npos; position = string.find(pattern, position + replacement.size())) {
+            string.replace(position, pattern.size(), replacement);
+        }
+    }
+
+    static void WriteBigEndian(std::vector<unsigned char>& output, std::uint32_t value) {
+        output.push_back(static_cast<unsigned char>(value >> 24));
+        output.push_back(static_cast<unsigned char>(value >> 16));
+        output.push_back(static_cast<unsigned char>(value >> 8));
+        output.push_back(static_cast<unsigned char>(value));
+    }
+
+    // Quite OK Image format, see https://qoiformat.org/qoi-specification.pdf. Expects four channels.
+    static std::vector<unsigned char> EncodeQOI(const Texture::ImageData& image) {
+        static const unsigned char QOI_OP_INDEX = 0x00;
+        static const unsigned char QOI_OP_DIFF = 0x40;
+        static const unsigned char QOI_OP_LUMA = 0x80;
+        static const unsigned char QOI_OP_RUN = 0xc0;
+        static const unsigned char QOI_OP_RGB = 0xfe;
+        static const unsigned char QOI_OP_RGBA = 0xff;
+
+        struct Pixel {
+            unsigned char r, g, b, a;
+
+            bool operator==(const Pixel& other) const {
+                return r == other.r && g == other.g && b == other.b && a == other.a;
+            }
+        };
+
+        std::vector<unsigned char> output;
+        output.reserve(image.pixels.size() / 2);
+
+        output.insert(output.end(), { 'q', 'o', 'i', 'f' });
+        WriteBigEndian(output, static_cast<std::uint32_t>(image.width));
+        WriteBigEndian(output, static_cast<std::uint32_t>(image.height));
+        output.push_back(4); // Channels.
+        output.push_back(0); // sRGB with linear alpha.
+
+        Pixel index[64] { };
+        Pixel previous { 0, 0, 0, 255 };
+        int run = 0;
+
+        std::size_t count = static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height);
+
+        for (std::size_t i = 0; i < count; ++i) {
+            const unsigned char* data = &image.pixels[i * 4];
+            Pixel pixel { data[0], data[1], data[2], data[3] };
+
+            if (pixel == previous) {
+                ++run;
+
+                if (run == 62 || i + 1 == count) {
+                    output.push_back(static_cast<unsigned char>(QOI_OP_RUN | (run - 1)));
+                    run = 0;
+                }
+
+                continue;
+            }
+
+            if (run > 0) {
+                output.push_back(static_cast<unsigned char>(QOI_OP_RUN | (run - 1)));
+                run = 0;
+            }
+
+            int hash = (pixel.r * 3 + pixel.g * 5 + pixel.b * 7 + pixel.a * 11) % 64;
+
+            if (index[hash] == pixel) {
+                output.push_back(static_cast<unsigned char>(QOI_OP_INDEX | hash));
+            }
+            else {
+                index[hash] = pixel;
+
+                if (pixel.a == previous.a) {
+                    // Differences wrap around.
+                    int dr = static_cast<signed char>(pixel.r - previous.r);
+                    int dg = static_cast<signed char>(pixel.g - previous.g);
+                    int db = static_cast<signed char>(pixel.b - previous.b);
+
+                    int drg = dr - dg;
+                    int dbg = db - dg;
+
+                    if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+                        output.push_back(static_cast<unsigned char>(QOI_OP_DIFF | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2)));
+                    }
+                    else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+                        output.push_back(static_cast<unsigned char>(QOI_OP_LUMA | (dg + 32)));
+                        output.push_back(static_cast<unsigned char>((drg + 8) << 4 | (dbg + 8)));
+                    }
+                    else {
+                        output.insert(output.end(), { QOI_OP_RGB, pixel.r, pixel.g, pixel.b });
+                    }
+                }
+                else {
+                    output.insert(output.end(), { QOI_OP_RGBA, pixel.r, pixel.g, pixel.b, pixel.a });
+                }
+            }
+
+            previous = pixel;
+        }
+
+        // End marker.
+        output.insert(output.end(), { 0, 0, 0, 0, 0, 0, 0, 1 });
+        return output;
+    }
+
+    FrameCapture::Settings::Settings() : target("output"),
+                                         format(Format::PNG),
+                                         output("out/capture"),
+                                         ringSize(4),
+                                         queueSize(8)
+                                         {
+    }
+
+    FrameCapture::FrameCapture(Settings settings) : settings_(std::move(settings)),
+                                                    numBuffers_(0),
+                                                    numQueued_(0),
+                                                    pipe_(nullptr),
+                                                    pipeWidth_(0),
+                                                    pipeHeight_(0),
+                                                    frame_(0),
+                                                    stalls_(0),
+                                                    finished_(false)
+                                                    {
+        if (settings_.ringSize < 1 || settings_.queueSize < 1) {
+            throw std::runtime_error("Frame capture needs room for at least one frame in flight and one frame in the encoder queue.");
+        }
+
+        // Frames need to reach the encoder process in order.
+        workers_ = std::make_unique<ThreadPool>(settings_.format == Format::PIPE ? 1u : 0u);
+
+        if (settings_.format != Format::PIPE) {
+            CreateDirectory(settings_.output);
+        }
+    }
+
+    FrameCapture::~FrameCapture() {
+        Finish();
+    }
+
+    void FrameCapture::Capture(IScene* scene) {
+        if (finished_) {
+            return;
+        }
+
+        PROFILE_SCOPE("FrameCapture::Capture");
+
+        Texture* texture = nullptr;
+        for (Texture* renderTarget : scene->GetRenderTargets()) {
+            if (renderTarget->GetName() == settings_.target) {
+                texture = renderTarget;
+                break;
+            }
+        }
+
+        if (!texture) {
+            LogWarningOnce("Frame capture: scene '%s' has no render target named '%s'.", scene->GetName().c_str(), settings_.target.c_str());
+            return;
+        }
+
+        Collect(false);
+
+        std::unique_ptr<PixelBufferObject> buffer;
+
+        if (!pool_.empty()) {
+            buffer = std::move(pool_.back());
+            pool_.pop_back();
+        }
+        else if (numBuffers_ < settings_.ringSize) {
+            buffer = std::make_unique<PixelBufferObject>(PixelBufferObject::PACK);
+            ++numBuffers_;
+        }
+        else {
+            // Ring is full, wait for the oldest readback.
+            ++stalls_;
+            Collect(true);
+
+            buffer = std::move(pool_.back());
+            pool_.pop_back();
+        }
+
+        int width = texture->GetWidth();
+        int height = texture->GetHeight();
+        bool depth = texture->GetAttachmentType() == Texture::DEPTH;
+        int channels = depth ? 1 : 4;
+        std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * static_cast<std::size_t>(channels);
+
+        if (buffer->GetSize() != size) {
+            buffer->Reserve(size);
+        }
+
+        buffer->Bind();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        texture->Bind();
+        glGetTexImage(GL_TEXTURE_2D, 0, depth ? GL_DEPTH_COMPONENT : GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+        texture->Unbind();
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        buffer->Unbind();
+
+        readbacks_.push_back({ std::move(buffer), glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0), frame_++, width, height, channels });
+    }
+
+    void FrameCapture::Finish() {
+        if (finished_) {
+            return;
+        }
+
+        while (!readbacks_.empty()) {
+            Collect(true);
+        }
+
+        workers_->Wait();
+        finished_ = true;
+
+        if (pipe_) {
+            pclose(pipe_);
+            pipe_ = nullptr;
+        }
+
+        ImGuiLog::Instance().LogTrace("Frame capture finished: %i frames, render thread waited on %i of them.", frame_, stalls_);
+    }
+
+    int FrameCapture::GetCapturedFrames() const {
+        return frame_;
+    }
+
+    int FrameCapture::GetStalls() const {
+        return stalls_;
+    }
+
+    void FrameCapture::Collect(bool wait) {
+        while (!readbacks_.empty()) {
+            Readback& readback = readbacks_.front();
+
+            GLenum status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait ? GL_TIMEOUT_IGNORED : 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+
+            glDeleteSync(readback.fence);
+
+            std::shared_ptr<Texture::ImageData> image = std::make_shared<Texture::ImageData>();
+            image->width = readback.width;
+            image->height = readback.height;
+            image->channels = readback.channels;
+            image->pixels.resize(readback.buffer->GetSize());
+
+            readback.buffer->Bind();
+            const void* data = readback.buffer->Map();
+            if (data) {
+                std::memcpy(image->pixels.data(), data, image->pixels.size());
+            }
+            readback.buffer->Unmap();
+            readback.buffer->Unbind();
+
+            int frame = readback.frame;
+            pool_.push_back(std::move(readback.buffer));
+            readbacks_.pop_front();
+
+            if (!data) {
+                ImGuiLog::Instance().LogError("Frame capture: failed to map readback buffer of frame %i.", frame);
+            }
+            else {
+                Encode(frame, std::move(image));
+            }
+
+            // Only the oldest readback is waited on.
+            wait = false;
+        }
+    }
+
+    void FrameCapture::Encode(int frame, std::shared_ptr<Texture::ImageData> image) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+
+            if (numQueued_ >= settings_.queueSize) {
+                // Encoder is falling behind.
+                ++stalls_;
+                encoded_.wait(lock, [this]() { return numQueued_ < settings_.queueSize; });
+            }
+
+            ++numQueued_;
+        }
+
+        workers_->Submit([this, frame, image]() {
+            try {
+                Write(frame, *image);
+            }
+            catch (const std::exception& exception) {
+                ImGuiLog::Instance().LogError("Frame capture: %s", exception.what());
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --numQueued_;
+            }
+            encoded_.notify_one();
+        });
+    }
+
+    void FrameCapture::Write(int frame, Texture::ImageData& image) {
+        // Readbacks store the bottom row first.
+        image.FlipVertically();
+
+        if (image.channels == 1) {
+            // Depth is replicated into the color channels.
+            std::vector<unsigned char> pixels(image.pixels.size() * 4);
+            for (std::size_t i = 0; i < image.pixels.size(); ++i) {
+                pixels[i * 4 + 0] = image.pixels[i];
+                pixels[i * 4 + 1] = image.pixels[i];
+                pixels[i * 4 + 2] = image.pixels[i];
+                pixels[i * 4 + 3] = 255;
+            }
+
+            image.pixels = std::move(pixels);
+            image.channels = 4;
+        }
+
+        switch (settings_.format) {
+            case Format::PNG: {
+                std::string filepath = GetFilepath(frame) + ".png";
+                if (!stbi_write_png(filepath.c_str(), image.width, image.height, 4, image.pixels.data(), 0)) {
+                    throw std::runtime_error("Failed to write frame '" + filepath + "'.");
+                }
+                break;
+            }
+            case Format::QOI:
+            case Format::RAW: {
+                bool qoi = settings_.format == Format::QOI;
+                std::string filepath = GetFilepath(frame) + (qoi ? ".qoi" : ".rgba");
+
+                std::ofstream file(filepath, std::ios::binary);
+                if (!file.is_open()) {
+                    throw std::runtime_error("Failed to open frame '" + filepath + "'.");
+                }
+
+                if (qoi) {
+                    std::vector<unsigned char> encoded = EncodeQOI(image);
+                    file.write(reinterpret_cast<const char*>(encoded.data()), static_cast<std::streamsize>(encoded.size()));
+                }
+                else {
+                    file.write(reinterpret_cast<const char*>(image.pixels.data()), static_cast<std::streamsize>(image.pixels.size()));
+                }
+                break;
+            }
+            case Format::PIPE: {
+                // Only ever touched by the single worker thread.
+                if (!pipe_) {
+                    std::string command = settings_.output;
+                    Replace(command, "{width}", std::to_string(image.width));
+                    Replace(command, "{height}", std::to_string(image.height));
+
+                    pipe_ = popen(command.c_str(), "w");
+                    if (!pipe_) {
+                        throw std::runtime_error("Failed to start encoder process '" + command + "'.");
+                    }
+
+                    pipeWidth_ = image.width;
+                    pipeHeight_ = image.height;
+                }
+
+                if (image.width != pipeWidth_ || image.height != pipeHeight_) {
+                    throw std::runtime_error("Frame " + std::to_string(frame) + " changed size, dropped from the encoder stream.");
+                }
+
+                if (std::fwrite(image.pixels.data(), 1, image.pixels.size(), pipe_) != image.pixels.size()) {
+                    throw std::runtime_error("Failed to write frame " + std::to_string(frame) + " to the encoder process.");
+                }
+                break;
+            }
+        }
+    }
+
+    std::string FrameCapture::GetFilepath(int frame) const {
+        std::stringstream builder;
+        builder << settings_.output << "/frame_" << std::setw(6) << std::setfill('0') << frame;
+        return builder.str();
+    }
+
+}
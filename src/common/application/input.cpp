@@ -4,13 +4,22 @@
 
 namespace Sandbox {
 
-    Input::Input() {
+    Input::Input() : enabled_(true) {
     }
 
     Input::~Input() {
     }
 
+    // Keys and buttons read as released while input is disabled, and on headless windows, which have no input.
+    static bool IsPolled(bool enabled) {
+        return enabled && !Window::Instance().IsHeadless();
+    }
+
     int Input::GetKeyState(int key) const {
+        if (!IsPolled(enabled_)) {
+            return GLFW_RELEASE;
+        }
+
         return glfwGetKey(Window::Instance().GetNativeWindow(), key);
     }
 
@@ -19,6 +28,10 @@ namespace Sandbox {
     }
 
     int Input::GetMouseButtonState(int button) const {
+        if (!IsPolled(enabled_)) {
+            return GLFW_RELEASE;
+        }
+
         return glfwGetMouseButton(Window::Instance().GetNativeWindow(), button);
     }
 
@@ -28,8 +41,20 @@ namespace Sandbox {
 
     glm::vec2 Input::GetMouseCursorPosition() const {
         static glm::dvec2 mouseCursorPosition;
+        if (!IsPolled(enabled_)) {
+            return { mouseCursorPosition.x, mouseCursorPosition.y };
+        }
+
         glfwGetCursorPos(Window::Instance().GetNativeWindow(), &mouseCursorPosition.x, &mouseCursorPosition.y);
         return { mouseCursorPosition.x, mouseCursorPosition.y };
     }
 
-}
\ No newline at end of file
+    void Input::SetEnabled(bool enabled) {
+        enabled_ = enabled;
+    }
+
+    bool Input::IsEnabled() const {
+        return enabled_;
+    }
+
+}
@@ -0,0 +1,204 @@
+
+#include "common/application/readback_service.h"
+#include "common/api/window.h"
+#include "common/api/backend.h"
+#include "common/utility/directory.h"
+#include "common/utility/log.h"
+#include "common/utility/profiler.h"
+
+namespace Sandbox {
+
+    static bool IsHDR(const std::string& filepath) {
+        std::string extension = ToLower(GetAssetExtension(filepath));
+
+        if (extension == "hdr") {
+            return true;
+        }
+
+        if (extension != "png") {
+            throw std::runtime_error("Unsupported readback image format of file '" + filepath + "', expected .png or .hdr.");
+        }
+
+        return false;
+    }
+
+    ReadbackService::ReadbackService() : numPendingWrites_(0) {
+    }
+
+    ReadbackService::~ReadbackService() {
+    }
+
+    void ReadbackService::Init() {
+        // Encoding is much slower than copying out of mapped buffers, a couple of threads keep up with per-frame captures.
+        workers_ = std::make_unique<ThreadPool>(2u);
+    }
+
+    void ReadbackService::Update() {
+        PROFILE_SCOPE("ReadbackService::Update");
+
+        // Readbacks complete in order, as fences signal in order.
+        while (!readbacks_.empty()) {
+            Readback& readback = readbacks_.front();
+
+            GLenum status = glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+            if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) {
+                break;
+            }
+
+            Complete(readback);
+            readbacks_.pop_front();
+        }
+    }
+
+    void ReadbackService::Shutdown() {
+        Flush();
+
+        workers_.reset();
+        pool_.clear();
+    }
+
+    std::shared_future<void> ReadbackService::Capture(const Texture* texture, const std::string& filepath) {
+        assert(texture);
+
+        bool hdr = IsHDR(filepath);
+        bool depth = texture->GetAttachmentType() == Texture::DEPTH;
+
+        GLenum format = depth ? GL_DEPTH_COMPONENT : (hdr ? GL_RGB : GL_RGBA);
+        GLenum type = hdr ? GL_FLOAT : GL_UNSIGNED_BYTE;
+        int channels = depth ? 1 : (hdr ? 3 : 4);
+
+        return Issue([texture, format, type]() {
+            texture->Bind();
+            glGetTexImage(GL_TEXTURE_2D, 0, format, type, nullptr); // Offset into the bound pack buffer.
+            texture->Unbind();
+        }, filepath, texture->GetWidth(), texture->GetHeight(), channels, hdr);
+    }
+
+    std::shared_future<void> ReadbackService::CaptureFramebuffer(const std::string& filepath) {
+        bool hdr = IsHDR(filepath);
+
+        Window& window = Window::Instance();
+        int width = window.GetWidth();
+        int height = window.GetHeight();
+
+        return Issue([width, height, hdr]() {
+            Backend::State::BindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            glReadBuffer(GL_BACK);
+            glReadPixels(0, 0, width, height, hdr ? GL_RGB : GL_RGBA, hdr ? GL_FLOAT : GL_UNSIGNED_BYTE, nullptr);
+        }, filepath, width, height, hdr ? 3 : 4, hdr);
+    }
+
+    void ReadbackService::Flush() {
+        while (!readbacks_.empty()) {
+            Readback& readback = readbacks_.front();
+
+            glClientWaitSync(readback.fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+            Complete(readback);
+            readbacks_.pop_front();
+        }
+
+        if (workers_) {
+            workers_->Wait();
+        }
+    }
+
+    int ReadbackService::GetPendingCount() const {
+        return static_cast<int>(readbacks_.size()) + numPendingWrites_;
+    }
+
+    std::shared_future<void> ReadbackService::Issue(const std::function<void()>& transfer, const std::string& filepath, int width, int height, int channels, bool hdr) {
+        Readback readback;
+        readback.filepath = filepath;
+        readback.width = width;
+        readback.height = height;
+        readback.channels = channels;
+        readback.hdr = hdr;
+        readback.promise = std::make_shared<std::promise<void>>();
+
+        std::shared_future<void> future = readback.promise->get_future().share();
+
+        std::size_t size = static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * static_cast<std::size_t>(channels) * (hdr ? sizeof(float) : 1u);
+
+        // Reuse a buffer of a completed readback if there is one.
+        if (!pool_.empty()) {
+            readback.buffer = std::move(pool_.back());
+            pool_.pop_back();
+        }
+        else {
+            readback.buffer = std::make_unique<PixelBufferObject>(PixelBufferObject::PACK);
+        }
+
+        if (readback.buffer->GetSize() != size) {
+            readback.buffer->Reserve(size);
+        }
+
+        readback.buffer->Bind();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        transfer();
+
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        readback.buffer->Unbind();
+
+        readback.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        readbacks_.push_back(std::move(readback));
+
+        return future;
+    }
+
+    void ReadbackService::Complete(Readback& readback) {
+        glDeleteSync(readback.fence);
+
+        std::shared_ptr<Texture::ImageData> image = std::make_shared<Texture::ImageData>();
+        image->width = readback.width;
+        image->height = readback.height;
+        image->channels = readback.channels;
+        image->hdr = readback.hdr;
+        image->pixels.resize(readback.buffer->GetSize());
+
+        readback.buffer->Bind();
+        const void* data = readback.buffer->Map();
+        if (data) {
+            std::memcpy(image->pixels.data(), data, image->pixels.size());
+        }
+        readback.buffer->Unmap();
+        readback.buffer->Unbind();
+
+        pool_.push_back(std::move(readback.buffer));
+
+        if (!data) {
+            readback.promise->set_exception(std::make_exception_ptr(std::runtime_error("Failed to map readback buffer of '" + readback.filepath + "'.")));
+            return;
+        }
+
+        ++numPendingWrites_;
+
+        workers_->Submit([this, image, filepath = readback.filepath, promise = readback.promise]() {
+            try {
+                // Flipped here rather than through stb, whose flip setting is global and not thread safe.
+                image->FlipVertically();
+
+                std::string directory = std::filesystem::path(filepath).parent_path().string();
+                if (!directory.empty()) {
+                    CreateDirectory(directory);
+                }
+
+                int result = image->hdr ? stbi_write_hdr(filepath.c_str(), image->width, image->height, image->channels, reinterpret_cast<const float*>(image->pixels.data()))
+                                        : stbi_write_png(filepath.c_str(), image->width, image->height, image->channels, image->pixels.data(), 0);
+
+                if (!result) {
+                    throw std::runtime_error("Failed to write image '" + filepath + "'.");
+                }
+
+                promise->set_value();
+            }
+            catch (const std::exception& exception) {
+                ImGuiLog::Instance().LogError("%s", exception.what());
+                promise->set_exception(std::current_exception());
+            }
+
+            --numPendingWrites_;
+        });
+    }
+
+}
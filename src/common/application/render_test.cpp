@@ -0,0 +1,272 @@
+
+#include "common/application/render_test.h"
+#include "common/application/asset_streamer.h"
+#include "common/utility/directory.h"
+#include "common/utility/log.h"
+
+namespace Sandbox {
+
+    // Structural similarity is computed over luminance, in windows of this size that overlap by half.
+    static const int SSIM_WINDOW = 8;
+
+    static float GetLuminance(const unsigned char* pixel) {
+        return (0.2126f * pixel[0] + 0.7152f * pixel[1] + 0.0722f * pixel[2]) / 255.0f;
+    }
+
+    // Mean SSIM over all windows, 1 for identical images. Expects images of equal size.
+    static float GetStructuralSimilarity(const Texture::ImageData& a, const Texture::ImageData& b) {
+        static const float C1 = 0.01f * 0.01f;
+        static const float C2 = 0.03f * 0.03f;
+
+        int window = std::min({ SSIM_WINDOW, a.width, a.height });
+        int stride = std::max(window / 2, 1);
+
+        double sum = 0.0;
+        int windows = 0;
+
+        for (int y = 0; y + window <= a.height; y += stride) {
+            for (int x = 0; x + window <= a.width; x += stride) {
+                float meanA = 0.0f, meanB = 0.0f;
+                float varianceA = 0.0f, varianceB = 0.0f, covariance = 0.0f;
+
+                for (int j = y; j < y + window; ++j) {
+                    for (int i = x; i < x + window; ++i) {
+                        std::size_t offset = (static_cast<std::size_t>(j) * a.width + i) * 4;
+                        float la = GetLuminance(&a.pixels[offset]);
+                        float lb = GetLuminance(&b.pixels[offset]);
+
+                        meanA += la;
+                        meanB += lb;
+                        varianceA += la * la;
+                        varianceB += lb * lb;
+                        covariance += la * lb;
+                    }
+                }
+
+                float count = static_cast<float>(window * window);
+                meanA /= count;
+                meanB /= count;
+                varianceA = varianceA / count - meanA * meanA;
+                varianceB = varianceB / count - meanB * meanB;
+                covariance = covariance / count - meanA * meanB;
+
+                sum += ((2.0f * meanA * meanB + C1) * (2.0f * covariance + C2)) / ((meanA * meanA + meanB * meanB + C1) * (varianceA + varianceB + C2));
+                ++windows;
+            }
+        }
+
+        return windows > 0 ? static_cast<float>(sum / windows) : 1.0f;
+    }
+
+    static void WriteImage(const std::string& filepath, const Texture::ImageData& image) {
+        // Rows are stored top to bottom already.
+        if (!stbi_write_png(filepath.c_str(), image.width, image.height, image.channels, image.pixels.data(), 0)) {
+            throw std::runtime_error("Failed to write image '" + filepath + "'.");
+        }
+    }
+
+    RenderTest::Settings::Settings() : frame(10),
+                                       referenceDirectory("data/golden"),
+                                       outputDirectory("out/golden"),
+                                       update(false),
+                                       tolerance(2),
+                                       failedPixels(0.001f),
+                                       similarity(0.98f)
+                                       {
+    }
+
+    RenderTest::RenderTest(Settings settings) : settings_(std::move(settings)),
+                                                current_(0),
+                                                frame_(0)
+                                                {
+        if (settings_.scenes.empty()) {
+            throw std::runtime_error("Render test has no scenes to render.");
+        }
+    }
+
+    RenderTest::~RenderTest() {
+    }
+
+    void RenderTest::Update(SceneManager& sceneManager) {
+        if (IsFinished()) {
+            return;
+        }
+
+        ++frame_;
+
+        IScene* scene = sceneManager.GetActiveScene();
+        if (!scene || frame_ < settings_.frame || AssetStreamer::Instance().GetPendingRequestCount() > 0) {
+            return;
+        }
+
+        Capture(scene);
+
+        ++current_;
+        frame_ = 0;
+
+        if (!IsFinished()) {
+            sceneManager.SetActiveScene(settings_.scenes[current_]);
+        }
+    }
+
+    bool RenderTest::IsFinished() const {
+        return current_ >= settings_.scenes.size();
+    }
+
+    bool RenderTest::Passed() const {
+        for (const Result& result : results_) {
+            if (!result.passed) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    void RenderTest::WriteReport() const {
+        CreateDirectory(settings_.outputDirectory);
+
+        std::string filepath = settings_.outputDirectory + "/report.json";
+        std::ofstream file(filepath);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open render test report file '" + filepath + "'.");
+        }
+
+        file << std::fixed << std::setprecision(6);
+        file << "{\n";
+        file << "  \"passed\": " << (Passed() ? "true" : "false") << ",\n";
+        file << "  \"updated\": " << (settings_.update ? "true" : "false") << ",\n";
+        file << "  \"targets\": [";
+
+        for (std::size_t i = 0; i < results_.size(); ++i) {
+            const Result& result = results_[i];
+
+            file << (i == 0 ? "\n" : ",\n");
+            file << "    { \"scene\": \"" << result.scene << "\", \"target\": \"" << result.target << "\", \"passed\": " << (result.passed ? "true" : "false");
+
+            if (!result.error.empty()) {
+                file << ", \"error\": \"" << result.error << "\"";
+            }
+            else {
+                file << ", \"failedPixels\": " << result.failedPixels << ", \"maximumDifference\": " << result.maximumDifference;
+                file << ", \"meanDifference\": " << result.meanDifference << ", \"ssim\": " << result.similarity;
+            }
+
+            file << " }";
+        }
+
+        file << "\n  ]\n";
+        file << "}\n";
+    }
+
+    void RenderTest::Capture(IScene* scene) {
+        ImGuiLog& log = ImGuiLog::Instance();
+
+        const std::string& sceneName = settings_.scenes[current_];
+        std::string sceneDirectory = ProcessName(sceneName);
+
+        std::vector<Texture*> renderTargets = scene->GetRenderTargets();
+        if (renderTargets.empty()) {
+            log.LogWarning("Scene '%s' exposes no render targets to test.", sceneName.c_str());
+            return;
+        }
+
+        std::string outputDirectory = settings_.outputDirectory + "/" + sceneDirectory;
+        std::string referenceDirectory = settings_.referenceDirectory + "/" + sceneDirectory;
+        CreateDirectory(outputDirectory);
+
+        if (settings_.update) {
+            CreateDirectory(referenceDirectory);
+        }
+
+        for (Texture* texture : renderTargets) {
+            std::string target = ProcessName(texture->GetName());
+            Texture::ImageData image = texture->ReadData();
+
+            WriteImage(outputDirectory + "/" + target + ".png", image);
+
+            if (settings_.update) {
+                WriteImage(referenceDirectory + "/" + target + ".png", image);
+                log.LogTrace("Updated reference image of render target '%s' of scene '%s'.", target.c_str(), sceneName.c_str());
+                continue;
+            }
+
+            Result result = Compare(sceneName, target, image);
+            if (result.passed) {
+                log.LogTrace("Render target '%s' of scene '%s' matches its reference (SSIM %.4f).", target.c_str(), sceneName.c_str(), result.similarity);
+            }
+            else if (!result.error.empty()) {
+                log.LogError("Render target '%s' of scene '%s': %s", target.c_str(), sceneName.c_str(), result.error.c_str());
+            }
+            else {
+                log.LogError("Render target '%s' of scene '%s' differs from its reference: %.4f%% failed pixels, SSIM %.4f.", target.c_str(), sceneName.c_str(), result.failedPixels * 100.0f, result.similarity);
+            }
+
+            results_.push_back(result);
+        }
+    }
+
+    RenderTest::Result RenderTest::Compare(const std::string& scene, const std::string& target, const Texture::ImageData& image) const {
+        Result result { scene, target, "", 0.0f, 0.0f, 0.0f, 0.0f, false };
+
+        std::string referencePath = settings_.referenceDirectory + "/" + ProcessName(scene) + "/" + target + ".png";
+        if (!Exists(referencePath)) {
+            result.error = "missing reference image " + referencePath;
+            return result;
+        }
+
+        Texture::ImageData reference = Texture::Decode(referencePath);
+        if (reference.width != image.width || reference.height != image.height) {
+            result.error = "reference image is " + std::to_string(reference.width) + "x" + std::to_string(reference.height) + ", render target is " + std::to_string(image.width) + "x" + std::to_string(image.height);
+            return result;
+        }
+
+        // Failed pixels are drawn red, scaled by their difference, over a dimmed copy of the reference.
+        Texture::ImageData difference = image;
+        std::size_t pixelCount = static_cast<std::size_t>(image.width) * static_cast<std::size_t>(image.height);
+        std::size_t failed = 0;
+        double differenceSum = 0.0;
+        int maximum = 0;
+
+        for (std::size_t i = 0; i < pixelCount; ++i) {
+            const unsigned char* a = &image.pixels[i * 4];
+            const unsigned char* b = &reference.pixels[i * 4];
+            unsigned char* output = &difference.pixels[i * 4];
+
+            int pixelDifference = 0;
+            for (int channel = 0; channel < 4; ++channel) {
+                pixelDifference = std::max(pixelDifference, std::abs(static_cast<int>(a[channel]) - static_cast<int>(b[channel])));
+            }
+
+            maximum = std::max(maximum, pixelDifference);
+            differenceSum += pixelDifference;
+
+            if (pixelDifference > settings_.tolerance) {
+                ++failed;
+
+                output[0] = static_cast<unsigned char>(std::min(128 + pixelDifference * 4, 255));
+                output[1] = 0;
+                output[2] = 0;
+            }
+            else {
+                unsigned char luminance = static_cast<unsigned char>(GetLuminance(b) * 64.0f);
+                output[0] = luminance;
+                output[1] = luminance;
+                output[2] = luminance;
+            }
+
+            output[3] = 255;
+        }
+
+        WriteImage(settings_.outputDirectory + "/" + ProcessName(scene) + "/" + target + "_diff.png", difference);
+
+        result.failedPixels = static_cast<float>(failed) / static_cast<float>(std::max<std::size_t>(pixelCount, 1));
+        result.maximumDifference = static_cast<float>(maximum) / 255.0f;
+        result.meanDifference = static_cast<float>(differenceSum / std::max<std::size_t>(pixelCount, 1) / 255.0);
+        result.similarity = GetStructuralSimilarity(image, reference);
+        result.passed = result.failedPixels <= settings_.failedPixels && result.similarity >= settings_.similarity;
+
+        return result;
+    }
+
+}
@@ -42,6 +42,14 @@ namespace Sandbox {
     void IScene::OnWindowResize(int width, int height) {
     }
 
+    ICamera* IScene::GetCamera() {
+        return nullptr;
+    }
+
+    std::vector<Texture*> IScene::GetRenderTargets() {
+        return { };
+    }
+
     void IScene::SetName(const std::string& name) {
         if (isLocked_) {
             LogWarningOnce("Function SetName called on a locked Scene instance - call has no effect. SetName should be called only in scene constructors.");
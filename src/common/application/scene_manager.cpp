@@ -2,6 +2,8 @@
 #include "common/application/scene_manager.h"
 #include "common/utility/log.h"
 #include "common/utility/directory.h"
+#include "common/application/asset_streamer.h"
+#include "common/utility/profiler.h"
 
 namespace Sandbox {
 
@@ -18,8 +20,12 @@ namespace Sandbox {
     }
 
     void SceneManager::Update() {
-    	ImGuiLog& log = ImGuiLog::Instance();
+        if (previousIndex_ != currentIndex_) {
+            sceneChangeRequested_ = true;
+        }
+    }
 
+    void SceneManager::OnImGui() {
         // Main menu bar (scene selection).
         if (ImGui::BeginMainMenuBar()) {
             if (ImGui::BeginMenu("Scenes")) {
@@ -39,10 +45,6 @@ namespace Sandbox {
             }
         }
         ImGui::EndMainMenuBar();
-
-        if (previousIndex_ != currentIndex_) {
-            sceneChangeRequested_ = true;
-        }
     }
 
     void SceneManager::Shutdown() {
@@ -55,11 +57,6 @@ namespace Sandbox {
     }
 
     void SceneManager::SetActiveScene(const std::string& name) {
-        if (currentIndex_ != -1) {
-            // Function only does something when no scene has been loaded.
-            return;
-        }
-
         ImGuiLog& log = ImGuiLog::Instance();
 
         // Find scene data with given scene name.
@@ -68,11 +65,25 @@ namespace Sandbox {
             const std::string& sceneName = type->name_;
 
             if (sceneName == name) {
-                log.LogTrace("Setting startup scene as: '%s'", sceneName.c_str());
+                log.LogTrace("Setting active scene as: '%s'", sceneName.c_str());
                 currentIndex_ = i;
-                break;
+                return;
             }
         }
+
+        log.LogWarning("No scene registered with name: '%s'", name.c_str());
+    }
+
+    bool SceneManager::HasScene(const std::string& name) const {
+        return !ValidateSceneName(name);
+    }
+
+    std::vector<std::string> SceneManager::GetSceneNames() const {
+        std::vector<std::string> names;
+        for (ISceneType* type : scenes_) {
+            names.push_back(type->name_);
+        }
+        return names;
     }
 
     bool SceneManager::ValidateSceneName(const std::string& name) const {
@@ -98,6 +109,14 @@ namespace Sandbox {
         return scenes_[currentIndex_];
     }
 
+    SceneManager::ISceneType* SceneManager::GetLoadedSceneType() const {
+        if (previousIndex_ < 0) {
+            return nullptr;
+        }
+
+        return scenes_[previousIndex_];
+    }
+
     void SceneManager::LoadSceneData() const {
     	ImGuiLog& log = ImGuiLog::Instance();
 
@@ -107,6 +126,7 @@ namespace Sandbox {
             return;
         }
 
+        PROFILE_SCOPE("Load scene");
         auto start = std::chrono::high_resolution_clock::now();
 
         type->Create(); // Create instance of scene.
@@ -150,12 +170,13 @@ namespace Sandbox {
 	void SceneManager::UnloadSceneData() const {
         ImGuiLog& log = ImGuiLog::Instance();
 
-        ISceneType* type = GetActiveSceneType();
+        ISceneType* type = GetLoadedSceneType();
         if (!type) {
             // No active scene to load.
             return;
         }
 
+        PROFILE_SCOPE("Unload scene");
         auto start = std::chrono::high_resolution_clock::now();
 
         IScene* scene = type->scene_;
@@ -170,6 +191,9 @@ namespace Sandbox {
     	log.LogTrace("Saving ImGui settings to: %s", ini.c_str());
     	ImGui::SaveIniSettingsToDisk(ini.c_str());
 
+        // Outstanding asset requests reference data owned by the current scene.
+        AssetStreamer::Instance().Reset();
+
         // Shutdown current scene.
         scene->OnShutdown();
         type->Destroy();
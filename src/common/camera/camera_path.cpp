@@ -0,0 +1,161 @@
+
+#include "common/camera/camera_path.h"
+#include "common/utility/directory.h"
+
+namespace Sandbox {
+
+    // File layout: magic, version and keyframe count, followed by tightly packed keyframes.
+    static const std::uint32_t CAMERA_PATH_MAGIC = 0x48544150u; // 'PATH'.
+    static const std::uint32_t CAMERA_PATH_VERSION = 1u;
+
+    struct CameraPathHeader {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::uint32_t count;
+    };
+
+    static_assert(sizeof(CameraPath::Keyframe) == 8 * sizeof(float), "Camera path keyframes are written to disk as is.");
+
+    // Uniform Catmull-Rom spline through p1 and p2.
+    template <typename T>
+    static T CatmullRom(const T& p0, const T& p1, const T& p2, const T& p3, float t) {
+        float t2 = t * t;
+        float t3 = t2 * t;
+
+        return 0.5f * ((2.0f * p1) +
+                       (-p0 + p2) * t +
+                       (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                       (-p0 + 3.0f * p1 - 3.0f * p2 + p3) * t3);
+    }
+
+    CameraPath::CameraPath() {
+    }
+
+    CameraPath::~CameraPath() {
+    }
+
+    void CameraPath::AddKeyframe(const ICamera& camera, float time) {
+        if (!keyframes_.empty() && time < keyframes_.back().time) {
+            throw std::runtime_error("Camera path keyframes need to be added in order of increasing time.");
+        }
+
+        keyframes_.push_back({ time, camera.GetPosition(), camera.GetForwardVector(), camera.GetFOV() });
+    }
+
+    void CameraPath::Clear() {
+        keyframes_.clear();
+    }
+
+    void CameraPath::Load(const std::string& filepath) {
+        std::ifstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open camera path file '" + filepath + "'.");
+        }
+
+        CameraPathHeader header { };
+        file.read(reinterpret_cast<char*>(&header), sizeof(CameraPathHeader));
+
+        if (!file || header.magic != CAMERA_PATH_MAGIC) {
+            throw std::runtime_error("File '" + filepath + "' is not a camera path.");
+        }
+
+        if (header.version != CAMERA_PATH_VERSION) {
+            throw std::runtime_error("Camera path file '" + filepath + "' has unsupported version " + std::to_string(header.version) + ".");
+        }
+
+        std::vector<Keyframe> keyframes(header.count);
+        file.read(reinterpret_cast<char*>(keyframes.data()), static_cast<std::streamsize>(keyframes.size() * sizeof(Keyframe)));
+
+        if (!file) {
+            throw std::runtime_error("Camera path file '" + filepath + "' is truncated.");
+        }
+
+        keyframes_ = std::move(keyframes);
+    }
+
+    void CameraPath::Save(const std::string& filepath) const {
+        std::string directory = std::filesystem::path(filepath).parent_path().string();
+        if (!directory.empty()) {
+            CreateDirectory(directory);
+        }
+
+        std::ofstream file(filepath, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open camera path file '" + filepath + "' for writing.");
+        }
+
+        CameraPathHeader header { CAMERA_PATH_MAGIC, CAMERA_PATH_VERSION, static_cast<std::uint32_t>(keyframes_.size()) };
+        file.write(reinterpret_cast<const char*>(&header), sizeof(CameraPathHeader));
+        file.write(reinterpret_cast<const char*>(keyframes_.data()), static_cast<std::streamsize>(keyframes_.size() * sizeof(Keyframe)));
+    }
+
+    CameraPath::Keyframe CameraPath::Evaluate(float time, Interpolation interpolation) const {
+        if (keyframes_.empty()) {
+            throw std::runtime_error("Evaluating an empty camera path.");
+        }
+
+        if (time <= keyframes_.front().time) {
+            return keyframes_.front();
+        }
+
+        if (time >= keyframes_.back().time) {
+            return keyframes_.back();
+        }
+
+        // First keyframe after 'time', the first keyframe is excluded by the check above.
+        std::size_t next = std::upper_bound(keyframes_.begin(), keyframes_.end(), time, [](float value, const Keyframe& keyframe) {
+            return value < keyframe.time;
+        }) - keyframes_.begin();
+
+        const Keyframe& k1 = keyframes_[next - 1];
+        const Keyframe& k2 = keyframes_[next];
+
+        float span = k2.time - k1.time;
+        float t = span > 0.0f ? (time - k1.time) / span : 1.0f;
+
+        Keyframe result { };
+        result.time = time;
+
+        if (interpolation == Interpolation::Linear) {
+            result.position = glm::mix(k1.position, k2.position, t);
+            result.forward = glm::mix(k1.forward, k2.forward, t);
+            result.fov = glm::mix(k1.fov, k2.fov, t);
+        }
+        else {
+            // Endpoints are repeated at the ends of the path.
+            const Keyframe& k0 = keyframes_[next > 1 ? next - 2 : next - 1];
+            const Keyframe& k3 = keyframes_[std::min(next + 1, keyframes_.size() - 1)];
+
+            result.position = CatmullRom(k0.position, k1.position, k2.position, k3.position, t);
+            result.forward = CatmullRom(k0.forward, k1.forward, k2.forward, k3.forward, t);
+            result.fov = CatmullRom(k0.fov, k1.fov, k2.fov, k3.fov, t);
+        }
+
+        // Interpolated directions are not unit length, and opposite directions may cancel out.
+        float length = glm::length(result.forward);
+        result.forward = length > std::numeric_limits<float>::epsilon() ? result.forward / length : k1.forward;
+
+        return result;
+    }
+
+    void CameraPath::Apply(ICamera& camera, float time, Interpolation interpolation) const {
+        Keyframe keyframe = Evaluate(time, interpolation);
+
+        camera.SetPosition(keyframe.position);
+        camera.SetLookAtDirection(keyframe.forward);
+        camera.SetFOVAngle(keyframe.fov);
+    }
+
+    bool CameraPath::IsEmpty() const {
+        return keyframes_.empty();
+    }
+
+    float CameraPath::GetDuration() const {
+        return keyframes_.empty() ? 0.0f : keyframes_.back().time - keyframes_.front().time;
+    }
+
+    const std::vector<CameraPath::Keyframe>& CameraPath::GetKeyframes() const {
+        return keyframes_;
+    }
+
+}
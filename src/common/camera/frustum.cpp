@@ -0,0 +1,162 @@
+
+#include "common/camera/frustum.h"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+namespace Sandbox {
+
+    Frustum::Frustum() : planes_ { }
+                         {
+    }
+
+    Frustum::Frustum(const glm::mat4& viewProjection) {
+        SetViewProjection(viewProjection);
+    }
+
+    Frustum::~Frustum() {
+    }
+
+    void Frustum::SetViewProjection(const glm::mat4& viewProjection) {
+        // Gribb / Hartmann plane extraction (OpenGL clip space, z in [-w, w]).
+        // Matrices are column-major, so row i is made up of the i-th element of every column.
+        glm::vec4 rows[4];
+        for (int i = 0; i < 4; ++i) {
+            rows[i] = glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+        }
+
+        planes_[0] = rows[3] + rows[0]; // Left.
+        planes_[1] = rows[3] - rows[0]; // Right.
+        planes_[2] = rows[3] + rows[1]; // Bottom.
+        planes_[3] = rows[3] - rows[1]; // Top.
+        planes_[4] = rows[3] + rows[2]; // Near.
+        planes_[5] = rows[3] - rows[2]; // Far.
+
+        // Normalize so plane tests yield actual distances (needed for sphere tests).
+        for (glm::vec4& plane : planes_) {
+            float length = glm::length(glm::vec3(plane));
+            if (length > 0.0f) {
+                plane /= length;
+            }
+        }
+    }
+
+    const glm::vec4& Frustum::GetPlane(int index) const {
+        assert(index >= 0 && index < NUM_PLANES);
+        return planes_[index];
+    }
+
+    bool Frustum::Contains(const glm::vec3& point) const {
+        return Intersects(point, 0.0f);
+    }
+
+    bool Frustum::Intersects(const glm::vec3& center, float radius) const {
+        for (const glm::vec4& plane : planes_) {
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool Frustum::Intersects(const Bounds& bounds) const {
+        if (!bounds.IsValid()) {
+            return false;
+        }
+
+        glm::vec3 center = bounds.GetCentroid();
+        glm::vec3 extent = bounds.GetDiagonal() * 0.5f;
+
+        for (const glm::vec4& plane : planes_) {
+            // Projected radius of the box onto the plane normal.
+            float radius = glm::dot(glm::abs(glm::vec3(plane)), extent);
+
+            if (glm::dot(glm::vec3(plane), center) + plane.w < -radius) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    int Frustum::Intersects(const float* centerX, const float* centerY, const float* centerZ,
+                            const float* extentX, const float* extentY, const float* extentZ,
+                            int count, int* visible) const {
+        int numVisible = 0;
+        int i = 0;
+
+#if defined(__AVX__)
+        for (; i + 8 <= count; i += 8) {
+            __m256 cx = _mm256_loadu_ps(centerX + i);
+            __m256 cy = _mm256_loadu_ps(centerY + i);
+            __m256 cz = _mm256_loadu_ps(centerZ + i);
+            __m256 ex = _mm256_loadu_ps(extentX + i);
+            __m256 ey = _mm256_loadu_ps(extentY + i);
+            __m256 ez = _mm256_loadu_ps(extentZ + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+            for (const glm::vec4& plane : planes_) {
+                __m256 distance = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.x), cx), _mm256_mul_ps(_mm256_set1_ps(plane.y), cy)), _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(plane.z), cz), _mm256_set1_ps(plane.w)));
+                __m256 radius = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(std::abs(plane.x)), ex), _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.y)), ey)), _mm256_mul_ps(_mm256_set1_ps(std::abs(plane.z)), ez));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+
+            int mask = _mm256_movemask_ps(inside);
+            for (int lane = 0; lane < 8; ++lane) {
+                if (mask & (1 << lane)) {
+                    visible[numVisible++] = i + lane;
+                }
+            }
+        }
+#elif defined(__SSE2__) || defined(_M_X64)
+        for (; i + 4 <= count; i += 4) {
+            __m128 cx = _mm_loadu_ps(centerX + i);
+            __m128 cy = _mm_loadu_ps(centerY + i);
+            __m128 cz = _mm_loadu_ps(centerZ + i);
+            __m128 ex = _mm_loadu_ps(extentX + i);
+            __m128 ey = _mm_loadu_ps(extentY + i);
+            __m128 ez = _mm_loadu_ps(extentZ + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+            for (const glm::vec4& plane : planes_) {
+                __m128 distance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.x), cx), _mm_mul_ps(_mm_set1_ps(plane.y), cy)), _mm_add_ps(_mm_mul_ps(_mm_set1_ps(plane.z), cz), _mm_set1_ps(plane.w)));
+                __m128 radius = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(std::abs(plane.x)), ex), _mm_mul_ps(_mm_set1_ps(std::abs(plane.y)), ey)), _mm_mul_ps(_mm_set1_ps(std::abs(plane.z)), ez));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), _mm_setzero_ps()));
+            }
+
+            int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; ++lane) {
+                if (mask & (1 << lane)) {
+                    visible[numVisible++] = i + lane;
+                }
+            }
+        }
+#endif
+
+        // Remaining boxes (or all of them, without SIMD support).
+        for (; i < count; ++i) {
+            bool inside = true;
+
+            for (const glm::vec4& plane : planes_) {
+                float distance = plane.x * centerX[i] + plane.y * centerY[i] + plane.z * centerZ[i] + plane.w;
+                float radius = std::abs(plane.x) * extentX[i] + std::abs(plane.y) * extentY[i] + std::abs(plane.z) * extentZ[i];
+
+                if (distance + radius < 0.0f) {
+                    inside = false;
+                    break;
+                }
+            }
+
+            if (inside) {
+                visible[numVisible++] = i;
+            }
+        }
+
+        return numVisible;
+    }
+
+}
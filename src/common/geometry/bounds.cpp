@@ -98,6 +98,10 @@ namespace Sandbox {
         return inside;
     }
 
+    bool Bounds::IsValid() const {
+        return initialized_;
+    }
+
     Bounds Bounds::GetUnion(const Bounds& first, const Bounds& second) {
         if (!first.initialized_) {
             if (!second.initialized_) {
@@ -147,6 +151,21 @@ namespace Sandbox {
         return overlap;
     }
 
+    Bounds Bounds::GetTransformed(const Bounds& bounds, const glm::mat4& transform) {
+        if (!bounds.initialized_) {
+            return { };
+        }
+
+        // Transform center and half-extents (Arvo) instead of all eight corners.
+        glm::vec3 center = transform * glm::vec4(bounds.GetCentroid(), 1.0f);
+        glm::vec3 extents = bounds.GetDiagonal() / 2.0f;
+
+        glm::mat3 absolute = glm::mat3(glm::abs(glm::vec3(transform[0])), glm::abs(glm::vec3(transform[1])), glm::abs(glm::vec3(transform[2])));
+        glm::vec3 transformedExtents = absolute * extents;
+
+        return { center - transformedExtents, center + transformedExtents };
+    }
+
     const glm::vec3& Bounds::GetMinimum() const {
         return minimum_;
     }
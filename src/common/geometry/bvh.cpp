@@ -0,0 +1,393 @@
+
+#include "common/geometry/bvh.h"
+
+#if defined(__AVX__) || defined(__SSE2__) || defined(_M_X64)
+    #include <immintrin.h>
+#endif
+
+namespace Sandbox {
+
+    // Binary node used during construction, before being collapsed into wide nodes.
+    struct BVH::BuildNode {
+        [[nodiscard]] bool IsLeaf() const {
+            return !children[0];
+        }
+
+        Bounds bounds;
+        std::unique_ptr<BuildNode> children[2];
+
+        // Primitive range (leaves only).
+        int begin = 0;
+        int end = 0;
+    };
+
+    BVH::BVH() {
+    }
+
+    BVH::~BVH() {
+    }
+
+    void BVH::Build(const std::vector<Bounds>& primitiveBounds, int parallelThreshold) {
+        Clear();
+
+        int numPrimitives = static_cast<int>(primitiveBounds.size());
+        if (numPrimitives == 0) {
+            return;
+        }
+
+        std::vector<glm::vec3> centroids;
+        centroids.reserve(numPrimitives);
+
+        std::vector<int> indices;
+        indices.reserve(numPrimitives);
+
+        for (int i = 0; i < numPrimitives; ++i) {
+            centroids.emplace_back(primitiveBounds[i].GetCentroid());
+            indices.emplace_back(i);
+        }
+
+        // Bounds are needed for both the build and overlap queries.
+        primitiveBounds_ = primitiveBounds;
+
+        // Every parallel level doubles the number of build threads.
+        unsigned numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+        int parallelDepth = 0;
+        while ((1u << parallelDepth) < numThreads) {
+            ++parallelDepth;
+        }
+
+        std::unique_ptr<BuildNode> root = BuildRecursive(centroids, indices, 0, numPrimitives, 0, parallelThreshold, parallelDepth);
+
+        // Store primitives in leaf order.
+        for (int i = 0; i < numPrimitives; ++i) {
+            primitiveBounds_[i] = primitiveBounds[indices[i]];
+        }
+        primitiveIndices_ = std::move(indices);
+
+        bounds_ = root->bounds;
+
+        // Wide nodes end up at most half as many as binary nodes.
+        nodes_.reserve(numPrimitives / MAX_LEAF_SIZE + 1);
+        Flatten(root.get());
+    }
+
+    void BVH::Clear() {
+        nodes_.clear();
+        primitiveIndices_.clear();
+        primitiveBounds_.clear();
+        bounds_ = Bounds();
+    }
+
+    bool BVH::IsEmpty() const {
+        return nodes_.empty();
+    }
+
+    const Bounds& BVH::GetBounds() const {
+        return bounds_;
+    }
+
+    int BVH::GetNodeCount() const {
+        return static_cast<int>(nodes_.size());
+    }
+
+    int BVH::GetPrimitiveCount() const {
+        return static_cast<int>(primitiveIndices_.size());
+    }
+
+    std::unique_ptr<BVH::BuildNode> BVH::BuildRecursive(const std::vector<glm::vec3>& centroids, std::vector<int>& indices, int begin, int end, int depth, int parallelThreshold, int parallelDepth) const {
+        std::unique_ptr<BuildNode> node = std::make_unique<BuildNode>();
+        node->begin = begin;
+        node->end = end;
+
+        Bounds centroidBounds;
+        for (int i = begin; i < end; ++i) {
+            node->bounds = Bounds::GetUnion(node->bounds, primitiveBounds_[indices[i]]);
+            centroidBounds.Extend(centroids[indices[i]]);
+        }
+
+        int count = end - begin;
+        if (count == 1 || depth >= MAX_DEPTH) {
+            return node;
+        }
+
+        // Find the best split plane over all axes.
+        // Cost is expressed relative to the cost of intersecting one primitive.
+        const float traversalCost = 1.0f;
+        const float leafCost = static_cast<float>(count);
+        float nodeArea = node->bounds.GetSurfaceArea();
+
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestSplit = -1; // Split is after bin 'bestSplit'.
+
+        const glm::vec3& centroidMinimum = centroidBounds.GetMinimum();
+        glm::vec3 centroidExtent = centroidBounds.GetDiagonal();
+
+        for (int axis = 0; axis < 3; ++axis) {
+            if (centroidExtent[axis] <= std::numeric_limits<float>::epsilon()) {
+                continue;
+            }
+
+            Bounds binBounds[NUM_BINS];
+            int binCounts[NUM_BINS] = { 0 };
+
+            float scale = static_cast<float>(NUM_BINS) / centroidExtent[axis];
+            for (int i = begin; i < end; ++i) {
+                int bin = std::min(static_cast<int>((centroids[indices[i]][axis] - centroidMinimum[axis]) * scale), NUM_BINS - 1);
+                binBounds[bin] = Bounds::GetUnion(binBounds[bin], primitiveBounds_[indices[i]]);
+                ++binCounts[bin];
+            }
+
+            // Sweep from the right to accumulate right-hand side areas.
+            float rightAreas[NUM_BINS - 1];
+            int rightCounts[NUM_BINS - 1];
+
+            Bounds accumulated;
+            int accumulatedCount = 0;
+            for (int bin = NUM_BINS - 1; bin > 0; --bin) {
+                accumulated = Bounds::GetUnion(accumulated, binBounds[bin]);
+                accumulatedCount += binCounts[bin];
+
+                rightAreas[bin - 1] = accumulated.GetSurfaceArea();
+                rightCounts[bin - 1] = accumulatedCount;
+            }
+
+            // Sweep from the left and evaluate each split.
+            accumulated = Bounds();
+            accumulatedCount = 0;
+            for (int bin = 0; bin < NUM_BINS - 1; ++bin) {
+                accumulated = Bounds::GetUnion(accumulated, binBounds[bin]);
+                accumulatedCount += binCounts[bin];
+
+                if (accumulatedCount == 0 || rightCounts[bin] == 0) {
+                    continue;
+                }
+
+                float cost = traversalCost + (accumulated.GetSurfaceArea() * static_cast<float>(accumulatedCount) + rightAreas[bin] * static_cast<float>(rightCounts[bin])) / nodeArea;
+                if (cost < bestCost) {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = bin;
+                }
+            }
+        }
+
+        if (count <= MAX_LEAF_SIZE && (bestAxis == -1 || bestCost >= leafCost)) {
+            // Splitting is not worth it.
+            return node;
+        }
+
+        int middle;
+
+        if (bestAxis != -1) {
+            float scale = static_cast<float>(NUM_BINS) / centroidExtent[bestAxis];
+            auto iterator = std::partition(indices.begin() + begin, indices.begin() + end, [&](int primitive) {
+                int bin = std::min(static_cast<int>((centroids[primitive][bestAxis] - centroidMinimum[bestAxis]) * scale), NUM_BINS - 1);
+                return bin <= bestSplit;
+            });
+
+            middle = static_cast<int>(iterator - indices.begin());
+        }
+        else {
+            // All centroids coincide, split the range in half to keep leaves small.
+            middle = begin + count / 2;
+        }
+
+        if (middle == begin || middle == end) {
+            middle = begin + count / 2;
+        }
+
+        if (count >= parallelThreshold && depth < parallelDepth) {
+            // Children cover disjoint index ranges and can be built independently.
+            std::future<std::unique_ptr<BuildNode>> left = std::async(std::launch::async, [&, begin, middle, depth]() {
+                return BuildRecursive(centroids, indices, begin, middle, depth + 1, parallelThreshold, parallelDepth);
+            });
+
+            node->children[1] = BuildRecursive(centroids, indices, middle, end, depth + 1, parallelThreshold, parallelDepth);
+            node->children[0] = left.get();
+        }
+        else {
+            node->children[0] = BuildRecursive(centroids, indices, begin, middle, depth + 1, parallelThreshold, parallelDepth);
+            node->children[1] = BuildRecursive(centroids, indices, middle, end, depth + 1, parallelThreshold, parallelDepth);
+        }
+
+        return node;
+    }
+
+    int BVH::Flatten(const BuildNode* buildNode) {
+        int index = static_cast<int>(nodes_.size());
+        nodes_.emplace_back();
+
+        // Pull up grandchildren until the node is full, always opening the child with the largest surface area.
+        std::vector<const BuildNode*> children;
+        if (buildNode->IsLeaf()) {
+            children.emplace_back(buildNode);
+        }
+        else {
+            children.emplace_back(buildNode->children[0].get());
+            children.emplace_back(buildNode->children[1].get());
+        }
+
+        while (children.size() < WIDTH) {
+            int largest = -1;
+            float largestArea = -1.0f;
+
+            for (int i = 0; i < children.size(); ++i) {
+                if (!children[i]->IsLeaf() && children[i]->bounds.GetSurfaceArea() > largestArea) {
+                    largest = i;
+                    largestArea = children[i]->bounds.GetSurfaceArea();
+                }
+            }
+
+            if (largest == -1) {
+                break;
+            }
+
+            const BuildNode* opened = children[largest];
+            children[largest] = opened->children[0].get();
+            children.emplace_back(opened->children[1].get());
+        }
+
+        {
+            Node& node = nodes_[index];
+            node.numChildren = static_cast<int>(children.size());
+
+            for (int i = 0; i < WIDTH; ++i) {
+                // Unused slots are masked out by the child count.
+                const Bounds& bounds = i < node.numChildren ? children[i]->bounds : bounds_;
+                const glm::vec3& minimum = bounds.GetMinimum();
+                const glm::vec3& maximum = bounds.GetMaximum();
+
+                node.minimumX[i] = minimum.x;
+                node.minimumY[i] = minimum.y;
+                node.minimumZ[i] = minimum.z;
+                node.maximumX[i] = maximum.x;
+                node.maximumY[i] = maximum.y;
+                node.maximumZ[i] = maximum.z;
+
+                node.children[i] = 0;
+                node.counts[i] = 0;
+            }
+        }
+
+        for (int i = 0; i < children.size(); ++i) {
+            const BuildNode* child = children[i];
+
+            if (child->IsLeaf()) {
+                nodes_[index].children[i] = child->begin;
+                nodes_[index].counts[i] = child->end - child->begin;
+            }
+            else {
+                // Flattening may reallocate the node array.
+                int childIndex = Flatten(child);
+                nodes_[index].children[i] = childIndex;
+            }
+        }
+
+        return index;
+    }
+
+    BVH::RayData BVH::GetRayData(const Ray& ray) {
+        RayData data { };
+        data.origin = ray.origin_;
+        data.inverseDirection = 1.0f / ray.direction_; // Division by zero yields infinities, which the slab test handles.
+        data.tMinimum = ray.tMinimum_;
+        return data;
+    }
+
+    int BVH::IntersectNode(const Node& node, const RayData& ray, float tMaximum, float* distances) {
+        int mask;
+
+#if defined(__AVX__)
+        __m256 originX = _mm256_set1_ps(ray.origin.x);
+        __m256 originY = _mm256_set1_ps(ray.origin.y);
+        __m256 originZ = _mm256_set1_ps(ray.origin.z);
+        __m256 inverseX = _mm256_set1_ps(ray.inverseDirection.x);
+        __m256 inverseY = _mm256_set1_ps(ray.inverseDirection.y);
+        __m256 inverseZ = _mm256_set1_ps(ray.inverseDirection.z);
+
+        __m256 t0x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minimumX), originX), inverseX);
+        __m256 t1x = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maximumX), originX), inverseX);
+        __m256 t0y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minimumY), originY), inverseY);
+        __m256 t1y = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maximumY), originY), inverseY);
+        __m256 t0z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.minimumZ), originZ), inverseZ);
+        __m256 t1z = _mm256_mul_ps(_mm256_sub_ps(_mm256_load_ps(node.maximumZ), originZ), inverseZ);
+
+        __m256 entry = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(t0x, t1x), _mm256_min_ps(t0y, t1y)), _mm256_max_ps(_mm256_min_ps(t0z, t1z), _mm256_set1_ps(ray.tMinimum)));
+        __m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(t0x, t1x), _mm256_max_ps(t0y, t1y)), _mm256_min_ps(_mm256_max_ps(t0z, t1z), _mm256_set1_ps(tMaximum)));
+
+        _mm256_storeu_ps(distances, entry);
+        mask = _mm256_movemask_ps(_mm256_cmp_ps(entry, exit, _CMP_LE_OQ));
+#elif defined(__SSE2__) || defined(_M_X64)
+        __m128 originX = _mm_set1_ps(ray.origin.x);
+        __m128 originY = _mm_set1_ps(ray.origin.y);
+        __m128 originZ = _mm_set1_ps(ray.origin.z);
+        __m128 inverseX = _mm_set1_ps(ray.inverseDirection.x);
+        __m128 inverseY = _mm_set1_ps(ray.inverseDirection.y);
+        __m128 inverseZ = _mm_set1_ps(ray.inverseDirection.z);
+
+        __m128 t0x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minimumX), originX), inverseX);
+        __m128 t1x = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maximumX), originX), inverseX);
+        __m128 t0y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minimumY), originY), inverseY);
+        __m128 t1y = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maximumY), originY), inverseY);
+        __m128 t0z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.minimumZ), originZ), inverseZ);
+        __m128 t1z = _mm_mul_ps(_mm_sub_ps(_mm_load_ps(node.maximumZ), originZ), inverseZ);
+
+        __m128 entry = _mm_max_ps(_mm_max_ps(_mm_min_ps(t0x, t1x), _mm_min_ps(t0y, t1y)), _mm_max_ps(_mm_min_ps(t0z, t1z), _mm_set1_ps(ray.tMinimum)));
+        __m128 exit = _mm_min_ps(_mm_min_ps(_mm_max_ps(t0x, t1x), _mm_max_ps(t0y, t1y)), _mm_min_ps(_mm_max_ps(t0z, t1z), _mm_set1_ps(tMaximum)));
+
+        _mm_storeu_ps(distances, entry);
+        mask = _mm_movemask_ps(_mm_cmple_ps(entry, exit));
+#else
+        mask = 0;
+
+        for (int i = 0; i < WIDTH; ++i) {
+            float t0x = (node.minimumX[i] - ray.origin.x) * ray.inverseDirection.x;
+            float t1x = (node.maximumX[i] - ray.origin.x) * ray.inverseDirection.x;
+            float t0y = (node.minimumY[i] - ray.origin.y) * ray.inverseDirection.y;
+            float t1y = (node.maximumY[i] - ray.origin.y) * ray.inverseDirection.y;
+            float t0z = (node.minimumZ[i] - ray.origin.z) * ray.inverseDirection.z;
+            float t1z = (node.maximumZ[i] - ray.origin.z) * ray.inverseDirection.z;
+
+            float entry = std::max(std::max(std::min(t0x, t1x), std::min(t0y, t1y)), std::max(std::min(t0z, t1z), ray.tMinimum));
+            float exit = std::min(std::min(std::max(t0x, t1x), std::max(t0y, t1y)), std::min(std::max(t0z, t1z), tMaximum));
+
+            distances[i] = entry;
+            mask |= (entry <= exit) << i;
+        }
+#endif
+
+        return mask & ((1 << node.numChildren) - 1);
+    }
+
+    int BVH::OverlapNode(const Node& node, const Bounds& bounds) {
+        const glm::vec3& minimum = bounds.GetMinimum();
+        const glm::vec3& maximum = bounds.GetMaximum();
+
+        int mask;
+
+#if defined(__AVX__)
+        __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(node.minimumX), _mm256_set1_ps(maximum.x), _CMP_LE_OQ), _mm256_cmp_ps(_mm256_load_ps(node.maximumX), _mm256_set1_ps(minimum.x), _CMP_GE_OQ));
+        __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(node.minimumY), _mm256_set1_ps(maximum.y), _CMP_LE_OQ), _mm256_cmp_ps(_mm256_load_ps(node.maximumY), _mm256_set1_ps(minimum.y), _CMP_GE_OQ));
+        __m256 overlapZ = _mm256_and_ps(_mm256_cmp_ps(_mm256_load_ps(node.minimumZ), _mm256_set1_ps(maximum.z), _CMP_LE_OQ), _mm256_cmp_ps(_mm256_load_ps(node.maximumZ), _mm256_set1_ps(minimum.z), _CMP_GE_OQ));
+        mask = _mm256_movemask_ps(_mm256_and_ps(overlapX, _mm256_and_ps(overlapY, overlapZ)));
+#elif defined(__SSE2__) || defined(_M_X64)
+        __m128 overlapX = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minimumX), _mm_set1_ps(maximum.x)), _mm_cmpge_ps(_mm_load_ps(node.maximumX), _mm_set1_ps(minimum.x)));
+        __m128 overlapY = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minimumY), _mm_set1_ps(maximum.y)), _mm_cmpge_ps(_mm_load_ps(node.maximumY), _mm_set1_ps(minimum.y)));
+        __m128 overlapZ = _mm_and_ps(_mm_cmple_ps(_mm_load_ps(node.minimumZ), _mm_set1_ps(maximum.z)), _mm_cmpge_ps(_mm_load_ps(node.maximumZ), _mm_set1_ps(minimum.z)));
+        mask = _mm_movemask_ps(_mm_and_ps(overlapX, _mm_and_ps(overlapY, overlapZ)));
+#else
+        mask = 0;
+
+        for (int i = 0; i < WIDTH; ++i) {
+            bool overlap = node.minimumX[i] <= maximum.x && node.maximumX[i] >= minimum.x &&
+                           node.minimumY[i] <= maximum.y && node.maximumY[i] >= minimum.y &&
+                           node.minimumZ[i] <= maximum.z && node.maximumZ[i] >= minimum.z;
+            mask |= overlap << i;
+        }
+#endif
+
+        return mask & ((1 << node.numChildren) - 1);
+    }
+
+}
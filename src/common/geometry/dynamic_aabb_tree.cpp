@@ -0,0 +1,387 @@
+
+#include "common/geometry/dynamic_aabb_tree.h"
+
+namespace Sandbox {
+
+    DynamicAABBTree::DynamicAABBTree(float margin, float relativeMargin) : root_(NULL_NODE),
+                                                                           freeList_(NULL_NODE),
+                                                                           proxyCount_(0),
+                                                                           margin_(margin),
+                                                                           relativeMargin_(relativeMargin)
+                                                                           {
+    }
+
+    DynamicAABBTree::~DynamicAABBTree() {
+    }
+
+    int DynamicAABBTree::Insert(const Bounds& bounds, int userData) {
+        int proxy = AllocateNode();
+
+        Node& node = nodes_[proxy];
+        node.bounds = Fatten(bounds);
+        node.userData = userData;
+        node.height = 0;
+
+        InsertLeaf(proxy);
+        ++proxyCount_;
+
+        return proxy;
+    }
+
+    void DynamicAABBTree::Remove(int proxy) {
+        assert(proxy >= 0 && proxy < static_cast<int>(nodes_.size()) && nodes_[proxy].IsLeaf());
+
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        --proxyCount_;
+    }
+
+    bool DynamicAABBTree::Move(int proxy, const Bounds& bounds) {
+        assert(proxy >= 0 && proxy < static_cast<int>(nodes_.size()) && nodes_[proxy].IsLeaf());
+
+        const Bounds& fatBounds = nodes_[proxy].bounds;
+
+        if (bounds.IsValid() && fatBounds.IsValid()) {
+            const glm::vec3& minimum = bounds.GetMinimum();
+            const glm::vec3& maximum = bounds.GetMaximum();
+            const glm::vec3& fatMinimum = fatBounds.GetMinimum();
+            const glm::vec3& fatMaximum = fatBounds.GetMaximum();
+
+            bool contained = minimum.x >= fatMinimum.x && minimum.y >= fatMinimum.y && minimum.z >= fatMinimum.z &&
+                             maximum.x <= fatMaximum.x && maximum.y <= fatMaximum.y && maximum.z <= fatMaximum.z;
+
+            // Objects that shrink significantly are re-inserted too, to keep the tree tight.
+            if (contained && Fatten(bounds).GetSurfaceArea() * 4.0f > fatBounds.GetSurfaceArea()) {
+                return false;
+            }
+        }
+
+        RemoveLeaf(proxy);
+        nodes_[proxy].bounds = Fatten(bounds);
+        InsertLeaf(proxy);
+
+        return true;
+    }
+
+    void DynamicAABBTree::Clear() {
+        nodes_.clear();
+        root_ = NULL_NODE;
+        freeList_ = NULL_NODE;
+        proxyCount_ = 0;
+    }
+
+    int DynamicAABBTree::GetUserData(int proxy) const {
+        assert(proxy >= 0 && proxy < static_cast<int>(nodes_.size()));
+        return nodes_[proxy].userData;
+    }
+
+    const Bounds& DynamicAABBTree::GetFatBounds(int proxy) const {
+        assert(proxy >= 0 && proxy < static_cast<int>(nodes_.size()));
+        return nodes_[proxy].bounds;
+    }
+
+    int DynamicAABBTree::GetProxyCount() const {
+        return proxyCount_;
+    }
+
+    int DynamicAABBTree::GetHeight() const {
+        return root_ == NULL_NODE ? 0 : nodes_[root_].height;
+    }
+
+    bool DynamicAABBTree::IsEmpty() const {
+        return root_ == NULL_NODE;
+    }
+
+    float DynamicAABBTree::GetSquaredDistance(const Bounds& bounds, const glm::vec3& point) {
+        if (!bounds.IsValid()) {
+            return std::numeric_limits<float>::max();
+        }
+
+        glm::vec3 closest = glm::clamp(point, bounds.GetMinimum(), bounds.GetMaximum());
+        glm::vec3 difference = point - closest;
+
+        return glm::dot(difference, difference);
+    }
+
+    int DynamicAABBTree::AllocateNode() {
+        int index;
+
+        if (freeList_ == NULL_NODE) {
+            index = static_cast<int>(nodes_.size());
+            nodes_.emplace_back();
+        }
+        else {
+            index = freeList_;
+            freeList_ = nodes_[index].parent;
+        }
+
+        Node& node = nodes_[index];
+        node.bounds = Bounds();
+        node.parent = NULL_NODE;
+        node.child1 = NULL_NODE;
+        node.child2 = NULL_NODE;
+        node.height = 0;
+        node.userData = -1;
+
+        return index;
+    }
+
+    void DynamicAABBTree::FreeNode(int index) {
+        Node& node = nodes_[index];
+        node.parent = freeList_;
+        node.height = -1;
+        freeList_ = index;
+    }
+
+    void DynamicAABBTree::InsertLeaf(int leaf) {
+        if (root_ == NULL_NODE) {
+            root_ = leaf;
+            nodes_[root_].parent = NULL_NODE;
+            return;
+        }
+
+        Bounds leafBounds = nodes_[leaf].bounds;
+
+        // Descend towards the sibling with the lowest cost (surface area heuristic).
+        int index = root_;
+        while (!nodes_[index].IsLeaf()) {
+            const Node& node = nodes_[index];
+
+            float area = node.bounds.GetSurfaceArea();
+            float combinedArea = Bounds::GetUnion(node.bounds, leafBounds).GetSurfaceArea();
+
+            // Cost of creating a new parent for this node and the new leaf.
+            float cost = 2.0f * combinedArea;
+
+            // Minimum cost of pushing the leaf further down the tree.
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float costs[2];
+            int children[2] = { node.child1, node.child2 };
+
+            for (int i = 0; i < 2; ++i) {
+                const Node& child = nodes_[children[i]];
+                float childArea = Bounds::GetUnion(child.bounds, leafBounds).GetSurfaceArea();
+
+                if (child.IsLeaf()) {
+                    costs[i] = childArea + inheritanceCost;
+                }
+                else {
+                    costs[i] = (childArea - child.bounds.GetSurfaceArea()) + inheritanceCost;
+                }
+            }
+
+            if (cost < costs[0] && cost < costs[1]) {
+                break;
+            }
+
+            index = costs[0] < costs[1] ? children[0] : children[1];
+        }
+
+        int sibling = index;
+
+        // Allocation may reallocate node storage, references are taken afterwards.
+        int parent = AllocateNode();
+        int oldParent = nodes_[sibling].parent;
+
+        Node& newParent = nodes_[parent];
+        newParent.parent = oldParent;
+        newParent.bounds = Bounds::GetUnion(leafBounds, nodes_[sibling].bounds);
+        newParent.height = nodes_[sibling].height + 1;
+        newParent.child1 = sibling;
+        newParent.child2 = leaf;
+
+        if (oldParent != NULL_NODE) {
+            if (nodes_[oldParent].child1 == sibling) {
+                nodes_[oldParent].child1 = parent;
+            }
+            else {
+                nodes_[oldParent].child2 = parent;
+            }
+        }
+        else {
+            root_ = parent;
+        }
+
+        nodes_[sibling].parent = parent;
+        nodes_[leaf].parent = parent;
+
+        Refit(nodes_[leaf].parent);
+    }
+
+    void DynamicAABBTree::RemoveLeaf(int leaf) {
+        if (leaf == root_) {
+            root_ = NULL_NODE;
+            return;
+        }
+
+        int parent = nodes_[leaf].parent;
+        int grandParent = nodes_[parent].parent;
+        int sibling = nodes_[parent].child1 == leaf ? nodes_[parent].child2 : nodes_[parent].child1;
+
+        // Sibling takes the place of the parent.
+        if (grandParent != NULL_NODE) {
+            if (nodes_[grandParent].child1 == parent) {
+                nodes_[grandParent].child1 = sibling;
+            }
+            else {
+                nodes_[grandParent].child2 = sibling;
+            }
+
+            nodes_[sibling].parent = grandParent;
+            FreeNode(parent);
+
+            Refit(grandParent);
+        }
+        else {
+            root_ = sibling;
+            nodes_[sibling].parent = NULL_NODE;
+            FreeNode(parent);
+        }
+    }
+
+    int DynamicAABBTree::Balance(int indexA) {
+        Node& A = nodes_[indexA];
+        if (A.IsLeaf() || A.height < 2) {
+            return indexA;
+        }
+
+        int indexB = A.child1;
+        int indexC = A.child2;
+        Node& B = nodes_[indexB];
+        Node& C = nodes_[indexC];
+
+        int balance = C.height - B.height;
+
+        // Rotate C up.
+        if (balance > 1) {
+            int indexF = C.child1;
+            int indexG = C.child2;
+            Node& F = nodes_[indexF];
+            Node& G = nodes_[indexG];
+
+            // Swap A and C.
+            C.child1 = indexA;
+            C.parent = A.parent;
+            A.parent = indexC;
+
+            // A's old parent should point to C.
+            if (C.parent != NULL_NODE) {
+                if (nodes_[C.parent].child1 == indexA) {
+                    nodes_[C.parent].child1 = indexC;
+                }
+                else {
+                    nodes_[C.parent].child2 = indexC;
+                }
+            }
+            else {
+                root_ = indexC;
+            }
+
+            // Keep the taller child of C under C.
+            if (F.height > G.height) {
+                C.child2 = indexF;
+                A.child2 = indexG;
+                G.parent = indexA;
+
+                A.bounds = Bounds::GetUnion(B.bounds, G.bounds);
+                C.bounds = Bounds::GetUnion(A.bounds, F.bounds);
+
+                A.height = 1 + std::max(B.height, G.height);
+                C.height = 1 + std::max(A.height, F.height);
+            }
+            else {
+                C.child2 = indexG;
+                A.child2 = indexF;
+                F.parent = indexA;
+
+                A.bounds = Bounds::GetUnion(B.bounds, F.bounds);
+                C.bounds = Bounds::GetUnion(A.bounds, G.bounds);
+
+                A.height = 1 + std::max(B.height, F.height);
+                C.height = 1 + std::max(A.height, G.height);
+            }
+
+            return indexC;
+        }
+
+        // Rotate B up.
+        if (balance < -1) {
+            int indexD = B.child1;
+            int indexE = B.child2;
+            Node& D = nodes_[indexD];
+            Node& E = nodes_[indexE];
+
+            // Swap A and B.
+            B.child1 = indexA;
+            B.parent = A.parent;
+            A.parent = indexB;
+
+            // A's old parent should point to B.
+            if (B.parent != NULL_NODE) {
+                if (nodes_[B.parent].child1 == indexA) {
+                    nodes_[B.parent].child1 = indexB;
+                }
+                else {
+                    nodes_[B.parent].child2 = indexB;
+                }
+            }
+            else {
+                root_ = indexB;
+            }
+
+            // Keep the taller child of B under B.
+            if (D.height > E.height) {
+                B.child2 = indexD;
+                A.child1 = indexE;
+                E.parent = indexA;
+
+                A.bounds = Bounds::GetUnion(C.bounds, E.bounds);
+                B.bounds = Bounds::GetUnion(A.bounds, D.bounds);
+
+                A.height = 1 + std::max(C.height, E.height);
+                B.height = 1 + std::max(A.height, D.height);
+            }
+            else {
+                B.child2 = indexE;
+                A.child1 = indexD;
+                D.parent = indexA;
+
+                A.bounds = Bounds::GetUnion(C.bounds, D.bounds);
+                B.bounds = Bounds::GetUnion(A.bounds, E.bounds);
+
+                A.height = 1 + std::max(C.height, D.height);
+                B.height = 1 + std::max(A.height, E.height);
+            }
+
+            return indexB;
+        }
+
+        return indexA;
+    }
+
+    void DynamicAABBTree::Refit(int index) {
+        while (index != NULL_NODE) {
+            index = Balance(index);
+
+            Node& node = nodes_[index];
+            const Node& child1 = nodes_[node.child1];
+            const Node& child2 = nodes_[node.child2];
+
+            node.height = 1 + std::max(child1.height, child2.height);
+            node.bounds = Bounds::GetUnion(child1.bounds, child2.bounds);
+
+            index = node.parent;
+        }
+    }
+
+    Bounds DynamicAABBTree::Fatten(const Bounds& bounds) const {
+        if (!bounds.IsValid()) {
+            return bounds;
+        }
+
+        glm::vec3 margin = glm::vec3(margin_) + bounds.GetDiagonal() * relativeMargin_;
+        return { bounds.GetMinimum() - margin, bounds.GetMaximum() + margin };
+    }
+
+}
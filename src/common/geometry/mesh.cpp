@@ -5,50 +5,28 @@
 
 namespace Sandbox {
 
-    Mesh::Mesh(VertexArrayObject* vao) : vao_(vao),
-                   isDirty_(false),
+    // Meshes may be built off of the render thread. Versions are unique across meshes, so replacing the mesh of an entity
+    // is detected as a change.
+    static std::atomic<unsigned> nextVersion { 0 };
+
+    Mesh::Mesh() : isDirty_(false),
+                   version_(++nextVersion),
                    topology_(MeshTopology::TRIANGLES),
                    vertexData_()
                    {
-//        // Mesh has one global data layout that does not change.
-//        vao_.Bind();
-//
-//        // Vertex position.
-//        {
-//            BufferLayout bufferLayout { };
-//            bufferLayout.SetBufferElements( { BufferElement { ShaderDataType::VEC3, "vertexPosition" } } );
-//            vao_.AddVBO("position", bufferLayout);
-//        }
-//
-//        // Vertex normal.
-//        {
-//            BufferLayout bufferLayout { };
-//            bufferLayout.SetBufferElements( { BufferElement { ShaderDataType::VEC3, "vertexNormal" } } );
-//            vao_.AddVBO("normal", bufferLayout);
-//        }
-//
-//        // Vertex UV coordinates.
-//        {
-//            BufferLayout bufferLayout { };
-//            bufferLayout.SetBufferElements( { BufferElement { ShaderDataType::VEC2, "vertexUV" } } );
-//            vao_.AddVBO("uv", bufferLayout);
-//        }
-//
-//        // TODO: TBN frame, skinned models.
-//
-//        vao_.Unbind();
     }
 
     Mesh::~Mesh() {
     }
 
-    Mesh::Mesh(const Mesh& other) : vao_(other.vao_),
-                                    isDirty_(true),  // Buffers need updating.
+    Mesh::Mesh(const Mesh& other) : geometry_(other.geometry_),
+                                    isDirty_(other.isDirty_),
+                                    version_(other.version_),
                                     topology_(other.topology_),
                                     vertexData_(other.vertexData_),
-                                    indices_(other.indices_)
+                                    indices_(other.indices_),
+                                    bounds_(other.bounds_)
                                     {
-        vao_->initialized = false;
     }
 
     Mesh &Mesh::operator=(const Mesh &other) {
@@ -56,109 +34,82 @@ namespace Sandbox {
             return *this;
         }
 
-        vao_ = other.vao_;
-        vao_->initialized = false;
-        isDirty_ = true;  // Buffers need updating.
+        geometry_ = other.geometry_;
+        isDirty_ = other.isDirty_;
+        version_ = other.version_;
         topology_ = other.topology_;
         vertexData_ = other.vertexData_;
         indices_ = other.indices_;
+        bounds_ = other.bounds_;
 
         return *this;
     }
 
     void Mesh::Bind() const {
-        // TODO: smart bind.
-        vao_->Bind();
+        GeometryArena::Instance().Bind();
     }
 
     void Mesh::Unbind() const {
-        vao_->Unbind();
+        GeometryArena::Instance().Unbind();
     }
 
     void Mesh::Render() {
-        vao_->Bind();
         Complete();
+        Bind();
 
-        // Indices array always has the most up-to-date index count.
-        Backend::Rendering::DrawIndexed(GetRenderingPrimitive(topology_), indices_.size());
+        Backend::Rendering::DrawIndexed(GetRenderingPrimitive(topology_), geometry_->indexCount, geometry_->firstIndex, geometry_->baseVertex);
     }
 
-    void Mesh::Complete() {
-        vao_->Bind();
-
-        if (!vao_->initialized || isDirty_) {
-            // Configure mesh buffer data.
-            // Vertex positions.
-            {
-                VertexBufferObject* vbo = vao_->GetVBO("position");
-                assert(vbo);
-
-                std::vector<glm::vec3> vertices = GetVertices();
-                assert(!vertices.empty());
-
-                vbo->SetData(vertices.size() * sizeof(vertices[0]), vertices.data());
-            }
-
-            // Vertex normals.
-            {
-                VertexBufferObject* vbo = vao_->GetVBO("normal");
-                assert(vbo);
+    void Mesh::RenderInstanced(int instanceCount) {
+        if (instanceCount <= 0) {
+            return;
+        }
 
-                std::vector<glm::vec3> normals = GetNormals();
-                if (normals.empty()) {
-                    // Recalculating normals requires vertices to be present, which was validated above.
-                    RecalculateNormals();
-                }
+        Complete();
+        Bind();
 
-                vbo->SetData(normals.size() * sizeof(normals[0]), normals.data());
-            }
+        Backend::Rendering::DrawIndexedInstanced(GetRenderingPrimitive(topology_), geometry_->indexCount, instanceCount, geometry_->firstIndex, geometry_->baseVertex);
+    }
 
-            // Texture coordinates.
-            {
-                VertexBufferObject* vbo = vao_->GetVBO("uv");
-                assert(vbo);
+    void Mesh::Complete() {
+        if (geometry_ && !isDirty_) {
+            return;
+        }
 
-                std::vector<glm::vec2> uv = GetUVs();
-                assert(!uv.empty());
+        assert(!vertexData_.empty());
 
-                vbo->SetData(uv.size() * sizeof(uv[0]), uv.data());
+        // Indices were not set, configure them by default based on mesh topology.
+        if (indices_.empty()) {
+            std::size_t numVertices = vertexData_.size();
+            for (unsigned i = 0; i < numVertices; ++i) {
+                indices_.emplace_back(i);
             }
+        }
 
-            // Indices.
-            {
-                ElementBufferObject* ebo = vao_->GetEBO();
-                assert(ebo);
-
-                // Indices were not set, configure them by default based on mesh topology.
-                if (indices_.empty()) {
-                    std::vector<glm::vec3> vertices = GetVertices();
-                    assert(!vertices.empty());
-
-                    std::size_t numVertices = vertices.size();
-                    for (unsigned i = 0; i < numVertices; ++i) {
-                        indices_.emplace_back(i);
-                    }
-                }
-
-                ebo->SetData(indices_.size() * sizeof(indices_[0]), indices_.data());
-            }
+        std::vector<GeometryArena::Vertex> vertices;
+        vertices.reserve(vertexData_.size());
 
-            vao_->initialized = true;
-            isDirty_ = false;
+        for (const Vertex& vertex : vertexData_) {
+            vertices.push_back({ vertex.vertex_, vertex.normal_, vertex.uv_ });
         }
+
+        // Copies of this mesh keep referencing the previous geometry, which is released once it is no longer used.
+        geometry_ = GeometryArena::Instance().Allocate(vertices, indices_);
+        isDirty_ = false;
     }
 
     void Mesh::RecalculateNormals() {
-        // Recalculate all vertex normals.
-        std::vector<glm::vec3> vertices = GetVertices();
+        SetNormals(CalculateNormals(GetVertices(), indices_));
+    }
 
+    std::vector<glm::vec3> Mesh::CalculateNormals(const std::vector<glm::vec3>& vertices, const std::vector<unsigned>& indices) {
         // Calculate unique contributing vertex normals, per vertex.
         // (vertex -> contributing face normals at that vertex)
         std::unordered_map<glm::vec3, std::unordered_set<glm::vec3>> contributingFaceNormals;
-        for (int i = 0; i < indices_.size(); i += 3) {
-            const glm::vec3& v1 = vertices[indices_[i + 0]];
-            const glm::vec3& v2 = vertices[indices_[i + 1]];
-            const glm::vec3& v3 = vertices[indices_[i + 2]];
+        for (int i = 0; i < indices.size(); i += 3) {
+            const glm::vec3& v1 = vertices[indices[i + 0]];
+            const glm::vec3& v2 = vertices[indices[i + 1]];
+            const glm::vec3& v3 = vertices[indices[i + 2]];
 
             const glm::vec3& faceNormal = glm::normalize(glm::cross(v3 - v2, v1 - v2));
 
@@ -185,7 +136,7 @@ namespace Sandbox {
             normals.emplace_back(glm::normalize(normal));
         }
 
-        SetNormals(normals);
+        return normals;
     }
 
     void Mesh::SetVertices(const std::vector<glm::vec3>& vertices) {
@@ -197,13 +148,13 @@ namespace Sandbox {
             bounds_.Extend(vertices[i]);
         }
 
-        isDirty_ = true;
+        Modify();
     }
 
     void Mesh::SetIndices(const std::vector<unsigned int>& indices, MeshTopology topology) {
         indices_ = indices;
         topology_ = topology;
-        isDirty_ = true;
+        Modify();
     }
 
     void Mesh::SetUVs(const std::vector<glm::vec2>& uv) {
@@ -214,7 +165,7 @@ namespace Sandbox {
             vertexData_[i].uv_ = uv[i];
         }
 
-        isDirty_ = true;
+        Modify();
     }
 
     void Mesh::SetNormals(const std::vector<glm::vec3>& normals) {
@@ -225,7 +176,7 @@ namespace Sandbox {
             vertexData_[i].normal_ = normals[i];
         }
 
-        isDirty_ = true;
+        Modify();
     }
 
     std::vector<glm::vec3> Mesh::GetVertices() const {
@@ -269,4 +220,22 @@ namespace Sandbox {
         return bounds_;
     }
 
+    MeshTopology Mesh::GetTopology() const {
+        return topology_;
+    }
+
+    unsigned Mesh::GetVersion() const {
+        return version_;
+    }
+
+    void Mesh::Modify() {
+        isDirty_ = true;
+        version_ = ++nextVersion;
+    }
+
+    std::shared_ptr<const GeometryArena::Allocation> Mesh::GetGeometry() {
+        Complete();
+        return geometry_;
+    }
+
 }
@@ -0,0 +1,112 @@
+
+#include "common/geometry/mesh_bvh.h"
+#include "common/utility/log.h"
+
+namespace Sandbox {
+
+    MeshBVH::MeshBVH() {
+    }
+
+    MeshBVH::MeshBVH(const Mesh& mesh) {
+        Build(mesh);
+    }
+
+    MeshBVH::~MeshBVH() {
+    }
+
+    void MeshBVH::Build(const Mesh& mesh) {
+        bvh_.Clear();
+
+        if (mesh.GetTopology() != MeshTopology::TRIANGLES) {
+            ImGuiLog::Instance().LogWarning("Building a MeshBVH requires triangle topology, BVH will be empty.");
+            vertices_.clear();
+            indices_.clear();
+            return;
+        }
+
+        vertices_ = mesh.GetVertices();
+        indices_ = mesh.GetIndices();
+
+        int numTriangles = static_cast<int>(indices_.size() / 3);
+
+        std::vector<Bounds> triangleBounds;
+        triangleBounds.reserve(numTriangles);
+
+        for (int i = 0; i < numTriangles; ++i) {
+            Bounds bounds(vertices_[indices_[3 * i + 0]]);
+            bounds.Extend(vertices_[indices_[3 * i + 1]]);
+            bounds.Extend(vertices_[indices_[3 * i + 2]]);
+            triangleBounds.emplace_back(bounds);
+        }
+
+        bvh_.Build(triangleBounds);
+    }
+
+    bool MeshBVH::ClosestHit(const Ray& ray, RayHit& hit) const {
+        return bvh_.ClosestHit(ray, [this](int triangle, const Ray& r, RayHit& h) {
+            return IntersectTriangle(triangle, r, h);
+        }, hit);
+    }
+
+    bool MeshBVH::AnyHit(const Ray& ray) const {
+        return bvh_.AnyHit(ray, [this](int triangle, const Ray& r, RayHit& h) {
+            return IntersectTriangle(triangle, r, h);
+        });
+    }
+
+    void MeshBVH::QueryOverlap(const Bounds& bounds, std::vector<int>& triangles) const {
+        bvh_.QueryOverlap(bounds, [&triangles](int triangle) {
+            triangles.emplace_back(triangle);
+        });
+    }
+
+    const BVH& MeshBVH::GetBVH() const {
+        return bvh_;
+    }
+
+    int MeshBVH::GetTriangleCount() const {
+        return static_cast<int>(indices_.size() / 3);
+    }
+
+    bool MeshBVH::IntersectTriangle(int triangle, const Ray& ray, RayHit& hit) const {
+        const glm::vec3& v0 = vertices_[indices_[3 * triangle + 0]];
+        const glm::vec3& v1 = vertices_[indices_[3 * triangle + 1]];
+        const glm::vec3& v2 = vertices_[indices_[3 * triangle + 2]];
+
+        glm::vec3 edge1 = v1 - v0;
+        glm::vec3 edge2 = v2 - v0;
+
+        glm::vec3 p = glm::cross(ray.direction_, edge2);
+        float determinant = glm::dot(edge1, p);
+
+        // Ray is parallel to the triangle (both faces are considered).
+        if (glm::abs(determinant) < std::numeric_limits<float>::epsilon()) {
+            return false;
+        }
+
+        float inverseDeterminant = 1.0f / determinant;
+
+        glm::vec3 s = ray.origin_ - v0;
+        float u = glm::dot(s, p) * inverseDeterminant;
+        if (u < 0.0f || u > 1.0f) {
+            return false;
+        }
+
+        glm::vec3 q = glm::cross(s, edge1);
+        float v = glm::dot(ray.direction_, q) * inverseDeterminant;
+        if (v < 0.0f || u + v > 1.0f) {
+            return false;
+        }
+
+        float t = glm::dot(edge2, q) * inverseDeterminant;
+        if (t < ray.tMinimum_ || t >= hit.t_) {
+            return false;
+        }
+
+        hit.primitive_ = triangle;
+        hit.t_ = t;
+        hit.barycentrics_ = glm::vec2(u, v);
+        return true;
+    }
+
+}
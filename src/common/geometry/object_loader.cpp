@@ -1,6 +1,5 @@
 
 #include "common/geometry/object_loader.h"
-#include "common/api/buffer/vao_manager.h"
 
 namespace Sandbox {
 
@@ -11,13 +10,17 @@ namespace Sandbox {
     }
 
     Mesh OBJLoader::LoadFromFile(const Request& request) {
-        const std::string& filename = request.filepath_;
-
-        if (meshes_.find(filename) != meshes_.end()) {
-            return meshes_.at(filename); // Make copy.
+        if (IsLoaded(request)) {
+            return meshes_.at(request.filepath_); // Make copy.
         }
 
         // Loading new mesh.
+        return Create(request, Parse(request));
+    }
+
+    OBJLoader::MeshData OBJLoader::Parse(const Request& request) const {
+        const std::string& filename = request.filepath_;
+
         std::unordered_map<glm::vec3, unsigned> uniqueVertices;
         std::vector<glm::vec3> vertices;
         std::vector<unsigned> indices;
@@ -87,17 +90,41 @@ namespace Sandbox {
             vertex = transform * glm::vec4(vertex, 1.0f);
         }
 
-        Mesh mesh { VAOManager::Instance().GetVAO(filename) };
-        mesh.SetVertices(vertices);
-        mesh.SetIndices(indices, MeshTopology::TRIANGLES);
-        mesh.SetUVs(uv);
-        mesh.RecalculateNormals();
+        MeshData data { };
+        data.normals = Mesh::CalculateNormals(vertices, indices);
+        data.vertices = std::move(vertices);
+        data.indices = std::move(indices);
+        data.uv = std::move(uv);
+
+        return data;
+    }
+
+    Mesh OBJLoader::Create(const Request& request, const MeshData& data) {
+        const std::string& filename = request.filepath_;
+
+        if (IsLoaded(request)) {
+            // Mesh was created by a different request in the meantime.
+            return meshes_.at(filename); // Make copy.
+        }
+
+        Mesh mesh { };
+        mesh.SetVertices(data.vertices);
+        mesh.SetIndices(data.indices, MeshTopology::TRIANGLES);
+        mesh.SetUVs(data.uv);
+        mesh.SetNormals(data.normals);
+
+        // Upload before caching so that all copies of the mesh share the same geometry.
+        mesh.Complete();
 
         // Save mesh for future use.
         meshes_.emplace(filename, mesh);
         return mesh;
     }
 
+    bool OBJLoader::IsLoaded(const Request& request) const {
+        return meshes_.find(request.filepath_) != meshes_.end();
+    }
+
     Mesh OBJLoader::LoadSphere() {
         if (meshes_.find("uv sphere") != meshes_.end()) {
             return meshes_.at("uv sphere"); // Make copy.
@@ -157,11 +184,12 @@ namespace Sandbox {
         }
 
         // Remove duplicates.
-        Mesh mesh { VAOManager::Instance().GetVAO("uv sphere") };
+        Mesh mesh { };
         mesh.SetVertices(vertices);
         mesh.SetNormals(normals);
         mesh.SetIndices(indices, MeshTopology::TRIANGLES);
         // mesh.RecalculateNormals(); // TODO: recalculate without any duplicate data.
+        mesh.Complete();
 
         // Save mesh for future use.
         meshes_.emplace("uv sphere", mesh);
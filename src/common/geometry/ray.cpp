@@ -0,0 +1,31 @@
+
+#include "common/geometry/ray.h"
+
+namespace Sandbox {
+
+    Ray::Ray(const glm::vec3& origin, const glm::vec3& direction, float tMinimum, float tMaximum) : origin_(origin),
+                                                                                                    direction_(direction),
+                                                                                                    tMinimum_(tMinimum),
+                                                                                                    tMaximum_(tMaximum)
+                                                                                                    {
+    }
+
+    Ray::~Ray() = default;
+
+    glm::vec3 Ray::At(float t) const {
+        return origin_ + direction_ * t;
+    }
+
+    RayHit::RayHit() : primitive_(-1),
+                       t_(std::numeric_limits<float>::max()),
+                       barycentrics_(0.0f)
+                       {
+    }
+
+    RayHit::~RayHit() = default;
+
+    bool RayHit::IsValid() const {
+        return primitive_ >= 0;
+    }
+
+}
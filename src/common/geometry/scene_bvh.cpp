@@ -0,0 +1,112 @@
+
+#include "common/geometry/scene_bvh.h"
+#include "common/geometry/transform.h"
+#include "common/ecs/ecs.h"
+
+namespace Sandbox {
+
+    SceneBVH::Hit::Hit() : entityID_(-1),
+                           triangle_(-1),
+                           t_(std::numeric_limits<float>::max()),
+                           position_(0.0f)
+                           {
+    }
+
+    SceneBVH::Hit::~Hit() = default;
+
+    bool SceneBVH::Hit::IsValid() const {
+        return entityID_ >= 0;
+    }
+
+    SceneBVH::SceneBVH() {
+    }
+
+    SceneBVH::~SceneBVH() {
+    }
+
+    void SceneBVH::Build() {
+        ECS& ecs = ECS::Instance();
+
+        entities_.clear();
+        std::vector<Bounds> entityBounds;
+
+        for (int entityID : ecs.GetEntityIDs<Transform, Mesh>()) {
+            Transform& transform = *ecs.GetComponent<Transform>(entityID);
+            Mesh& mesh = *ecs.GetComponent<Mesh>(entityID);
+
+            // Geometry shared between meshes only needs one triangle hierarchy.
+            std::shared_ptr<const GeometryArena::Allocation> geometry = mesh.GetGeometry();
+            MeshEntry& meshEntry = meshes_[geometry.get()];
+            if (!meshEntry.hierarchy) {
+                meshEntry.geometry = geometry;
+                meshEntry.hierarchy = std::make_unique<MeshBVH>(mesh);
+            }
+
+            const MeshBVH* meshBVH = meshEntry.hierarchy.get();
+
+            glm::mat4 matrix = transform.GetMatrix();
+            entities_.push_back({ entityID, glm::inverse(matrix), meshBVH });
+            entityBounds.emplace_back(Bounds::GetTransformed(mesh.GetBounds(), matrix));
+        }
+
+        bvh_.Build(entityBounds);
+    }
+
+    void SceneBVH::Clear() {
+        bvh_.Clear();
+        entities_.clear();
+        meshes_.clear();
+    }
+
+    bool SceneBVH::ClosestHit(const Ray& ray, Hit& hit) const {
+        RayHit entityHit { };
+        entityHit.t_ = std::min(hit.t_, ray.tMaximum_);
+
+        int triangle = -1;
+
+        bool found = bvh_.ClosestHit(ray, [this, &triangle](int index, const Ray& r, RayHit& h) {
+            const Entry& entry = entities_[index];
+
+            RayHit meshHit { };
+            meshHit.t_ = h.t_;
+
+            if (!entry.mesh->ClosestHit(ToObjectSpace(r, entry.inverseTransform), meshHit)) {
+                return false;
+            }
+
+            h.primitive_ = index;
+            h.t_ = meshHit.t_;
+            triangle = meshHit.primitive_;
+            return true;
+        }, entityHit);
+
+        if (found) {
+            hit.entityID_ = entities_[entityHit.primitive_].entityID;
+            hit.triangle_ = triangle;
+            hit.t_ = entityHit.t_;
+            hit.position_ = ray.At(entityHit.t_);
+        }
+
+        return found;
+    }
+
+    bool SceneBVH::AnyHit(const Ray& ray) const {
+        return bvh_.AnyHit(ray, [this](int index, const Ray& r, RayHit&) {
+            const Entry& entry = entities_[index];
+            return entry.mesh->AnyHit(ToObjectSpace(r, entry.inverseTransform));
+        });
+    }
+
+    void SceneBVH::QueryOverlap(const Bounds& bounds, std::vector<int>& entityIDs) const {
+        bvh_.QueryOverlap(bounds, [this, &entityIDs](int index) {
+            entityIDs.emplace_back(entities_[index].entityID);
+        });
+    }
+
+    Ray SceneBVH::ToObjectSpace(const Ray& ray, const glm::mat4& inverseTransform) {
+        glm::vec3 origin = inverseTransform * glm::vec4(ray.origin_, 1.0f);
+        glm::vec3 direction = inverseTransform * glm::vec4(ray.direction_, 0.0f);
+        return { origin, direction, ray.tMinimum_, ray.tMaximum_ };
+    }
+
+}
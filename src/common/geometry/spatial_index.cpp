@@ -0,0 +1,119 @@
+
+#include "common/geometry/spatial_index.h"
+#include "common/rendering/frustum_culler.h"
+
+namespace Sandbox {
+
+    SpatialIndex::SpatialIndex() {
+    }
+
+    SpatialIndex::~SpatialIndex() {
+    }
+
+    void SpatialIndex::Update(const FrustumCuller& culler) {
+        for (int entityID : culler.GetRemovedEntities()) {
+            Remove(entityID);
+        }
+
+        for (int entityID : culler.GetModifiedEntities()) {
+            Bounds bounds = culler.GetBounds(entityID);
+
+            auto iterator = proxies_.find(entityID);
+            if (iterator == proxies_.end()) {
+                Insert(entityID, bounds);
+            }
+            else {
+                int proxy = iterator->second;
+                bounds_[proxy] = bounds;
+                tree_.Move(proxy, bounds);
+            }
+        }
+    }
+
+    void SpatialIndex::Clear() {
+        tree_.Clear();
+        proxies_.clear();
+        bounds_.clear();
+    }
+
+    void SpatialIndex::QueryRadius(const glm::vec3& center, float radius, std::vector<int>& entityIDs) const {
+        float radiusSquared = radius * radius;
+
+        tree_.Query([&center, radiusSquared](const Bounds& bounds) {
+            return DynamicAABBTree::GetSquaredDistance(bounds, center) <= radiusSquared;
+        }, [this, &center, radiusSquared, &entityIDs](int proxy) {
+            if (DynamicAABBTree::GetSquaredDistance(bounds_[proxy], center) <= radiusSquared) {
+                entityIDs.emplace_back(tree_.GetUserData(proxy));
+            }
+            return true;
+        });
+    }
+
+    void SpatialIndex::QueryBox(const Bounds& bounds, std::vector<int>& entityIDs) const {
+        if (!bounds.IsValid()) {
+            return;
+        }
+
+        tree_.Query([&bounds](const Bounds& nodeBounds) {
+            return nodeBounds.IsValid() && Bounds::Overlap(nodeBounds, bounds);
+        }, [this, &bounds, &entityIDs](int proxy) {
+            if (bounds_[proxy].IsValid() && Bounds::Overlap(bounds_[proxy], bounds)) {
+                entityIDs.emplace_back(tree_.GetUserData(proxy));
+            }
+            return true;
+        });
+    }
+
+    void SpatialIndex::QueryFrustum(const Frustum& frustum, std::vector<int>& entityIDs) const {
+        tree_.Query([&frustum](const Bounds& bounds) {
+            return frustum.Intersects(bounds);
+        }, [this, &frustum, &entityIDs](int proxy) {
+            if (frustum.Intersects(bounds_[proxy])) {
+                entityIDs.emplace_back(tree_.GetUserData(proxy));
+            }
+            return true;
+        });
+    }
+
+    void SpatialIndex::QueryNearest(const glm::vec3& point, int k, std::vector<int>& entityIDs) const {
+        std::vector<int> proxies;
+        proxies.reserve(k);
+
+        tree_.QueryNearest(point, k, [this, &point](int proxy) {
+            return DynamicAABBTree::GetSquaredDistance(bounds_[proxy], point);
+        }, proxies);
+
+        for (int proxy : proxies) {
+            entityIDs.emplace_back(tree_.GetUserData(proxy));
+        }
+    }
+
+    int SpatialIndex::GetEntityCount() const {
+        return static_cast<int>(proxies_.size());
+    }
+
+    const DynamicAABBTree& SpatialIndex::GetTree() const {
+        return tree_;
+    }
+
+    void SpatialIndex::Insert(int entityID, const Bounds& bounds) {
+        int proxy = tree_.Insert(bounds, entityID);
+        proxies_[entityID] = proxy;
+
+        if (proxy >= static_cast<int>(bounds_.size())) {
+            bounds_.resize(proxy + 1);
+        }
+        bounds_[proxy] = bounds;
+    }
+
+    void SpatialIndex::Remove(int entityID) {
+        auto iterator = proxies_.find(entityID);
+        if (iterator == proxies_.end()) {
+            return;
+        }
+
+        tree_.Remove(iterator->second);
+        proxies_.erase(iterator);
+    }
+
+}
@@ -3,7 +3,11 @@
 
 namespace Sandbox {
 
+    // Versions are unique across transforms, so replacing a component is detected as a change.
+    static unsigned nextVersion = 0;
+
     Transform::Transform() : _isDirty(true),
+                             _version(++nextVersion),
                              _matrix(glm::mat4(1.0f)),
                              _rotation(glm::vec3(0.0f)),
                              _scale(glm::vec3(1.0f)),
@@ -16,7 +20,7 @@ namespace Sandbox {
     void Transform::SetPosition(glm::vec3 position) {
         if (_position != position) {
             _position = position;
-            _isDirty = true;
+            Modify();
         }
     }
 
@@ -35,7 +39,7 @@ namespace Sandbox {
     void Transform::SetScale(glm::vec3 scale) {
         if (_scale != scale) {
             _scale = scale;
-            _isDirty = true;
+            Modify();
         }
     }
 
@@ -58,7 +62,7 @@ namespace Sandbox {
 
         if (_rotation != rotation) {
             _rotation = rotation;
-            _isDirty = true;
+            Modify();
         }
     }
 
@@ -80,17 +84,17 @@ namespace Sandbox {
     void Transform::OnImGui() {
         ImGui::Text("Position:");
         if (ImGui::SliderFloat3("##position", (float *) (&_position), -5.0f, 5.0f)) {
-            _isDirty = true;
+            Modify();
         }
 
         ImGui::Text("Scale:");
         if (ImGui::SliderFloat3("##scale", (float *) (&_scale), -5.0f, 5.0f)) {
-            _isDirty = true;
+            Modify();
         }
 
         ImGui::Text("Rotation:");
         if (ImGui::SliderFloat3("##rotation", (float *) (&_rotation), -360.0f, 360.0f)) {
-            _isDirty = true;
+            Modify();
         }
     }
 
@@ -98,4 +102,13 @@ namespace Sandbox {
         return _isDirty;
     }
 
+    unsigned Transform::GetVersion() const {
+        return _version;
+    }
+
+    void Transform::Modify() {
+        _isDirty = true;
+        _version = ++nextVersion;
+    }
+
 }
\ No newline at end of file
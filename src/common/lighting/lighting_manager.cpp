@@ -1,12 +1,12 @@
 
 #include "common/lighting/lighting_manager.h"
+#include "common/api/buffer/streaming_buffer.h"
 #define MAX_NUM_LIGHTS 256
+#define BINDING_POINT 1
 
 namespace Sandbox {
 
-    LightingManager::LightingManager() : _numActiveLights(0u),
-                                         _lightingUBO(),
-                                         _isDirty(true) {
+    LightingManager::LightingManager() : _numActiveLights(0u) {
         ConstructUniformBlock();
     }
 
@@ -28,11 +28,8 @@ namespace Sandbox {
             elementList.emplace_back(UniformBufferElement { ShaderDataType::VEC3, "specularColor" });
         }
 
-        UniformBlockLayout lightingBlockLayout;
-        lightingBlockLayout.SetBufferElements(0, 5, elementList);
-
-        UniformBlock lightingBlock(1, lightingBlockLayout);
-        _lightingUBO.SetUniformBlock(lightingBlock);
+        _blockLayout.SetBufferElements(0, 5, elementList);
+        _blockData.resize(_blockLayout.GetStride(), 0);
     }
 
     void LightingManager::OnImGui() {
@@ -49,12 +46,9 @@ namespace Sandbox {
 //        ImGui::Separator();
         ImGui::BeginChild("#scrollingSection", ImVec2(0, 0), false, ImGuiWindowFlags_None);
 
-        for (int i = 0; i < _numActiveLights; ++i) {
-            std::list<Light>::iterator lightIter = _lights.begin();
-            std::advance(lightIter, i);
-            Light& light = *lightIter;
-
-            std::string lightID = std::to_string(i);
+        int i = 0;
+        for (Light& light : _lights) {
+            std::string lightID = std::to_string(i++);
             std::string lightName = "Light " + lightID;
             if (ImGui::TreeNode(lightName.c_str())) {
                 Transform& transform = light.GetTransform();
@@ -93,88 +87,39 @@ namespace Sandbox {
     }
 
     void LightingManager::Update() {
-        if (_isDirty) {
-            _lightingUBO.Bind();
-            UniformBlock& lightUniformBlock = _lightingUBO.GetUniformBlock();
-            UniformBlockLayout& lightBufferBlockLayout = lightUniformBlock.GetUniformBlockLayout();
-            const std::vector<UniformBufferElement>& lightBufferElements = lightBufferBlockLayout.GetBufferElements();
-            unsigned offset = lightBufferBlockLayout.GetInitialOffsetInElements();
-
-            for (int i = 0; i < _numActiveLights; ++i) {
-                std::list<Light>::iterator lightIter = _lights.begin();
-                std::advance(lightIter, i);
-
-                Light& light = *lightIter;
-                unsigned bufferElementIndex = offset + lightBufferBlockLayout.GetIntermediateOffsetInElements() * i;
-
-                if (light.IsDirty()) {
-                    // Update all of light's data.
-                    light.Clean(); // Update light data.
-
-                    // isActive
-                    {
-                        const UniformBufferElement& element = lightBufferElements[bufferElementIndex];
-                        unsigned elementOffset = element.GetBufferOffset();
-                        unsigned elementDataSize = UniformBufferElement::UBOShaderDataTypeSize(element.GetShaderDataType());
-                        bool isActive = light.IsActive();
-                        _lightingUBO.SetSubData(elementOffset, elementDataSize, static_cast<const void*>(&isActive));
-                    }
-
-                    ++bufferElementIndex;
-
-                    // position
-                    {
-                        const UniformBufferElement& element = lightBufferElements[bufferElementIndex];
-                        unsigned elementOffset = element.GetBufferOffset();
-                        unsigned elementDataSize = UniformBufferElement::UBOShaderDataTypeSize(element.GetShaderDataType());
-                        const glm::vec3& position = light.GetTransform().GetPosition();
-                        _lightingUBO.SetSubData(elementOffset, elementDataSize, static_cast<const void*>(&position));
-                    }
-
-                    ++bufferElementIndex;
-
-                    // ambientColor
-                    {
-                        const UniformBufferElement& element = lightBufferElements[bufferElementIndex];
-                        unsigned elementOffset = element.GetBufferOffset();
-                        unsigned elementDataSize = UniformBufferElement::UBOShaderDataTypeSize(element.GetShaderDataType());
-                        const glm::vec3& ambientColor = light.GetAmbientColor();
-                        _lightingUBO.SetSubData(elementOffset, elementDataSize, static_cast<const void*>(&ambientColor));
-                    }
-
-                    ++bufferElementIndex;
-
-                    // diffuseColor
-                    {
-                        const UniformBufferElement& element = lightBufferElements[bufferElementIndex];
-                        unsigned elementOffset = element.GetBufferOffset();
-                        unsigned elementDataSize = UniformBufferElement::UBOShaderDataTypeSize(element.GetShaderDataType());
-                        const glm::vec3& diffuseColor = light.GetDiffuseColor();
-                        _lightingUBO.SetSubData(elementOffset, elementDataSize, static_cast<const void*>(&diffuseColor));
-                    }
-
-                    ++bufferElementIndex;
-
-                    // specularColor
-                    {
-                        const UniformBufferElement& element = lightBufferElements[bufferElementIndex];
-                        unsigned elementOffset = element.GetBufferOffset();
-                        unsigned elementDataSize = UniformBufferElement::UBOShaderDataTypeSize(element.GetShaderDataType());
-                        const glm::vec3& specularColor = light.GetSpecularColor();
-                        _lightingUBO.SetSubData(elementOffset, elementDataSize, static_cast<const void*>(&specularColor));
-                    }
-                }
+        const std::vector<UniformBufferElement>& elements = _blockLayout.GetBufferElements();
+        unsigned elementIndex = _blockLayout.GetInitialOffsetInElements();
+
+        auto write = [this, &elements](unsigned index, const void* data, std::size_t size) {
+            std::memcpy(_blockData.data() + elements[index].GetBufferOffset(), data, size);
+        };
+
+        for (Light& light : _lights) {
+            if (light.IsDirty()) {
+                light.Clean(); // Update light data.
+
+                // GLSL booleans take four bytes.
+                int isActive = light.IsActive() ? 1 : 0;
+                glm::vec3 position = light.GetTransform().GetPosition();
+
+                write(elementIndex + 0, &isActive, sizeof(int));
+                write(elementIndex + 1, &position, sizeof(glm::vec3));
+                write(elementIndex + 2, &light.GetAmbientColor(), sizeof(glm::vec3));
+                write(elementIndex + 3, &light.GetDiffuseColor(), sizeof(glm::vec3));
+                write(elementIndex + 4, &light.GetSpecularColor(), sizeof(glm::vec3));
             }
 
-            _isDirty = false;
-            _lightingUBO.Unbind();
+            elementIndex += _blockLayout.GetIntermediateOffsetInElements();
         }
+
+        StreamingBuffer& streamingBuffer = StreamingBuffer::Instance();
+        StreamingBuffer::Allocation allocation = streamingBuffer.Write(_blockData.data(), _blockData.size(), GL_UNIFORM_BUFFER);
+        streamingBuffer.BindRange(GL_UNIFORM_BUFFER, BINDING_POINT, allocation);
     }
 
     void LightingManager::AddLight(const Light& light) {
         _lights.push_back(light);
         ++_numActiveLights;
-        _isDirty = true;
     }
 
 }
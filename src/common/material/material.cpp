@@ -3,7 +3,9 @@
 
 namespace Sandbox {
 
-    Material::Material(std::string name, std::initializer_list<std::pair<std::string, ShaderUniform::UniformEntry>> uniforms) : _name(std::move(name)) {
+    Material::Material(std::string name, std::initializer_list<std::pair<std::string, ShaderUniform::UniformEntry>> uniforms) : _name(std::move(name)),
+                                                                                                                                 _dirty(true)
+                                                                                                                                 {
         for (const std::pair<std::string, ShaderUniform::UniformEntry>& uniformData : uniforms) {
             const std::string& uniformName = uniformData.first;
             const ShaderUniform::UniformEntry& uniform = uniformData.second;
@@ -25,6 +27,7 @@ namespace Sandbox {
             _uniforms.emplace(uniformData);
         }
 
+        _dirty = true;
         return *this;
     }
 
@@ -34,7 +37,9 @@ namespace Sandbox {
 
     void Material::OnImGui() {
         for (const std::pair<std::string, ShaderUniform*>& uniformData : _uniforms) {
-            uniformData.second->OnImGui();
+            if (uniformData.second->OnImGui()) {
+                _dirty = true;
+            }
         }
     }
 
@@ -54,7 +59,7 @@ namespace Sandbox {
         return _name;
     }
 
-    Material::Material(const Material &other) {
+    Material::Material(const Material &other) : _dirty(true) {
         _name = other._name;
 
         for (const auto& uniformData : other._uniforms) {
@@ -67,6 +72,7 @@ namespace Sandbox {
 
     void Material::SetUniform(const std::string &uniformName, ShaderUniform::UniformEntry uniformData) {
         _uniforms[uniformName] = new ShaderUniform(uniformName, uniformData);
+        _dirty = true;
     }
 
     ShaderUniform *Material::GetUniform(const std::string &uniformName) const {
@@ -78,6 +84,18 @@ namespace Sandbox {
         return nullptr;
     }
 
+    const std::unordered_map<std::string, ShaderUniform*>& Material::GetUniforms() const {
+        return _uniforms;
+    }
+
+    void Material::MarkDirty() {
+        _dirty = true;
+    }
+
+    bool Material::IsDirty() const {
+        return _dirty;
+    }
+
     MaterialCollection::MaterialCollection() {
     }
 
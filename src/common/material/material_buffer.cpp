@@ -0,0 +1,230 @@
+
+#include "common/material/material_buffer.h"
+
+namespace Sandbox {
+
+    MaterialBuffer::MaterialBuffer(std::string blockName) : blockName_(std::move(blockName)),
+                                                            shader_(nullptr),
+                                                            linkID_(0u),
+                                                            stride_(0),
+                                                            dirtyBegin_(0),
+                                                            dirtyEnd_(0),
+                                                            reallocate_(false),
+                                                            uploadedBytes_(0),
+                                                            buffer_(BINDING_POINT)
+                                                            {
+    }
+
+    MaterialBuffer::~MaterialBuffer() {
+    }
+
+    void MaterialBuffer::SetLayout(Shader* shader) {
+        shader_ = shader;
+        Reflect();
+    }
+
+    int MaterialBuffer::GetMaterialID(Material* material) {
+        if (!material) {
+            throw std::runtime_error("Material buffer '" + blockName_ + "' cannot hold a record for a null material.");
+        }
+
+        auto iterator = materialIDs_.find(material);
+        if (iterator != materialIDs_.end()) {
+            return iterator->second;
+        }
+
+        int materialID = static_cast<int>(materials_.size());
+        materials_.emplace_back(material);
+        materialIDs_.emplace(material, materialID);
+
+        material->MarkDirty();
+        return materialID;
+    }
+
+    void MaterialBuffer::Update() {
+        uploadedBytes_ = 0;
+
+        if (!shader_) {
+            throw std::runtime_error("Material buffer '" + blockName_ + "' has no layout.");
+        }
+
+        // Hot reload may have changed the layout, all records are rewritten.
+        if (shader_->GetLinkID() != linkID_) {
+            Reflect();
+        }
+
+        std::size_t size = materials_.size() * stride_;
+        if (data_.size() < size) {
+            data_.resize(size, 0);
+            reallocate_ = true;
+        }
+
+        dirtyBegin_ = data_.size();
+        dirtyEnd_ = 0;
+
+        for (int i = 0; i < static_cast<int>(materials_.size()); ++i) {
+            Material* material = materials_[i];
+            if (!material->IsDirty()) {
+                continue;
+            }
+
+            WriteRecord(i);
+            material->_dirty = false;
+
+            dirtyBegin_ = std::min(dirtyBegin_, i * stride_);
+            dirtyEnd_ = std::max(dirtyEnd_, (i + 1) * stride_);
+        }
+
+        if (reallocate_) {
+            buffer_.SetData(data_.size(), data_.data());
+            uploadedBytes_ = data_.size();
+            reallocate_ = false;
+        }
+        else if (dirtyBegin_ < dirtyEnd_) {
+            buffer_.Bind();
+            buffer_.SetSubData(dirtyBegin_, dirtyEnd_ - dirtyBegin_, data_.data() + dirtyBegin_);
+            buffer_.Unbind();
+            uploadedBytes_ = dirtyEnd_ - dirtyBegin_;
+        }
+    }
+
+    void MaterialBuffer::Bind() const {
+        buffer_.BindBase();
+    }
+
+    void MaterialBuffer::Clear() {
+        materials_.clear();
+        materialIDs_.clear();
+        data_.clear();
+        reallocate_ = true;
+    }
+
+    int MaterialBuffer::GetMaterialCount() const {
+        return static_cast<int>(materials_.size());
+    }
+
+    std::size_t MaterialBuffer::GetRecordSize() const {
+        return stride_;
+    }
+
+    std::size_t MaterialBuffer::GetUploadedBytes() const {
+        return uploadedBytes_;
+    }
+
+    void MaterialBuffer::Reflect() {
+        GLuint program = shader_->GetID();
+        linkID_ = shader_->GetLinkID();
+        members_.clear();
+        stride_ = 0;
+
+        GLuint blockIndex = glGetProgramResourceIndex(program, GL_SHADER_STORAGE_BLOCK, blockName_.c_str());
+        if (blockIndex == GL_INVALID_INDEX) {
+            throw std::runtime_error("Shader '" + shader_->GetName() + "' has no storage block '" + blockName_ + "'.");
+        }
+
+        GLenum countProperty = GL_NUM_ACTIVE_VARIABLES;
+        GLint variableCount = 0;
+        glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, blockIndex, 1, &countProperty, 1, nullptr, &variableCount);
+
+        std::vector<GLint> variables(variableCount);
+        GLenum variablesProperty = GL_ACTIVE_VARIABLES;
+        glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, blockIndex, 1, &variablesProperty, variableCount, nullptr, variables.data());
+
+        const GLenum properties[] = { GL_NAME_LENGTH, GL_OFFSET, GL_TYPE, GL_MATRIX_STRIDE, GL_TOP_LEVEL_ARRAY_STRIDE };
+        std::vector<char> name;
+
+        for (GLint variable : variables) {
+            GLint values[5] = { };
+            glGetProgramResourceiv(program, GL_BUFFER_VARIABLE, static_cast<GLuint>(variable), 5, properties, 5, nullptr, values);
+
+            name.resize(values[0]);
+            glGetProgramResourceName(program, GL_BUFFER_VARIABLE, static_cast<GLuint>(variable), values[0], nullptr, name.data());
+
+            // Reported as 'materials[0].member', offsets are relative to the start of the first record.
+            std::string memberName(name.data());
+            memberName = memberName.substr(memberName.find_last_of('.') + 1);
+
+            members_[memberName] = { static_cast<std::size_t>(values[1]), static_cast<GLenum>(values[2]), static_cast<std::size_t>(values[3]) };
+            stride_ = static_cast<std::size_t>(values[4]);
+        }
+
+        if (stride_ == 0) {
+            throw std::runtime_error("Storage block '" + blockName_ + "' of shader '" + shader_->GetName() + "' is not an array of material records.");
+        }
+
+        // Records of all materials are rebuilt with the new layout.
+        data_.assign(materials_.size() * stride_, 0);
+        reallocate_ = true;
+
+        for (Material* material : materials_) {
+            material->MarkDirty();
+        }
+    }
+
+    void MaterialBuffer::WriteRecord(int materialID) {
+        char* record = data_.data() + materialID * stride_;
+
+        for (const std::pair<const std::string, ShaderUniform*>& uniform : materials_[materialID]->GetUniforms()) {
+            auto iterator = members_.find(uniform.first);
+
+            // Uniform is not part of the record.
+            if (iterator == members_.end()) {
+                continue;
+            }
+
+            const Member& member = iterator->second;
+            char* destination = record + member.offset;
+
+            auto check = [this, &uniform, &member](GLenum type) {
+                if (member.type != type) {
+                    throw std::runtime_error("Type of material uniform '" + uniform.first + "' does not match its member in storage block '" + blockName_ + "'.");
+                }
+            };
+
+            auto write = [&check, destination](GLenum type, const void* source, std::size_t size) {
+                check(type);
+                std::memcpy(destination, source, size);
+            };
+
+            std::visit([&](const auto& value) {
+                using Type = std::decay_t<decltype(value)>;
+
+                // GLSL booleans take four bytes.
+                if constexpr (std::is_same_v<Type, bool>) {
+                    int data = value ? 1 : 0;
+                    write(GL_BOOL, &data, sizeof(int));
+                }
+                else if constexpr (std::is_same_v<Type, int>) {
+                    write(GL_INT, &value, sizeof(int));
+                }
+                else if constexpr (std::is_same_v<Type, float>) {
+                    write(GL_FLOAT, &value, sizeof(float));
+                }
+                else if constexpr (std::is_same_v<Type, glm::vec2>) {
+                    write(GL_FLOAT_VEC2, glm::value_ptr(value), sizeof(glm::vec2));
+                }
+                else if constexpr (std::is_same_v<Type, glm::vec3>) {
+                    write(GL_FLOAT_VEC3, glm::value_ptr(value), sizeof(glm::vec3));
+                }
+                else if constexpr (std::is_same_v<Type, glm::vec4>) {
+                    write(GL_FLOAT_VEC4, glm::value_ptr(value), sizeof(glm::vec4));
+                }
+                else if constexpr (std::is_same_v<Type, glm::mat3>) {
+                    check(GL_FLOAT_MAT3);
+
+                    // Columns are padded to the matrix stride.
+                    for (int column = 0; column < 3; ++column) {
+                        std::memcpy(destination + column * member.matrixStride, glm::value_ptr(value[column]), sizeof(glm::vec3));
+                    }
+                }
+                else if constexpr (std::is_same_v<Type, glm::mat4>) {
+                    write(GL_FLOAT_MAT4, glm::value_ptr(value), sizeof(glm::mat4));
+                }
+                else {
+                    throw std::runtime_error("Material uniform '" + uniform.first + "' cannot be stored in a material record.");
+                }
+            }, uniform.second->GetData());
+        }
+    }
+
+}
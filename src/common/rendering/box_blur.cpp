@@ -0,0 +1,92 @@
+
+#include "common/rendering/box_blur.h"
+
+namespace Sandbox {
+
+    static constexpr UniformName SOURCE("src");
+    static constexpr UniformName DESTINATION("dst");
+    static constexpr UniformName RADIUS("radius");
+    static constexpr UniformName AXIS("axis");
+    static constexpr UniformName SEGMENT_LENGTH_UNIFORM("segmentLength");
+
+    int BoxBlur::radiusOverride_ = -1;
+
+    BoxBlur::BoxBlur() : radius_(0),
+                         boxRadii_ { }
+                         {
+    }
+
+    BoxBlur::~BoxBlur() {
+    }
+
+    void BoxBlur::SetRadius(int radius) {
+        radius_ = std::max(radiusOverride_ >= 0 ? radiusOverride_ : radius, 0);
+
+        // Widths of n boxes with a combined variance of sigma ^ 2. The lower width is used by the first m boxes, widths
+        // two pixels wider by the rest, keeping boxes of odd widths centered.
+        float sigma = static_cast<float>(radius_) / 2.0f;
+        float n = static_cast<float>(PASSES);
+
+        int lower = static_cast<int>(std::floor(std::sqrt(12.0f * sigma * sigma / n + 1.0f)));
+        if (lower % 2 == 0) {
+            --lower;
+        }
+
+        float width = static_cast<float>(lower);
+        int m = static_cast<int>(std::round((12.0f * sigma * sigma - n * width * width - 4.0f * n * width - 3.0f * n) / (-4.0f * width - 4.0f)));
+
+        for (int i = 0; i < PASSES; ++i) {
+            int boxWidth = i < m ? lower : lower + 2;
+            boxRadii_[i] = (boxWidth - 1) / 2;
+        }
+    }
+
+    int BoxBlur::GetRadius() const {
+        return radius_;
+    }
+
+    void BoxBlur::SetRadiusOverride(int radius) {
+        radiusOverride_ = radius;
+    }
+
+    void BoxBlur::Blur(Shader* blurShader, const Texture* source, const Texture* destination, const Texture* scratch) const {
+        GLenum format = source->GetInternalFormat();
+
+        blurShader->Bind();
+        blurShader->SetUniform(SOURCE, 0);
+        blurShader->SetUniform(DESTINATION, 1);
+
+        // Passes alternate between the scratch and destination textures, the last one writes the destination.
+        const Texture* input = source;
+
+        for (int pass = 0; pass < 2 * PASSES; ++pass) {
+            const Texture* output = pass % 2 == 0 ? scratch : destination;
+            int axis = pass / PASSES;
+
+            glBindImageTexture(0, input->ID(), 0, GL_FALSE, 0, GL_READ_ONLY, format);
+            glBindImageTexture(1, output->ID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, format);
+
+            int radius = boxRadii_[pass % PASSES];
+
+            // Segments at least as wide as the box spend less time priming their window than filtering.
+            int segmentLength = std::max(SEGMENT_LENGTH, 2 * radius + 1);
+
+            blurShader->SetUniform(RADIUS, radius);
+            blurShader->SetUniform(AXIS, axis);
+            blurShader->SetUniform(SEGMENT_LENGTH_UNIFORM, segmentLength);
+
+            // One invocation per segment of every row or column.
+            int lines = axis == 0 ? source->GetHeight() : source->GetWidth();
+            int lineLength = axis == 0 ? source->GetWidth() : source->GetHeight();
+            glDispatchCompute((lines + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, (lineLength + segmentLength - 1) / segmentLength, 1);
+
+            // Next pass reads what this one wrote, the result may be sampled afterwards.
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+
+            input = output;
+        }
+
+        blurShader->Unbind();
+    }
+
+}
@@ -0,0 +1,25 @@
+
+#include "common/rendering/frame_constants.h"
+#include "common/api/buffer/streaming_buffer.h"
+
+namespace Sandbox {
+
+    FrameConstants::FrameConstants(ICamera& camera, float exposure, float contrast) : cameraTransform_(camera.GetCameraTransform()),
+                                                                                      inverseCameraTransform_(glm::inverse(cameraTransform_)),
+                                                                                      cameraPosition_(camera.GetPosition()),
+                                                                                      nearPlane_(camera.GetNearPlaneDistance()),
+                                                                                      farPlane_(camera.GetFarPlaneDistance()),
+                                                                                      exposure_(exposure),
+                                                                                      contrast_(contrast),
+                                                                                      padding_(0.0f)
+                                                                                      {
+        static_assert(sizeof(FrameConstants) == 160, "FrameConstants must match the std140 layout of the uniform block.");
+    }
+
+    void FrameConstants::Bind() const {
+        StreamingBuffer& streamingBuffer = StreamingBuffer::Instance();
+        StreamingBuffer::Allocation allocation = streamingBuffer.Write(this, sizeof(FrameConstants), GL_UNIFORM_BUFFER);
+        streamingBuffer.BindRange(GL_UNIFORM_BUFFER, BINDING_POINT, allocation);
+    }
+
+}
@@ -0,0 +1,443 @@
+
+#include "common/rendering/frame_graph.h"
+#include "common/api/backend.h"
+#include "common/utility/profiler.h"
+
+namespace Sandbox {
+
+    // Pooled textures not used by any render target for this many frames are released.
+    static const int TEXTURE_RETIRE_FRAMES = 3;
+
+    static std::size_t GetTextureSize(GLenum format, int width, int height) {
+        return Texture::GetPixelSize(format) * static_cast<std::size_t>(width) * static_cast<std::size_t>(height);
+    }
+
+    FrameGraph::TextureDescription FrameGraph::TextureDescription::Relative(GLenum format, float scale) {
+        return { format, scale, 0, 0 };
+    }
+
+    FrameGraph::TextureDescription FrameGraph::TextureDescription::Absolute(GLenum format, int width, int height) {
+        return { format, 0.0f, width, height };
+    }
+
+    FrameGraph::PassBuilder::PassBuilder(FrameGraph& graph, int passID) : graph_(graph),
+                                                                         passID_(passID)
+                                                                         {
+    }
+
+    void FrameGraph::PassBuilder::Create(const std::string& name, const TextureDescription& description) {
+        if (graph_.resourceIDs_.find(name) != graph_.resourceIDs_.end()) {
+            throw std::runtime_error("Frame graph render target '" + name + "' is declared more than once.");
+        }
+
+        graph_.resourceIDs_.emplace(name, static_cast<int>(graph_.resources_.size()));
+        graph_.resources_.push_back({ name, description, false, false, { }, 0, -1, -1, -1, nullptr });
+    }
+
+    void FrameGraph::PassBuilder::Read(const std::string& name) {
+        graph_.passes_[passID_].reads.push_back(graph_.GetResourceID(name));
+    }
+
+    void FrameGraph::PassBuilder::Write(const std::string& name) {
+        int resourceID = graph_.GetResourceID(name);
+        graph_.passes_[passID_].writes.push_back(resourceID);
+        graph_.resources_[resourceID].writers.push_back(passID_);
+    }
+
+    void FrameGraph::PassBuilder::WriteStorage(const std::string& name) {
+        int resourceID = graph_.GetResourceID(name);
+        graph_.passes_[passID_].storage.push_back(resourceID);
+        graph_.resources_[resourceID].writers.push_back(passID_);
+    }
+
+    void FrameGraph::PassBuilder::SetSideEffect() {
+        graph_.passes_[passID_].sideEffect = true;
+    }
+
+    FrameGraph::FrameGraph() : width_(1),
+                               height_(1),
+                               frame_(0),
+                               statistics_()
+                               {
+    }
+
+    FrameGraph::~FrameGraph() {
+        Clear();
+    }
+
+    void FrameGraph::SetSize(int width, int height) {
+        if (width == width_ && height == height_) {
+            return;
+        }
+
+        // Render targets of the current graph may reference released textures.
+        Reset();
+
+        width_ = width;
+        height_ = height;
+
+        // Relative render targets can no longer reuse these, everything else is unaffected by the resize.
+        for (auto iterator = pool_.begin(); iterator != pool_.end();) {
+            if (iterator->relative) {
+                DestroyFramebuffers(iterator->texture->ID());
+                iterator = pool_.erase(iterator);
+            }
+            else {
+                ++iterator;
+            }
+        }
+    }
+
+    void FrameGraph::Import(const std::string& name, Texture* texture) {
+        if (resourceIDs_.find(name) != resourceIDs_.end()) {
+            throw std::runtime_error("Frame graph render target '" + name + "' is declared more than once.");
+        }
+
+        TextureDescription description = TextureDescription::Absolute(texture->GetInternalFormat(), texture->GetWidth(), texture->GetHeight());
+
+        resourceIDs_.emplace(name, static_cast<int>(resources_.size()));
+        resources_.push_back({ name, description, true, false, { }, 0, -1, -1, -1, texture });
+    }
+
+    void FrameGraph::MarkOutput(const std::string& name) {
+        resources_[GetResourceID(name)].output = true;
+    }
+
+    void FrameGraph::AddPass(const std::string& name, const std::function<void(PassBuilder&)>& setup, const std::function<void()>& execute) {
+        int passID = static_cast<int>(passes_.size());
+        passes_.push_back({ name, execute, { }, { }, { }, false, 0, false });
+
+        PassBuilder builder(*this, passID);
+        setup(builder);
+    }
+
+    void FrameGraph::Compile() {
+        statistics_ = { };
+        statistics_.passes = static_cast<int>(passes_.size());
+
+        Cull();
+        ComputeLifetimes();
+        AssignTextures();
+        ReleaseUnused();
+
+        for (const PooledTexture& pooled : pool_) {
+            statistics_.bytes += GetTextureSize(pooled.format, pooled.width, pooled.height);
+        }
+        statistics_.textures = static_cast<int>(pool_.size());
+    }
+
+    void FrameGraph::Execute() {
+        glm::vec4 viewport = Backend::Core::GetViewport();
+
+        for (const Pass& pass : passes_) {
+            if (pass.culled) {
+                continue;
+            }
+
+            // Passes without attachments (compute) leave the framebuffer binding alone.
+            if (!pass.writes.empty()) {
+                Backend::State::BindFramebuffer(GL_FRAMEBUFFER, GetFramebuffer(pass));
+
+                const Texture* target = resources_[pass.writes.front()].texture;
+                Backend::Core::SetViewport(0, 0, target->GetWidth(), target->GetHeight());
+            }
+
+            {
+                ProfileZone zone(Profiler::Instance().Intern(pass.name), true);
+                pass.execute();
+            }
+
+            // Image stores must be visible to any pass that reads the render target afterwards.
+            if (!pass.storage.empty()) {
+                glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT);
+            }
+        }
+
+        Backend::State::BindFramebuffer(GL_FRAMEBUFFER, 0);
+        Backend::Core::SetViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+    }
+
+    void FrameGraph::Reset() {
+        passes_.clear();
+        resources_.clear();
+        resourceIDs_.clear();
+        ++frame_;
+    }
+
+    void FrameGraph::Clear() {
+        Reset();
+
+        for (const std::pair<const std::vector<GLuint>, GLuint>& framebuffer : framebuffers_) {
+            glDeleteFramebuffers(1, &framebuffer.second);
+            Backend::State::OnFramebufferDeleted(framebuffer.second);
+        }
+
+        framebuffers_.clear();
+        pool_.clear();
+    }
+
+    Texture* FrameGraph::GetTexture(const std::string& name) const {
+        auto iterator = resourceIDs_.find(name);
+        if (iterator == resourceIDs_.end()) {
+            return nullptr;
+        }
+
+        return resources_[iterator->second].texture;
+    }
+
+    int FrameGraph::GetWidth() const {
+        return width_;
+    }
+
+    int FrameGraph::GetHeight() const {
+        return height_;
+    }
+
+    const FrameGraph::Statistics& FrameGraph::GetStatistics() const {
+        return statistics_;
+    }
+
+    int FrameGraph::GetResourceID(const std::string& name) const {
+        auto iterator = resourceIDs_.find(name);
+        if (iterator == resourceIDs_.end()) {
+            throw std::runtime_error("Frame graph render target '" + name + "' is not declared.");
+        }
+
+        return iterator->second;
+    }
+
+    glm::ivec2 FrameGraph::GetSize(const TextureDescription& description) const {
+        if (description.scale > 0.0f) {
+            return glm::max(glm::ivec2(glm::vec2(width_, height_) * description.scale), glm::ivec2(1));
+        }
+
+        return glm::ivec2(description.width, description.height);
+    }
+
+    void FrameGraph::Cull() {
+        // Reference counting: a pass stays as long as something it writes is read, is an output, or lives outside of the graph.
+        for (Pass& pass : passes_) {
+            pass.references = static_cast<int>(pass.writes.size() + pass.storage.size());
+
+            for (int resourceID : pass.reads) {
+                ++resources_[resourceID].readers;
+            }
+        }
+
+        std::vector<int> unused;
+        for (int resourceID = 0; resourceID < static_cast<int>(resources_.size()); ++resourceID) {
+            Resource& resource = resources_[resourceID];
+            if (resource.output || resource.imported) {
+                ++resource.readers;
+            }
+
+            if (resource.readers == 0) {
+                unused.push_back(resourceID);
+            }
+        }
+
+        while (!unused.empty()) {
+            const Resource& resource = resources_[unused.back()];
+            unused.pop_back();
+
+            for (int passID : resource.writers) {
+                Pass& pass = passes_[passID];
+                if (pass.culled || --pass.references > 0 || pass.sideEffect) {
+                    continue;
+                }
+
+                pass.culled = true;
+                ++statistics_.culledPasses;
+
+                for (int resourceID : pass.reads) {
+                    if (--resources_[resourceID].readers == 0) {
+                        unused.push_back(resourceID);
+                    }
+                }
+            }
+        }
+    }
+
+    void FrameGraph::ComputeLifetimes() {
+        for (int passID = 0; passID < static_cast<int>(passes_.size()); ++passID) {
+            const Pass& pass = passes_[passID];
+            if (pass.culled) {
+                continue;
+            }
+
+            for (const std::vector<int>* accesses : { &pass.reads, &pass.writes, &pass.storage }) {
+                for (int resourceID : *accesses) {
+                    Resource& resource = resources_[resourceID];
+                    if (resource.firstPass == -1) {
+                        resource.firstPass = passID;
+                    }
+                    resource.lastPass = passID;
+                }
+            }
+        }
+
+        for (Resource& resource : resources_) {
+            if (resource.output && resource.firstPass != -1) {
+                resource.lastPass = static_cast<int>(passes_.size());
+            }
+        }
+    }
+
+    void FrameGraph::AssignTextures() {
+        std::vector<bool> busy(pool_.size(), false);
+
+        // Render targets are handed out in pass order and returned to the pool after their last pass, so the next render target
+        // with a matching description created after that point reuses the texture.
+        std::vector<std::vector<int>> acquired(passes_.size());
+        std::vector<std::vector<int>> released(passes_.size() + 1u);
+
+        for (int resourceID = 0; resourceID < static_cast<int>(resources_.size()); ++resourceID) {
+            const Resource& resource = resources_[resourceID];
+            if (resource.imported || resource.firstPass == -1) {
+                continue;
+            }
+
+            acquired[resource.firstPass].push_back(resourceID);
+            released[resource.lastPass].push_back(resourceID);
+        }
+
+        for (std::size_t passID = 0; passID < passes_.size(); ++passID) {
+            for (int resourceID : acquired[passID]) {
+                Resource& resource = resources_[resourceID];
+                resource.pooled = Acquire(resource, busy);
+
+                Texture* texture = pool_[resource.pooled].texture.get();
+                texture->SetName(resource.name);
+                resource.texture = texture;
+
+                glm::ivec2 size = GetSize(resource.description);
+                statistics_.unaliasedBytes += GetTextureSize(resource.description.format, size.x, size.y);
+                ++statistics_.resources;
+            }
+
+            for (int resourceID : released[passID]) {
+                busy[resources_[resourceID].pooled] = false;
+            }
+        }
+    }
+
+    int FrameGraph::Acquire(const Resource& resource, std::vector<bool>& busy) {
+        glm::ivec2 size = GetSize(resource.description);
+
+        for (std::size_t i = 0; i < pool_.size(); ++i) {
+            PooledTexture& pooled = pool_[i];
+
+            if (!busy[i] && pooled.format == resource.description.format && pooled.width == size.x && pooled.height == size.y) {
+                busy[i] = true;
+                pooled.lastUsedFrame = frame_;
+                return static_cast<int>(i);
+            }
+        }
+
+        std::unique_ptr<Texture> texture = std::make_unique<Texture>(resource.name);
+        texture->ReserveData(resource.description.format, size.x, size.y);
+
+        pool_.push_back({ std::move(texture), resource.description.format, size.x, size.y, resource.description.scale > 0.0f, frame_ });
+        busy.push_back(true);
+
+        return static_cast<int>(pool_.size() - 1u);
+    }
+
+    void FrameGraph::ReleaseUnused() {
+        std::size_t count = pool_.size();
+
+        for (std::size_t i = 0; i < count;) {
+            if (frame_ - pool_[i].lastUsedFrame < TEXTURE_RETIRE_FRAMES) {
+                ++i;
+                continue;
+            }
+
+            // Swap with the last texture, whose render targets (if any) are updated to the new index.
+            DestroyFramebuffers(pool_[i].texture->ID());
+
+            --count;
+            if (i != count) {
+                std::swap(pool_[i], pool_[count]);
+
+                for (Resource& resource : resources_) {
+                    if (resource.pooled == static_cast<int>(count)) {
+                        resource.pooled = static_cast<int>(i);
+                    }
+                }
+            }
+        }
+
+        pool_.resize(count);
+    }
+
+    GLuint FrameGraph::GetFramebuffer(const Pass& pass) {
+        std::vector<GLuint> colors;
+        GLuint depth = 0;
+
+        for (int resourceID : pass.writes) {
+            const Texture* texture = resources_[resourceID].texture;
+
+            if (texture->GetAttachmentType() == Texture::AttachmentType::DEPTH) {
+                depth = texture->ID();
+            }
+            else {
+                colors.push_back(texture->ID());
+            }
+        }
+
+        // Depth attachment goes last, after a separator, so that color-only and depth-only framebuffers never share a key.
+        std::vector<GLuint> key = colors;
+        key.push_back(0);
+        key.push_back(depth);
+
+        auto iterator = framebuffers_.find(key);
+        if (iterator != framebuffers_.end()) {
+            return iterator->second;
+        }
+
+        GLuint framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        Backend::State::BindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+        std::vector<GLenum> drawBuffers;
+        for (std::size_t i = 0; i < colors.size(); ++i) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + i, GL_TEXTURE_2D, colors[i], 0);
+            drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + i);
+        }
+
+        if (depth) {
+            glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, depth, 0);
+        }
+
+        // Draw buffers are framebuffer state, set once for all passes writing to the same render targets.
+        if (drawBuffers.empty()) {
+            glDrawBuffer(GL_NONE);
+        }
+        else {
+            glDrawBuffers(static_cast<GLsizei>(drawBuffers.size()), drawBuffers.data());
+        }
+
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+            throw std::runtime_error("Framebuffer of frame graph pass '" + pass.name + "' is not complete.");
+        }
+
+        framebuffers_.emplace(std::move(key), framebuffer);
+        return framebuffer;
+    }
+
+    void FrameGraph::DestroyFramebuffers(GLuint texture) {
+        for (auto iterator = framebuffers_.begin(); iterator != framebuffers_.end();) {
+            const std::vector<GLuint>& attachments = iterator->first;
+
+            if (std::find(attachments.begin(), attachments.end(), texture) != attachments.end()) {
+                glDeleteFramebuffers(1, &iterator->second);
+                Backend::State::OnFramebufferDeleted(iterator->second);
+                iterator = framebuffers_.erase(iterator);
+            }
+            else {
+                ++iterator;
+            }
+        }
+    }
+
+}
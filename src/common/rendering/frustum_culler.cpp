@@ -0,0 +1,220 @@
+
+#include "common/rendering/frustum_culler.h"
+#include "common/geometry/transform.h"
+#include "common/geometry/mesh.h"
+#include "common/ecs/ecs.h"
+
+namespace Sandbox {
+
+    FrustumCuller::FrustumCuller() : frame_(0u)
+                                     {
+    }
+
+    FrustumCuller::~FrustumCuller() {
+    }
+
+    void FrustumCuller::Update() {
+        ECS& ecs = ECS::Instance();
+
+        ++frame_;
+        modified_.clear();
+        removed_.clear();
+
+        for (int entityID : ecs.GetEntityIDs<Transform, Mesh>()) {
+            Transform& transform = *ecs.GetComponent<Transform>(entityID);
+            const Mesh& mesh = *ecs.GetComponent<Mesh>(entityID);
+
+            int index;
+            bool changed;
+
+            auto iterator = indices_.find(entityID);
+            if (iterator == indices_.end()) {
+                index = static_cast<int>(entityIDs_.size());
+                Insert(entityID);
+                changed = true;
+            }
+            else {
+                index = iterator->second;
+
+                // Mesh changes when streamed geometry replaces a placeholder.
+                changed = transformVersions_[index] != transform.GetVersion() || meshVersions_[index] != mesh.GetVersion();
+            }
+
+            if (changed) {
+                SetBounds(index, mesh.GetBounds(), transform.GetMatrix());
+                transformVersions_[index] = transform.GetVersion();
+                meshVersions_[index] = mesh.GetVersion();
+                modified_.emplace_back(entityID);
+            }
+
+            lastUpdated_[index] = frame_;
+        }
+
+        // Remove entities that were destroyed or lost a required component.
+        // Iterating backwards keeps swapped-in entries from being skipped.
+        for (int i = static_cast<int>(entityIDs_.size()) - 1; i >= 0; --i) {
+            if (lastUpdated_[i] != frame_) {
+                removed_.emplace_back(entityIDs_[i]);
+                Remove(i);
+            }
+        }
+    }
+
+    void FrustumCuller::Clear() {
+        indices_.clear();
+        entityIDs_.clear();
+        localBounds_.clear();
+        transformVersions_.clear();
+        meshVersions_.clear();
+        lastUpdated_.clear();
+
+        centerX_.clear();
+        centerY_.clear();
+        centerZ_.clear();
+        extentX_.clear();
+        extentY_.clear();
+        extentZ_.clear();
+
+        modified_.clear();
+        removed_.clear();
+        passes_.clear();
+    }
+
+    void FrustumCuller::Cull(const Frustum& frustum, std::vector<int>& visibleEntityIDs) const {
+        int count = static_cast<int>(entityIDs_.size());
+        visibleEntityIDs.resize(count);
+
+        int numVisible = frustum.Intersects(centerX_.data(), centerY_.data(), centerZ_.data(), extentX_.data(), extentY_.data(), extentZ_.data(), count, visibleEntityIDs.data());
+        visibleEntityIDs.resize(numVisible);
+
+        // Convert indices to entity IDs in place.
+        for (int& index : visibleEntityIDs) {
+            index = entityIDs_[index];
+        }
+    }
+
+    bool FrustumCuller::HasEntity(int entityID) const {
+        return indices_.find(entityID) != indices_.end();
+    }
+
+    Bounds FrustumCuller::GetBounds(int entityID) const {
+        auto iterator = indices_.find(entityID);
+        if (iterator == indices_.end() || !localBounds_[iterator->second].IsValid()) {
+            return Bounds();
+        }
+
+        int index = iterator->second;
+        glm::vec3 center(centerX_[index], centerY_[index], centerZ_[index]);
+        glm::vec3 extent(extentX_[index], extentY_[index], extentZ_[index]);
+
+        return Bounds(center - extent, center + extent);
+    }
+
+    int FrustumCuller::GetEntityCount() const {
+        return static_cast<int>(entityIDs_.size());
+    }
+
+    const std::vector<int>& FrustumCuller::GetModifiedEntities() const {
+        return modified_;
+    }
+
+    const std::vector<int>& FrustumCuller::GetRemovedEntities() const {
+        return removed_;
+    }
+
+    void FrustumCuller::RecordPass(const std::string& pass, int drawn, int total) {
+        for (PassStatistics& statistics : passes_) {
+            if (statistics.name == pass) {
+                statistics.drawn = drawn;
+                statistics.culled = total - drawn;
+                return;
+            }
+        }
+
+        passes_.push_back({ pass, drawn, total - drawn });
+    }
+
+    void FrustumCuller::OnImGui() const {
+        ImGui::Text("Frustum culling (%i entities):", GetEntityCount());
+
+        for (const PassStatistics& statistics : passes_) {
+            ImGui::Text("%s: %i drawn, %i culled", statistics.name.c_str(), statistics.drawn, statistics.culled);
+        }
+    }
+
+    void FrustumCuller::Insert(int entityID) {
+        indices_[entityID] = static_cast<int>(entityIDs_.size());
+        entityIDs_.emplace_back(entityID);
+        localBounds_.emplace_back();
+        transformVersions_.emplace_back(0);
+        meshVersions_.emplace_back(0);
+        lastUpdated_.emplace_back(frame_);
+
+        centerX_.emplace_back(0.0f);
+        centerY_.emplace_back(0.0f);
+        centerZ_.emplace_back(0.0f);
+        extentX_.emplace_back(0.0f);
+        extentY_.emplace_back(0.0f);
+        extentZ_.emplace_back(0.0f);
+    }
+
+    void FrustumCuller::Remove(int index) {
+        int last = static_cast<int>(entityIDs_.size()) - 1;
+
+        indices_.erase(entityIDs_[index]);
+
+        if (index != last) {
+            // Move last element into the vacated slot.
+            entityIDs_[index] = entityIDs_[last];
+            localBounds_[index] = localBounds_[last];
+            transformVersions_[index] = transformVersions_[last];
+            meshVersions_[index] = meshVersions_[last];
+            lastUpdated_[index] = lastUpdated_[last];
+
+            centerX_[index] = centerX_[last];
+            centerY_[index] = centerY_[last];
+            centerZ_[index] = centerZ_[last];
+            extentX_[index] = extentX_[last];
+            extentY_[index] = extentY_[last];
+            extentZ_[index] = extentZ_[last];
+
+            indices_[entityIDs_[index]] = index;
+        }
+
+        entityIDs_.pop_back();
+        localBounds_.pop_back();
+        transformVersions_.pop_back();
+        meshVersions_.pop_back();
+        lastUpdated_.pop_back();
+
+        centerX_.pop_back();
+        centerY_.pop_back();
+        centerZ_.pop_back();
+        extentX_.pop_back();
+        extentY_.pop_back();
+        extentZ_.pop_back();
+    }
+
+    void FrustumCuller::SetBounds(int index, const Bounds& localBounds, const glm::mat4& transform) {
+        localBounds_[index] = localBounds;
+
+        if (!localBounds.IsValid()) {
+            // Negative extents fail every plane test, so empty meshes are always culled.
+            centerX_[index] = centerY_[index] = centerZ_[index] = 0.0f;
+            extentX_[index] = extentY_[index] = extentZ_[index] = std::numeric_limits<float>::lowest();
+            return;
+        }
+
+        Bounds world = Bounds::GetTransformed(localBounds, transform);
+        glm::vec3 center = world.GetCentroid();
+        glm::vec3 extent = world.GetDiagonal() * 0.5f;
+
+        centerX_[index] = center.x;
+        centerY_[index] = center.y;
+        centerZ_[index] = center.z;
+        extentX_[index] = extent.x;
+        extentY_[index] = extent.y;
+        extentZ_[index] = extent.z;
+    }
+
+}
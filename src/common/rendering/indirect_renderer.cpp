@@ -0,0 +1,282 @@
+
+#include "common/rendering/indirect_renderer.h"
+#include "common/geometry/transform.h"
+#include "common/material/material.h"
+#include "common/api/backend.h"
+#include "common/ecs/ecs.h"
+
+namespace Sandbox {
+
+    // Layout of the commands consumed by glMultiDrawElementsIndirect.
+    struct DrawElementsIndirectCommand {
+        unsigned count;
+        unsigned instanceCount;
+        unsigned firstIndex;
+        int baseVertex;
+        unsigned baseInstance;
+    };
+
+    static constexpr UniformName FRUSTUM_PLANES[Frustum::NUM_PLANES] = {
+        UniformName("frustumPlanes[0]"),
+        UniformName("frustumPlanes[1]"),
+        UniformName("frustumPlanes[2]"),
+        UniformName("frustumPlanes[3]"),
+        UniformName("frustumPlanes[4]"),
+        UniformName("frustumPlanes[5]")
+    };
+    static constexpr UniformName OBJECT_COUNT("objectCount");
+    static constexpr UniformName PASS_MASK("passMask");
+
+    IndirectRenderer::IndirectRenderer() : dirtyBegin_(0),
+                                           dirtyEnd_(0),
+                                           rebuild_(true),
+                                           objectBuffer_(OBJECT_BINDING_POINT)
+                                           {
+        static_assert(sizeof(ObjectData) % 16 == 0, "ObjectData must match std430 struct array stride.");
+    }
+
+    IndirectRenderer::~IndirectRenderer() {
+    }
+
+    void IndirectRenderer::Update(const FrustumCuller& culler, const std::function<unsigned(int)>& getPassMask, const std::function<int(int)>& getMaterialID) {
+        if (rebuild_) {
+            Clear();
+            rebuild_ = false;
+
+            for (int entityID : ECS::Instance().GetEntityIDs<Transform, Mesh>()) {
+                Write(culler, entityID, getPassMask, getMaterialID);
+            }
+        }
+        else {
+            for (int entityID : culler.GetRemovedEntities()) {
+                Remove(entityID);
+            }
+
+            for (int entityID : culler.GetModifiedEntities()) {
+                Write(culler, entityID, getPassMask, getMaterialID);
+            }
+        }
+
+        // Defragmenting the geometry arena moves mesh ranges in place.
+        for (int i = 0; i < static_cast<int>(objects_.size()); ++i) {
+            ObjectData& object = objects_[i];
+            const GeometryArena::Allocation& geometry = *objectGeometry_[i];
+
+            if (object.firstIndex != geometry.firstIndex || object.baseVertex != geometry.baseVertex) {
+                object.firstIndex = geometry.firstIndex;
+                object.baseVertex = geometry.baseVertex;
+                MarkDirty(i);
+            }
+        }
+
+        Upload();
+    }
+
+    void IndirectRenderer::Invalidate() {
+        rebuild_ = true;
+    }
+
+    void IndirectRenderer::Clear() {
+        geometry_.clear();
+        indices_.clear();
+        entityIDs_.clear();
+        objects_.clear();
+        objectGeometry_.clear();
+
+        dirtyBegin_ = 0;
+        dirtyEnd_ = 0;
+        rebuild_ = true;
+    }
+
+    void IndirectRenderer::Cull(Shader* cullShader, const Frustum& frustum, unsigned pass) {
+        ShaderStorageBufferObject* commands = GetCommandBuffer(pass);
+
+        int count = static_cast<int>(objects_.size());
+        commands->SetData(objects_.size() * sizeof(DrawElementsIndirectCommand), nullptr);
+
+        if (count == 0) {
+            return;
+        }
+
+        cullShader->Bind();
+
+        for (int i = 0; i < Frustum::NUM_PLANES; ++i) {
+            cullShader->SetUniform(FRUSTUM_PLANES[i], frustum.GetPlane(i));
+        }
+        cullShader->SetUniform(OBJECT_COUNT, count);
+        cullShader->SetUniform(PASS_MASK, static_cast<int>(pass));
+
+        objectBuffer_.BindBase();
+        commands->BindBase();
+
+        glDispatchCompute((count + WORK_GROUP_SIZE - 1) / WORK_GROUP_SIZE, 1, 1);
+
+        // Commands are consumed as indirect draw parameters.
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT);
+
+        cullShader->Unbind();
+    }
+
+    void IndirectRenderer::Render(unsigned pass) const {
+        const ShaderStorageBufferObject* commands = GetCommandBuffer(pass);
+        if (!commands || objects_.empty()) {
+            return;
+        }
+
+        objectBuffer_.BindBase();
+
+        GeometryArena& arena = GeometryArena::Instance();
+        arena.Bind();
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands->ID());
+
+        // Culled objects have an instance count of 0, so every object can be submitted with the same call.
+        Backend::Rendering::DrawIndexedIndirect(GL_TRIANGLES, static_cast<int>(objects_.size()));
+
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        arena.Unbind();
+    }
+
+    int IndirectRenderer::GetObjectCount() const {
+        return static_cast<int>(objects_.size());
+    }
+
+    int IndirectRenderer::GetGeometryCount() const {
+        return static_cast<int>(geometry_.size());
+    }
+
+    void IndirectRenderer::Write(const FrustumCuller& culler, int entityID, const std::function<unsigned(int)>& getPassMask, const std::function<int(int)>& getMaterialID) {
+        ECS& ecs = ECS::Instance();
+
+        unsigned passMask = getPassMask(entityID);
+        Mesh& mesh = *ecs.GetComponent<Mesh>(entityID);
+        Bounds bounds = culler.GetBounds(entityID);
+
+        // Entities may stop being drawn, for example when their mesh is replaced by one without geometry.
+        if (passMask == 0u || mesh.GetTopology() != MeshTopology::TRIANGLES || !bounds.IsValid()) {
+            Remove(entityID);
+            return;
+        }
+
+        int index;
+
+        auto iterator = indices_.find(entityID);
+        if (iterator == indices_.end()) {
+            index = static_cast<int>(objects_.size());
+            indices_.emplace(entityID, index);
+            entityIDs_.emplace_back(entityID);
+            objects_.emplace_back();
+            objectGeometry_.emplace_back();
+        }
+        else {
+            index = iterator->second;
+        }
+
+        std::shared_ptr<const GeometryArena::Allocation> geometry = mesh.GetGeometry();
+        AddGeometry(geometry);
+        ReleaseGeometry(objectGeometry_[index]);
+        objectGeometry_[index] = geometry;
+
+        ObjectData& object = objects_[index];
+        object.modelTransform = ecs.GetComponent<Transform>(entityID)->GetMatrix();
+        object.normalTransform = glm::transpose(glm::inverse(object.modelTransform));
+        object.center = glm::vec4(bounds.GetCentroid(), 1.0f);
+        object.extent = glm::vec4(bounds.GetDiagonal() * 0.5f, 0.0f);
+        object.indexCount = geometry->indexCount;
+        object.firstIndex = geometry->firstIndex;
+        object.baseVertex = geometry->baseVertex;
+        object.passMask = passMask;
+        object.materialID = getMaterialID(entityID);
+
+        MarkDirty(index);
+    }
+
+    void IndirectRenderer::Remove(int entityID) {
+        auto iterator = indices_.find(entityID);
+        if (iterator == indices_.end()) {
+            return;
+        }
+
+        int index = iterator->second;
+        int last = static_cast<int>(objects_.size()) - 1;
+
+        indices_.erase(iterator);
+        ReleaseGeometry(objectGeometry_[index]);
+
+        if (index != last) {
+            // Move last object into the vacated slot.
+            entityIDs_[index] = entityIDs_[last];
+            objects_[index] = objects_[last];
+            objectGeometry_[index] = std::move(objectGeometry_[last]);
+
+            indices_[entityIDs_[index]] = index;
+            MarkDirty(index);
+        }
+
+        entityIDs_.pop_back();
+        objects_.pop_back();
+        objectGeometry_.pop_back();
+    }
+
+    void IndirectRenderer::MarkDirty(int index) {
+        if (dirtyBegin_ >= dirtyEnd_) {
+            dirtyBegin_ = index;
+            dirtyEnd_ = index + 1;
+        }
+        else {
+            dirtyBegin_ = std::min(dirtyBegin_, index);
+            dirtyEnd_ = std::max(dirtyEnd_, index + 1);
+        }
+    }
+
+    void IndirectRenderer::Upload() {
+        std::size_t size = objects_.size() * sizeof(ObjectData);
+
+        // Growing the buffer discards its contents.
+        if (size > objectBuffer_.GetCapacity()) {
+            objectBuffer_.SetData(size, objects_.data());
+        }
+        else {
+            // Objects past the end were removed and are no longer drawn.
+            int end = std::min(dirtyEnd_, static_cast<int>(objects_.size()));
+
+            if (dirtyBegin_ < end) {
+                objectBuffer_.SetSubData(dirtyBegin_ * sizeof(ObjectData), (end - dirtyBegin_) * sizeof(ObjectData), objects_.data() + dirtyBegin_);
+            }
+        }
+
+        dirtyBegin_ = 0;
+        dirtyEnd_ = 0;
+    }
+
+    void IndirectRenderer::AddGeometry(const std::shared_ptr<const GeometryArena::Allocation>& geometry) {
+        ++geometry_[geometry.get()];
+    }
+
+    void IndirectRenderer::ReleaseGeometry(const std::shared_ptr<const GeometryArena::Allocation>& geometry) {
+        if (!geometry) {
+            return;
+        }
+
+        auto iterator = geometry_.find(geometry.get());
+        assert(iterator != geometry_.end());
+
+        if (--iterator->second == 0) {
+            geometry_.erase(iterator);
+        }
+    }
+
+    ShaderStorageBufferObject* IndirectRenderer::GetCommandBuffer(unsigned pass) {
+        std::unique_ptr<ShaderStorageBufferObject>& buffer = commandBuffers_[pass];
+        if (!buffer) {
+            buffer = std::make_unique<ShaderStorageBufferObject>(COMMAND_BINDING_POINT);
+        }
+
+        return buffer.get();
+    }
+
+    const ShaderStorageBufferObject* IndirectRenderer::GetCommandBuffer(unsigned pass) const {
+        auto iterator = commandBuffers_.find(pass);
+        return iterator == commandBuffers_.end() ? nullptr : iterator->second.get();
+    }
+
+}
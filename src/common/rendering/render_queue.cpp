@@ -0,0 +1,200 @@
+
+#include "common/rendering/render_queue.h"
+#include "common/api/buffer/streaming_buffer.h"
+
+namespace Sandbox {
+
+    static constexpr UniformName DRAW_ID("drawID");
+
+    static const unsigned SHADER_BITS = 12u;
+    static const unsigned MATERIAL_BITS = 16u;
+    static const unsigned MESH_BITS = 16u;
+    static const unsigned DEPTH_BITS = 20u;
+
+    static const unsigned MESH_SHIFT = DEPTH_BITS;
+    static const unsigned MATERIAL_SHIFT = MESH_SHIFT + MESH_BITS;
+    static const unsigned SHADER_SHIFT = MATERIAL_SHIFT + MATERIAL_BITS;
+
+    void RenderQueue::DrawList::Submit(float depth, const DrawPacket& packet) {
+        assert(packet.shader && packet.mesh);
+
+        entries_.push_back({ depth, packet });
+    }
+
+    RenderQueue::RenderQueue() {
+        static_assert(SHADER_SHIFT + SHADER_BITS == 64u, "Sort key fields must fill 64 bits.");
+        static_assert(sizeof(DrawData) % 16 == 0, "DrawData must match std430 struct array stride.");
+    }
+
+    RenderQueue::~RenderQueue() {
+    }
+
+    RenderQueue::DrawList& RenderQueue::CreateList() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lists_.emplace_back();
+    }
+
+    void RenderQueue::Submit(float depth, const DrawPacket& packet) {
+        renderThreadList_.Submit(depth, packet);
+    }
+
+    void RenderQueue::Sort() {
+        packets_.clear();
+        keys_.clear();
+        materialIDs_.clear();
+        meshIDs_.clear();
+
+        auto gather = [this](DrawList& list) {
+            for (const Entry& entry : list.entries_) {
+                const DrawPacket& packet = entry.packet;
+
+                // IDs are handed out in submission order and wrap around if a frame has more unique materials / meshes than fit
+                // the key. Packets are still executed correctly, they are only grouped less tightly.
+                unsigned material = 0u;
+                if (packet.material) {
+                    material = materialIDs_.emplace(packet.material, static_cast<unsigned>(materialIDs_.size()) + 1u).first->second;
+                }
+
+                // Copies of a mesh share geometry, group by geometry rather than by component.
+                unsigned mesh = meshIDs_.emplace(packet.mesh->GetGeometry().get(), static_cast<unsigned>(meshIDs_.size())).first->second;
+
+                keys_.emplace_back(MakeKey(packet.shader->GetID(), material, mesh, entry.depth), static_cast<unsigned>(packets_.size()));
+                packets_.emplace_back(packet);
+            }
+
+            list.entries_.clear();
+        };
+
+        gather(renderThreadList_);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (DrawList& list : lists_) {
+            gather(list);
+        }
+
+        RadixSort();
+    }
+
+    int RenderQueue::Execute(const std::function<void(Shader&, const DrawPacket&)>& setDrawUniforms) {
+        if (keys_.empty()) {
+            return 0;
+        }
+
+        // Per-draw data replaces setting the transforms and material of every draw as separate uniforms.
+        draws_.resize(keys_.size());
+
+        for (std::size_t i = 0; i < keys_.size(); ++i) {
+            const DrawPacket& packet = packets_[keys_[i].second];
+            DrawData& draw = draws_[i];
+
+            draw.modelTransform = packet.modelTransform;
+            draw.normalTransform = glm::transpose(glm::inverse(packet.modelTransform));
+            draw.materialID = packet.materialID;
+        }
+
+        StreamingBuffer& streamingBuffer = StreamingBuffer::Instance();
+        StreamingBuffer::Allocation allocation = streamingBuffer.Write(draws_.data(), draws_.size() * sizeof(DrawData), GL_SHADER_STORAGE_BUFFER);
+        streamingBuffer.BindRange(GL_SHADER_STORAGE_BUFFER, DRAW_BINDING_POINT, allocation);
+
+        const Shader* currentShader = nullptr;
+        const Material* currentMaterial = nullptr;
+        int count = 0;
+
+        for (const std::pair<std::uint64_t, unsigned>& entry : keys_) {
+            const DrawPacket& packet = packets_[entry.second];
+            Shader& shader = *packet.shader;
+
+            if (&shader != currentShader) {
+                shader.Bind();
+                currentShader = &shader;
+                currentMaterial = nullptr; // Material uniforms are per program.
+            }
+
+            if (packet.material && packet.material != currentMaterial) {
+                packet.material->Bind(&shader);
+                currentMaterial = packet.material;
+            }
+
+            shader.SetUniform(DRAW_ID, count);
+
+            if (setDrawUniforms) {
+                setDrawUniforms(shader, packet);
+            }
+
+            packet.mesh->Bind();
+            packet.mesh->Render();
+            ++count;
+        }
+
+        return count;
+    }
+
+    void RenderQueue::Clear() {
+        renderThreadList_.entries_.clear();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            lists_.clear();
+        }
+
+        packets_.clear();
+        keys_.clear();
+    }
+
+    int RenderQueue::GetPacketCount() const {
+        return static_cast<int>(packets_.size());
+    }
+
+    std::uint64_t RenderQueue::MakeKey(unsigned shader, unsigned material, unsigned mesh, float depth) {
+        auto field = [](std::uint64_t value, unsigned bits, unsigned shift) -> std::uint64_t {
+            return (value & ((std::uint64_t(1) << bits) - 1u)) << shift;
+        };
+
+        auto quantizedDepth = static_cast<std::uint64_t>(glm::clamp(depth, 0.0f, 1.0f) * static_cast<float>((1u << DEPTH_BITS) - 1u));
+
+        return field(shader, SHADER_BITS, SHADER_SHIFT) |
+               field(material, MATERIAL_BITS, MATERIAL_SHIFT) |
+               field(mesh, MESH_BITS, MESH_SHIFT) |
+               field(quantizedDepth, DEPTH_BITS, 0u);
+    }
+
+    void RenderQueue::RadixSort() {
+        static const unsigned RADIX_BITS = 8u;
+        static const unsigned NUM_BUCKETS = 1u << RADIX_BITS;
+
+        std::size_t count = keys_.size();
+        if (count < 2) {
+            return;
+        }
+
+        scratch_.resize(count);
+
+        for (unsigned shift = 0u; shift < 64u; shift += RADIX_BITS) {
+            std::size_t offsets[NUM_BUCKETS] = { };
+
+            for (const std::pair<std::uint64_t, unsigned>& entry : keys_) {
+                ++offsets[(entry.first >> shift) & (NUM_BUCKETS - 1u)];
+            }
+
+            // All keys share this digit, order does not change.
+            if (offsets[(keys_.front().first >> shift) & (NUM_BUCKETS - 1u)] == count) {
+                continue;
+            }
+
+            std::size_t sum = 0;
+            for (std::size_t& offset : offsets) {
+                std::size_t bucketSize = offset;
+                offset = sum;
+                sum += bucketSize;
+            }
+
+            // Scattering in order keeps the sort stable, so less significant digits stay ordered.
+            for (const std::pair<std::uint64_t, unsigned>& entry : keys_) {
+                scratch_[offsets[(entry.first >> shift) & (NUM_BUCKETS - 1u)]++] = entry;
+            }
+
+            keys_.swap(scratch_);
+        }
+    }
+
+}
@@ -0,0 +1,146 @@
+
+#include "common/rendering/shadow_cache.h"
+#include "common/geometry/transform.h"
+#include "common/geometry/mesh.h"
+#include "common/ecs/ecs.h"
+
+namespace Sandbox {
+
+    ShadowCache::ShadowCache() : lightTransform_(0.0f),
+                                 dynamicCasterCount_(0),
+                                 staticDirty_(true),
+                                 filterDirty_(true),
+                                 frames_(0),
+                                 staticUpdates_(0),
+                                 filterUpdates_(0)
+                                 {
+    }
+
+    ShadowCache::~ShadowCache() {
+    }
+
+    void ShadowCache::Initialize(GLenum format, int size) {
+        staticMoments_ = std::make_unique<Texture>("static shadow moments");
+        staticMoments_->ReserveData(format, size, size);
+
+        staticDepth_ = std::make_unique<Texture>("static shadow depth buffer");
+        staticDepth_->ReserveData(GL_DEPTH_COMPONENT32F, size, size);
+
+        shadowMap_ = std::make_unique<Texture>("shadow map");
+        shadowMap_->ReserveData(format, size, size);
+
+        Invalidate();
+    }
+
+    void ShadowCache::Clear() {
+        staticMoments_.reset();
+        staticDepth_.reset();
+        shadowMap_.reset();
+
+        staticCasters_.clear();
+        dynamicCasterCount_ = 0;
+
+        frames_ = 0;
+        staticUpdates_ = 0;
+        filterUpdates_ = 0;
+
+        Invalidate();
+    }
+
+    void ShadowCache::Update(const glm::mat4& lightTransform, const std::function<Layer(int)>& getLayer) {
+        ECS& ecs = ECS::Instance();
+
+        if (lightTransform != lightTransform_) {
+            lightTransform_ = lightTransform;
+            staticDirty_ = true;
+        }
+
+        // Casters that were added, removed, moved between layers, or had their transform or mesh (for example streamed
+        // geometry replacing a placeholder) change since the last update change the list.
+        std::vector<Caster> previousCasters;
+        previousCasters.swap(staticCasters_);
+        dynamicCasterCount_ = 0;
+
+        for (int entityID : ecs.GetEntityIDs<Transform, Mesh>()) {
+            Layer layer = getLayer(entityID);
+
+            if (layer == Layer::STATIC) {
+                const Transform& transform = *ecs.GetComponent<Transform>(entityID);
+                const Mesh& mesh = *ecs.GetComponent<Mesh>(entityID);
+
+                staticCasters_.push_back({ entityID, transform.GetVersion(), mesh.GetVersion() });
+            }
+            else if (layer == Layer::DYNAMIC) {
+                ++dynamicCasterCount_;
+            }
+        }
+
+        std::sort(staticCasters_.begin(), staticCasters_.end(), [](const Caster& first, const Caster& second) {
+            return first.entityID < second.entityID;
+        });
+
+        if (staticCasters_ != previousCasters) {
+            staticDirty_ = true;
+        }
+    }
+
+    void ShadowCache::Invalidate() {
+        staticDirty_ = true;
+    }
+
+    void ShadowCache::InvalidateFilter() {
+        filterDirty_ = true;
+    }
+
+    void ShadowCache::Validate() {
+        ++frames_;
+
+        if (staticDirty_) {
+            ++staticUpdates_;
+        }
+        if (IsShadowMapDirty()) {
+            ++filterUpdates_;
+        }
+
+        staticDirty_ = false;
+        filterDirty_ = false;
+    }
+
+    bool ShadowCache::IsStaticLayerDirty() const {
+        return staticDirty_;
+    }
+
+    bool ShadowCache::IsShadowMapDirty() const {
+        return staticDirty_ || filterDirty_ || HasDynamicCasters();
+    }
+
+    bool ShadowCache::HasDynamicCasters() const {
+        return dynamicCasterCount_ > 0;
+    }
+
+    Texture* ShadowCache::GetStaticMoments() const {
+        return staticMoments_.get();
+    }
+
+    Texture* ShadowCache::GetStaticDepth() const {
+        return staticDepth_.get();
+    }
+
+    Texture* ShadowCache::GetShadowMap() const {
+        return shadowMap_.get();
+    }
+
+    int ShadowCache::GetStaticCasterCount() const {
+        return static_cast<int>(staticCasters_.size());
+    }
+
+    int ShadowCache::GetDynamicCasterCount() const {
+        return dynamicCasterCount_;
+    }
+
+    void ShadowCache::OnImGui() const {
+        ImGui::Text("Shadow cache (%i static, %i dynamic casters):", GetStaticCasterCount(), GetDynamicCasterCount());
+        ImGui::Text("Static layer rendered in %i of %i frames, shadow map filtered in %i", staticUpdates_, frames_, filterUpdates_);
+    }
+
+}
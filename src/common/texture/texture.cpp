@@ -2,32 +2,147 @@
 #include "common/texture/texture.h"
 #include "common/utility/directory.h"
 #include "common/utility/log.h"
+#include "common/api/backend.h"
+#include "common/application/readback_service.h"
 
 namespace Sandbox {
 
+    // Upload format and type matching a sized internal format, used to reserve render target storage.
+    struct PixelFormat {
+        GLenum format;
+        GLenum type;
+        std::size_t size; // Bytes per pixel.
+    };
+
+    static PixelFormat GetPixelFormat(GLenum internalFormat) {
+        switch (internalFormat) {
+            case GL_RGBA32F:
+                return { GL_RGBA, GL_FLOAT, 16 };
+            case GL_RGBA16F:
+                return { GL_RGBA, GL_HALF_FLOAT, 8 };
+            case GL_RGBA16:
+                return { GL_RGBA, GL_UNSIGNED_SHORT, 8 };
+            case GL_RG16F:
+                return { GL_RG, GL_HALF_FLOAT, 4 };
+            case GL_RG16:
+                return { GL_RG, GL_UNSIGNED_SHORT, 4 };
+            case GL_RG16_SNORM:
+                return { GL_RG, GL_SHORT, 4 };
+            case GL_R11F_G11F_B10F:
+                return { GL_RGB, GL_UNSIGNED_INT_10F_11F_11F_REV, 4 };
+            case GL_RGB10_A2:
+                return { GL_RGBA, GL_UNSIGNED_INT_2_10_10_10_REV, 4 };
+            case GL_RGBA8:
+            case GL_SRGB8_ALPHA8:
+                return { GL_RGBA, GL_UNSIGNED_BYTE, 4 };
+            case GL_R32F:
+                return { GL_RED, GL_FLOAT, 4 };
+            case GL_DEPTH_COMPONENT32F:
+                return { GL_DEPTH_COMPONENT, GL_FLOAT, 4 };
+            case GL_DEPTH_COMPONENT24:
+                return { GL_DEPTH_COMPONENT, GL_UNSIGNED_INT, 4 };
+            default:
+                throw std::runtime_error("Unsupported render target format.");
+        }
+    }
+
+    Texture::ImageData::ImageData() : width(0),
+                                      height(0),
+                                      channels(0),
+                                      hdr(false)
+                                      {
+    }
+
+    std::size_t Texture::ImageData::GetSize() const {
+        return pixels.size();
+    }
+
+    void Texture::ImageData::FlipVertically() {
+        if (height <= 1) {
+            return;
+        }
+
+        std::size_t rowSize = pixels.size() / static_cast<std::size_t>(height);
+        std::vector<unsigned char> row(rowSize);
+
+        for (int top = 0, bottom = height - 1; top < bottom; ++top, --bottom) {
+            unsigned char* a = pixels.data() + static_cast<std::size_t>(top) * rowSize;
+            unsigned char* b = pixels.data() + static_cast<std::size_t>(bottom) * rowSize;
+
+            std::memcpy(row.data(), a, rowSize);
+            std::memcpy(a, b, rowSize);
+            std::memcpy(b, row.data(), rowSize);
+        }
+    }
+
+    Texture::ImageData Texture::Decode(const std::string& filepath) {
+        std::string name = ConvertToNativeSeparators(filepath);
+        std::string extension = GetAssetExtension(filepath);
+
+        ImageData image { };
+
+        // Vertical flip is left at its default, as stb stores it globally.
+        if (extension == "png" || extension == "jpg") {
+            // Always expand to four channels to match the GL_RGBA upload format.
+            unsigned char* data = stbi_load(name.c_str(), &image.width, &image.height, &image.channels, 4);
+            if (!data) {
+                throw std::runtime_error("Failed to load texture: " + filepath);
+            }
+
+            image.channels = 4;
+            image.pixels.assign(data, data + static_cast<std::size_t>(image.width) * image.height * image.channels);
+            stbi_image_free(data);
+        }
+        else if (extension == "hdr") {
+            // High definition range image.
+            float* data = stbi_loadf(name.c_str(), &image.width, &image.height, &image.channels, 3);
+            if (!data) {
+                throw std::runtime_error("Failed to load texture: " + filepath);
+            }
+
+            image.channels = 3;
+            image.hdr = true;
+
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+            image.pixels.assign(bytes, bytes + static_cast<std::size_t>(image.width) * image.height * image.channels * sizeof(float));
+            stbi_image_free(data);
+        }
+        else {
+            throw std::runtime_error("Unsupported texture format: " + filepath);
+        }
+
+        return image;
+    }
+
     Texture::Texture(std::string name) : _name(std::move(name)),
                                          _contentWidth(-1),
                                          _contentHeight(-1),
-                                         _stbLoaded(false) {
+                                         _stbLoaded(false),
+                                         _internalFormat(GL_NONE) {
         glGenTextures(1, &_textureID);
     }
 
     Texture::~Texture() {
         glDeleteTextures(1, &_textureID);
+        Backend::State::OnTextureDeleted(_textureID);
     }
 
     void Texture::Bind() const {
-        glBindTexture(GL_TEXTURE_2D, _textureID);
+        Backend::State::BindTexture(GL_TEXTURE_2D, _textureID);
     }
 
     void Texture::Unbind() const {
-        glBindTexture(GL_TEXTURE_2D, 0);
+        Backend::State::BindTexture(GL_TEXTURE_2D, 0);
     }
 
     const std::string &Texture::GetName() const {
         return _name;
     }
 
+    void Texture::SetName(const std::string& name) {
+        _name = name;
+    }
+
     GLuint Texture::ID() const {
         return _textureID;
     }
@@ -41,50 +156,30 @@ namespace Sandbox {
     }
 
     void Texture::ReserveData(AttachmentType attachmentType, int contentWidth, int contentHeight) {
-        _stbLoaded = false;
-        _attachmentType = attachmentType;
-
-        Bind();
-
-        _contentWidth = contentWidth;
-        _contentHeight = contentHeight;
-
-        // Texture wrapping.
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-        // Texturing filtering.
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        switch (_attachmentType) {
+        switch (attachmentType) {
             case COLOR:
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA32F, contentWidth, contentHeight, 0, GL_RGBA, GL_FLOAT, nullptr);
+                ReserveData(GL_RGBA32F, contentWidth, contentHeight);
                 break;
             case DEPTH:
-                glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, contentWidth, contentHeight, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+                ReserveData(GL_DEPTH_COMPONENT32F, contentWidth, contentHeight);
                 break;
             case UNKNOWN:
                 throw std::runtime_error("Usage of attachment type UNKNOWN is reserved.");
         }
-
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        Unbind();
     }
 
-    void Texture::ReserveData(const std::string &textureName) {
-        _stbLoaded = true;
-
-        stbi_set_flip_vertically_on_load(false);
-
-        std::string name = ConvertToNativeSeparators(textureName);
-        std::string extension = GetAssetExtension(textureName);
+    void Texture::ReserveData(GLenum internalFormat, int contentWidth, int contentHeight) {
+        PixelFormat pixelFormat = GetPixelFormat(internalFormat);
 
-        int width, height, channels;
+        _stbLoaded = false;
+        _internalFormat = internalFormat;
+        _attachmentType = pixelFormat.format == GL_DEPTH_COMPONENT ? DEPTH : COLOR;
 
         Bind();
 
+        _contentWidth = contentWidth;
+        _contentHeight = contentHeight;
+
         // Texture wrapping.
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
@@ -93,31 +188,17 @@ namespace Sandbox {
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
         glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-        if (extension == "png" || extension == "jpg") {
-            unsigned char* data = stbi_load(name.c_str(), &width, &height, &channels, 0);
-            if (!data) {
-                throw std::runtime_error("Failed to load texture: " + textureName);
-            }
-
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-            stbi_image_free(data);
-        }
-        else if (extension == "hdr") {
-            // High definition range image.
-            float* data = stbi_loadf(name.c_str(), &width, &height, &channels, 0);
-            if (!data) {
-                throw std::runtime_error("Failed to load texture: " + textureName);
-            }
-
-            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, width, height, 0, GL_RGB, GL_FLOAT, data);
-            stbi_image_free(data);
-        }
+        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, contentWidth, contentHeight, 0, pixelFormat.format, pixelFormat.type, nullptr);
 
         glGenerateMipmap(GL_TEXTURE_2D);
 
         Unbind();
     }
 
+    void Texture::ReserveData(const std::string &textureName) {
+        SetData(Decode(textureName));
+    }
+
     void Texture::SetAttachmentLocation(GLuint attachmentLocation) {
         _attachmentLocation = attachmentLocation;
     }
@@ -138,6 +219,14 @@ namespace Sandbox {
         return _attachmentType;
     }
 
+    GLenum Texture::GetInternalFormat() const {
+        return _internalFormat;
+    }
+
+    std::size_t Texture::GetPixelSize(GLenum internalFormat) {
+        return GetPixelFormat(internalFormat).size;
+    }
+
     void Texture::WriteDataToDirectory(const std::string &directory) const {
         ImGuiLog& log = ImGuiLog::Instance();
 
@@ -159,13 +248,14 @@ namespace Sandbox {
 
         std::string filepath = directory + stringbuilder.str() + ".png";
 
+        // Written to disk a few frames later, without stalling on the readback.
         switch (_attachmentType) {
             case COLOR:
-                WriteData(filepath, GL_RGBA, GL_UNSIGNED_BYTE, 4);
+                ReadbackService::Instance().Capture(this, filepath);
                 log.LogTrace("Saving RGBA image file: \"%s\" under location: %s", _name.c_str(), filepath.c_str());
                 break;
             case DEPTH:
-                WriteData(filepath, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, 1);
+                ReadbackService::Instance().Capture(this, filepath);
                 log.LogTrace("Saving DEPTH image file: \"%s\" under location: %s", _name.c_str(), filepath.c_str());
                 break;
             case UNKNOWN:
@@ -174,18 +264,41 @@ namespace Sandbox {
         }
     }
 
-    void Texture::WriteData(const std::string& filepath, GLenum format, GLenum type, int channels) const {
-        unsigned char* textureData = new unsigned char[_contentWidth * _contentHeight * channels];
+    Texture::ImageData Texture::ReadData() const {
+        ImageData image { };
+        image.width = _contentWidth;
+        image.height = _contentHeight;
+        image.channels = 4;
+
+        std::size_t pixelCount = static_cast<std::size_t>(_contentWidth) * static_cast<std::size_t>(_contentHeight);
+        std::vector<unsigned char>& pixels = image.pixels;
 
-        // Get texture data to store inside textureData array.
         Bind();
-        glGetTexImage(GL_TEXTURE_2D, 0, format, type, textureData);
-        Unbind();
+        glPixelStorei(GL_PACK_ALIGNMENT, 1);
+
+        if (_attachmentType == DEPTH) {
+            std::vector<unsigned char> depth(pixelCount);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, GL_UNSIGNED_BYTE, depth.data());
+
+            pixels.resize(pixelCount * 4);
+            for (std::size_t i = 0; i < pixelCount; ++i) {
+                pixels[i * 4 + 0] = depth[i];
+                pixels[i * 4 + 1] = depth[i];
+                pixels[i * 4 + 2] = depth[i];
+                pixels[i * 4 + 3] = 255;
+            }
+        }
+        else {
+            pixels.resize(pixelCount * 4);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
 
-        stbi_flip_vertically_on_write(true);
-        stbi_write_png(filepath.c_str(), _contentWidth, _contentHeight, channels, textureData, 0);
+        glPixelStorei(GL_PACK_ALIGNMENT, 4);
+        Unbind();
 
-        delete[] textureData;
+        // OpenGL returns the bottom row first.
+        image.FlipVertically();
+        return image;
     }
 
     void Texture::SetData(int contentWidth, int contentHeight, const std::vector<unsigned char>& data) {
@@ -220,4 +333,58 @@ namespace Sandbox {
         Unbind();
     }
 
-}
\ No newline at end of file
+    void Texture::SetData(const ImageData& image) {
+        UploadImage(image, image.pixels.data());
+    }
+
+    void Texture::SetData(const ImageData& image, PixelBufferObject& stagingBuffer) {
+        stagingBuffer.Reserve(image.GetSize());
+
+        void* staging = stagingBuffer.Map();
+        if (!staging) {
+            // Fall back to uploading directly from client memory.
+            stagingBuffer.Unbind();
+            UploadImage(image, image.pixels.data());
+            return;
+        }
+
+        std::memcpy(staging, image.pixels.data(), image.GetSize());
+        stagingBuffer.Unmap();
+
+        // Pixel data is sourced from the start of the bound unpack buffer.
+        UploadImage(image, nullptr);
+        stagingBuffer.Unbind();
+    }
+
+    void Texture::UploadImage(const ImageData& image, const void* data) {
+        _stbLoaded = true;
+        _contentWidth = image.width;
+        _contentHeight = image.height;
+
+        Bind();
+
+        // Texture wrapping.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+        // Texturing filtering.
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+        // Rows are tightly packed.
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+        if (image.hdr) {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB16F, image.width, image.height, 0, GL_RGB, GL_FLOAT, data);
+        }
+        else {
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+        }
+
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glGenerateMipmap(GL_TEXTURE_2D);
+
+        Unbind();
+    }
+
+}
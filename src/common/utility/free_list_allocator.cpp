@@ -0,0 +1,172 @@
+
+#include "common/utility/free_list_allocator.h"
+
+namespace Sandbox {
+
+    FreeListAllocator::FreeListAllocator(unsigned capacity) : capacity_(0u),
+                                                              allocated_(0u)
+                                                              {
+        Reset(capacity);
+    }
+
+    FreeListAllocator::~FreeListAllocator() {
+    }
+
+    bool FreeListAllocator::Allocate(unsigned size, unsigned& offset) {
+        if (size == 0u) {
+            offset = 0u;
+            return true;
+        }
+
+        // Best fit: smallest free block that can hold the allocation.
+        auto iterator = blocksBySize_.lower_bound(size);
+        if (iterator == blocksBySize_.end()) {
+            return false;
+        }
+
+        unsigned blockOffset = iterator->second;
+        unsigned blockSize = iterator->first;
+        EraseFreeBlock(blocksByOffset_.find(blockOffset));
+
+        // Remainder of the block stays free.
+        if (blockSize > size) {
+            InsertFreeBlock(blockOffset + size, blockSize - size);
+        }
+
+        allocated_ += size;
+        offset = blockOffset;
+        return true;
+    }
+
+    void FreeListAllocator::AllocateAt(unsigned offset, unsigned size) {
+        if (size == 0u) {
+            return;
+        }
+
+        // Find the free block containing the range.
+        auto block = blocksByOffset_.upper_bound(offset);
+        assert(block != blocksByOffset_.begin());
+        --block;
+
+        unsigned blockOffset = block->first;
+        unsigned blockSize = block->second;
+        assert(offset + size <= blockOffset + blockSize);
+        EraseFreeBlock(block);
+
+        // Space on either side of the range stays free.
+        if (offset > blockOffset) {
+            InsertFreeBlock(blockOffset, offset - blockOffset);
+        }
+        if (offset + size < blockOffset + blockSize) {
+            InsertFreeBlock(offset + size, blockOffset + blockSize - (offset + size));
+        }
+
+        allocated_ += size;
+    }
+
+    void FreeListAllocator::Free(unsigned offset, unsigned size) {
+        if (size == 0u) {
+            return;
+        }
+
+        assert(offset + size <= capacity_);
+        assert(allocated_ >= size);
+        allocated_ -= size;
+
+        // Coalesce with the free blocks on either side.
+        auto next = blocksByOffset_.lower_bound(offset);
+        if (next != blocksByOffset_.end() && next->first == offset + size) {
+            size += next->second;
+            EraseFreeBlock(next);
+        }
+
+        auto previous = blocksByOffset_.lower_bound(offset);
+        if (previous != blocksByOffset_.begin()) {
+            --previous;
+
+            if (previous->first + previous->second == offset) {
+                offset = previous->first;
+                size += previous->second;
+                EraseFreeBlock(previous);
+            }
+        }
+
+        InsertFreeBlock(offset, size);
+    }
+
+    void FreeListAllocator::Grow(unsigned capacity) {
+        if (capacity <= capacity_) {
+            return;
+        }
+
+        unsigned offset = capacity_;
+        unsigned size = capacity - capacity_;
+        capacity_ = capacity;
+
+        // Freeing the new space merges it with a free block at the end of the previous address space.
+        allocated_ += size;
+        Free(offset, size);
+    }
+
+    void FreeListAllocator::Reset(unsigned capacity) {
+        blocksByOffset_.clear();
+        blocksBySize_.clear();
+
+        capacity_ = capacity;
+        allocated_ = 0u;
+
+        if (capacity > 0u) {
+            InsertFreeBlock(0u, capacity);
+        }
+    }
+
+    bool FreeListAllocator::GetNextHole(unsigned start, unsigned& offset, unsigned& size) const {
+        auto iterator = blocksByOffset_.lower_bound(start);
+        if (iterator == blocksByOffset_.end()) {
+            return false;
+        }
+
+        // Free blocks never touch, so only the block at the end of the address space is not followed by an allocation.
+        if (iterator->first + iterator->second == capacity_) {
+            return false;
+        }
+
+        offset = iterator->first;
+        size = iterator->second;
+        return true;
+    }
+
+    unsigned FreeListAllocator::GetCapacity() const {
+        return capacity_;
+    }
+
+    unsigned FreeListAllocator::GetAllocatedSize() const {
+        return allocated_;
+    }
+
+    unsigned FreeListAllocator::GetLargestFreeBlock() const {
+        return blocksBySize_.empty() ? 0u : blocksBySize_.rbegin()->first;
+    }
+
+    int FreeListAllocator::GetFreeBlockCount() const {
+        return static_cast<int>(blocksByOffset_.size());
+    }
+
+    void FreeListAllocator::InsertFreeBlock(unsigned offset, unsigned size) {
+        blocksByOffset_.emplace(offset, size);
+        blocksBySize_.emplace(size, offset);
+    }
+
+    void FreeListAllocator::EraseFreeBlock(std::map<unsigned, unsigned>::iterator block) {
+        auto range = blocksBySize_.equal_range(block->second);
+        for (auto iterator = range.first; iterator != range.second; ++iterator) {
+            if (iterator->second == block->first) {
+                blocksBySize_.erase(iterator);
+                break;
+            }
+        }
+
+        blocksByOffset_.erase(block);
+    }
+
+}
@@ -22,6 +22,8 @@ namespace Sandbox {
     }
 
     void ImGuiLog::OnImGui() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+
         static bool showLogWindow = true;
         if (ImGui::Begin("Log Window", &showLogWindow)) {
             ImGuiIO& io = ImGui::GetIO();
@@ -79,6 +81,7 @@ namespace Sandbox {
     }
 
     void ImGuiLog::ClearLog() {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
         gui_.clear();
     }
 
@@ -104,6 +107,8 @@ namespace Sandbox {
     }
 
     void ImGuiLog::ProcessMessage(Severity severity, const char *formatString, va_list argsList) {
+        std::lock_guard<std::recursive_mutex> lock(mutex_);
+
         int currentBufferSize = _processingBufferSize;
 
         // Copy args list to not modify passed parameters (yet).
@@ -0,0 +1,482 @@
+
+#include "common/utility/profiler.h"
+#include "common/utility/directory.h"
+#include "common/utility/log.h"
+
+namespace Sandbox {
+
+    // Track of GPU zones in exported traces.
+    static const int GPU_TRACK = 1000;
+
+    struct OpenZone {
+        const char* name;
+        double start;
+    };
+
+    // CPU zones nest per thread.
+    static thread_local std::vector<OpenZone> openZones;
+    static thread_local int threadIndex = -1;
+
+    static std::string EscapeJSON(const std::string& in) {
+        std::string out;
+        out.reserve(in.size());
+
+        for (char character : in) {
+            if (character == '"' || character == '\\') {
+                out += '\\';
+            }
+            out += character;
+        }
+
+        return out;
+    }
+
+    static ImU32 GetZoneColor(const char* name) {
+        // Same color for the same zone across frames.
+        std::size_t hash = std::hash<std::string_view>()(name);
+        float hue = static_cast<float>(hash % 360u) / 360.0f;
+        return ImColor::HSV(hue, 0.5f, 0.7f);
+    }
+
+    void Profiler::Init() {
+        epoch_ = std::chrono::steady_clock::now();
+
+        // GPU and CPU clocks are calibrated once, drift over a session is well below a frame.
+        GLint64 timestamp = 0;
+        glGetInteger64v(GL_TIMESTAMP, &timestamp);
+        gpuOffset_ = Now() - static_cast<double>(timestamp) / 1000000.0;
+
+        // Initialized on the main thread before any worker threads start, so it is always the first track.
+        SetThreadName("Main");
+
+        initialized_ = true;
+    }
+
+    void Profiler::Shutdown() {
+        for (GPUFrame& gpuFrame : gpuFrames_) {
+            for (GPUZone& zone : gpuFrame.zones) {
+                glDeleteQueries(2, zone.queries);
+            }
+
+            gpuFrame.zones.clear();
+            gpuFrame.used = 0;
+            gpuFrame.pending = false;
+        }
+
+        history_.clear();
+        initialized_ = false;
+    }
+
+    void Profiler::BeginFrame() {
+        enabled_ = requestedEnabled_;
+        if (!enabled_ || !initialized_) {
+            return;
+        }
+
+        // Frame that last used this set of queries was issued BUFFERED_FRAMES frames ago, its results are almost always ready.
+        GPUFrame& gpuFrame = gpuFrames_[frameIndex_ % BUFFERED_FRAMES];
+        if (gpuFrame.pending) {
+            ResolveGPUFrame(gpuFrame, true);
+        }
+
+        // Read back any other frame that has already finished on the GPU, oldest first.
+        for (int i = 1; i < BUFFERED_FRAMES; ++i) {
+            GPUFrame& other = gpuFrames_[(frameIndex_ + i) % BUFFERED_FRAMES];
+            if (!other.pending) {
+                continue;
+            }
+
+            ResolveGPUFrame(other, false);
+
+            // Later frames cannot have finished before this one.
+            if (other.pending) {
+                break;
+            }
+        }
+
+        gpuFrame.index = frameIndex_;
+        gpuFrame.used = 0;
+        gpuDepth_ = 0;
+        gpuStack_.clear();
+
+        std::lock_guard lock(mutex_);
+        current_.index = frameIndex_;
+        current_.start = Now();
+        current_.duration = 0.0;
+        current_.resolved = false;
+        current_.zones.clear();
+    }
+
+    void Profiler::EndFrame() {
+        if (!enabled_ || !initialized_) {
+            return;
+        }
+
+        GPUFrame& gpuFrame = gpuFrames_[frameIndex_ % BUFFERED_FRAMES];
+        if (!gpuStack_.empty()) {
+            throw std::runtime_error("GPU profiler zone '" + std::string(gpuFrame.zones[gpuStack_.back()].name) + "' was not closed before the end of the frame.");
+        }
+
+        gpuFrame.pending = gpuFrame.used > 0;
+
+        {
+            std::lock_guard lock(mutex_);
+            current_.duration = Now() - current_.start;
+            current_.resolved = !gpuFrame.pending;
+
+            history_.emplace_back(std::move(current_));
+            current_ = Frame { };
+        }
+
+        while (history_.size() > HISTORY_FRAMES) {
+            history_.pop_front();
+        }
+
+        ++frameIndex_;
+    }
+
+    void Profiler::BeginZone(const char* name) {
+        openZones.push_back({ name, Now() });
+    }
+
+    void Profiler::EndZone() {
+        if (openZones.empty()) {
+            throw std::runtime_error("Profiler zone closed without a matching open zone.");
+        }
+
+        OpenZone zone = openZones.back();
+        openZones.pop_back();
+
+        double end = Now();
+        int thread = GetThreadIndex();
+
+        std::lock_guard lock(mutex_);
+        current_.zones.push_back({ zone.name, thread, static_cast<int>(openZones.size()), zone.start, end - zone.start });
+    }
+
+    void Profiler::BeginGPUZone(const char* name) {
+        GPUFrame& gpuFrame = gpuFrames_[frameIndex_ % BUFFERED_FRAMES];
+
+        // Queries are created once and reused by later frames using the same set.
+        if (gpuFrame.used == gpuFrame.zones.size()) {
+            GPUZone zone { };
+            glGenQueries(2, zone.queries);
+            gpuFrame.zones.push_back(zone);
+        }
+
+        GPUZone& zone = gpuFrame.zones[gpuFrame.used];
+        zone.name = name;
+        zone.depth = gpuDepth_++;
+        glQueryCounter(zone.queries[0], GL_TIMESTAMP);
+
+        gpuStack_.push_back(gpuFrame.used++);
+    }
+
+    void Profiler::EndGPUZone() {
+        if (gpuStack_.empty()) {
+            throw std::runtime_error("GPU profiler zone closed without a matching open zone.");
+        }
+
+        GPUFrame& gpuFrame = gpuFrames_[frameIndex_ % BUFFERED_FRAMES];
+        glQueryCounter(gpuFrame.zones[gpuStack_.back()].queries[1], GL_TIMESTAMP);
+
+        gpuStack_.pop_back();
+        --gpuDepth_;
+    }
+
+    void Profiler::SetEnabled(bool enabled) {
+        requestedEnabled_ = enabled;
+    }
+
+    bool Profiler::IsEnabled() const {
+        return initialized_ && enabled_;
+    }
+
+    const char* Profiler::Intern(const std::string& name) {
+        std::lock_guard lock(mutex_);
+        return names_.insert(name).first->c_str();
+    }
+
+    void Profiler::SetThreadName(const std::string& name) {
+        int thread = GetThreadIndex();
+
+        std::lock_guard lock(mutex_);
+        threadNames_[thread] = name;
+    }
+
+    void Profiler::ExportChromeTrace(const std::string& filepath) const {
+        CreateDirectory(std::filesystem::path(filepath).parent_path().string());
+
+        std::ofstream file(filepath);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open profiler trace file '" + filepath + "'.");
+        }
+
+        // Trace event timestamps are in microseconds.
+        auto writeEvent = [&file](const std::string& name, const char* category, int thread, double start, double duration) {
+            file << ",\n{\"name\":\"" << EscapeJSON(name) << "\",\"cat\":\"" << category << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << thread;
+            file << ",\"ts\":" << start * 1000.0 << ",\"dur\":" << duration * 1000.0 << "}";
+        };
+
+        file << std::fixed << std::setprecision(3);
+        file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << GPU_TRACK << ",\"args\":{\"name\":\"GPU\"}}";
+
+        {
+            std::lock_guard lock(mutex_);
+            for (std::size_t thread = 0; thread < threadNames_.size(); ++thread) {
+                file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << thread << ",\"args\":{\"name\":\"" << EscapeJSON(threadNames_[thread]) << "\"}}";
+            }
+        }
+
+        for (const Frame& frame : history_) {
+            if (!frame.resolved) {
+                continue;
+            }
+
+            writeEvent("Frame " + std::to_string(frame.index), "frame", 0, frame.start, frame.duration);
+
+            for (const Zone& zone : frame.zones) {
+                bool gpu = zone.thread < 0;
+                writeEvent(zone.name, gpu ? "gpu" : "cpu", gpu ? GPU_TRACK : zone.thread, zone.start, zone.duration);
+            }
+        }
+
+        file << "\n]}\n";
+    }
+
+    void Profiler::Flush() {
+        // Oldest frame first.
+        for (int i = 0; i < BUFFERED_FRAMES; ++i) {
+            GPUFrame& gpuFrame = gpuFrames_[(frameIndex_ + i) % BUFFERED_FRAMES];
+            if (gpuFrame.pending) {
+                ResolveGPUFrame(gpuFrame, true);
+            }
+        }
+    }
+
+    const Profiler::Frame* Profiler::GetLatestFrame() const {
+        for (auto iterator = history_.rbegin(); iterator != history_.rend(); ++iterator) {
+            if (iterator->resolved) {
+                return &*iterator;
+            }
+        }
+
+        return nullptr;
+    }
+
+    const std::deque<Profiler::Frame>& Profiler::GetHistory() const {
+        return history_;
+    }
+
+    unsigned Profiler::GetFrameIndex() const {
+        return frameIndex_;
+    }
+
+    void Profiler::OnImGui() {
+        if (ImGui::Begin("Profiler")) {
+            bool enabled = requestedEnabled_;
+            if (ImGui::Checkbox("Enabled", &enabled)) {
+                SetEnabled(enabled);
+            }
+
+            ImGui::SameLine();
+            ImGui::Checkbox("Pause", &paused_);
+
+            ImGui::SameLine();
+            if (ImGui::Button("Export trace")) {
+                std::string filepath = "out/profiler/trace_" + std::to_string(frameIndex_) + ".json";
+                ExportChromeTrace(filepath);
+                ImGuiLog::Instance().LogTrace("Exported profiler trace of the last %i frames to: %s", static_cast<int>(history_.size()), filepath.c_str());
+            }
+
+            const Frame* latest = GetLatestFrame();
+            if (!paused_ && latest) {
+                displayed_ = *latest;
+            }
+
+            if (displayed_.zones.empty()) {
+                ImGui::Text("No frames recorded.");
+                ImGui::End();
+                return;
+            }
+
+            // GPU work trails the CPU frame that submitted it, the timeline spans both.
+            double start = displayed_.start;
+            double end = displayed_.start + displayed_.duration;
+            double gpuTime = 0.0;
+
+            std::map<int, int> depths; // Deepest zone per track.
+
+            for (const Zone& zone : displayed_.zones) {
+                end = std::max(end, zone.start + zone.duration);
+                depths[zone.thread] = std::max(depths[zone.thread], zone.depth + 1);
+
+                if (zone.thread < 0 && zone.depth == 0) {
+                    gpuTime += zone.duration;
+                }
+            }
+
+            ImGui::Text("Frame %u: %.3f ms CPU, %.3f ms GPU", displayed_.index, displayed_.duration, gpuTime);
+
+            const float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+            const float labelWidth = 80.0f;
+
+            ImVec2 origin = ImGui::GetCursorScreenPos();
+            float width = std::max(ImGui::GetContentRegionAvail().x - labelWidth, 1.0f);
+            float scale = width / static_cast<float>(std::max(end - start, 0.001));
+
+            ImDrawList* drawList = ImGui::GetWindowDrawList();
+            ImVec2 mouse = ImGui::GetIO().MousePos;
+
+            float y = origin.y;
+            for (const std::pair<const int, int>& track : depths) {
+                std::string label;
+                {
+                    std::lock_guard lock(mutex_);
+                    label = track.first < 0 ? "GPU" : (track.first < static_cast<int>(threadNames_.size()) ? threadNames_[track.first] : "Thread " + std::to_string(track.first));
+                }
+                drawList->AddText(ImVec2(origin.x, y), ImGui::GetColorU32(ImGuiCol_Text), label.c_str());
+
+                for (const Zone& zone : displayed_.zones) {
+                    if (zone.thread != track.first) {
+                        continue;
+                    }
+
+                    ImVec2 min(origin.x + labelWidth + static_cast<float>(zone.start - start) * scale, y + static_cast<float>(zone.depth) * rowHeight);
+                    ImVec2 max(std::max(min.x + 1.0f, min.x + static_cast<float>(zone.duration) * scale), min.y + rowHeight - 1.0f);
+
+                    drawList->AddRectFilled(min, max, GetZoneColor(zone.name));
+                    drawList->PushClipRect(min, max, true);
+                    drawList->AddText(ImVec2(min.x + 2.0f, min.y), IM_COL32_WHITE, zone.name);
+                    drawList->PopClipRect();
+
+                    if (mouse.x >= min.x && mouse.x < max.x && mouse.y >= min.y && mouse.y < max.y) {
+                        ImGui::SetTooltip("%s: %.3f ms", zone.name, zone.duration);
+                    }
+                }
+
+                y += static_cast<float>(track.second) * rowHeight + 4.0f;
+            }
+
+            ImGui::Dummy(ImVec2(labelWidth + width, y - origin.y));
+        }
+
+        ImGui::End();
+    }
+
+    Profiler::Profiler() : enabled_(true),
+                           requestedEnabled_(true),
+                           initialized_(false),
+                           gpuOffset_(0.0),
+                           frameIndex_(0u),
+                           current_ { },
+                           gpuFrames_ { },
+                           gpuDepth_(0),
+                           paused_(false),
+                           displayed_ { }
+                           {
+    }
+
+    Profiler::~Profiler() {
+    }
+
+    double Profiler::Now() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - epoch_).count();
+    }
+
+    int Profiler::GetThreadIndex() {
+        if (threadIndex >= 0) {
+            return threadIndex;
+        }
+
+        std::lock_guard lock(mutex_);
+        std::thread::id id = std::this_thread::get_id();
+
+        auto iterator = threadIndices_.find(id);
+        if (iterator == threadIndices_.end()) {
+            int index = static_cast<int>(threadNames_.size());
+            iterator = threadIndices_.emplace(id, index).first;
+            threadNames_.emplace_back("Thread " + std::to_string(index));
+        }
+
+        threadIndex = iterator->second;
+        return threadIndex;
+    }
+
+    void Profiler::ResolveGPUFrame(GPUFrame& gpuFrame, bool wait) {
+        if (!wait) {
+            // Queries complete in order, the last one being available means all of them are.
+            GLuint available = GL_FALSE;
+            glGetQueryObjectuiv(gpuFrame.zones[gpuFrame.used - 1].queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) {
+                return;
+            }
+        }
+
+        Frame* frame = FindFrame(gpuFrame.index);
+
+        for (std::size_t i = 0; i < gpuFrame.used; ++i) {
+            const GPUZone& zone = gpuFrame.zones[i];
+
+            GLuint64 begin = 0;
+            GLuint64 end = 0;
+            glGetQueryObjectui64v(zone.queries[0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(zone.queries[1], GL_QUERY_RESULT, &end);
+
+            // Frame has already dropped out of the history.
+            if (!frame) {
+                continue;
+            }
+
+            double start = static_cast<double>(begin) / 1000000.0 + gpuOffset_;
+            double duration = static_cast<double>(end - begin) / 1000000.0;
+            frame->zones.push_back({ zone.name, -1, zone.depth, start, duration });
+        }
+
+        if (frame) {
+            frame->resolved = true;
+        }
+
+        gpuFrame.pending = false;
+    }
+
+    Profiler::Frame* Profiler::FindFrame(unsigned index) {
+        for (auto iterator = history_.rbegin(); iterator != history_.rend(); ++iterator) {
+            if (iterator->index == index) {
+                return &*iterator;
+            }
+        }
+
+        return nullptr;
+    }
+
+    ProfileZone::ProfileZone(const char* name, bool gpu) : gpu_(gpu),
+                                                           active_(Profiler::Instance().IsEnabled())
+                                                           {
+        if (!active_) {
+            return;
+        }
+
+        Profiler& profiler = Profiler::Instance();
+        profiler.BeginZone(name);
+
+        if (gpu_) {
+            profiler.BeginGPUZone(name);
+        }
+    }
+
+    ProfileZone::~ProfileZone() {
+        if (!active_) {
+            return;
+        }
+
+        Profiler& profiler = Profiler::Instance();
+        if (gpu_) {
+            profiler.EndGPUZone();
+        }
+
+        profiler.EndZone();
+    }
+
+}
@@ -0,0 +1,100 @@
+
+#include "common/utility/thread_pool.h"
+
+namespace Sandbox {
+
+    ThreadPool::ThreadPool(unsigned numThreads) : numActiveTasks_(0u),
+                                                  running_(true)
+                                                  {
+        if (numThreads == 0u) {
+            // Hardware concurrency is only a hint and may not be available.
+            unsigned hardwareThreads = std::thread::hardware_concurrency();
+            numThreads = hardwareThreads > 1u ? hardwareThreads - 1u : 1u;
+        }
+
+        workers_.reserve(numThreads);
+        for (unsigned i = 0u; i < numThreads; ++i) {
+            workers_.emplace_back(&ThreadPool::ProcessTasks, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            running_ = false;
+        }
+
+        taskAvailable_.notify_all();
+
+        for (std::thread& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::Wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasksFinished_.wait(lock, [this]() {
+            return tasks_.empty() && numActiveTasks_ == 0u;
+        });
+    }
+
+    void ThreadPool::Clear() {
+        std::deque<std::function<void()>> dropped;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            dropped.swap(tasks_);
+
+            tasksFinished_.wait(lock, [this]() {
+                return numActiveTasks_ == 0u;
+            });
+        }
+
+        // Dropped tasks get destroyed outside of the lock, breaking their promises.
+    }
+
+    unsigned ThreadPool::GetThreadCount() const {
+        return static_cast<unsigned>(workers_.size());
+    }
+
+    void ThreadPool::Enqueue(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back(std::move(task));
+        }
+
+        taskAvailable_.notify_one();
+    }
+
+    void ThreadPool::ProcessTasks() {
+        while (true) {
+            std::function<void()> task;
+
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                taskAvailable_.wait(lock, [this]() {
+                    return !running_ || !tasks_.empty();
+                });
+
+                if (!running_ && tasks_.empty()) {
+                    return;
+                }
+
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+                ++numActiveTasks_;
+            }
+
+            // Exceptions are captured by the packaged task and rethrown through the associated future.
+            task();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                --numActiveTasks_;
+            }
+
+            tasksFinished_.notify_all();
+        }
+    }
+
+}
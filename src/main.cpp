@@ -10,24 +10,116 @@
 #include "common/api/shader/shader_preprocessor.h"
 #include "common/api/shader/shader_compiler.h"
 #include "common/api/shader/shader_uniform_lut.h"
+#include "common/application/command_line.h"
+#include "common/rendering/box_blur.h"
 
 using namespace Sandbox;
 
-int main() {
+int main(int argc, char* argv[]) {
+    CommandLineOptions options;
+
+    try {
+        options = ParseCommandLine(argc, argv);
+    }
+    catch (const std::exception& exception) {
+        std::cerr << exception.what() << std::endl << GetCommandLineUsage(argv[0]);
+        return 1;
+    }
+
+    if (options.help) {
+        std::cout << GetCommandLineUsage(argv[0]);
+        return 0;
+    }
+
     auto pp = ShaderPreprocessor::Instance().ProcessFile("assets/shaders/ascii.vert");
     auto c = ShaderCompiler::Instance().ProcessFile(pp);
 
     Application& application = Application::Instance();
-    application.Init(1920, 1080);
+    application.Init(options.width, options.height, options.headless);
+    application.SetFrameLimit(options.frames);
+
+    if (options.blurRadius >= 0) {
+        BoxBlur::SetRadiusOverride(options.blurRadius);
+    }
 
     SceneManager& sceneManager = application.GetSceneManager();
-//    sceneManager.AddScene<SceneCS562Project1>("CS562: Project 1");
-//    sceneManager.AddScene<SceneCS562Project2>("CS562: Project 2");
+    sceneManager.AddScene<SceneCS562Project1>("CS562: Project 1");
+    sceneManager.AddScene<SceneCS562Project2>("CS562: Project 2");
     sceneManager.AddScene<SceneCS562Project3>("CS562: Project 3");
-    sceneManager.SetActiveScene("CS562: Project 3");
+
+    if (!options.scene.empty() && !sceneManager.HasScene(options.scene)) {
+        std::cerr << "No scene registered with name '" << options.scene << "'." << std::endl;
+        application.Shutdown();
+        return 1;
+    }
+
+    sceneManager.SetActiveScene(options.scene.empty() ? "CS562: Project 3" : options.scene);
+
+    if (options.benchmark) {
+        try {
+            application.SetBenchmark({ options.scene, options.frames, options.warmup, "out/benchmark" });
+        }
+        catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            application.Shutdown();
+            return 1;
+        }
+    }
+
+    if (options.renderTest) {
+        RenderTest::Settings settings;
+        settings.scenes = options.scene.empty() ? sceneManager.GetSceneNames() : std::vector<std::string> { options.scene };
+        settings.update = options.updateReferences;
+
+        if (!options.references.empty()) {
+            settings.referenceDirectory = options.references;
+        }
+
+        try {
+            application.SetRenderTest(settings);
+        }
+        catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            application.Shutdown();
+            return 1;
+        }
+
+        sceneManager.SetActiveScene(settings.scenes.front());
+    }
+
+    if (!options.playCamera.empty()) {
+        try {
+            application.PlayCameraPath(options.playCamera, options.playbackSpeed, options.playbackInterpolation);
+        }
+        catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            application.Shutdown();
+            return 1;
+        }
+    }
+
+    if (!options.capture.empty()) {
+        FrameCapture::Settings settings;
+        settings.target = options.captureTarget;
+        settings.format = options.captureFormat;
+        settings.output = options.capture;
+
+        try {
+            application.SetFrameCapture(settings);
+        }
+        catch (const std::exception& exception) {
+            std::cerr << exception.what() << std::endl;
+            application.Shutdown();
+            return 1;
+        }
+    }
+
+    if (!options.recordCamera.empty()) {
+        application.RecordCameraPath(options.recordCamera);
+    }
 
     application.Run();
     application.Shutdown();
 
-    return 0;
+    return application.GetExitCode();
 }
@@ -0,0 +1,52 @@
+
+#include "scenes/cs562/project1/clustered_lighting.h"
+#include "scenes/cs562/project1/light.h"
+#include "common/geometry/transform.h"
+#include "common/ecs/ecs.h"
+
+namespace Sandbox {
+
+    ClusteredLighting::ClusteredLighting() : lightData_ { }
+                                             {
+    }
+
+    ClusteredLighting::~ClusteredLighting() {
+    }
+
+    int ClusteredLighting::Build(const std::vector<int>& entityIDs) {
+        lights_.clear();
+
+        int count = ECS::Instance().IterateOver<Transform, LocalLight>(entityIDs, [this](Transform& transform, LocalLight& light) {
+            lights_.push_back({ glm::vec4(transform.GetPosition(), transform.GetScale().x), glm::vec4(light.color_, light.brightness_) });
+        });
+
+        lightData_ = StreamingBuffer::Instance().Write(lights_.data(), lights_.size() * sizeof(LightData), GL_SHADER_STORAGE_BUFFER);
+        return count;
+    }
+
+    void ClusteredLighting::Render(Shader* shader, Texture* output, ICamera& camera) const {
+        int width = output->GetWidth();
+        int height = output->GetHeight();
+
+        shader->SetUniform("resolution", glm::vec2(width, height));
+        shader->SetUniform("cameraPosition", camera.GetPosition());
+        shader->SetUniform("viewTransform", camera.GetViewTransform());
+        shader->SetUniform("inverseProjection", glm::inverse(camera.GetPerspectiveTransform()));
+        shader->SetUniform("nearPlane", camera.GetNearPlaneDistance());
+        shader->SetUniform("farPlane", camera.GetFarPlaneDistance());
+        shader->SetUniform("lightCount", static_cast<int>(lights_.size()));
+
+        StreamingBuffer::Instance().BindRange(GL_SHADER_STORAGE_BUFFER, BINDING_POINT, lightData_);
+        glBindImageTexture(0, output->ID(), 0, GL_FALSE, 0, GL_READ_WRITE, GL_RGBA32F);
+
+        glDispatchCompute((width + TILE_SIZE - 1) / TILE_SIZE, (height + TILE_SIZE - 1) / TILE_SIZE, 1);
+
+        // Output is sampled and rendered to afterwards.
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT | GL_FRAMEBUFFER_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+    }
+
+    int ClusteredLighting::GetLightCount() const {
+        return static_cast<int>(lights_.size());
+    }
+
+}
@@ -1,5 +1,7 @@
 
 #include "scenes/cs562/project1/light.h"
+#include "common/geometry/transform.h"
+#include "common/ecs/ecs.h"
 
 namespace Sandbox {
 
@@ -24,4 +26,57 @@ namespace Sandbox {
                                                                        {
     }
 
+    LocalLightBatch::LocalLightBatch() : instanceData_ { }
+                                         {
+    }
+
+    LocalLightBatch::~LocalLightBatch() {
+    }
+
+    int LocalLightBatch::Build(const std::vector<int>& entityIDs) {
+        entries_.clear();
+        instances_.clear();
+        batches_.clear();
+
+        int count = ECS::Instance().IterateOver<Transform, Mesh, LocalLight>(entityIDs, [this](Transform& transform, Mesh& mesh, LocalLight& light) {
+            LocalLightInstance instance { };
+            instance.modelTransform_ = transform.GetMatrix();
+            instance.position_ = glm::vec4(transform.GetPosition(), transform.GetScale().x);
+            instance.color_ = glm::vec4(light.color_, light.brightness_);
+
+            entries_.push_back({ mesh.GetGeometry().get(), &mesh, instance });
+        });
+
+        // Lights sharing geometry are drawn together.
+        std::stable_sort(entries_.begin(), entries_.end(), [](const Entry& first, const Entry& second) {
+            return std::less<const GeometryArena::Allocation*>()(first.geometry, second.geometry);
+        });
+
+        instances_.reserve(entries_.size());
+
+        for (const Entry& entry : entries_) {
+            if (batches_.empty() || batches_.back().geometry != entry.geometry) {
+                batches_.push_back({ entry.geometry, entry.mesh, static_cast<int>(instances_.size()), 0 });
+            }
+
+            instances_.emplace_back(entry.instance);
+            ++batches_.back().count;
+        }
+
+        instanceData_ = StreamingBuffer::Instance().Write(instances_.data(), instances_.size() * sizeof(LocalLightInstance), GL_SHADER_STORAGE_BUFFER);
+        return count;
+    }
+
+    void LocalLightBatch::Render(Shader* shader) const {
+        StreamingBuffer::Instance().BindRange(GL_SHADER_STORAGE_BUFFER, BINDING_POINT, instanceData_);
+
+        for (const Batch& batch : batches_) {
+            shader->SetUniform("instanceOffset", batch.offset);
+
+            batch.mesh->Bind();
+            batch.mesh->RenderInstanced(batch.count);
+            batch.mesh->Unbind();
+        }
+    }
+
 }
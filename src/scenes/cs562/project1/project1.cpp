@@ -3,14 +3,18 @@
 #include "common/api/window.h"
 #include "common/geometry/object_loader.h"
 #include "common/utility/log.h"
+#include "common/utility/profiler.h"
 #include "common/geometry/transform.h"
 #include "common/ecs/ecs.h"
 #include "common/application/time.h"
+#include "common/application/asset_streamer.h"
+#include "common/rendering/frame_constants.h"
 
 namespace Sandbox {
 
     SceneCS562Project1::SceneCS562Project1() : fbo_(2560, 1440),
-                                               camera_(Window::Instance().GetWidth(), Window::Instance().GetHeight())
+                                               camera_(Window::Instance().GetWidth(), Window::Instance().GetHeight()),
+                                               clusteredLightingEnabled_(true)
                                                {
     }
 
@@ -42,6 +46,14 @@ namespace Sandbox {
     void SceneCS562Project1::OnRender() {
         IScene::OnRender();
 
+        // Refresh culling bounds before any pass is drawn.
+        culler_.Update();
+        spatialIndex_.Update(culler_);
+        culler_.Cull(Frustum(camera_.GetCameraTransform()), visibleEntities_);
+
+        // Camera constants are shared by all passes of the frame.
+        FrameConstants(camera_).Bind();
+
         // Set viewport.
         fbo_.BindForReadWrite();
         Backend::Core::SetViewport(0, 0, fbo_.GetWidth(), fbo_.GetHeight());
@@ -55,16 +67,21 @@ namespace Sandbox {
         GlobalLightingPass();
 
         // 3. Local lighting pass.
-        Backend::Core::EnableFlag(GL_BLEND); // Enable blending.
-        glBlendFunc(GL_ONE, GL_ONE);         // Additive blending TODO: abstract out.
+        if (clusteredLightingEnabled_) {
+            ClusteredLightingPass();
+        }
+        else {
+            Backend::Core::EnableFlag(GL_BLEND); // Enable blending.
+            glBlendFunc(GL_ONE, GL_ONE);         // Additive blending TODO: abstract out.
 
-        Backend::Core::EnableFlag(GL_CULL_FACE);
-        Backend::Core::CullFace(GL_FRONT);
+            Backend::Core::EnableFlag(GL_CULL_FACE);
+            Backend::Core::CullFace(GL_FRONT);
 
-        LocalLightingPass();
+            LocalLightingPass();
 
-        Backend::Core::DisableFlag(GL_CULL_FACE);
-        Backend::Core::DisableFlag(GL_BLEND);
+            Backend::Core::DisableFlag(GL_CULL_FACE);
+            Backend::Core::DisableFlag(GL_BLEND);
+        }
 
         RenderDepthBuffer();
 
@@ -93,6 +110,23 @@ namespace Sandbox {
             ImGui::Text("Render time:");
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+            const Backend::State::Statistics& stateChanges = Backend::State::GetStatistics();
+            ImGui::Text("%i state changes issued, %i redundant skipped", stateChanges.issued, stateChanges.avoided);
+
+            const StreamingBuffer& streamingBuffer = StreamingBuffer::Instance();
+            ImGui::Text("%.1f / %.1f KB of streamed buffer data", static_cast<float>(streamingBuffer.GetFrameUsage()) / 1024.0f, static_cast<float>(streamingBuffer.GetSegmentSize()) / 1024.0f);
+
+            ImGui::Separator();
+
+            culler_.OnImGui();
+
+            ImGui::Separator();
+
+            ImGui::Checkbox("Clustered local lighting", &clusteredLightingEnabled_);
+            if (clusteredLightingEnabled_) {
+                ImGui::Text("%i lights binned into %ix%i pixel tiles, %i depth slices each", clusteredLighting_.GetLightCount(), ClusteredLighting::TILE_SIZE, ClusteredLighting::TILE_SIZE, ClusteredLighting::DEPTH_SLICES);
+            }
+
             ImGui::Separator();
 
             if (ImGui::Button("Take Screenshot")) {
@@ -150,10 +184,14 @@ namespace Sandbox {
         ImGui::End();
 
         ImGuiLog::Instance().OnImGui();
+        Profiler::Instance().OnImGui();
     }
 
     void SceneCS562Project1::OnShutdown() {
         IScene::OnShutdown();
+        culler_.Clear();
+        spatialIndex_.Clear();
+        materialBuffer_.Clear();
     }
 
     void SceneCS562Project1::OnWindowResize(int width, int height) {
@@ -171,12 +209,21 @@ namespace Sandbox {
         Backend::Core::SetViewport(0, 0, width, height);
     }
 
+    ICamera* SceneCS562Project1::GetCamera() {
+        return &camera_;
+    }
+
+    std::vector<Texture*> SceneCS562Project1::GetRenderTargets() {
+        return fbo_.GetRenderTargets();
+    }
+
     void SceneCS562Project1::InitializeShaders() {
         ShaderLibrary& shaderLibrary = ShaderLibrary::Instance();
 
-        shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer.frag" });
+        materialBuffer_.SetLayout(shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer.frag" }));
         shaderLibrary.CreateShader("Global Lighting Pass", { "assets/shaders/fsq.vert", "assets/shaders/global_lighting.frag" });
-        shaderLibrary.CreateShader("Local Lighting Pass", { "assets/shaders/model.vert", "assets/shaders/local_lighting.frag" });
+        shaderLibrary.CreateShader("Local Lighting Pass", { "assets/shaders/local_light.vert", "assets/shaders/local_lighting.frag" });
+        shaderLibrary.CreateShader("Clustered Lighting Pass", { "assets/shaders/clustered_lighting.comp" });
         shaderLibrary.CreateShader("Depth", { "assets/shaders/depth.vert", "assets/shaders/depth.frag" });
         shaderLibrary.CreateShader("FSQ", { "assets/shaders/fsq.vert", "assets/shaders/fsq.frag" });
     }
@@ -202,9 +249,7 @@ namespace Sandbox {
         // Bunny.
         int bunny = ecs.CreateEntity("Bunny");
 
-        ecs.AddComponent<Mesh>(bunny, OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/bunny.obj"))).Configure([](Mesh& mesh) {
-            mesh.Complete();
-        });
+        AssetStreamer::Instance().LoadMesh(bunny, "assets/models/bunny.obj");
 
         ecs.AddComponent<MaterialCollection>(bunny).Configure([this](MaterialCollection& materialCollection) {
             Material* phong = materialLibrary_.GetMaterialInstance("Phong");
@@ -215,9 +260,7 @@ namespace Sandbox {
 
         // Floor.
         int floor = ecs.CreateEntity("Floor");
-        ecs.AddComponent<Mesh>(floor, OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/quad.obj"))).Configure([](Mesh& mesh) {
-            mesh.Complete();
-        });
+        AssetStreamer::Instance().LoadMesh(floor, "assets/models/quad.obj");
 
         ecs.AddComponent<MaterialCollection>(floor).Configure([this](MaterialCollection& materialCollection) {
             Material* phong = materialLibrary_.GetMaterialInstance("Phong");
@@ -261,7 +304,9 @@ namespace Sandbox {
         }
 
         ECS& ecs = ECS::Instance();
-        Mesh mesh = OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/sphere.obj"));
+
+        // Light volumes share a single mesh, which is streamed in once all lights are created.
+        std::vector<int> lights;
 
         float radius = 4.0f;
         float angle = 0.0f;
@@ -272,9 +317,7 @@ namespace Sandbox {
         for (int x = 0; x < numPerSide; ++x) {
             for (int z = 0; z < numPerSide; ++z) {
                 int ID = ecs.CreateEntity("light");
-                ecs.AddComponent<Mesh>(ID, mesh).Configure([](Mesh& mesh) {
-                    mesh.Complete();
-                });
+                lights.emplace_back(ID);
 
                 glm::vec3 position = glm::vec3(x - numPerSide / 2, -1.5f, z - numPerSide / 2);
 
@@ -286,6 +329,8 @@ namespace Sandbox {
             }
         }
 
+        AssetStreamer::Instance().LoadMesh(lights, "assets/models/sphere.obj");
+
 //        float angleChange = 360.0f / (float)numLights;
 //
 //        // Push back vertices in a circle.
@@ -384,6 +429,8 @@ namespace Sandbox {
     }
 
     void SceneCS562Project1::GeometryPass() {
+        PROFILE_GPU_SCOPE("GeometryPass");
+
         fbo_.DrawBuffers(0, 5);
         Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear everything for a new scene.
@@ -406,34 +453,39 @@ namespace Sandbox {
             multiplier = 1.0f;
         }
 
-        // Set camera uniforms.
-        geometryShader->SetUniform("cameraTransform", camera_.GetCameraTransform());
         geometryShader->SetUniform("normalBlend", timer);
 
-        // Render models to FBO attachments.
-        ECS::Instance().IterateOver<Transform, Mesh, MaterialCollection>([geometryShader](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
+        // Render visible models to FBO attachments, grouped by material and mesh and front to back within a group.
+        ECS& ecs = ECS::Instance();
+        const glm::vec3& cameraPosition = camera_.GetPosition();
+        float farPlaneDistance = camera_.GetFarPlaneDistance();
+
+        renderQueue_.Clear();
+        ecs.IterateOver<Transform, Mesh, MaterialCollection>(visibleEntities_, [this, geometryShader, &cameraPosition, farPlaneDistance](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
             const glm::mat4& modelTransform = transform.GetMatrix();
-            geometryShader->SetUniform("modelTransform", modelTransform);
-            geometryShader->SetUniform("normalTransform", glm::transpose(glm::inverse(modelTransform)));
+            float depth = glm::distance(cameraPosition, glm::vec3(modelTransform[3])) / farPlaneDistance;
 
-            // Bind all related uniforms with the Phong shader.
+            // Phong material is selected by its record in the material buffer.
             Material* phong = materialCollection.GetNamedMaterial("Phong");
-            if (phong) {
-                phong->Bind(geometryShader);
-            }
+            renderQueue_.Submit(depth, { geometryShader, nullptr, &mesh, modelTransform, phong ? materialBuffer_.GetMaterialID(phong) : 0 });
+        });
 
-            // Render stage.
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
+        renderQueue_.Sort();
 
-            // Post render stage.
-        });
+        // Only records of materials edited since the last frame are uploaded.
+        materialBuffer_.Update();
+        materialBuffer_.Bind();
+
+        int drawn = renderQueue_.Execute();
+
+        culler_.RecordPass("Geometry", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, MaterialCollection>().size()));
 
         geometryShader->Unbind();
     }
 
     void SceneCS562Project1::GlobalLightingPass() {
+        PROFILE_GPU_SCOPE("GlobalLightingPass");
+
         // Render to 'output' texture.
         fbo_.DrawBuffers(5, 1);
 
@@ -465,6 +517,8 @@ namespace Sandbox {
     }
 
     void SceneCS562Project1::LocalLightingPass() {
+        PROFILE_GPU_SCOPE("LocalLightingPass");
+
         // Render to 'output' texture.
         fbo_.DrawBuffers(5, 1);
         // No clearing here.
@@ -485,23 +539,50 @@ namespace Sandbox {
         Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("diffuse"), 3);
         Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("specular"), 4);
 
-        ECS::Instance().IterateOver<Transform, Mesh, LocalLight>([localLightingShader](Transform& transform, Mesh& mesh, LocalLight& light) {
-            localLightingShader->SetUniform("modelTransform", transform.GetMatrix());
+        // Light volumes are looked up in the spatial index instead of being tested against the frustum one by one.
+        visibleLights_.clear();
+        spatialIndex_.QueryFrustum(Frustum(camera_.GetCameraTransform()), visibleLights_);
 
-            localLightingShader->SetUniform("lightPosition", transform.GetPosition());
-            localLightingShader->SetUniform("lightRadius", transform.GetScale().x);
-            localLightingShader->SetUniform("lightColor", light.color_);
-            localLightingShader->SetUniform("lightBrightness", light.brightness_);
+        // All visible lights sharing a light volume mesh are drawn with a single instanced draw call.
+        ECS& ecs = ECS::Instance();
+        int drawn = lightBatch_.Build(visibleLights_);
+        lightBatch_.Render(localLightingShader);
 
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
-        });
+        culler_.RecordPass("Local lights", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, LocalLight>().size()));
 
         localLightingShader->Unbind();
     }
 
+    void SceneCS562Project1::ClusteredLightingPass() {
+        PROFILE_GPU_SCOPE("ClusteredLightingPass");
+
+        Shader* clusteredLightingShader = ShaderLibrary::Instance().GetShader("Clustered Lighting Pass");
+        clusteredLightingShader->Bind();
+
+        // Bind geometry pass textures.
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("position"), 0);
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("normal"), 1);
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("ambient"), 2);
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("diffuse"), 3);
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("specular"), 4);
+        Backend::Rendering::BindTextureWithSampler(clusteredLightingShader, fbo_.GetNamedRenderTarget("depthBuffer"), 5);
+
+        // Lights outside the camera frustum are not uploaded at all, the rest are culled per tile on the GPU.
+        visibleLights_.clear();
+        spatialIndex_.QueryFrustum(Frustum(camera_.GetCameraTransform()), visibleLights_);
+
+        ECS& ecs = ECS::Instance();
+        int binned = clusteredLighting_.Build(visibleLights_);
+        clusteredLighting_.Render(clusteredLightingShader, fbo_.GetNamedRenderTarget("output"), camera_);
+
+        culler_.RecordPass("Local lights", binned, static_cast<int>(ecs.GetEntityIDs<Transform, LocalLight>().size()));
+
+        clusteredLightingShader->Unbind();
+    }
+
     void SceneCS562Project1::RenderDepthBuffer() {
+        PROFILE_GPU_SCOPE("RenderDepthBuffer");
+
         // Render to depth texturing using FSQ.
         fbo_.DrawBuffers(6, 1);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT);
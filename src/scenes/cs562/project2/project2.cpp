@@ -3,12 +3,21 @@
 #include "common/api/window.h"
 #include "common/geometry/object_loader.h"
 #include "common/utility/log.h"
+#include "common/utility/profiler.h"
 #include "common/geometry/transform.h"
 #include "common/ecs/ecs.h"
 #include "common/application/time.h"
+#include "common/application/asset_streamer.h"
+#include "common/rendering/frame_constants.h"
 
 namespace Sandbox {
 
+    // Moments are quantized to 16 bits per channel by the shadow pass, see shadow.frag.
+    static const GLenum SHADOW_MAP_FORMAT = GL_RGBA16;
+
+    // Quantized moments of the far plane, for texels not covered by any shadow caster.
+    static const glm::vec4 SHADOW_MAP_CLEAR_VALUE = glm::vec4(1.0f, 0.99756f, 0.893438f, 0.0f);
+
     SceneCS562Project2::SceneCS562Project2() : fbo_(2560, 1440),
                                                shadowMap_(2048, 2048),
                                                camera_(Window::Instance().GetWidth(), Window::Instance().GetHeight()),
@@ -50,6 +59,14 @@ namespace Sandbox {
     void SceneCS562Project2::OnRender() {
         IScene::OnRender();
 
+        // Refresh culling bounds before any pass is drawn.
+        culler_.Update();
+        spatialIndex_.Update(culler_);
+        culler_.Cull(Frustum(camera_.GetCameraTransform()), visibleEntities_);
+
+        // Camera constants are shared by all passes of the frame.
+        FrameConstants(camera_).Bind();
+
         Backend::Core::EnableFlag(GL_DEPTH_TEST);
 
         // Render shadow map.
@@ -111,6 +128,13 @@ namespace Sandbox {
             ImGui::Text("Render time:");
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+            const Backend::State::Statistics& stateChanges = Backend::State::GetStatistics();
+            ImGui::Text("%i state changes issued, %i redundant skipped", stateChanges.issued, stateChanges.avoided);
+
+            ImGui::Separator();
+
+            culler_.OnImGui();
+
             ImGui::Separator();
 
             if (ImGui::Button("Take Screenshot")) {
@@ -201,10 +225,14 @@ namespace Sandbox {
         ImGui::End();
 
         ImGuiLog::Instance().OnImGui();
+        Profiler::Instance().OnImGui();
     }
 
     void SceneCS562Project2::OnShutdown() {
         IScene::OnShutdown();
+        culler_.Clear();
+        spatialIndex_.Clear();
+        materialBuffer_.Clear();
     }
 
     void SceneCS562Project2::OnWindowResize(int width, int height) {
@@ -222,19 +250,28 @@ namespace Sandbox {
         Backend::Core::SetViewport(0, 0, width, height);
     }
 
+    ICamera* SceneCS562Project2::GetCamera() {
+        return &camera_;
+    }
+
+    std::vector<Texture*> SceneCS562Project2::GetRenderTargets() {
+        std::vector<Texture*> renderTargets = fbo_.GetRenderTargets();
+        renderTargets.insert(renderTargets.end(), shadowMap_.GetRenderTargets().begin(), shadowMap_.GetRenderTargets().end());
+        return renderTargets;
+    }
+
     void SceneCS562Project2::InitializeShaders() {
         ShaderLibrary& shaderLibrary = ShaderLibrary::Instance();
 
-        shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer.frag" });
+        materialBuffer_.SetLayout(shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer.frag" }));
         shaderLibrary.CreateShader("Global Lighting Shadow Pass", { "assets/shaders/fsq.vert", "assets/shaders/global_lighting_shadow.frag" });
-        shaderLibrary.CreateShader("Local Lighting Pass", { "assets/shaders/model.vert", "assets/shaders/local_lighting.frag" });
+        shaderLibrary.CreateShader("Local Lighting Pass", { "assets/shaders/local_light.vert", "assets/shaders/local_lighting.frag" });
         shaderLibrary.CreateShader("FSQ", { "assets/shaders/fsq.vert", "assets/shaders/fsq.frag" });
 
         shaderLibrary.CreateShader("Shadow Pass", { "assets/shaders/shadow.vert", "assets/shaders/shadow.frag" });
         shaderLibrary.CreateShader("Depth Pass", { "assets/shaders/fsq.vert", "assets/shaders/depth.frag" });
         shaderLibrary.CreateShader("Depth Out", { "assets/shaders/fsq.vert", "assets/shaders/depth_out.frag" });
-        shaderLibrary.CreateShader("Blur Horizontal", { "assets/shaders/blur_horizontal.comp" });
-        shaderLibrary.CreateShader("Blur Vertical", { "assets/shaders/blur_vertical.comp" });
+        shaderLibrary.CreateShader("Box Blur", { "assets/shaders/box_blur.comp" });
     }
 
     void SceneCS562Project2::InitializeMaterials() {
@@ -258,9 +295,7 @@ namespace Sandbox {
         // Bunny.
         int bunny = ecs.CreateEntity("Bunny");
 
-        ecs.AddComponent<Mesh>(bunny, OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/bunny_high_poly.obj"))).Configure([](Mesh& mesh) {
-            mesh.Complete();
-        });
+        AssetStreamer::Instance().LoadMesh(bunny, "assets/models/bunny_high_poly.obj");
 
         ecs.AddComponent<MaterialCollection>(bunny).Configure([this](MaterialCollection& materialCollection) {
             Material* phong = materialLibrary_.GetMaterialInstance("Phong");
@@ -271,9 +306,7 @@ namespace Sandbox {
 
         // Floor.
         int floor = ecs.CreateEntity("Floor");
-        ecs.AddComponent<Mesh>(floor, OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/quad.obj"))).Configure([](Mesh& mesh) {
-            mesh.Complete();
-        });
+        AssetStreamer::Instance().LoadMesh(floor, "assets/models/quad.obj");
 
         ecs.AddComponent<MaterialCollection>(floor).Configure([this](MaterialCollection& materialCollection) {
             Material* phong = materialLibrary_.GetMaterialInstance("Phong");
@@ -410,7 +443,7 @@ namespace Sandbox {
 
         Texture* depthTexture = new Texture("depth");
         depthTexture->Bind();
-        depthTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
+        depthTexture->ReserveData(SHADOW_MAP_FORMAT, contentWidth, contentHeight);
         depthTexture->Unbind();
         shadowMap_.AttachRenderTarget(depthTexture);
 
@@ -424,13 +457,13 @@ namespace Sandbox {
         // Textures for compute shader blurring.
         Texture* blurHorizontalTexture = new Texture("blur horizontal");
         blurHorizontalTexture->Bind();
-        blurHorizontalTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
+        blurHorizontalTexture->ReserveData(SHADOW_MAP_FORMAT, contentWidth, contentHeight);
         blurHorizontalTexture->Unbind();
         shadowMap_.AttachRenderTarget(blurHorizontalTexture);
 
         Texture* blurVerticalTexture = new Texture("blur vertical");
         blurVerticalTexture->Bind();
-        blurVerticalTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
+        blurVerticalTexture->ReserveData(SHADOW_MAP_FORMAT, contentWidth, contentHeight);
         blurVerticalTexture->Unbind();
         shadowMap_.AttachRenderTarget(blurVerticalTexture);
 
@@ -454,6 +487,8 @@ namespace Sandbox {
     }
 
     void SceneCS562Project2::GeometryPass() {
+        PROFILE_GPU_SCOPE("GeometryPass");
+
         fbo_.DrawBuffers(0, 5);
         Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear everything for a new scene.
@@ -461,29 +496,32 @@ namespace Sandbox {
         Shader* geometryShader = ShaderLibrary::Instance().GetShader("Geometry Pass");
         geometryShader->Bind();
 
-        // Set camera uniforms.
-        geometryShader->SetUniform("cameraTransform", camera_.GetCameraTransform());
         geometryShader->SetUniform("normalBlend", 1.0f);
 
-        // Render models to FBO attachments.
-        ECS::Instance().IterateOver<Transform, Mesh, MaterialCollection>([geometryShader](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
+        // Render visible models to FBO attachments, grouped by material and mesh and front to back within a group.
+        ECS& ecs = ECS::Instance();
+        const glm::vec3& cameraPosition = camera_.GetPosition();
+        float farPlaneDistance = camera_.GetFarPlaneDistance();
+
+        renderQueue_.Clear();
+        ecs.IterateOver<Transform, Mesh, MaterialCollection>(visibleEntities_, [this, geometryShader, &cameraPosition, farPlaneDistance](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
             const glm::mat4& modelTransform = transform.GetMatrix();
-            geometryShader->SetUniform("modelTransform", modelTransform);
-            geometryShader->SetUniform("normalTransform", glm::transpose(glm::inverse(modelTransform)));
+            float depth = glm::distance(cameraPosition, glm::vec3(modelTransform[3])) / farPlaneDistance;
 
-            // Bind all related uniforms with the Phong shader.
+            // Phong material is selected by its record in the material buffer.
             Material* phong = materialCollection.GetNamedMaterial("Phong");
-            if (phong) {
-                phong->Bind(geometryShader);
-            }
+            renderQueue_.Submit(depth, { geometryShader, nullptr, &mesh, modelTransform, phong ? materialBuffer_.GetMaterialID(phong) : 0 });
+        });
 
-            // Render stage.
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
+        renderQueue_.Sort();
 
-            // Post render stage.
-        });
+        // Only records of materials edited since the last frame are uploaded.
+        materialBuffer_.Update();
+        materialBuffer_.Bind();
+
+        int drawn = renderQueue_.Execute();
+
+        culler_.RecordPass("Geometry", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, MaterialCollection>().size()));
 
         geometryShader->Unbind();
 
@@ -497,8 +535,6 @@ namespace Sandbox {
 
             Shader* depthShader = ShaderLibrary::Instance().GetShader("Depth Pass");
             depthShader->Bind();
-            depthShader->SetUniform("near", camera_.GetNearPlaneDistance());
-            depthShader->SetUniform("far", camera_.GetFarPlaneDistance());
             Backend::Rendering::BindTextureWithSampler(depthShader, fbo_.GetNamedRenderTarget("depth buffer"), "inputTexture", 0);
             Backend::Rendering::DrawFSQ();
             depthShader->Unbind();
@@ -508,6 +544,8 @@ namespace Sandbox {
     }
 
     void SceneCS562Project2::GlobalLightingPass() {
+        PROFILE_GPU_SCOPE("GlobalLightingPass");
+
         // Render to 'output' texture.
         fbo_.DrawBuffers(6, 1);
 
@@ -553,6 +591,8 @@ namespace Sandbox {
     }
 
     void SceneCS562Project2::LocalLightingPass() {
+        PROFILE_GPU_SCOPE("LocalLightingPass");
+
         // Render to 'output' texture.
         fbo_.DrawBuffers(6, 1);
         // No clearing here.
@@ -573,18 +613,16 @@ namespace Sandbox {
         Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("diffuse"), 3);
         Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("specular"), 4);
 
-        ECS::Instance().IterateOver<Transform, Mesh, LocalLight>([localLightingShader](Transform& transform, Mesh& mesh, LocalLight& light) {
-            localLightingShader->SetUniform("modelTransform", transform.GetMatrix());
+        // Light volumes are looked up in the spatial index instead of being tested against the frustum one by one.
+        visibleLights_.clear();
+        spatialIndex_.QueryFrustum(Frustum(camera_.GetCameraTransform()), visibleLights_);
 
-            localLightingShader->SetUniform("lightPosition", transform.GetPosition());
-            localLightingShader->SetUniform("lightRadius", transform.GetScale().x);
-            localLightingShader->SetUniform("lightColor", light.color_);
-            localLightingShader->SetUniform("lightBrightness", light.brightness_);
+        // All visible lights sharing a light volume mesh are drawn with a single instanced draw call.
+        ECS& ecs = ECS::Instance();
+        int drawn = lightBatch_.Build(visibleLights_);
+        lightBatch_.Render(localLightingShader);
 
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
-        });
+        culler_.RecordPass("Local lights", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, LocalLight>().size()));
 
         localLightingShader->Unbind();
     }
@@ -607,82 +645,18 @@ namespace Sandbox {
     }
 
     void SceneCS562Project2::InitializeBlurKernel() {
-        static bool layoutInitialized = false;
-
-        // Initialize uniform block layout.
-        const unsigned maxBlurKernelRadius = 50;
-        unsigned maximumSize = 2 * maxBlurKernelRadius + 1; // 2 w + 1.
-
-        if (!layoutInitialized) {
-            std::vector<UniformBufferElement> layoutElements;
-            layoutElements.reserve(maximumSize);
-
-            for (unsigned i = 0; i < maximumSize; ++i) {
-                layoutElements.emplace_back(UniformBufferElement { ShaderDataType::FLOAT, "weights[" + std::to_string(i) + "]" } );
-            }
-
-            UniformBlockLayout layout { };
-            layout.SetBufferElements(0, 1, layoutElements);
-
-            UniformBlock block { 3, layout };
-            blurKernel_.SetUniformBlock(block);
-
-            layoutInitialized = true;
-        }
-
-        // Provide default values to uniform block data.
-        float value = 0.0f;
-
-        const std::vector<UniformBufferElement>& elements = blurKernel_.GetUniformBlock().GetUniformBlockLayout().GetBufferElements();
-        for (int i = 0; i < maximumSize; ++i) {
-            blurKernel_.SetSubData(elements[i].GetBufferOffset(), 16, static_cast<const void*>(&value));
-        }
-
-        unsigned size = 2 * blurKernelRadius_ + 1; // 2 w + 1.
-
-        // Initialize uniform block data.
-        std::vector<float> kernel;
-        if (blurKernelRadius_ == 0) {
-            kernel.resize(size, 1.0f);
-        }
-        else {
-            kernel.resize(size, 0.0f);
-        }
-
-        float s = static_cast<float>(blurKernelRadius_) / 2.0f;
-        int offset = 0;
-
-        for (int i = -static_cast<int>(blurKernelRadius_); i <= static_cast<int>(blurKernelRadius_); ++i) {
-            float p = -(static_cast<float>(i * i)) / (2.0f * static_cast<float>(s * s));
-            kernel[offset++] = glm::exp(p);
-        }
-
-        // Normalize data to sum to 1.
-        // Since set of data is guaranteed to be positive, normalization means dividing each element by the sum.
-        float sum = 0.0f;
-        for (int i = 0; i < size; ++i) {
-            sum += kernel[i];
-        }
-
-        if (sum > 0.0f) {
-            for (int i = 0; i < size; ++i) {
-                kernel[i] /= sum;
-            }
-        }
-
-        // Set data.
-        blurKernel_.Bind();
-        for (int i = 0; i < size; ++i) {
-            blurKernel_.SetSubData(elements[i].GetBufferOffset(), 16, static_cast<const void*>(&kernel[i]));
-        }
-        blurKernel_.Unbind();
+        // Box sizes are passed to the blur shader as uniforms, there is no kernel to upload.
+        shadowBlur_.SetRadius(blurKernelRadius_);
     }
 
     // Draws all scene geometry from the perspective of the directional light.
     // Generates 3 textures: depth buffer, output shadow map for visual debugging, and four-channel shadow map for MSM algorithm.
     void SceneCS562Project2::GenerateShadowMap() {
+        PROFILE_GPU_SCOPE("GenerateShadowMap");
+
         shadowMap_.DrawBuffers(0, 2);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+        glClearBufferfv(GL_COLOR, 1, glm::value_ptr(SHADOW_MAP_CLEAR_VALUE)); // Moments.
 
         // Render scene geometry to generate four-channel depth buffer for MSM algorithm.
         {
@@ -691,18 +665,24 @@ namespace Sandbox {
             // Render four channel depth buffer.
             Shader* shadowShader = ShaderLibrary::Instance().GetShader("Shadow Pass");
             shadowShader->Bind();
-            shadowShader->SetUniform("shadowTransform", CalculateShadowMatrix());
-            shadowShader->SetUniform("near", camera_.GetNearPlaneDistance());
-            shadowShader->SetUniform("far", camera_.GetFarPlaneDistance());
+            glm::mat4 shadowTransform = CalculateShadowMatrix();
+            shadowShader->SetUniform("shadowTransform", shadowTransform);
 
-            ECS::Instance().IterateOver<Transform, Mesh>([shadowShader](Transform& transform, Mesh& mesh) {
-                shadowShader->SetUniform("modelTransform", transform.GetMatrix());
+            // Only geometry inside the light frustum can cast shadows onto the map.
+            shadowCasters_.clear();
+            spatialIndex_.QueryFrustum(Frustum(shadowTransform), shadowCasters_);
 
-                mesh.Bind();
-                mesh.Render();
-                mesh.Unbind();
+            ECS& ecs = ECS::Instance();
+            renderQueue_.Clear();
+            ecs.IterateOver<Transform, Mesh>(shadowCasters_, [this, shadowShader](Transform& transform, Mesh& mesh) {
+                renderQueue_.Submit(0.0f, { shadowShader, nullptr, &mesh, transform.GetMatrix() });
             });
 
+            renderQueue_.Sort();
+            int drawn = renderQueue_.Execute();
+
+            culler_.RecordPass("Shadow", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh>().size()));
+
             shadowShader->Unbind();
         }
 
@@ -724,67 +704,17 @@ namespace Sandbox {
     }
 
     void SceneCS562Project2::BlurShadowMap() {
+        PROFILE_GPU_SCOPE("BlurShadowMap");
+
         shadowMap_.DrawBuffers(2, 3);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT);
 
         Backend::Core::DisableFlag(GL_DEPTH_TEST);
 
-        // Horizontal blur pass.
-        {
-            Shader* blurShader = ShaderLibrary::Instance().GetShader("Blur Horizontal");
-
-            blurShader->Bind();
-            GLuint ID = blurShader->GetID();
-
-            // Set uniforms.
-            // 'src' image.
-            glBindImageTexture(0, shadowMap_.GetNamedRenderTarget("depth")->ID(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-            static GLint src = glGetUniformLocation(ID, "src");
-            glUniform1i(src, 0);
-
-            // 'dst' image.
-            glBindImageTexture(1, shadowMap_.GetNamedRenderTarget("blur horizontal")->ID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-            static GLint dst = glGetUniformLocation(ID, "dst");
-            glUniform1i(dst, 1);
-
-            // 'blurKernel' already set.
-
-            static GLint blurKernelRadius = glGetUniformLocation(ID, "blurKernelRadius");
-            glUniform1i(blurKernelRadius, static_cast<int>(blurKernelRadius_));
-
-            // Dispatch shader horizontally.
-            glDispatchCompute(shadowMap_.GetWidth() / 128, shadowMap_.GetHeight(), 1);
-
-            blurShader->Unbind();
-        }
-
-        // Vertical blur pass.
-        {
-            Shader* blurShader = ShaderLibrary::Instance().GetShader("Blur Vertical");
-
-            blurShader->Bind();
-            GLuint ID = blurShader->GetID();
-
-            // Set uniforms.
-            // 'src' image.
-            glBindImageTexture(0, shadowMap_.GetNamedRenderTarget("blur horizontal")->ID(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-            static GLint src = glGetUniformLocation(ID, "src");
-            glUniform1i(src, 0);
-
-            // 'dst' image.
-            glBindImageTexture(1, shadowMap_.GetNamedRenderTarget("blur vertical")->ID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-            static GLint dst = glGetUniformLocation(ID, "dst");
-            glUniform1i(dst, 1);
-
-            // 'blurKernel' already set.
-
-            static GLint blurKernelRadius = glGetUniformLocation(ID, "blurKernelRadius");
-            glUniform1i(blurKernelRadius, static_cast<int>(blurKernelRadius_));
-
-            // Dispatch shader horizontally.
-            glDispatchCompute(shadowMap_.GetWidth(), shadowMap_.GetHeight() / 128, 1);
-
-            blurShader->Unbind();
+        // Box filters alternate between the two blur targets and leave the result in 'blur vertical'.
+        if (blurKernelRadius_ > 0) {
+            Shader* blurShader = ShaderLibrary::Instance().GetShader("Box Blur");
+            shadowBlur_.Blur(blurShader, shadowMap_.GetNamedRenderTarget("depth"), shadowMap_.GetNamedRenderTarget("blur vertical"), shadowMap_.GetNamedRenderTarget("blur horizontal"));
         }
 
         {
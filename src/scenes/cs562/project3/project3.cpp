@@ -5,9 +5,12 @@
 #include "common/api/window.h"
 #include "common/geometry/object_loader.h"
 #include "common/utility/log.h"
+#include "common/utility/profiler.h"
 #include "common/geometry/transform.h"
 #include "common/ecs/ecs.h"
 #include "common/application/time.h"
+#include "common/application/asset_streamer.h"
+#include "common/rendering/frame_constants.h"
 
 namespace Sandbox {
 
@@ -15,15 +18,42 @@ namespace Sandbox {
     static const int GGX = 1;
     static const int BECKMAN = 2;
 
-    SceneCS562Project3::SceneCS562Project3() : fbo_(2560, 1440),
-                                               shadowMap_(2048, 2048),
-                                               camera_(Window::Instance().GetWidth(), Window::Instance().GetHeight()),
+    // Passes rendered by the indirect renderer.
+    static const unsigned GEOMETRY_PASS = 1u << 0u;
+    static const unsigned SHADOW_PASS = 1u << 1u;
+    static const unsigned DYNAMIC_SHADOW_PASS = 1u << 2u;
+
+    static const int SHADOW_MAP_SIZE = 2048;
+
+    // Moments are quantized to 16 bits per channel by the shadow pass, see shadow.frag.
+    static const GLenum SHADOW_MAP_FORMAT = GL_RGBA16;
+
+    // Quantized moments of the far plane, for texels not covered by any shadow caster.
+    static const glm::vec4 SHADOW_MAP_CLEAR_VALUE = glm::vec4(1.0f, 0.99756f, 0.893438f, 0.0f);
+
+    // Selectable geometry buffer formats. Normals are octahedral encoded into two channels.
+    static const GLenum NORMAL_FORMATS[] = { GL_RG16, GL_RGB10_A2, GL_RG16F };
+    static const char* NORMAL_FORMAT_NAMES[] = { "RG16", "RGB10_A2", "RG16F" };
+
+    // Ambient, diffuse and specular colors. The specular exponent is packed into the alpha channel, which is linear for sRGB formats.
+    static const GLenum COLOR_FORMATS[] = { GL_SRGB8_ALPHA8, GL_RGBA8, GL_RGBA16F };
+    static const char* COLOR_FORMAT_NAMES[] = { "SRGB8_ALPHA8", "RGBA8", "RGBA16F" };
+
+    // Lit output is tone mapped, but local lights are accumulated on top of it.
+    static const GLenum OUTPUT_FORMAT = GL_RGBA16F;
+
+    SceneCS562Project3::SceneCS562Project3() : camera_(Window::Instance().GetWidth(), Window::Instance().GetHeight()),
                                                blurKernelRadius_(25),
                                                brdfModel_(PHONG),
                                                environmentMap_("environment"),
                                                irradianceMap_("irradiance"),
                                                exposure_(3.0f),
-                                               contrast_(2.0f)
+                                               contrast_(2.0f),
+                                               gpuDriven_(false),
+                                               sceneBVHDirty_(true),
+                                               debugTexturesVisible_(false),
+                                               normalFormat_(0),
+                                               colorFormat_(0)
                                                {
     }
 
@@ -39,8 +69,8 @@ namespace Sandbox {
 
         ConfigureLights();
         ConfigureModels();
-        ConstructFBO();
-        ConstructShadowMap();
+        frameGraph_.SetSize(Window::Instance().GetWidth(), Window::Instance().GetHeight());
+        shadowCache_.Initialize(SHADOW_MAP_FORMAT, SHADOW_MAP_SIZE);
         InitializeBlurKernel();
         GenerateRandomPoints();
 
@@ -65,58 +95,58 @@ namespace Sandbox {
     void SceneCS562Project3::OnRender() {
         IScene::OnRender();
 
-        Backend::Core::EnableFlag(GL_DEPTH_TEST);
-
-        // Render shadow map.
-        glm::vec4 viewport = Backend::Core::GetViewport();
-
-        Backend::Core::SetViewport(0, 0, shadowMap_.GetWidth(), shadowMap_.GetHeight());
-        shadowMap_.BindForReadWrite();
-
-        GenerateShadowMap();
-        BlurShadowMap();
-
-        // Restore viewport.
-        shadowMap_.Unbind();
-        Backend::Core::SetViewport(viewport.x, viewport.y, viewport.z, viewport.w);
-
-        // Set viewport.
-        fbo_.BindForReadWrite();
-        Backend::Core::SetViewport(0, 0, fbo_.GetWidth(), fbo_.GetHeight());
-
-        // 1. G-buffer pass.
-        GeometryPass();
+        // Refresh culling bounds before any pass is drawn.
+        culler_.Update();
+        spatialIndex_.Update(culler_);
 
-        Backend::Core::DisableFlag(GL_DEPTH_TEST);
+        if (!culler_.GetModifiedEntities().empty() || !culler_.GetRemovedEntities().empty()) {
+            sceneBVHDirty_ = true;
+        }
+        culler_.Cull(Frustum(camera_.GetCameraTransform()), visibleEntities_);
 
-        // 2. Global lighting pass.
-        GlobalLightingPass();
+        // Camera and tone mapping constants are shared by all passes of the frame.
+        FrameConstants(camera_, exposure_, contrast_).Bind();
 
-        glDepthMask(GL_FALSE); // Don't write to depth buffer.
+        ECS& ecs = ECS::Instance();
 
-        // 3. Local lighting pass.
-        Backend::Core::EnableFlag(GL_BLEND); // Enable blending.
-        glBlendFunc(GL_ONE, GL_ONE);         // Additive blending TODO: abstract out.
+        // Shadow map passes are only added to the graph for the layers that need to be rebuilt.
+        shadowCache_.Update(CalculateShadowMatrix(), [&ecs](int entityID) {
+            if (!ecs.HasComponent<ShadowCaster>(entityID)) {
+                return ShadowCache::Layer::NONE;
+            }
 
-        Backend::Core::EnableFlag(GL_CULL_FACE);
-        Backend::Core::CullFace(GL_FRONT);
+            return ecs.GetComponent<ShadowCaster>(entityID)->dynamic_ ? ShadowCache::Layer::DYNAMIC : ShadowCache::Layer::STATIC;
+        });
 
-        // LocalLightingPass();
+        if (gpuDriven_) {
+            indirectRenderer_.Update(culler_, [&ecs](int entityID) {
+                unsigned passMask = 0u;
 
-        Backend::Core::DisableFlag(GL_CULL_FACE);
-        Backend::Core::DisableFlag(GL_BLEND);
+                if (ecs.HasComponent<MaterialCollection>(entityID)) {
+                    passMask |= GEOMETRY_PASS;
+                }
+                if (ecs.HasComponent<ShadowCaster>(entityID)) {
+                    passMask |= ecs.GetComponent<ShadowCaster>(entityID)->dynamic_ ? DYNAMIC_SHADOW_PASS : SHADOW_PASS;
+                }
 
-        Backend::Core::DisableFlag(GL_BLEND); // Disable blending.
+                return passMask;
+            }, [this, &ecs](int entityID) {
+                Material* phong = ecs.HasComponent<MaterialCollection>(entityID) ? ecs.GetComponent<MaterialCollection>(entityID)->GetNamedMaterial("Phong") : nullptr;
+                return phong ? materialBuffer_.GetMaterialID(phong) : 0;
+            });
+        }
 
-        glDepthMask(GL_TRUE);
         Backend::Core::EnableFlag(GL_DEPTH_TEST);
 
-        // 4. Render skydome.
-        RenderSkydome();
+        {
+            PROFILE_SCOPE("BuildFrameGraph");
+            BuildFrameGraph();
+            frameGraph_.Compile();
+        }
 
-        // Restore viewport.
-        fbo_.Unbind();
-        Backend::Core::SetViewport(viewport.x, viewport.y, viewport.z, viewport.w);
+        // Each pass of the graph is profiled under its own name.
+        frameGraph_.Execute();
+        shadowCache_.Validate();
     }
 
     void SceneCS562Project3::OnPostRender() {
@@ -135,13 +165,45 @@ namespace Sandbox {
             ImGui::Text("Render time:");
             ImGui::Text("%.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
 
+            const Backend::State::Statistics& stateChanges = Backend::State::GetStatistics();
+            ImGui::Text("%i state changes issued, %i redundant skipped", stateChanges.issued, stateChanges.avoided);
+
+            const FrameGraph::Statistics& frameGraph = frameGraph_.GetStatistics();
+            ImGui::Text("%i of %i passes executed, %i render targets in %i textures", frameGraph.passes - frameGraph.culledPasses, frameGraph.passes, frameGraph.resources, frameGraph.textures);
+            ImGui::Text("%.1f MB of render targets (%.1f MB without aliasing)", static_cast<float>(frameGraph.bytes) / (1024.0f * 1024.0f), static_cast<float>(frameGraph.unaliasedBytes) / (1024.0f * 1024.0f));
+
             ImGui::Separator();
 
-            if (ImGui::Button("Take Screenshot")) {
-                fbo_.GetNamedRenderTarget("output")->WriteDataToDirectory("data/scenes/cs562/project2/");
+            // Objects are only updated while GPU-driven rendering is enabled.
+            if (ImGui::Checkbox("GPU-driven rendering", &gpuDriven_)) {
+                indirectRenderer_.Invalidate();
+            }
+
+            if (gpuDriven_) {
+                ImGui::Text("%i objects (%i meshes), one draw call per pass.", indirectRenderer_.GetObjectCount(), indirectRenderer_.GetGeometryCount());
+            }
+            else {
+                culler_.OnImGui();
+            }
+
+            shadowCache_.OnImGui();
+
+            ImGui::Separator();
+
+            // Entities are selected by clicking on the framebuffer image.
+            ECS& ecs = ECS::Instance();
+            if (selection_.IsValid() && ecs.HasComponent<Transform>(selection_.entityID_)) {
+                ImGui::Text("Selected entity %i (triangle %i at %.2f, %.2f, %.2f)", selection_.entityID_, selection_.triangle_, selection_.position_.x, selection_.position_.y, selection_.position_.z);
+                ecs.GetComponent<Transform>(selection_.entityID_)->OnImGui();
+            }
+            else {
+                ImGui::Text("No entity selected.");
+            }
 
-//                fbo_.SaveRenderTargetsToDirectory("data/scenes/cs562_project_2/");
-//                shadowMap_.SaveRenderTargetsToDirectory("data/scenes/cs562_project_2/");
+            ImGui::Separator();
+
+            if (ImGui::Button("Take Screenshot")) {
+                frameGraph_.GetTexture("output")->WriteDataToDirectory("data/scenes/cs562/project2/");
             }
         }
         ImGui::End();
@@ -158,65 +220,52 @@ namespace Sandbox {
             ImVec2 imageSize = ImVec2(maxWidth, maxWidth / aspectRatio);
 
             ImGui::SetCursorPosY(ImGui::GetItemRectSize().y + (ImGui::GetWindowSize().y - ImGui::GetItemRectSize().y - imageSize.y) * 0.5f);
-            ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("output")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
+            ImGui::Image(reinterpret_cast<ImTextureID>(frameGraph_.GetTexture("output")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
+
+            if (ImGui::IsItemClicked(0)) {
+                ImVec2 minimum = ImGui::GetItemRectMin();
+                ImVec2 size = ImGui::GetItemRectSize();
+                ImVec2 mouse = ImGui::GetMousePos();
+
+                PickEntity(glm::vec2((mouse.x - minimum.x) / size.x, (mouse.y - minimum.y) / size.y));
+            }
         }
         ImGui::End();
 
         // Draw individual deferred rendering textures.
-        static bool showDebugTextures = false;
-        if (ImGui::Begin("Debug Textures"), &showDebugTextures) {
-            {
-                float maxWidth = ImGui::GetWindowContentRegionWidth();
-                ImVec2 imageSize = ImVec2(maxWidth, maxWidth / aspectRatio);
-
-                ImGui::Text("Position (world space):");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("position")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-
-                ImGui::Text("Normals (world space):");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("normal")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-
-                ImGui::Text("Ambient component:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("ambient")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-
-                ImGui::Text("Diffuse component:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("diffuse")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-
-                ImGui::Text("Specular component:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("specular")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-
-                ImGui::Text("Scene depth:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(fbo_.GetNamedRenderTarget("depth")->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
+        // Debug render targets are only kept (and their passes only run) while the window is visible.
+        auto showRenderTarget = [this](const char* label, const std::string& name) {
+            Texture* texture = frameGraph_.GetTexture(name);
+            if (!texture) {
+                // Available from the frame after the window became visible.
+                return;
             }
 
-            {
-                Texture* shadowMap = shadowMap_.GetNamedRenderTarget("depth output");
-                float maxWidth = ImGui::GetWindowContentRegionWidth();
-                ImVec2 imageSize = ImVec2(maxWidth, maxWidth / (static_cast<float>(shadowMap->GetWidth()) / static_cast<float>(shadowMap->GetHeight())));
+            float maxWidth = ImGui::GetWindowContentRegionWidth();
+            ImVec2 imageSize = ImVec2(maxWidth, maxWidth / (static_cast<float>(texture->GetWidth()) / static_cast<float>(texture->GetHeight())));
 
-                ImGui::Text("Shadow Map:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(shadowMap->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
-                ImGui::Separator();
-            }
+            ImGui::Text("%s", label);
+            ImGui::Image(reinterpret_cast<ImTextureID>(texture->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
+            ImGui::Separator();
+        };
 
-            {
-                ImGui::Text("Blur Kernel Radius: ");
-                if (ImGui::SliderInt("##kernelRadius", &blurKernelRadius_, 0, 50)) {
-                    InitializeBlurKernel();
-                }
+        debugTexturesVisible_ = ImGui::Begin("Debug Textures");
+        if (debugTexturesVisible_) {
+            showRenderTarget("Normals (octahedral):", "normal");
+            showRenderTarget("Ambient component:", "ambient");
+            showRenderTarget("Diffuse component:", "diffuse");
+            showRenderTarget("Specular component:", "specular");
+            showRenderTarget("Scene depth:", "depth");
 
-                Texture* shadowMap = shadowMap_.GetNamedRenderTarget("blur output");
-                float maxWidth = ImGui::GetWindowContentRegionWidth();
-                ImVec2 imageSize = ImVec2(maxWidth, maxWidth / (static_cast<float>(shadowMap->GetWidth()) / static_cast<float>(shadowMap->GetHeight())));
+            showRenderTarget("Shadow Map:", "shadow map output");
 
-                ImGui::Text("Blurred Shadow Map:");
-                ImGui::Image(reinterpret_cast<ImTextureID>(shadowMap->ID()), imageSize, ImVec2(0, 1), ImVec2(1, 0));
+            ImGui::Text("Blur Kernel Radius: ");
+            if (ImGui::SliderInt("##kernelRadius", &blurKernelRadius_, 0, 50)) {
+                InitializeBlurKernel();
+                shadowCache_.InvalidateFilter();
             }
+
+            showRenderTarget("Blurred Shadow Map:", "blurred shadow map output");
         }
         ImGui::End();
 
@@ -227,24 +276,38 @@ namespace Sandbox {
 
             ImGui::Text("Contrast: ");
             ImGui::SliderFloat("##contrast", &contrast_, 0.0f, 5.0f);
+
+            // Render targets of the new format are picked up by the frame graph on the next frame.
+            ImGui::Text("G-buffer normal format: ");
+            ImGui::Combo("##normalFormat", &normalFormat_, NORMAL_FORMAT_NAMES, IM_ARRAYSIZE(NORMAL_FORMAT_NAMES));
+
+            ImGui::Text("G-buffer color format: ");
+            ImGui::Combo("##colorFormat", &colorFormat_, COLOR_FORMAT_NAMES, IM_ARRAYSIZE(COLOR_FORMAT_NAMES));
         }
         ImGui::End();
 
         ImGuiLog::Instance().OnImGui();
+        Profiler::Instance().OnImGui();
     }
 
     void SceneCS562Project3::OnShutdown() {
         IScene::OnShutdown();
+        culler_.Clear();
+        spatialIndex_.Clear();
+        sceneBVH_.Clear();
+        sceneBVHDirty_ = true;
+        selection_ = SceneBVH::Hit();
+        materialBuffer_.Clear();
+        indirectRenderer_.Clear();
+        shadowCache_.Clear();
+        frameGraph_.Clear();
     }
 
     void SceneCS562Project3::OnWindowResize(int width, int height) {
         IScene::OnWindowResize(width, height);
 
-        // Rebuild swapchain.
-        fbo_.Reallocate(width, height);
-        if (!fbo_.CheckStatus()) {
-            throw std::runtime_error("Custom FBO is not complete.");
-        }
+        // Only render targets sized relative to the window are reallocated.
+        frameGraph_.SetSize(width, height);
 
         // Update camera aspect ratio.
         camera_.SetAspectRatio(static_cast<float>(width) / static_cast<float>(height));
@@ -252,10 +315,19 @@ namespace Sandbox {
         Backend::Core::SetViewport(0, 0, width, height);
     }
 
+    ICamera* SceneCS562Project3::GetCamera() {
+        return &camera_;
+    }
+
+    std::vector<Texture*> SceneCS562Project3::GetRenderTargets() {
+        // Intermediate targets share aliased textures, only the final output keeps its contents until the end of the frame.
+        return { frameGraph_.GetTexture("output") };
+    }
+
     void SceneCS562Project3::InitializeShaders() {
         ShaderLibrary& shaderLibrary = ShaderLibrary::Instance();
 
-        shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer.frag" });
+        materialBuffer_.SetLayout(shaderLibrary.CreateShader("Geometry Pass", { "assets/shaders/geometry_buffer.vert", "assets/shaders/geometry_buffer_compact.frag" }));
         shaderLibrary.CreateShader("Global Lighting BRDF Pass", { "assets/shaders/global_brdf.vert", "assets/shaders/global_brdf.frag" });
          shaderLibrary.CreateShader("Local Lighting BRDF Pass", { "assets/shaders/local_brdf.vert", "assets/shaders/local_brdf.frag" });
         shaderLibrary.CreateShader("FSQ", { "assets/shaders/fsq.vert", "assets/shaders/fsq.frag" });
@@ -263,10 +335,13 @@ namespace Sandbox {
         shaderLibrary.CreateShader("Shadow Pass", { "assets/shaders/shadow.vert", "assets/shaders/shadow.frag" });
         shaderLibrary.CreateShader("Depth Pass", { "assets/shaders/fsq.vert", "assets/shaders/depth.frag" });
         shaderLibrary.CreateShader("Depth Out", { "assets/shaders/fsq.vert", "assets/shaders/depth_out.frag" });
-        shaderLibrary.CreateShader("Blur Horizontal", { "assets/shaders/blur_horizontal.comp" });
-        shaderLibrary.CreateShader("Blur Vertical", { "assets/shaders/blur_vertical.comp" });
+        shaderLibrary.CreateShader("Box Blur", { "assets/shaders/box_blur.comp" });
 
         shaderLibrary.CreateShader("Skydome", { "assets/shaders/skydome.vert", "assets/shaders/skydome.frag" });
+
+        shaderLibrary.CreateShader("Indirect Cull", { "assets/shaders/indirect_cull.comp" });
+        shaderLibrary.CreateShader("Geometry Pass Indirect", { "assets/shaders/geometry_buffer_indirect.vert", "assets/shaders/geometry_buffer_indirect.frag" });
+        shaderLibrary.CreateShader("Shadow Pass Indirect", { "assets/shaders/shadow_indirect.vert", "assets/shaders/shadow.frag" });
     }
 
     void SceneCS562Project3::InitializeMaterials() {
@@ -290,9 +365,7 @@ namespace Sandbox {
         // Bunny.
         {
             int bunny = ecs.CreateEntity("Bunny");
-            ecs.AddComponent<Mesh>(bunny, OBJLoader::Instance().LoadFromFile(OBJLoader::Request("assets/models/bunny_high_poly.obj"))).Configure([](Mesh& mesh) {
-                mesh.Complete();
-            });
+            AssetStreamer::Instance().LoadMesh(bunny, "assets/models/bunny_high_poly.obj");
             ecs.AddComponent<MaterialCollection>(bunny).Configure([this](MaterialCollection& materialCollection) {
                 Material* phong = materialLibrary_.GetMaterialInstance("Phong");
                 phong->GetUniform("ambientCoefficient")->SetData(glm::vec3(0.05f));
@@ -400,209 +473,240 @@ namespace Sandbox {
         // ecs.AddComponent<ShadowCaster>(ID);
     }
 
-    void SceneCS562Project3::ConstructFBO() {
-        int contentWidth = 2560;
-        int contentHeight = 1440;
-
-        fbo_.BindForReadWrite();
-
-        // Position (world space).
-        Texture* positionTexture = new Texture("position");
-        positionTexture->Bind();
-        positionTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        positionTexture->Unbind();
-        fbo_.AttachRenderTarget(positionTexture);
-
-        // Normals (world space).
-        Texture* normalTexture = new Texture("normal");
-        normalTexture->Bind();
-        normalTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        normalTexture->Unbind();
-        fbo_.AttachRenderTarget(normalTexture);
-
-        // Ambient color.
-        Texture* ambientTexture = new Texture("ambient");
-        ambientTexture->Bind();
-        ambientTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        ambientTexture->Unbind();
-        fbo_.AttachRenderTarget(ambientTexture);
-
-        // Diffuse color.
-        Texture* diffuseTexture = new Texture("diffuse");
-        diffuseTexture->Bind();
-        diffuseTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        diffuseTexture->Unbind();
-        fbo_.AttachRenderTarget(diffuseTexture);
-
-        // Specular color.
-        Texture* specularTexture = new Texture("specular");
-        specularTexture->Bind();
-        specularTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        specularTexture->Unbind();
-        fbo_.AttachRenderTarget(specularTexture);
-
-        // Depth texture (for visualizing depth information).
-        Texture* depthTexture = new Texture("depth");
-        depthTexture->Bind();
-        depthTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        depthTexture->Unbind();
-        fbo_.AttachRenderTarget(depthTexture);
-
-        // Output texture.
-        Texture* outputTexture = new Texture("output");
-        outputTexture->Bind();
-        outputTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        outputTexture->Unbind();
-        fbo_.AttachRenderTarget(outputTexture);
-
-        // Depth buffer.
-        Texture* depthBuffer = new Texture("depth buffer");
-        depthBuffer->Bind();
-        depthBuffer->ReserveData(Texture::AttachmentType::DEPTH, contentWidth, contentHeight);
-        depthBuffer->Unbind();
-        fbo_.AttachRenderTarget(depthBuffer);
-
-        // Depth buffer (RBO).
-//        RenderBufferObject* depthBuffer = new RenderBufferObject();
-//        depthBuffer->Bind();
-//        depthBuffer->ReserveData(contentWidth, contentHeight);
-//        fbo_.AttachDepthBuffer(depthBuffer);
-
-        if (!fbo_.CheckStatus()) {
-            throw std::runtime_error("Custom FBO is not complete.");
+    void SceneCS562Project3::BuildFrameGraph() {
+        typedef FrameGraph::TextureDescription Description;
+
+        frameGraph_.Reset();
+
+        // Cached shadow map layers persist between frames. Passes writing them are only added when they are out of date,
+        // so a shadow map without changes to its casters or the light costs nothing to render.
+        frameGraph_.Import("static shadow moments", shadowCache_.GetStaticMoments());
+        frameGraph_.Import("static shadow depth buffer", shadowCache_.GetStaticDepth());
+        frameGraph_.Import("shadow map", shadowCache_.GetShadowMap());
+
+        if (shadowCache_.IsStaticLayerDirty()) {
+            frameGraph_.AddPass("Shadow Map Static", [](FrameGraph::PassBuilder& builder) {
+                builder.Write("static shadow moments");
+                builder.Write("static shadow depth buffer");
+            }, [this]() {
+                GenerateShadowMap();
+            });
         }
 
-        fbo_.Unbind();
-    }
+        // Dynamic casters are depth tested against a copy of the static layer.
+        std::string moments = "static shadow moments";
+
+        if (shadowCache_.HasDynamicCasters()) {
+            moments = "shadow moments";
+
+            frameGraph_.AddPass("Shadow Map Dynamic", [](FrameGraph::PassBuilder& builder) {
+                builder.Create("shadow moments", Description::Absolute(SHADOW_MAP_FORMAT, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+                builder.Create("shadow depth buffer", Description::Absolute(GL_DEPTH_COMPONENT32F, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+                builder.Read("static shadow moments");
+                builder.Read("static shadow depth buffer");
+                builder.Write("shadow moments");
+                builder.Write("shadow depth buffer");
+            }, [this]() {
+                CompositeShadowMap();
+            });
+        }
 
-    void SceneCS562Project3::ConstructShadowMap() {
-        int contentWidth = 2048;
-        int contentHeight = 2048;
-
-        shadowMap_.BindForReadWrite();
-
-        // Texture for visually debugging the shadow map pass.
-        Texture* outputTexture = new Texture("depth output");
-        outputTexture->Bind();
-        outputTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        outputTexture->Unbind();
-        shadowMap_.AttachRenderTarget(outputTexture);
-
-        Texture* depthTexture = new Texture("depth");
-        depthTexture->Bind();
-        depthTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        depthTexture->Unbind();
-        shadowMap_.AttachRenderTarget(depthTexture);
-
-        // Texture for visually debugging the shadow map blurring pass.
-        Texture* blurTexture = new Texture("blur output");
-        blurTexture->Bind();
-        blurTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        blurTexture->Unbind();
-        shadowMap_.AttachRenderTarget(blurTexture);
-
-        // Textures for compute shader blurring.
-        Texture* blurHorizontalTexture = new Texture("blur horizontal");
-        blurHorizontalTexture->Bind();
-        blurHorizontalTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        blurHorizontalTexture->Unbind();
-        shadowMap_.AttachRenderTarget(blurHorizontalTexture);
-
-        Texture* blurVerticalTexture = new Texture("blur vertical");
-        blurVerticalTexture->Bind();
-        blurVerticalTexture->ReserveData(Texture::AttachmentType::COLOR, contentWidth, contentHeight);
-        blurVerticalTexture->Unbind();
-        shadowMap_.AttachRenderTarget(blurVerticalTexture);
-
-        Texture* depthBuffer = new Texture("depth buffer");
-        depthBuffer->Bind();
-        depthBuffer->ReserveData(Texture::AttachmentType::DEPTH, contentWidth, contentHeight);
-        depthBuffer->Unbind();
-        shadowMap_.AttachRenderTarget(depthBuffer);
-
-//        // Depth buffer (RBO).
-//        RenderBufferObject* depthBuffer = new RenderBufferObject();
-//        depthBuffer->Bind();
-//        depthBuffer->ReserveData(contentWidth, contentHeight);
-//        shadowMap_.AttachDepthBuffer(depthBuffer);
-
-        if (!shadowMap_.CheckStatus()) {
-            throw std::runtime_error("Custom Shadow FBO is not complete.");
+        frameGraph_.AddPass("Shadow Map Debug", [moments](FrameGraph::PassBuilder& builder) {
+            builder.Create("shadow map output", Description::Absolute(GL_RGBA8, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+            builder.Read(moments);
+            builder.Write("shadow map output");
+        }, [this, moments]() {
+            RenderDepth(moments, "inputTexture");
+        });
+
+        // Blurred moments are used for shadowing, unless blurring is disabled. They are kept until one of the layers changes.
+        std::string shadowMap = moments;
+
+        if (blurKernelRadius_ > 0) {
+            shadowMap = "shadow map";
+
+            if (shadowCache_.IsShadowMapDirty()) {
+                // Blur passes alternate between the scratch target and the shadow map.
+                frameGraph_.AddPass("Shadow Map Blur", [moments](FrameGraph::PassBuilder& builder) {
+                    builder.Create("shadow blur", Description::Absolute(SHADOW_MAP_FORMAT, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+                    builder.Read(moments);
+                    builder.WriteStorage("shadow blur");
+                    builder.WriteStorage("shadow map");
+                }, [this, moments]() {
+                    BlurShadowMap(moments);
+                });
+            }
         }
 
-        shadowMap_.Unbind();
+        frameGraph_.AddPass("Shadow Map Blur Debug", [shadowMap](FrameGraph::PassBuilder& builder) {
+            builder.Create("blurred shadow map output", Description::Absolute(GL_RGBA8, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE));
+            builder.Read(shadowMap);
+            builder.Write("blurred shadow map output");
+        }, [this, shadowMap]() {
+            RenderDepth(shadowMap, "depthTexture");
+        });
+
+        // World position is not stored, it is reconstructed from the depth buffer.
+        GLenum normalFormat = NORMAL_FORMATS[normalFormat_];
+        GLenum colorFormat = COLOR_FORMATS[colorFormat_];
+
+        frameGraph_.AddPass("Geometry", [normalFormat, colorFormat](FrameGraph::PassBuilder& builder) {
+            builder.Create("normal", Description::Relative(normalFormat));
+            builder.Write("normal");
+
+            for (const char* name : { "ambient", "diffuse", "specular" }) {
+                builder.Create(name, Description::Relative(colorFormat));
+                builder.Write(name);
+            }
+
+            builder.Create("depth buffer", Description::Relative(GL_DEPTH_COMPONENT32F));
+            builder.Write("depth buffer");
+        }, [this]() {
+            GeometryPass();
+        });
+
+        frameGraph_.AddPass("Scene Depth Debug", [](FrameGraph::PassBuilder& builder) {
+            builder.Create("depth", Description::Relative(GL_RGBA8));
+            builder.Read("depth buffer");
+            builder.Write("depth");
+        }, [this]() {
+            RenderSceneDepth();
+        });
+
+        frameGraph_.AddPass("Lighting", [shadowMap](FrameGraph::PassBuilder& builder) {
+            for (const char* name : { "depth buffer", "normal", "ambient", "diffuse", "specular" }) {
+                builder.Read(name);
+            }
+            builder.Read(shadowMap);
+
+            builder.Create("output", Description::Relative(OUTPUT_FORMAT));
+            builder.Write("output");
+        }, [this, shadowMap]() {
+            Backend::Core::DisableFlag(GL_DEPTH_TEST);
+
+            // 1. Global lighting pass.
+            GlobalLightingPass(shadowMap);
+
+            Backend::Core::WriteDepth(false); // Don't write to depth buffer.
+
+            // 2. Local lighting pass.
+            Backend::Core::EnableFlag(GL_BLEND); // Enable blending.
+            glBlendFunc(GL_ONE, GL_ONE);         // Additive blending TODO: abstract out.
+
+            Backend::Core::EnableFlag(GL_CULL_FACE);
+            Backend::Core::CullFace(GL_FRONT);
+
+            // LocalLightingPass();
+
+            Backend::Core::DisableFlag(GL_CULL_FACE);
+            Backend::Core::DisableFlag(GL_BLEND); // Disable blending.
+
+            Backend::Core::WriteDepth(true);
+            Backend::Core::EnableFlag(GL_DEPTH_TEST);
+        });
+
+        // Skydome is depth tested against the scene.
+        frameGraph_.AddPass("Skydome", [](FrameGraph::PassBuilder& builder) {
+            builder.Write("output");
+            builder.Write("depth buffer");
+        }, [this]() {
+            RenderSkydome();
+        });
+
+        frameGraph_.MarkOutput("output");
+
+        if (debugTexturesVisible_) {
+            for (const char* name : { "normal", "ambient", "diffuse", "specular", "depth", "shadow map output", "blurred shadow map output" }) {
+                frameGraph_.MarkOutput(name);
+            }
+        }
     }
 
     void SceneCS562Project3::GeometryPass() {
-        fbo_.DrawBuffers(0, 5);
         Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT); // Clear everything for a new scene.
 
-        Shader* geometryShader = ShaderLibrary::Instance().GetShader("Geometry Pass");
-        geometryShader->Bind();
+        // Linear colors are encoded when written to sRGB attachments, and decoded again when sampled.
+        Backend::Core::EnableFlag(GL_FRAMEBUFFER_SRGB);
 
-        // Set camera uniforms.
-        geometryShader->SetUniform("cameraTransform", camera_.GetCameraTransform());
-        geometryShader->SetUniform("normalBlend", 1.0f);
+        if (gpuDriven_) {
+            // Culling and submission of all models happen on the GPU.
+            indirectRenderer_.Cull(ShaderLibrary::Instance().GetShader("Indirect Cull"), Frustum(camera_.GetCameraTransform()), GEOMETRY_PASS);
 
-        // Render models to FBO attachments.
-        ECS::Instance().IterateOver<Transform, Mesh, MaterialCollection>([geometryShader](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
-            const glm::mat4& modelTransform = transform.GetMatrix();
-            geometryShader->SetUniform("modelTransform", modelTransform);
-            geometryShader->SetUniform("normalTransform", glm::transpose(glm::inverse(modelTransform)));
+            Shader* geometryShader = ShaderLibrary::Instance().GetShader("Geometry Pass Indirect");
+            geometryShader->Bind();
+            geometryShader->SetUniform("normalBlend", 1.0f);
 
-            // Bind all related uniforms with the Phong shader.
-            Material* phong = materialCollection.GetNamedMaterial("Phong");
-            if (phong) {
-                phong->Bind(geometryShader);
-            }
+            // Objects select their Phong material by its record in the material buffer.
+            materialBuffer_.Update();
+            materialBuffer_.Bind();
 
-            // Render stage.
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
+            indirectRenderer_.Render(GEOMETRY_PASS);
 
-            // Post render stage.
-        });
+            geometryShader->Unbind();
+        }
+        else {
+            Shader* geometryShader = ShaderLibrary::Instance().GetShader("Geometry Pass");
+            geometryShader->Bind();
 
-        geometryShader->Unbind();
+            geometryShader->SetUniform("normalBlend", 1.0f);
 
-        Backend::Core::DisableFlag(GL_DEPTH_TEST);
+            // Render visible models to FBO attachments, grouped by material and mesh and front to back within a group.
+            ECS& ecs = ECS::Instance();
+            const glm::vec3& cameraPosition = camera_.GetPosition();
+            float farPlaneDistance = camera_.GetFarPlaneDistance();
 
-        // Render scene depth.
-        {
-            fbo_.DrawBuffers(5, 1);
-            Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-            Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT); // Clear everything for a new scene.
-
-            Shader* depthShader = ShaderLibrary::Instance().GetShader("Depth Pass");
-            depthShader->Bind();
-            depthShader->SetUniform("near", camera_.GetNearPlaneDistance());
-            depthShader->SetUniform("far", camera_.GetFarPlaneDistance());
-            Backend::Rendering::BindTextureWithSampler(depthShader, fbo_.GetNamedRenderTarget("depth buffer"), "inputTexture", 0);
-            Backend::Rendering::DrawFSQ();
-            depthShader->Unbind();
+            renderQueue_.Clear();
+            ecs.IterateOver<Transform, Mesh, MaterialCollection>(visibleEntities_, [this, geometryShader, &cameraPosition, farPlaneDistance](Transform& transform, Mesh& mesh, MaterialCollection& materialCollection) {
+                const glm::mat4& modelTransform = transform.GetMatrix();
+                float depth = glm::distance(cameraPosition, glm::vec3(modelTransform[3])) / farPlaneDistance;
+
+                // Phong material is selected by its record in the material buffer.
+                Material* phong = materialCollection.GetNamedMaterial("Phong");
+                renderQueue_.Submit(depth, { geometryShader, nullptr, &mesh, modelTransform, phong ? materialBuffer_.GetMaterialID(phong) : 0 });
+            });
+
+            renderQueue_.Sort();
+
+            // Only records of materials edited since the last frame are uploaded.
+            materialBuffer_.Update();
+            materialBuffer_.Bind();
+
+            int drawn = renderQueue_.Execute();
+
+            culler_.RecordPass("Geometry", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, MaterialCollection>().size()));
+
+            geometryShader->Unbind();
         }
 
-        Backend::Core::EnableFlag(GL_DEPTH_TEST);
+        Backend::Core::DisableFlag(GL_FRAMEBUFFER_SRGB);
     }
 
-    void SceneCS562Project3::GlobalLightingPass() {
-        // Render to 'output' texture.
-        fbo_.DrawBuffers(6, 1);
+    void SceneCS562Project3::RenderSceneDepth() {
+        Backend::Core::DisableFlag(GL_DEPTH_TEST);
 
+        Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT);
+
+        Shader* depthShader = ShaderLibrary::Instance().GetShader("Depth Pass");
+        depthShader->Bind();
+        Backend::Rendering::BindTextureWithSampler(depthShader, frameGraph_.GetTexture("depth buffer"), "inputTexture", 0);
+        Backend::Rendering::DrawFSQ();
+        depthShader->Unbind();
+
+        Backend::Core::EnableFlag(GL_DEPTH_TEST);
+    }
+
+    void SceneCS562Project3::GlobalLightingPass(const std::string& shadowMap) {
         Backend::Core::ClearColor(0.0f, 0.0f, 0.0f, 1.0f);
         Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT); // We are not touching depth buffer here.
 
         Shader* globalLightingShader = ShaderLibrary::Instance().GetShader("Global Lighting BRDF Pass");
         globalLightingShader->Bind();
 
-        // Set camera uniforms.
-        globalLightingShader->SetUniform("cameraPosition", camera_.GetPosition());
+        // Set shadow uniforms.
         glm::mat4 B = glm::translate(glm::mat4(1.0f), glm::vec3(0.5f)) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f));
         globalLightingShader->SetUniform("shadowTransform", B * CalculateShadowMatrix());
-        globalLightingShader->SetUniform("near", camera_.GetNearPlaneDistance());
-        globalLightingShader->SetUniform("far", camera_.GetFarPlaneDistance());
 
         // Set global lighting uniforms.
         globalLightingShader->SetUniform("lightDirection", directionalLight_.direction_);
@@ -611,25 +715,16 @@ namespace Sandbox {
 
         // BRDF model.
         globalLightingShader->SetUniform("model", brdfModel_);
-        globalLightingShader->SetUniform("exposure", exposure_);
-        globalLightingShader->SetUniform("contrast", contrast_);
 
         // Bind geometry pass textures.
-        Backend::Rendering::BindTextureWithSampler(globalLightingShader, fbo_.GetNamedRenderTarget("position"), 0);
-        Backend::Rendering::BindTextureWithSampler(globalLightingShader, fbo_.GetNamedRenderTarget("normal"), 1);
-        Backend::Rendering::BindTextureWithSampler(globalLightingShader, fbo_.GetNamedRenderTarget("ambient"), 2);
-        Backend::Rendering::BindTextureWithSampler(globalLightingShader, fbo_.GetNamedRenderTarget("diffuse"), 3);
-        Backend::Rendering::BindTextureWithSampler(globalLightingShader, fbo_.GetNamedRenderTarget("specular"), 4);
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture("depth buffer"), "depthBuffer", 0);
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture("normal"), 1);
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture("ambient"), 2);
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture("diffuse"), 3);
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture("specular"), 4);
 
         // Bind shadow map.
-        shadowMap_.BindForRead();
-        if (blurKernelRadius_ > 0) {
-            // Vertical blurring pass happens after horizontal blurring pass.
-            Backend::Rendering::BindTextureWithSampler(globalLightingShader, shadowMap_.GetNamedRenderTarget("blur vertical"), "shadowMap", 5);
-        }
-        else {
-            Backend::Rendering::BindTextureWithSampler(globalLightingShader, shadowMap_.GetNamedRenderTarget("depth"), "shadowMap", 5);
-        }
+        Backend::Rendering::BindTextureWithSampler(globalLightingShader, frameGraph_.GetTexture(shadowMap), "shadowMap", 5);
 
         Backend::Rendering::BindTextureWithSampler(globalLightingShader, &environmentMap_, "environmentMap", 6);
         Backend::Rendering::BindTextureWithSampler(globalLightingShader, &irradianceMap_, "irradianceMap", 7);
@@ -641,40 +736,30 @@ namespace Sandbox {
     }
 
     void SceneCS562Project3::LocalLightingPass() {
-        // Render to 'output' texture.
-        fbo_.DrawBuffers(6, 1);
-
         Shader* localLightingShader = ShaderLibrary::Instance().GetShader("Local Lighting BRDF Pass");
         localLightingShader->Bind();
 
-        localLightingShader->SetUniform("resolution", glm::vec2(fbo_.GetWidth(), fbo_.GetHeight()));
+        localLightingShader->SetUniform("resolution", glm::vec2(frameGraph_.GetWidth(), frameGraph_.GetHeight()));
 
-        // Set camera uniforms.
-        localLightingShader->SetUniform("cameraPosition", camera_.GetPosition());
-        localLightingShader->SetUniform("cameraTransform", camera_.GetCameraTransform());
         localLightingShader->SetUniform("model", brdfModel_);
-        localLightingShader->SetUniform("exposure", exposure_);
-        localLightingShader->SetUniform("contrast", contrast_);
 
         // Bind geometry pass textures.
-        Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("position"), 0);
-        Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("normal"), 1);
-        Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("ambient"), 2);
-        Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("diffuse"), 3);
-        Backend::Rendering::BindTextureWithSampler(localLightingShader, fbo_.GetNamedRenderTarget("specular"), 4);
+        Backend::Rendering::BindTextureWithSampler(localLightingShader, frameGraph_.GetTexture("depth buffer"), "depthBuffer", 0);
+        Backend::Rendering::BindTextureWithSampler(localLightingShader, frameGraph_.GetTexture("normal"), 1);
+        Backend::Rendering::BindTextureWithSampler(localLightingShader, frameGraph_.GetTexture("ambient"), 2);
+        Backend::Rendering::BindTextureWithSampler(localLightingShader, frameGraph_.GetTexture("diffuse"), 3);
+        Backend::Rendering::BindTextureWithSampler(localLightingShader, frameGraph_.GetTexture("specular"), 4);
 
-        ECS::Instance().IterateOver<Transform, Mesh, LocalLight>([localLightingShader](Transform& transform, Mesh& mesh, LocalLight& light) {
-            localLightingShader->SetUniform("modelTransform", transform.GetMatrix());
+        // Light volumes are looked up in the spatial index instead of being tested against the frustum one by one.
+        visibleLights_.clear();
+        spatialIndex_.QueryFrustum(Frustum(camera_.GetCameraTransform()), visibleLights_);
 
-            localLightingShader->SetUniform("lightPosition", transform.GetPosition());
-            localLightingShader->SetUniform("lightRadius", transform.GetScale().x);
-            localLightingShader->SetUniform("lightColor", light.color_);
-            localLightingShader->SetUniform("lightBrightness", light.brightness_);
+        // All visible lights sharing a light volume mesh are drawn with a single instanced draw call.
+        ECS& ecs = ECS::Instance();
+        int drawn = lightBatch_.Build(visibleLights_);
+        lightBatch_.Render(localLightingShader);
 
-            mesh.Bind();
-            mesh.Render();
-            mesh.Unbind();
-        });
+        culler_.RecordPass("Local lights", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, LocalLight>().size()));
 
         localLightingShader->Unbind();
     }
@@ -697,197 +782,85 @@ namespace Sandbox {
     }
 
     void SceneCS562Project3::InitializeBlurKernel() {
-        static bool layoutInitialized = false;
-
-        // Initialize uniform block layout.
-        const unsigned maxBlurKernelRadius = 50;
-        unsigned maximumSize = 2 * maxBlurKernelRadius + 1; // 2 w + 1.
-
-        if (!layoutInitialized) {
-            std::vector<UniformBufferElement> layoutElements;
-            layoutElements.reserve(maximumSize);
-
-            for (unsigned i = 0; i < maximumSize; ++i) {
-                layoutElements.emplace_back(UniformBufferElement { ShaderDataType::FLOAT, "weights[" + std::to_string(i) + "]" } );
-            }
+        // Box sizes are passed to the blur shader as uniforms, there is no kernel to upload.
+        shadowBlur_.SetRadius(blurKernelRadius_);
+    }
 
-            UniformBlockLayout layout { };
-            layout.SetBufferElements(0, 1, layoutElements);
+    // Draws static shadow casters from the perspective of the directional light into the cached layer.
+    // Generates 2 textures: depth buffer and four-channel shadow map for MSM algorithm.
+    void SceneCS562Project3::GenerateShadowMap() {
+        glClearBufferfv(GL_COLOR, 0, glm::value_ptr(SHADOW_MAP_CLEAR_VALUE));
+        Backend::Core::ClearFlag(GL_DEPTH_BUFFER_BIT);
+        RenderShadowCasters(SHADOW_PASS);
+    }
 
-            UniformBlock block { 3, layout };
-            blurKernel_.SetUniformBlock(block);
+    // Draws dynamic shadow casters over a copy of the static layer, without clearing it.
+    void SceneCS562Project3::CompositeShadowMap() {
+        glCopyImageSubData(shadowCache_.GetStaticMoments()->ID(), GL_TEXTURE_2D, 0, 0, 0, 0, frameGraph_.GetTexture("shadow moments")->ID(), GL_TEXTURE_2D, 0, 0, 0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1);
+        glCopyImageSubData(shadowCache_.GetStaticDepth()->ID(), GL_TEXTURE_2D, 0, 0, 0, 0, frameGraph_.GetTexture("shadow depth buffer")->ID(), GL_TEXTURE_2D, 0, 0, 0, 0, SHADOW_MAP_SIZE, SHADOW_MAP_SIZE, 1);
 
-            layoutInitialized = true;
-        }
+        RenderShadowCasters(DYNAMIC_SHADOW_PASS);
+    }
 
-        // Provide default values to uniform block data.
-        float value = 0.0f;
+    void SceneCS562Project3::RenderShadowCasters(unsigned pass) {
+        // Render four channel depth buffer.
+        glm::mat4 shadowTransform = CalculateShadowMatrix();
 
-        const std::vector<UniformBufferElement>& elements = blurKernel_.GetUniformBlock().GetUniformBlockLayout().GetBufferElements();
-        for (int i = 0; i < maximumSize; ++i) {
-            blurKernel_.SetSubData(elements[i].GetBufferOffset(), 16, static_cast<const void*>(&value));
+        if (gpuDriven_) {
+            indirectRenderer_.Cull(ShaderLibrary::Instance().GetShader("Indirect Cull"), Frustum(shadowTransform), pass);
         }
 
-        unsigned size = 2 * blurKernelRadius_ + 1; // 2 w + 1.
+        Shader* shadowShader = ShaderLibrary::Instance().GetShader(gpuDriven_ ? "Shadow Pass Indirect" : "Shadow Pass");
+        shadowShader->Bind();
+        shadowShader->SetUniform("shadowTransform", shadowTransform);
 
-        // Initialize uniform block data.
-        std::vector<float> kernel;
-        if (blurKernelRadius_ == 0) {
-            kernel.resize(size, 1.0f);
+        if (gpuDriven_) {
+            indirectRenderer_.Render(pass);
         }
         else {
-            kernel.resize(size, 0.0f);
-        }
+            bool dynamic = pass == DYNAMIC_SHADOW_PASS;
 
-        float s = static_cast<float>(blurKernelRadius_) / 2.0f;
-        int offset = 0;
+            // Only geometry inside the light frustum can cast shadows onto the map.
+            shadowCasters_.clear();
+            spatialIndex_.QueryFrustum(Frustum(shadowTransform), shadowCasters_);
 
-        for (int i = -static_cast<int>(blurKernelRadius_); i <= static_cast<int>(blurKernelRadius_); ++i) {
-            float p = -(static_cast<float>(i * i)) / (2.0f * static_cast<float>(s * s));
-            kernel[offset++] = glm::exp(p);
-        }
+            renderQueue_.Clear();
+            ECS::Instance().IterateOver<Transform, Mesh, ShadowCaster>(shadowCasters_, [this, shadowShader, dynamic](Transform& transform, Mesh& mesh, ShadowCaster& shadowCaster) {
+                if (shadowCaster.dynamic_ == dynamic) {
+                    renderQueue_.Submit(0.0f, { shadowShader, nullptr, &mesh, transform.GetMatrix() });
+                }
+            });
 
-        // Normalize data to sum to 1.
-        // Since set of data is guaranteed to be positive, normalization means dividing each element by the sum.
-        float sum = 0.0f;
-        for (int i = 0; i < size; ++i) {
-            sum += kernel[i];
-        }
+            renderQueue_.Sort();
+            int drawn = renderQueue_.Execute();
 
-        if (sum > 0.0f) {
-            for (int i = 0; i < size; ++i) {
-                kernel[i] /= sum;
+            if (dynamic) {
+                culler_.RecordPass("Shadow (dynamic)", drawn, shadowCache_.GetDynamicCasterCount());
+            }
+            else {
+                culler_.RecordPass("Shadow (static)", drawn, shadowCache_.GetStaticCasterCount());
             }
         }
 
-        // Set data.
-        blurKernel_.Bind();
-        for (int i = 0; i < size; ++i) {
-            blurKernel_.SetSubData(elements[i].GetBufferOffset(), 16, static_cast<const void*>(&kernel[i]));
-        }
-        blurKernel_.Unbind();
+        shadowShader->Unbind();
     }
 
-    // Draws all scene geometry from the perspective of the directional light.
-    // Generates 3 textures: depth buffer, output shadow map for visual debugging, and four-channel shadow map for MSM algorithm.
-    void SceneCS562Project3::GenerateShadowMap() {
-        shadowMap_.DrawBuffers(0, 2);
-        Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-
-        // Render scene geometry to generate four-channel depth buffer for MSM algorithm.
-        {
-            shadowMap_.DrawBuffers(1, 1);
-
-            // Render four channel depth buffer.
-            Shader* shadowShader = ShaderLibrary::Instance().GetShader("Shadow Pass");
-            shadowShader->Bind();
-            shadowShader->SetUniform("shadowTransform", CalculateShadowMatrix());
-            shadowShader->SetUniform("near", camera_.GetNearPlaneDistance());
-            shadowShader->SetUniform("far", camera_.GetFarPlaneDistance());
-
-            ECS::Instance().IterateOver<Transform, Mesh, ShadowCaster>([shadowShader](Transform& transform, Mesh& mesh, ShadowCaster&) {
-                shadowShader->SetUniform("modelTransform", transform.GetMatrix());
-
-                mesh.Bind();
-                mesh.Render();
-                mesh.Unbind();
-            });
-
-            shadowShader->Unbind();
-        }
-
+    // Renders a single channel of a shadow map out for debug viewing.
+    void SceneCS562Project3::RenderDepth(const std::string& source, const std::string& samplerName) {
         Backend::Core::DisableFlag(GL_DEPTH_TEST);
 
-        // Render output shadow map for visual debugging.
-        {
-            shadowMap_.DrawBuffers(0, 1);
-
-            // Render single channel shadow map out for debug viewing.
-            Shader* shadowShader = ShaderLibrary::Instance().GetShader("Depth Out");
-            shadowShader->Bind();
-            Backend::Rendering::BindTextureWithSampler(shadowShader, shadowMap_.GetNamedRenderTarget("depth"), "inputTexture", 0);
-            Backend::Rendering::DrawFSQ();
-            shadowShader->Unbind();
-        }
+        Shader* depthShader = ShaderLibrary::Instance().GetShader("Depth Out");
+        depthShader->Bind();
+        Backend::Rendering::BindTextureWithSampler(depthShader, frameGraph_.GetTexture(source), samplerName, 0);
+        Backend::Rendering::DrawFSQ();
+        depthShader->Unbind();
 
         Backend::Core::EnableFlag(GL_DEPTH_TEST);
     }
 
-    void SceneCS562Project3::BlurShadowMap() {
-        shadowMap_.DrawBuffers(2, 3);
-        Backend::Core::ClearFlag(GL_COLOR_BUFFER_BIT);
-
-        Backend::Core::DisableFlag(GL_DEPTH_TEST);
-
-        // Horizontal blur pass.
-        {
-            Shader* blurShader = ShaderLibrary::Instance().GetShader("Blur Horizontal");
-
-            blurShader->Bind();
-            GLuint ID = blurShader->GetID();
-
-            // Set uniforms.
-            // 'src' image.
-            glBindImageTexture(0, shadowMap_.GetNamedRenderTarget("depth")->ID(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-            static GLint src = glGetUniformLocation(ID, "src");
-            glUniform1i(src, 0);
-
-            // 'dst' image.
-            glBindImageTexture(1, shadowMap_.GetNamedRenderTarget("blur horizontal")->ID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-            static GLint dst = glGetUniformLocation(ID, "dst");
-            glUniform1i(dst, 1);
-
-            // 'blurKernel' already set.
-
-            static GLint blurKernelRadius = glGetUniformLocation(ID, "blurKernelRadius");
-            glUniform1i(blurKernelRadius, static_cast<int>(blurKernelRadius_));
-
-            // Dispatch shader horizontally.
-            glDispatchCompute(shadowMap_.GetWidth() / 128, shadowMap_.GetHeight(), 1);
-
-            blurShader->Unbind();
-        }
-
-        // Vertical blur pass.
-        {
-            Shader* blurShader = ShaderLibrary::Instance().GetShader("Blur Vertical");
-
-            blurShader->Bind();
-            GLuint ID = blurShader->GetID();
-
-            // Set uniforms.
-            // 'src' image.
-            glBindImageTexture(0, shadowMap_.GetNamedRenderTarget("blur horizontal")->ID(), 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA32F);
-            static GLint src = glGetUniformLocation(ID, "src");
-            glUniform1i(src, 0);
-
-            // 'dst' image.
-            glBindImageTexture(1, shadowMap_.GetNamedRenderTarget("blur vertical")->ID(), 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA32F);
-            static GLint dst = glGetUniformLocation(ID, "dst");
-            glUniform1i(dst, 1);
-
-            // 'blurKernel' already set.
-
-            static GLint blurKernelRadius = glGetUniformLocation(ID, "blurKernelRadius");
-            glUniform1i(blurKernelRadius, static_cast<int>(blurKernelRadius_));
-
-            // Dispatch shader horizontally.
-            glDispatchCompute(shadowMap_.GetWidth(), shadowMap_.GetHeight() / 128, 1);
-
-            blurShader->Unbind();
-        }
-
-        {
-            shadowMap_.DrawBuffers(2, 1);
-
-            Shader* depthShader = ShaderLibrary::Instance().GetShader("Depth Out");
-            depthShader->Bind();
-            Backend::Rendering::BindTextureWithSampler(depthShader, shadowMap_.GetNamedRenderTarget(blurKernelRadius_ > 0 ? "blur vertical" : "depth"), "depthTexture", 0);
-            Backend::Rendering::DrawFSQ();
-            depthShader->Unbind();
-        }
-
-        Backend::Core::EnableFlag(GL_DEPTH_TEST);
+    void SceneCS562Project3::BlurShadowMap(const std::string& source) {
+        Shader* blurShader = ShaderLibrary::Instance().GetShader("Box Blur");
+        shadowBlur_.Blur(blurShader, frameGraph_.GetTexture(source), frameGraph_.GetTexture("shadow map"), frameGraph_.GetTexture("shadow blur"));
     }
 
     void SceneCS562Project3::GenerateRandomPoints() {
@@ -926,15 +899,17 @@ namespace Sandbox {
                 points.emplace_back(u, v);
             }
 
-            // Set data.
-            const std::vector<UniformBufferElement>& layoutElements = randomPoints_.GetUniformBlock().GetUniformBlockLayout().GetBufferElements();
-            int index = 0;
+            // std140 layout: the count takes the first 16 bytes, each point is padded to 16 bytes.
+            // The whole block is uploaded at once.
+            std::vector<glm::vec4> data(numRandomPoints + 1, glm::vec4(0.0f));
+            std::memcpy(&data[0], &numRandomPoints, sizeof(int));
 
-            randomPoints_.Bind();
-            randomPoints_.SetSubData(layoutElements[index++].GetBufferOffset(), 16, static_cast<const void*>(&numRandomPoints));
-            for (const glm::vec2& value : points) {
-                randomPoints_.SetSubData(layoutElements[index++].GetBufferOffset(), 16, static_cast<const void*>(&value));
+            for (int i = 0; i < numRandomPoints; ++i) {
+                data[i + 1] = glm::vec4(points[i], 0.0f, 0.0f);
             }
+
+            randomPoints_.Bind();
+            randomPoints_.SetSubData(0, data.size() * sizeof(glm::vec4), static_cast<const void*>(data.data()));
             randomPoints_.Unbind();
         }
     }
@@ -943,14 +918,15 @@ namespace Sandbox {
         const std::string environmentMapName = ConvertToNativeSeparators("assets/textures/ibl/monument_valley.hdr");
         const std::string irradianceMapName = ConvertToNativeSeparators(GetAssetDirectory(environmentMapName) + "/" + GetAssetName(environmentMapName) + "_irradiance.hdr");
 
-        environmentMap_.ReserveData(environmentMapName);
-
-        if (!Exists(irradianceMapName)) {
-            ImGuiLog::Instance().LogTrace("Generating irradiance map for environment map: '%s'", environmentMapName.c_str());
-            GenerateIrradianceMap(environmentMapName);
-        }
+        AssetStreamer& assetStreamer = AssetStreamer::Instance();
+        assetStreamer.LoadTexture(&environmentMap_, environmentMapName);
 
-        irradianceMap_.ReserveData(irradianceMapName);
+        // Irradiance map generation takes several seconds, do it on the worker thread as well.
+        assetStreamer.LoadTexture(&irradianceMap_, irradianceMapName, [this, environmentMapName, irradianceMapName]() {
+            if (!Exists(irradianceMapName)) {
+                GenerateIrradianceMap(environmentMapName);
+            }
+        });
     }
 
 //    SceneCS562Project3::HDRImageData SceneCS562Project3::ReadHDRImage(const std::string& filename) const {
@@ -1017,6 +993,7 @@ namespace Sandbox {
             throw std::runtime_error("GenerateIrradianceMap expects an .hdr (HDR) input file.");
         }
 
+        PROFILE_SCOPE("GenerateIrradianceMap");
         std::chrono::high_resolution_clock::time_point start = std::chrono::high_resolution_clock::now();
 
         // Load raw image data.
@@ -1175,8 +1152,6 @@ namespace Sandbox {
     }
 
     void SceneCS562Project3::RenderSkydome() {
-        fbo_.DrawBuffers(6, 1);
-
         // Render four channel depth buffer.
         Shader* skydomeShader = ShaderLibrary::Instance().GetShader("Skydome");
         skydomeShader->Bind();
@@ -1189,7 +1164,12 @@ namespace Sandbox {
         skydomeShader->SetUniform("contrast", contrast_);
         Backend::Rendering::BindTextureWithSampler(skydomeShader, &environmentMap_, "environmentMap", 0);
 
-        ECS::Instance().IterateOver<Transform, Mesh, Skydome>([skydomeShader](Transform& transform, Mesh& mesh, Skydome&) {
+        // The skydome is rendered without camera translation, so it is culled against the matching frustum.
+        std::vector<int> visibleSkydomes;
+        culler_.Cull(Frustum(perspective * view), visibleSkydomes);
+
+        ECS& ecs = ECS::Instance();
+        int drawn = ecs.IterateOver<Transform, Mesh, Skydome>(visibleSkydomes, [skydomeShader](Transform& transform, Mesh& mesh, Skydome&) {
             skydomeShader->SetUniform("modelTransform", transform.GetMatrix());
             skydomeShader->SetUniform("normalTransform", glm::inverse(glm::transpose(transform.GetMatrix())));
 
@@ -1198,7 +1178,31 @@ namespace Sandbox {
             mesh.Unbind();
         });
 
+        culler_.RecordPass("Skydome", drawn, static_cast<int>(ecs.GetEntityIDs<Transform, Mesh, Skydome>().size()));
+
         skydomeShader->Unbind();
     }
 
-}
\ No newline at end of file
+    void SceneCS562Project3::PickEntity(const glm::vec2& position) {
+        if (sceneBVHDirty_) {
+            sceneBVH_.Build();
+            sceneBVHDirty_ = false;
+        }
+
+        // Image is displayed with the origin in the top left corner, NDC have it in the bottom left.
+        glm::vec2 ndc = glm::vec2(position.x * 2.0f - 1.0f, 1.0f - position.y * 2.0f);
+        glm::mat4 inverseCameraTransform = glm::inverse(camera_.GetCameraTransform());
+
+        glm::vec4 nearPoint = inverseCameraTransform * glm::vec4(ndc, -1.0f, 1.0f);
+        glm::vec4 farPoint = inverseCameraTransform * glm::vec4(ndc, 1.0f, 1.0f);
+        nearPoint /= nearPoint.w;
+        farPoint /= farPoint.w;
+
+        // Ray spans the camera frustum from the near to the far plane.
+        Ray ray(glm::vec3(nearPoint), glm::vec3(farPoint - nearPoint), 0.0f, 1.0f);
+
+        selection_ = SceneBVH::Hit();
+        sceneBVH_.ClosestHit(ray, selection_);
+    }
+
+}